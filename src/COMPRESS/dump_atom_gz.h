@@ -21,7 +21,6 @@ DumpStyle(atom/gz,DumpAtomGZ)
 #define LMP_DUMP_ATOM_GZ_H
 
 #include "dump_atom.h"
-#include <zlib.h>
 
 namespace LAMMPS_NS {
 
@@ -31,12 +30,16 @@ class DumpAtomGZ : public DumpAtom {
   virtual ~DumpAtomGZ();
 
  protected:
-  gzFile gzFp;  // file pointer for the compressed output stream
+  class GzFileWriter *writer;  // writer for the compressed output stream
+  int compression_level;       // zlib compression level 0-9
+  int compression_threads;     // # of threads compressing output
 
   virtual void openfile();
   virtual void write_header(bigint);
+  void write_header_binary(bigint);
   virtual void write_data(int, double *);
-  virtual void write();
+  virtual void write_finish();
+  virtual int modify_param(int, char **);
 };
 
 }
@@ -54,4 +57,17 @@ E: Cannot open dump file
 
 Self-explanatory.
 
+E: Compression of gzip file failed
+
+Zlib reported an error while compressing a block of the dump file.
+
+E: Write to gzip file failed
+
+The compressed dump file could not be written, e.g. because the disk
+is full.
+
+E: Illegal dump_modify command
+
+Self-explanatory.
+
 */
@@ -12,9 +12,11 @@
 ------------------------------------------------------------------------- */
 
 #include "dump_cfg_gz.h"
+#include "gz_file_writer.h"
 #include "atom.h"
 #include "domain.h"
 #include "error.h"
+#include "force.h"
 #include "update.h"
 
 #include <cstring>
@@ -25,10 +27,14 @@ using namespace LAMMPS_NS;
 DumpCFGGZ::DumpCFGGZ(LAMMPS *lmp, int narg, char **arg) :
   DumpCFG(lmp, narg, arg)
 {
-  gzFp = NULL;
+  writer = NULL;
+  compression_level = 9;
+  compression_threads = 1;
 
   if (!compressed)
     error->all(FLERR,"Dump cfg/gz only writes compressed files");
+  if (binary)
+    error->all(FLERR,"Dump cfg/gz cannot write binary files");
 }
 
 
@@ -36,8 +42,9 @@ DumpCFGGZ::DumpCFGGZ(LAMMPS *lmp, int narg, char **arg) :
 
 DumpCFGGZ::~DumpCFGGZ()
 {
-  if (gzFp) gzclose(gzFp);
-  gzFp = NULL;
+  wait_write();
+  delete writer;
+  writer = NULL;
   fp = NULL;
 }
 
@@ -93,14 +100,10 @@ void DumpCFGGZ::openfile()
   // each proc with filewriter = 1 opens a file
 
   if (filewriter) {
-    if (append_flag) {
-      gzFp = gzopen(filecurrent,"ab9");
-    } else {
-      gzFp = gzopen(filecurrent,"wb9");
-    }
-
-    if (gzFp == NULL) error->one(FLERR,"Cannot open dump file");
-  } else gzFp = NULL;
+    writer = new GzFileWriter(compression_level,compression_threads);
+    if (writer->open(filecurrent,append_flag))
+      error->one(FLERR,"Cannot open dump file");
+  } else writer = NULL;
 
   // delete string with timestep replaced
 
@@ -124,43 +127,70 @@ void DumpCFGGZ::write_header(bigint n)
 
   char str[64];
   sprintf(str,"Number of particles = %s\n",BIGINT_FORMAT);
-  gzprintf(gzFp,str,n);
-  gzprintf(gzFp,"A = %g Angstrom (basic length-scale)\n",scale);
-  gzprintf(gzFp,"H0(1,1) = %g A\n",domain->xprd);
-  gzprintf(gzFp,"H0(1,2) = 0 A \n");
-  gzprintf(gzFp,"H0(1,3) = 0 A \n");
-  gzprintf(gzFp,"H0(2,1) = %g A \n",domain->xy);
-  gzprintf(gzFp,"H0(2,2) = %g A\n",domain->yprd);
-  gzprintf(gzFp,"H0(2,3) = 0 A \n");
-  gzprintf(gzFp,"H0(3,1) = %g A \n",domain->xz);
-  gzprintf(gzFp,"H0(3,2) = %g A \n",domain->yz);
-  gzprintf(gzFp,"H0(3,3) = %g A\n",domain->zprd);
-  gzprintf(gzFp,".NO_VELOCITY.\n");
-  gzprintf(gzFp,"entry_count = %d\n",nfield-2);
+  writer->printf(str,n);
+  writer->printf("A = %g Angstrom (basic length-scale)\n",scale);
+  writer->printf("H0(1,1) = %g A\n",domain->xprd);
+  writer->printf("H0(1,2) = 0 A \n");
+  writer->printf("H0(1,3) = 0 A \n");
+  writer->printf("H0(2,1) = %g A \n",domain->xy);
+  writer->printf("H0(2,2) = %g A\n",domain->yprd);
+  writer->printf("H0(2,3) = 0 A \n");
+  writer->printf("H0(3,1) = %g A \n",domain->xz);
+  writer->printf("H0(3,2) = %g A \n",domain->yz);
+  writer->printf("H0(3,3) = %g A\n",domain->zprd);
+  writer->printf(".NO_VELOCITY.\n");
+  writer->printf("entry_count = %d\n",nfield-2);
   for (int i = 0; i < nfield-5; i++)
-    gzprintf(gzFp,"auxiliary[%d] = %s\n",i,auxname[i]);
+    writer->printf("auxiliary[%d] = %s\n",i,auxname[i]);
 }
 
 /* ---------------------------------------------------------------------- */
 
 void DumpCFGGZ::write_data(int n, double *mybuf)
 {
-  gzwrite(gzFp,mybuf,sizeof(char)*n);
+  writer->write(mybuf,n);
+  if (writer->failed()) write_error(writer->message());
 }
 
 /* ---------------------------------------------------------------------- */
 
-void DumpCFGGZ::write()
+void DumpCFGGZ::write_finish()
 {
-  DumpCFG::write();
-  if (filewriter) {
-    if (multifile) {
-      gzclose(gzFp);
-      gzFp = NULL;
-    } else {
-      if (flush_flag)
-        gzflush(gzFp,Z_SYNC_FLUSH);
-    }
+  if (multifile) writer->close();
+  else if (flush_flag) writer->flush();
+  if (writer->failed()) write_error(writer->message());
+
+  if (multifile) {
+    delete writer;
+    writer = NULL;
   }
 }
 
+/* ---------------------------------------------------------------------- */
+
+int DumpCFGGZ::modify_param(int narg, char **arg)
+{
+  int n = DumpCFG::modify_param(narg,arg);
+  if (n) return n;
+
+  if (strcmp(arg[0],"compression_level") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_level = force->inumeric(FLERR,arg[1]);
+    if (compression_level < 0 || compression_level > 9)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_level(compression_level);
+    return 2;
+  }
+
+  if (strcmp(arg[0],"compression_threads") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_threads = force->inumeric(FLERR,arg[1]);
+    if (compression_threads < 1)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_threads(compression_threads);
+    return 2;
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,308 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "dump_columnar.h"
+#include <cstring>
+#include <zlib.h>
+#include "domain.h"
+#include "update.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+// file layout, also in reader_columnar.cpp
+//   file magic, one frame per snapshot, index of all frames, index magic
+//   frame = header, size of each chunk in file, chunks of column 0,
+//           chunks of column 1, ...
+//   chunk = CHUNKROWS values of one column as doubles
+//           or byte-shuffled and deflated if that is smaller
+
+#define FILEMAGIC "LMPCOL01"
+#define INDEXMAGIC "LMPCOLIX"
+#define MAGICLEN 8
+#define CHUNKROWS 65536
+
+/* ---------------------------------------------------------------------- */
+
+DumpColumnar::DumpColumnar(LAMMPS *lmp, int narg, char **arg) :
+  DumpCustom(lmp, narg, arg)
+{
+  if (compressed)
+    error->all(FLERR,"Dump columnar cannot write gzipped files");
+
+  // per-atom values are sent to the filewriter as doubles
+
+  binary = 1;
+  buffer_allow = 0;
+  buffer_flag = 0;
+
+  compression_level = 0;
+
+  nrows = maxrows = 0;
+  frame = NULL;
+
+  column = NULL;
+  shuffle = NULL;
+  zbuf = NULL;
+  maxzbuf = 0;
+  chunkbytes = NULL;
+  maxchunks = 0;
+
+  nindex = maxindex = 0;
+  index_step = index_offset = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpColumnar::~DumpColumnar()
+{
+  wait_write();
+
+  // index of single file is written when it is closed
+
+  if (filewriter && fp && !multifile) write_index();
+
+  memory->sfree(frame);
+  memory->destroy(column);
+  memory->destroy(shuffle);
+  memory->sfree(zbuf);
+  memory->destroy(chunkbytes);
+  memory->destroy(index_step);
+  memory->destroy(index_offset);
+}
+
+/* ----------------------------------------------------------------------
+   appending would put a 2nd file magic after the index of the old frames
+------------------------------------------------------------------------- */
+
+void DumpColumnar::init_style()
+{
+  if (append_flag)
+    error->all(FLERR,"Dump columnar cannot append to existing file");
+
+  DumpCustom::init_style();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpColumnar::openfile()
+{
+  if (singlefile_opened) return;
+
+  Dump::openfile();
+
+  if (filewriter) write_bytes(FILEMAGIC,MAGICLEN);
+  nindex = 0;
+}
+
+/* ----------------------------------------------------------------------
+   store header info of snapshot, it is written with the per-atom data
+------------------------------------------------------------------------- */
+
+void DumpColumnar::write_header(bigint /*ndump*/)
+{
+  frame_step = update->ntimestep;
+  frame_triclinic = domain->triclinic;
+  nrows = 0;
+}
+
+/* ----------------------------------------------------------------------
+   append per-atom values of one proc to snapshot
+------------------------------------------------------------------------- */
+
+void DumpColumnar::write_data(int n, double *mybuf)
+{
+  if (nrows + n > maxrows) {
+    maxrows = nrows + n;
+    frame = (double *)
+      memory->srealloc(frame,maxrows*size_one*sizeof(double),"dump:frame");
+  }
+  memcpy(&frame[nrows*size_one],mybuf,(bigint) n*size_one*sizeof(double));
+  nrows += n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpColumnar::write_finish()
+{
+  write_frame();
+  if (multifile) write_index();
+  Dump::write_finish();
+}
+
+/* ----------------------------------------------------------------------
+   write gathered snapshot column by column
+   chunk sizes are only known after compression,
+     so their slots are written first and filled in at the end
+------------------------------------------------------------------------- */
+
+void DumpColumnar::write_frame()
+{
+  if (nindex == maxindex) {
+    maxindex += 1024;
+    memory->grow(index_step,maxindex,"dump:index_step");
+    memory->grow(index_offset,maxindex,"dump:index_offset");
+  }
+  index_step[nindex] = frame_step;
+  index_offset[nindex] = tell();
+  nindex++;
+
+  double box[9];
+  box[0] = boxxlo; box[1] = boxxhi;
+  box[2] = boxylo; box[3] = boxyhi;
+  box[4] = boxzlo; box[5] = boxzhi;
+  box[6] = box[7] = box[8] = 0.0;
+  if (frame_triclinic) {
+    box[6] = boxxy; box[7] = boxxz; box[8] = boxyz;
+  }
+
+  int nlabel = strlen(columns) + 1;
+  int chunkrows = CHUNKROWS;
+
+  write_bytes(&frame_step,sizeof(bigint));
+  write_bytes(&nrows,sizeof(bigint));
+  write_bytes(&frame_triclinic,sizeof(int));
+  write_bytes(box,9*sizeof(double));
+  write_bytes(&size_one,sizeof(int));
+  write_bytes(&nlabel,sizeof(int));
+  write_bytes(columns,nlabel);
+  write_bytes(&chunkrows,sizeof(int));
+
+  int nchunks = (nrows + CHUNKROWS - 1) / CHUNKROWS;
+  if (nchunks*size_one > maxchunks) {
+    maxchunks = nchunks*size_one;
+    memory->destroy(chunkbytes);
+    memory->create(chunkbytes,maxchunks,"dump:chunkbytes");
+  }
+  if (column == NULL) {
+    memory->create(column,CHUNKROWS,"dump:column");
+    memory->create(shuffle,CHUNKROWS*sizeof(double),"dump:shuffle");
+  }
+  if (compression_level && zbuf == NULL) {
+    maxzbuf = compressBound(CHUNKROWS*sizeof(double));
+    zbuf = (char *) memory->smalloc(maxzbuf,"dump:zbuf");
+  }
+
+  bigint dirpos = tell();
+  memset(chunkbytes,0,nchunks*size_one*sizeof(bigint));
+  write_bytes(chunkbytes,(bigint) nchunks*size_one*sizeof(bigint));
+
+  for (int icol = 0; icol < size_one; icol++) {
+    for (int ichunk = 0; ichunk < nchunks; ichunk++) {
+      bigint first = (bigint) ichunk*CHUNKROWS;
+      int m = MIN(nrows-first,CHUNKROWS);
+      const double *src = &frame[first*size_one + icol];
+      for (int i = 0; i < m; i++) column[i] = src[i*size_one];
+
+      bigint nbytes = (bigint) m*sizeof(double);
+      const char *out = (const char *) column;
+
+      // store as deflated byte planes if that is smaller
+      // the same bytes of neighboring doubles are often identical
+
+      if (compression_level) {
+        const char *bytes = (const char *) column;
+        for (int i = 0; i < m; i++)
+          for (int b = 0; b < (int) sizeof(double); b++)
+            shuffle[b*m + i] = bytes[i*sizeof(double) + b];
+        uLongf zlen = maxzbuf;
+        if (compress2((Bytef *) zbuf,&zlen,(Bytef *) shuffle,nbytes,
+                      compression_level) == Z_OK && (bigint) zlen < nbytes) {
+          nbytes = zlen;
+          out = zbuf;
+        }
+      }
+
+      write_bytes(out,nbytes);
+      chunkbytes[icol*nchunks + ichunk] = nbytes;
+    }
+  }
+
+  bigint endpos = tell();
+  if (fseek(fp,dirpos,SEEK_SET) != 0)
+    write_error("Error writing dump columnar file");
+  write_bytes(chunkbytes,(bigint) nchunks*size_one*sizeof(bigint));
+  if (fseek(fp,endpos,SEEK_SET) != 0)
+    write_error("Error writing dump columnar file");
+}
+
+/* ----------------------------------------------------------------------
+   write index of timesteps and offsets of all frames at end of file
+------------------------------------------------------------------------- */
+
+void DumpColumnar::write_index()
+{
+  bigint offset = tell();
+  bigint n = nindex;
+
+  write_bytes(index_step,n*sizeof(bigint));
+  write_bytes(index_offset,n*sizeof(bigint));
+  write_bytes(&n,sizeof(bigint));
+  write_bytes(&offset,sizeof(bigint));
+  write_bytes(INDEXMAGIC,MAGICLEN);
+  nindex = 0;
+}
+
+/* ----------------------------------------------------------------------
+   write N bytes to file, a short write means the index would be wrong
+------------------------------------------------------------------------- */
+
+void DumpColumnar::write_bytes(const void *ptr, bigint n)
+{
+  if ((bigint) fwrite(ptr,sizeof(char),n,fp) != n)
+    write_error("Error writing dump columnar file");
+}
+
+/* ----------------------------------------------------------------------
+   return current position in file
+------------------------------------------------------------------------- */
+
+bigint DumpColumnar::tell()
+{
+  long pos = ftell(fp);
+  if (pos < 0) write_error("Error writing dump columnar file");
+  return pos;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpColumnar::modify_param(int narg, char **arg)
+{
+  int n = DumpCustom::modify_param(narg,arg);
+  if (n) return n;
+
+  if (strcmp(arg[0],"compression_level") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_level = force->inumeric(FLERR,arg[1]);
+    if (compression_level < 0 || compression_level > 9)
+      error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+bigint DumpColumnar::memory_usage()
+{
+  bigint bytes = DumpCustom::memory_usage();
+  bytes += maxrows*size_one * sizeof(double);
+  if (column) bytes += CHUNKROWS * 2*sizeof(double);
+  bytes += maxzbuf;
+  bytes += maxchunks * sizeof(bigint);
+  bytes += 2*maxindex * sizeof(bigint);
+  return bytes;
+}
@@ -0,0 +1,95 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(columnar,DumpColumnar)
+
+#else
+
+#ifndef LMP_DUMP_COLUMNAR_H
+#define LMP_DUMP_COLUMNAR_H
+
+#include "dump_custom.h"
+
+namespace LAMMPS_NS {
+
+class DumpColumnar : public DumpCustom {
+ public:
+  DumpColumnar(class LAMMPS *, int, char **);
+  virtual ~DumpColumnar();
+  virtual bigint memory_usage();
+
+ protected:
+  int compression_level;     // zlib level for column chunks, 0 = none
+
+  bigint frame_step;         // timestep of snapshot being written
+  int frame_triclinic;       // 1 if snapshot box is triclinic
+
+  bigint nrows;              // # of atoms gathered for snapshot
+  bigint maxrows;            // allocated rows of frame
+  double *frame;             // per-atom values of snapshot, row by row
+
+  double *column;            // values of one chunk of one column
+  char *shuffle;             // byte-shuffled copy of column
+  char *zbuf;                // compressed chunk
+  bigint maxzbuf;            // allocated size of zbuf
+  bigint *chunkbytes;        // size in file of each chunk of snapshot
+  int maxchunks;             // allocated length of chunkbytes
+
+  int nindex,maxindex;       // # of snapshots in file and allocated
+  bigint *index_step;        // timestep of each snapshot in file
+  bigint *index_offset;      // byte offset of each snapshot in file
+
+  virtual void init_style();
+  virtual void openfile();
+  virtual void write_header(bigint);
+  virtual void write_data(int, double *);
+  virtual void write_finish();
+  virtual int modify_param(int, char **);
+
+  void write_frame();
+  void write_index();
+  void write_bytes(const void *, bigint);
+  bigint tell();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Dump columnar cannot write gzipped files
+
+Use the dump_modify compression_level keyword to compress the data
+in a columnar dump file.
+
+E: Dump columnar cannot append to existing file
+
+The index at the end of a columnar dump file cannot be extended.
+Write the new snapshots to a different file.
+
+E: Error writing dump columnar file
+
+A snapshot or the frame index could not be written completely, e.g.
+because the disk is full.
+
+E: Illegal dump_modify command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+*/
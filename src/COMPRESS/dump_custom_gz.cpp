@@ -12,8 +12,10 @@
 ------------------------------------------------------------------------- */
 
 #include "dump_custom_gz.h"
+#include "gz_file_writer.h"
 #include "domain.h"
 #include "error.h"
+#include "force.h"
 #include "update.h"
 
 #include <cstring>
@@ -23,7 +25,9 @@ using namespace LAMMPS_NS;
 DumpCustomGZ::DumpCustomGZ(LAMMPS *lmp, int narg, char **arg) :
   DumpCustom(lmp, narg, arg)
 {
-  gzFp = NULL;
+  writer = NULL;
+  compression_level = 9;
+  compression_threads = 1;
 
   if (!compressed)
     error->all(FLERR,"Dump custom/gz only writes compressed files");
@@ -34,8 +38,9 @@ DumpCustomGZ::DumpCustomGZ(LAMMPS *lmp, int narg, char **arg) :
 
 DumpCustomGZ::~DumpCustomGZ()
 {
-  if (gzFp) gzclose(gzFp);
-  gzFp = NULL;
+  wait_write();
+  delete writer;
+  writer = NULL;
   fp = NULL;
 }
 
@@ -91,14 +96,10 @@ void DumpCustomGZ::openfile()
   // each proc with filewriter = 1 opens a file
 
   if (filewriter) {
-    if (append_flag) {
-      gzFp = gzopen(filecurrent,"ab9");
-    } else {
-      gzFp = gzopen(filecurrent,"wb9");
-    }
-
-    if (gzFp == NULL) error->one(FLERR,"Cannot open dump file");
-  } else gzFp = NULL;
+    writer = new GzFileWriter(compression_level,compression_threads);
+    if (writer->open(filecurrent,append_flag))
+      error->one(FLERR,"Cannot open dump file");
+  } else writer = NULL;
 
   // delete string with timestep replaced
 
@@ -108,51 +109,114 @@ void DumpCustomGZ::openfile()
 void DumpCustomGZ::write_header(bigint ndump)
 {
   if ((multiproc) || (!multiproc && me == 0)) {
+    if (binary) {
+      write_header_binary(ndump);
+      return;
+    }
+
     if (unit_flag && !unit_count) {
       ++unit_count;
-      gzprintf(gzFp,"ITEM: UNITS\n%s\n",update->unit_style);
+      writer->printf("ITEM: UNITS\n%s\n",update->unit_style);
     }
-    if (time_flag) gzprintf(gzFp,"ITEM: TIME\n%.16g\n",compute_time());
+    if (time_flag) writer->printf("ITEM: TIME\n%.16g\n",compute_time());
 
-    gzprintf(gzFp,"ITEM: TIMESTEP\n");
-    gzprintf(gzFp,BIGINT_FORMAT "\n",update->ntimestep);
-    gzprintf(gzFp,"ITEM: NUMBER OF ATOMS\n");
-    gzprintf(gzFp,BIGINT_FORMAT "\n",ndump);
+    writer->printf("ITEM: TIMESTEP\n");
+    writer->printf(BIGINT_FORMAT "\n",update->ntimestep);
+    writer->printf("ITEM: NUMBER OF ATOMS\n");
+    writer->printf(BIGINT_FORMAT "\n",ndump);
     if (domain->triclinic == 0) {
-      gzprintf(gzFp,"ITEM: BOX BOUNDS %s\n",boundstr);
-      gzprintf(gzFp,"%-1.16g %-1.16g\n",boxxlo,boxxhi);
-      gzprintf(gzFp,"%-1.16g %-1.16g\n",boxylo,boxyhi);
-      gzprintf(gzFp,"%-1.16g %-1.16g\n",boxzlo,boxzhi);
+      writer->printf("ITEM: BOX BOUNDS %s\n",boundstr);
+      writer->printf("%-1.16g %-1.16g\n",boxxlo,boxxhi);
+      writer->printf("%-1.16g %-1.16g\n",boxylo,boxyhi);
+      writer->printf("%-1.16g %-1.16g\n",boxzlo,boxzhi);
     } else {
-      gzprintf(gzFp,"ITEM: BOX BOUNDS xy xz yz %s\n",boundstr);
-      gzprintf(gzFp,"%-1.16g %-1.16g %-1.16g\n",boxxlo,boxxhi,boxxy);
-      gzprintf(gzFp,"%-1.16g %-1.16g %-1.16g\n",boxylo,boxyhi,boxxz);
-      gzprintf(gzFp,"%-1.16g %-1.16g %-1.16g\n",boxzlo,boxzhi,boxyz);
+      writer->printf("ITEM: BOX BOUNDS xy xz yz %s\n",boundstr);
+      writer->printf("%-1.16g %-1.16g %-1.16g\n",boxxlo,boxxhi,boxxy);
+      writer->printf("%-1.16g %-1.16g %-1.16g\n",boxylo,boxyhi,boxxz);
+      writer->printf("%-1.16g %-1.16g %-1.16g\n",boxzlo,boxzhi,boxyz);
     }
-    gzprintf(gzFp,"ITEM: ATOMS %s\n",columns);
+    writer->printf("ITEM: ATOMS %s\n",columns);
   }
 }
 
+/* ----------------------------------------------------------------------
+   header of binary dump, same layout as DumpCustom::header_binary()
+------------------------------------------------------------------------- */
+
+void DumpCustomGZ::write_header_binary(bigint ndump)
+{
+  int nchunk = multiproc ? nclusterprocs : nprocs;
+
+  writer->write(&update->ntimestep,sizeof(bigint));
+  writer->write(&ndump,sizeof(bigint));
+  writer->write(&domain->triclinic,sizeof(int));
+  writer->write(&domain->boundary[0][0],6*sizeof(int));
+  writer->write(&boxxlo,sizeof(double));
+  writer->write(&boxxhi,sizeof(double));
+  writer->write(&boxylo,sizeof(double));
+  writer->write(&boxyhi,sizeof(double));
+  writer->write(&boxzlo,sizeof(double));
+  writer->write(&boxzhi,sizeof(double));
+  if (domain->triclinic) {
+    writer->write(&boxxy,sizeof(double));
+    writer->write(&boxxz,sizeof(double));
+    writer->write(&boxyz,sizeof(double));
+  }
+  writer->write(&size_one,sizeof(int));
+  writer->write(&nchunk,sizeof(int));
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpCustomGZ::write_data(int n, double *mybuf)
 {
-  gzwrite(gzFp,mybuf,sizeof(char)*n);
+  if (binary) {
+    int m = n*size_one;
+    writer->write(&m,sizeof(int));
+    writer->write(mybuf,(bigint) m*sizeof(double));
+  } else writer->write(mybuf,n);
+  if (writer->failed()) write_error(writer->message());
 }
 
 /* ---------------------------------------------------------------------- */
 
-void DumpCustomGZ::write()
+void DumpCustomGZ::write_finish()
 {
-  DumpCustom::write();
-  if (filewriter) {
-    if (multifile) {
-      gzclose(gzFp);
-      gzFp = NULL;
-    } else {
-      if (flush_flag)
-        gzflush(gzFp,Z_SYNC_FLUSH);
-    }
+  if (multifile) writer->close();
+  else if (flush_flag) writer->flush();
+  if (writer->failed()) write_error(writer->message());
+
+  if (multifile) {
+    delete writer;
+    writer = NULL;
   }
 }
 
+/* ---------------------------------------------------------------------- */
+
+int DumpCustomGZ::modify_param(int narg, char **arg)
+{
+  int n = DumpCustom::modify_param(narg,arg);
+  if (n) return n;
+
+  if (strcmp(arg[0],"compression_level") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_level = force->inumeric(FLERR,arg[1]);
+    if (compression_level < 0 || compression_level > 9)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_level(compression_level);
+    return 2;
+  }
+
+  if (strcmp(arg[0],"compression_threads") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_threads = force->inumeric(FLERR,arg[1]);
+    if (compression_threads < 1)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_threads(compression_threads);
+    return 2;
+  }
+
+  return 0;
+}
+
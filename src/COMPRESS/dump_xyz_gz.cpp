@@ -12,7 +12,9 @@
 ------------------------------------------------------------------------- */
 
 #include "dump_xyz_gz.h"
+#include "gz_file_writer.h"
 #include "error.h"
+#include "force.h"
 #include "update.h"
 
 #include <cstring>
@@ -22,7 +24,9 @@ using namespace LAMMPS_NS;
 DumpXYZGZ::DumpXYZGZ(LAMMPS *lmp, int narg, char **arg) :
   DumpXYZ(lmp, narg, arg)
 {
-  gzFp = NULL;
+  writer = NULL;
+  compression_level = 9;
+  compression_threads = 1;
 
   if (!compressed)
     error->all(FLERR,"Dump xyz/gz only writes compressed files");
@@ -33,8 +37,9 @@ DumpXYZGZ::DumpXYZGZ(LAMMPS *lmp, int narg, char **arg) :
 
 DumpXYZGZ::~DumpXYZGZ()
 {
-  if (gzFp) gzclose(gzFp);
-  gzFp = NULL;
+  wait_write();
+  delete writer;
+  writer = NULL;
   fp = NULL;
 }
 
@@ -90,14 +95,10 @@ void DumpXYZGZ::openfile()
   // each proc with filewriter = 1 opens a file
 
   if (filewriter) {
-    if (append_flag) {
-      gzFp = gzopen(filecurrent,"ab9");
-    } else {
-      gzFp = gzopen(filecurrent,"wb9");
-    }
-
-    if (gzFp == NULL) error->one(FLERR,"Cannot open dump file");
-  } else gzFp = NULL;
+    writer = new GzFileWriter(compression_level,compression_threads);
+    if (writer->open(filecurrent,append_flag))
+      error->one(FLERR,"Cannot open dump file");
+  } else writer = NULL;
 
   // delete string with timestep replaced
 
@@ -107,8 +108,8 @@ void DumpXYZGZ::openfile()
 void DumpXYZGZ::write_header(bigint ndump)
 {
   if (me == 0) {
-    gzprintf(gzFp,BIGINT_FORMAT "\n",ndump);
-    gzprintf(gzFp,"Atoms. Timestep: " BIGINT_FORMAT "\n",update->ntimestep);
+    writer->printf(BIGINT_FORMAT "\n",ndump);
+    writer->printf("Atoms. Timestep: " BIGINT_FORMAT "\n",update->ntimestep);
   }
 }
 
@@ -116,21 +117,48 @@ void DumpXYZGZ::write_header(bigint ndump)
 
 void DumpXYZGZ::write_data(int n, double *mybuf)
 {
-  gzwrite(gzFp,mybuf,sizeof(char)*n);
+  writer->write(mybuf,n);
+  if (writer->failed()) write_error(writer->message());
 }
 
 /* ---------------------------------------------------------------------- */
 
-void DumpXYZGZ::write()
+void DumpXYZGZ::write_finish()
 {
-  DumpXYZ::write();
-  if (filewriter) {
-    if (multifile) {
-      gzclose(gzFp);
-      gzFp = NULL;
-    } else {
-      if (flush_flag)
-        gzflush(gzFp,Z_SYNC_FLUSH);
-    }
+  if (multifile) writer->close();
+  else if (flush_flag) writer->flush();
+  if (writer->failed()) write_error(writer->message());
+
+  if (multifile) {
+    delete writer;
+    writer = NULL;
   }
 }
+
+/* ---------------------------------------------------------------------- */
+
+int DumpXYZGZ::modify_param(int narg, char **arg)
+{
+  int n = DumpXYZ::modify_param(narg,arg);
+  if (n) return n;
+
+  if (strcmp(arg[0],"compression_level") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_level = force->inumeric(FLERR,arg[1]);
+    if (compression_level < 0 || compression_level > 9)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_level(compression_level);
+    return 2;
+  }
+
+  if (strcmp(arg[0],"compression_threads") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    compression_threads = force->inumeric(FLERR,arg[1]);
+    if (compression_threads < 1)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (writer) writer->set_threads(compression_threads);
+    return 2;
+  }
+
+  return 0;
+}
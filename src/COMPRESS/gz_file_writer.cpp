@@ -0,0 +1,247 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "gz_file_writer.h"
+#include <cstdarg>
+#include <cstring>
+#include <thread>
+#include <zlib.h>
+
+using namespace LAMMPS_NS;
+
+// size of uncompressed input deflated by one thread into one gzip member
+// large enough that the restart of the dictionary costs little ratio
+
+#define BLOCKSIZE 1048576
+#define LINEMAX 256
+
+/* ---------------------------------------------------------------------- */
+
+GzFileWriter::GzFileWriter(int level_caller, int nthreads_caller) :
+  fp(NULL), nmembers(0)
+{
+  level = level_caller;
+  nthreads = nthreads_caller;
+  if (nthreads < 1) nthreads = 1;
+  zbuf.resize(nthreads);
+}
+
+/* ---------------------------------------------------------------------- */
+
+GzFileWriter::~GzFileWriter()
+{
+  close();
+}
+
+/* ----------------------------------------------------------------------
+   open file for writing, or for appending gzip members if append is set
+   return 0 on success, 1 if the file could not be opened
+------------------------------------------------------------------------- */
+
+int GzFileWriter::open(const char *file, int append)
+{
+  close();
+  if (append) fp = fopen(file,"ab");
+  else fp = fopen(file,"wb");
+  if (fp == NULL) return 1;
+  nmembers = 0;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   deflate remaining input and close file
+   a file without any data gets one empty member to remain valid gzip
+------------------------------------------------------------------------- */
+
+void GzFileWriter::close()
+{
+  if (fp == NULL) return;
+  if (pending.size() || nmembers == 0) {
+    deflate_write(pending.data(),pending.size());
+    pending.clear();
+  }
+  if (fclose(fp) && !failed()) errmesg = "Write to gzip file failed";
+  fp = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   deflate remaining input so that all data written so far can be read
+------------------------------------------------------------------------- */
+
+void GzFileWriter::flush()
+{
+  if (fp == NULL) return;
+  if (pending.size()) {
+    deflate_write(pending.data(),pending.size());
+    pending.clear();
+  }
+  if (fflush(fp) && !failed()) errmesg = "Write to gzip file failed";
+}
+
+/* ----------------------------------------------------------------------
+   add n bytes of data to the file
+   input is collected until there is one block for each thread
+------------------------------------------------------------------------- */
+
+void GzFileWriter::write(const void *data, bigint n)
+{
+  const char *ptr = (const char *) data;
+  const bigint nbatch = (bigint) nthreads * BLOCKSIZE;
+
+  // complete a partial batch from previous calls first
+
+  if (pending.size()) {
+    bigint m = nbatch - pending.size();
+    if (m > n) m = n;
+    pending.insert(pending.end(),ptr,ptr+m);
+    ptr += m;
+    n -= m;
+    if ((bigint) pending.size() < nbatch) return;
+    deflate_write(pending.data(),pending.size());
+    pending.clear();
+  }
+
+  // deflate full batches directly from the caller's data
+
+  while (n >= nbatch) {
+    deflate_write(ptr,nbatch);
+    ptr += nbatch;
+    n -= nbatch;
+  }
+
+  pending.insert(pending.end(),ptr,ptr+n);
+}
+
+/* ----------------------------------------------------------------------
+   change compression level, applies to input not yet deflated
+------------------------------------------------------------------------- */
+
+void GzFileWriter::set_level(int level_caller)
+{
+  level = level_caller;
+}
+
+/* ----------------------------------------------------------------------
+   change # of threads, applies to input not yet deflated
+   pending input stays below one batch of the new size
+------------------------------------------------------------------------- */
+
+void GzFileWriter::set_threads(int nthreads_caller)
+{
+  nthreads = nthreads_caller;
+  if (nthreads < 1) nthreads = 1;
+  zbuf.resize(nthreads);
+
+  if ((bigint) pending.size() >= (bigint) nthreads * BLOCKSIZE) {
+    deflate_write(pending.data(),pending.size());
+    pending.clear();
+  }
+}
+
+/* ----------------------------------------------------------------------
+   formatted output, same as fprintf()
+------------------------------------------------------------------------- */
+
+void GzFileWriter::printf(const char *format, ...)
+{
+  char line[LINEMAX];
+  va_list args;
+
+  va_start(args,format);
+  int n = vsnprintf(line,LINEMAX,format,args);
+  va_end(args);
+
+  if (n < LINEMAX) {
+    write(line,n);
+    return;
+  }
+
+  char *longline = new char[n+1];
+  va_start(args,format);
+  vsnprintf(longline,n+1,format,args);
+  va_end(args);
+  write(longline,n);
+  delete [] longline;
+}
+
+/* ----------------------------------------------------------------------
+   deflate n bytes as up to nthreads concurrent blocks
+   write resulting gzip members to file in order
+   nothing more is written after a failure
+------------------------------------------------------------------------- */
+
+void GzFileWriter::deflate_write(const char *data, bigint n)
+{
+  if (failed()) return;
+
+  int nblocks = (n + BLOCKSIZE - 1) / BLOCKSIZE;
+  if (nblocks == 0) nblocks = 1;
+  if ((int) zbuf.size() < nblocks) zbuf.resize(nblocks);
+  std::vector<int> status(nblocks,0);
+
+  if (nblocks == 1) deflate_block(data,n,level,&zbuf[0],&status[0]);
+  else {
+    std::vector<std::thread> workers;
+    for (int i = 1; i < nblocks; i++) {
+      bigint offset = (bigint) i * BLOCKSIZE;
+      bigint m = n - offset;
+      if (m > BLOCKSIZE) m = BLOCKSIZE;
+      workers.push_back(std::thread(deflate_block,data+offset,m,level,
+                                    &zbuf[i],&status[i]));
+    }
+    deflate_block(data,BLOCKSIZE,level,&zbuf[0],&status[0]);
+    for (int i = 1; i < nblocks; i++) workers[i-1].join();
+  }
+
+  for (int i = 0; i < nblocks; i++)
+    if (status[i]) {
+      errmesg = "Compression of gzip file failed";
+      return;
+    }
+
+  for (int i = 0; i < nblocks; i++)
+    if (fwrite(zbuf[i].data(),sizeof(char),zbuf[i].size(),fp) !=
+        zbuf[i].size()) {
+      errmesg = "Write to gzip file failed";
+      return;
+    }
+  nmembers += nblocks;
+}
+
+/* ----------------------------------------------------------------------
+   deflate one block of n bytes into a complete gzip member
+   windowBits of 15+16 selects the gzip header and trailer
+   status = 0 on success, 1 if zlib failed
+------------------------------------------------------------------------- */
+
+void GzFileWriter::deflate_block(const char *data, bigint n, int level,
+                                 std::vector<char> *out, int *status)
+{
+  z_stream strm;
+  memset(&strm,0,sizeof(z_stream));
+  if (deflateInit2(&strm,level,Z_DEFLATED,15+16,8,Z_DEFAULT_STRATEGY) != Z_OK) {
+    out->clear();
+    *status = 1;
+    return;
+  }
+
+  out->resize(deflateBound(&strm,n));
+  strm.next_in = (Bytef *) data;
+  strm.avail_in = n;
+  strm.next_out = (Bytef *) out->data();
+  strm.avail_out = out->size();
+  *status = (deflate(&strm,Z_FINISH) == Z_STREAM_END) ? 0 : 1;
+  out->resize(strm.total_out);
+
+  deflateEnd(&strm);
+}
@@ -0,0 +1,63 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_GZ_FILE_WRITER_H
+#define LMP_GZ_FILE_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "lmptype.h"
+
+namespace LAMMPS_NS {
+
+// gzip file writer that deflates blocks of its input concurrently
+// each block becomes an independent gzip member of the file,
+// concatenated members are a valid gzip file for gzip, zcat, and zlib
+// failures are recorded, not raised, since the writer may run in a
+//   background thread; the caller checks failed() and reports message()
+
+class GzFileWriter {
+ public:
+  GzFileWriter(int level, int nthreads);
+  ~GzFileWriter();
+
+  int open(const char *, int);
+  void close();
+  void flush();
+  void write(const void *, bigint);
+  void printf(const char *, ...);
+  void set_level(int);
+  void set_threads(int);
+
+  int failed() const { return !errmesg.empty(); }
+  const char *message() const { return errmesg.c_str(); }
+
+ private:
+  FILE *fp;
+  int level;                  // zlib compression level 0-9
+  int nthreads;               // # of threads to deflate blocks with
+  bigint nmembers;            // # of gzip members written to file
+  std::string errmesg;        // first failure, empty if none
+
+  std::vector<char> pending;                // input not yet deflated
+  std::vector<std::vector<char> > zbuf;     // deflated blocks, one per thread
+
+  void deflate_write(const char *, bigint);
+  static void deflate_block(const char *, bigint, int, std::vector<char> *,
+                            int *);
+};
+
+}
+
+#endif
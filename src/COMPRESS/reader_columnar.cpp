@@ -0,0 +1,382 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "reader_columnar.h"
+#include <cstring>
+#include <zlib.h>
+#include "atom.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+// file layout as written by dump_columnar.cpp
+
+#define FILEMAGIC "LMPCOL01"
+#define INDEXMAGIC "LMPCOLIX"
+#define MAGICLEN 8
+
+/* ---------------------------------------------------------------------- */
+
+ReaderColumnar::ReaderColumnar(LAMMPS *lmp) : ReaderNative(lmp)
+{
+  nframes = maxframes = iframe = 0;
+  frame_step = frame_offset = NULL;
+
+  chunkbytes = chunkoffset = NULL;
+  maxchunks = 0;
+
+  nfield = maxrows = 0;
+  cached = NULL;
+  values = NULL;
+  zbuf = shuffle = NULL;
+  maxzbuf = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ReaderColumnar::~ReaderColumnar()
+{
+  memory->destroy(frame_step);
+  memory->destroy(frame_offset);
+  memory->destroy(chunkbytes);
+  memory->destroy(chunkoffset);
+  memory->destroy(cached);
+  memory->destroy(values);
+  memory->sfree(zbuf);
+  memory->sfree(shuffle);
+}
+
+/* ----------------------------------------------------------------------
+   open binary file and build list of its frames
+   use index at end of file if present, else scan the frame headers,
+     e.g. for a file that is still being written
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::open_file(const char *file)
+{
+  if (fp != NULL) close_file();
+
+  compressed = 0;
+  fp = fopen(file,"rb");
+
+  if (fp == NULL) {
+    char str[128];
+    snprintf(str,128,"Cannot open file %s",file);
+    error->one(FLERR,str);
+  }
+
+  char magic[MAGICLEN];
+  if (fread(magic,sizeof(char),MAGICLEN,fp) != MAGICLEN ||
+      strncmp(magic,FILEMAGIC,MAGICLEN) != 0)
+    error->one(FLERR,"Dump file is not a columnar dump file");
+
+  nframes = iframe = 0;
+  if (!read_index()) scan_frames();
+}
+
+/* ----------------------------------------------------------------------
+   read timestamp of next frame from index
+   return 1 if there are no more frames
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+int ReaderColumnar::read_time(bigint &ntimestep)
+{
+  if (iframe >= nframes) return 1;
+  ntimestep = frame_step[iframe];
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   skip frame, frames are accessed via their offset so nothing is read
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::skip()
+{
+  iframe++;
+}
+
+/* ----------------------------------------------------------------------
+   read header and chunk sizes of current frame
+   return natoms, box bounds, triclinic
+   if fieldinfo set, match fields to columns as in ReaderNative
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+bigint ReaderColumnar::read_header(double box[3][3], int &boxinfo,
+                                   int &triclinic, int fieldinfo, int nfield_in,
+                                   int *fieldtype, char **fieldlabel,
+                                   int scaleflag, int wrapflag, int &fieldflag,
+                                   int &xflag, int &yflag, int &zflag)
+{
+  if (iframe >= nframes) error->one(FLERR,"Unexpected end of dump file");
+  fseek(fp,frame_offset[iframe],SEEK_SET);
+  iframe++;
+
+  bigint ntimestep;
+  double bounds[9];
+  int ncolumns,nlabel;
+
+  read_bytes(&ntimestep,sizeof(bigint));
+  read_bytes(&natoms,sizeof(bigint));
+  read_bytes(&triclinic,sizeof(int));
+  read_bytes(bounds,9*sizeof(double));
+  read_bytes(&ncolumns,sizeof(int));
+  read_bytes(&nlabel,sizeof(int));
+  if (ncolumns <= 0 || nlabel <= 0)
+    error->one(FLERR,"Dump file is incorrectly formatted");
+  char *labelline = new char[nlabel];
+  read_bytes(labelline,nlabel);
+  read_bytes(&chunkrows,sizeof(int));
+  if (chunkrows <= 0) error->one(FLERR,"Dump file is incorrectly formatted");
+
+  nchunks = (natoms + chunkrows - 1) / chunkrows;
+  if (ncolumns*nchunks > maxchunks) {
+    maxchunks = ncolumns*nchunks;
+    memory->destroy(chunkbytes);
+    memory->destroy(chunkoffset);
+    memory->create(chunkbytes,maxchunks,"read_dump:chunkbytes");
+    memory->create(chunkoffset,maxchunks,"read_dump:chunkoffset");
+  }
+  read_bytes(chunkbytes,(bigint) ncolumns*nchunks*sizeof(bigint));
+
+  bigint offset = ftell(fp);
+  for (int i = 0; i < ncolumns*nchunks; i++) {
+    chunkoffset[i] = offset;
+    offset += chunkbytes[i];
+  }
+
+  boxinfo = 1;
+  box[0][0] = bounds[0]; box[0][1] = bounds[1]; box[0][2] = bounds[6];
+  box[1][0] = bounds[2]; box[1][1] = bounds[3]; box[1][2] = bounds[7];
+  box[2][0] = bounds[4]; box[2][1] = bounds[5]; box[2][2] = bounds[8];
+
+  irow = 0;
+
+  // chunks cached for the previous frame are stale
+  // grow cache if this frame has longer chunks than previous ones
+
+  if (nfield) {
+    if (chunkrows > maxrows) {
+      maxrows = chunkrows;
+      memory->destroy(values);
+      memory->create(values,nfield,maxrows,"read_dump:values");
+    }
+    for (int m = 0; m < nfield; m++) cached[m] = -1;
+  }
+
+  // if no field info requested, just return
+
+  if (!fieldinfo) {
+    delete [] labelline;
+    return natoms;
+  }
+
+  // extract column labels and match to requested fields
+
+  nwords = atom->count_words(labelline);
+  if (nwords != ncolumns)
+    error->one(FLERR,"Dump file is incorrectly formatted");
+  char **labels = new char*[nwords];
+  labels[0] = strtok(labelline," \t\n\r\f");
+  for (int m = 1; m < nwords; m++)
+    labels[m] = strtok(NULL," \t\n\r\f");
+
+  match_fields(nwords,labels,nfield_in,fieldtype,fieldlabel,scaleflag,wrapflag,
+               fieldflag,xflag,yflag,zflag);
+  delete [] labels;
+  delete [] labelline;
+
+  // one chunk of values is cached for each requested field
+
+  nfield = nfield_in;
+  maxrows = chunkrows;
+  memory->destroy(cached);
+  memory->destroy(values);
+  memory->create(cached,nfield,"read_dump:cached");
+  memory->create(values,nfield,maxrows,"read_dump:values");
+  for (int m = 0; m < nfield; m++) cached[m] = -1;
+
+  return natoms;
+}
+
+/* ----------------------------------------------------------------------
+   read N atoms of the requested fields from current frame
+   only the chunks of requested columns are read from the file
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_atoms(int n, int nfield_in, double **fields)
+{
+  if (irow + n > natoms) error->one(FLERR,"Unexpected end of dump file");
+
+  for (int m = 0; m < nfield_in; m++) {
+    int i = 0;
+    while (i < n) {
+      bigint r = irow + i;
+      int ichunk = r / chunkrows;
+      if (cached[m] != ichunk) load_chunk(m,ichunk);
+      int j = r - (bigint) ichunk*chunkrows;
+      int k = MIN(n-i,chunkrows-j);
+      double *src = values[m];
+      for (; k > 0; k--) fields[i++][m] = src[j++];
+    }
+  }
+
+  irow += n;
+}
+
+/* ----------------------------------------------------------------------
+   skip N atoms of current frame, no chunk needs to be loaded
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::skip_atoms(bigint n, int /*nfield*/)
+{
+  if (irow + n > natoms) error->one(FLERR,"Unexpected end of dump file");
+  irow += n;
+}
+
+/* ----------------------------------------------------------------------
+   read chunk ichunk of the column of field m into values[m]
+   chunks smaller than the raw doubles hold deflated byte planes
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::load_chunk(int m, int ichunk)
+{
+  int idx = fieldindex[m]*nchunks + ichunk;
+  bigint rows = MIN(natoms - (bigint) ichunk*chunkrows,chunkrows);
+  bigint nraw = rows*sizeof(double);
+  bigint nbytes = chunkbytes[idx];
+
+  fseek(fp,chunkoffset[idx],SEEK_SET);
+
+  if (nbytes == nraw) read_bytes(values[m],nraw);
+  else {
+    if (nbytes > maxzbuf || nraw > maxzbuf) {
+      maxzbuf = MAX(nbytes,(bigint) chunkrows*sizeof(double));
+      zbuf = (char *) memory->srealloc(zbuf,maxzbuf,"read_dump:zbuf");
+      shuffle = (char *) memory->srealloc(shuffle,maxzbuf,"read_dump:shuffle");
+    }
+    read_bytes(zbuf,nbytes);
+    uLongf nout = nraw;
+    if (uncompress((Bytef *) shuffle,&nout,(Bytef *) zbuf,nbytes) != Z_OK ||
+        (bigint) nout != nraw)
+      error->one(FLERR,"Dump file is incorrectly formatted");
+    char *bytes = (char *) values[m];
+    for (bigint i = 0; i < rows; i++)
+      for (int b = 0; b < (int) sizeof(double); b++)
+        bytes[i*sizeof(double) + b] = shuffle[b*rows + i];
+  }
+
+  cached[m] = ichunk;
+}
+
+/* ----------------------------------------------------------------------
+   read list of frames from index at end of file
+   return 0 if there is no complete index
+------------------------------------------------------------------------- */
+
+int ReaderColumnar::read_index()
+{
+  bigint n,offset;
+  char magic[MAGICLEN];
+
+  if (fseek(fp,-(long) (2*sizeof(bigint) + MAGICLEN),SEEK_END)) return 0;
+  if (fread(&n,sizeof(bigint),1,fp) != 1) return 0;
+  if (fread(&offset,sizeof(bigint),1,fp) != 1) return 0;
+  if (fread(magic,sizeof(char),MAGICLEN,fp) != MAGICLEN) return 0;
+  if (strncmp(magic,INDEXMAGIC,MAGICLEN) != 0) return 0;
+  if (n < 0 || n > MAXSMALLINT) return 0;
+
+  fseek(fp,offset,SEEK_SET);
+  if (n > maxframes) {
+    maxframes = n;
+    memory->destroy(frame_step);
+    memory->destroy(frame_offset);
+    memory->create(frame_step,maxframes,"read_dump:frame_step");
+    memory->create(frame_offset,maxframes,"read_dump:frame_offset");
+  }
+  read_bytes(frame_step,n*sizeof(bigint));
+  read_bytes(frame_offset,n*sizeof(bigint));
+  nframes = n;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   build list of frames by hopping from one frame header to the next
+   stop at first frame that is not completely in the file
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::scan_frames()
+{
+  fseek(fp,0,SEEK_END);
+  bigint filesize = ftell(fp);
+  bigint offset = MAGICLEN;
+
+  bigint ntimestep,nrows;
+  int ncolumns,nlabel,rows;
+  const long skipbox = sizeof(int) + 9*sizeof(double);
+
+  while (offset < filesize) {
+    fseek(fp,offset,SEEK_SET);
+    if (fread(&ntimestep,sizeof(bigint),1,fp) != 1) break;
+    if (fread(&nrows,sizeof(bigint),1,fp) != 1) break;
+    if (fseek(fp,skipbox,SEEK_CUR)) break;
+    if (fread(&ncolumns,sizeof(int),1,fp) != 1) break;
+    if (fread(&nlabel,sizeof(int),1,fp) != 1) break;
+    if (fseek(fp,nlabel,SEEK_CUR)) break;
+    if (fread(&rows,sizeof(int),1,fp) != 1) break;
+    if (ncolumns <= 0 || rows <= 0) break;
+
+    int n = ncolumns * ((nrows + rows - 1) / rows);
+    bigint size,end = ftell(fp) + n*sizeof(bigint);
+    for (int i = 0; i < n; i++) {
+      if (fread(&size,sizeof(bigint),1,fp) != 1) {
+        end = filesize + 1;
+        break;
+      }
+      end += size;
+    }
+    if (end > filesize) break;
+
+    add_frame(ntimestep,offset);
+    offset = end;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ReaderColumnar::add_frame(bigint ntimestep, bigint offset)
+{
+  if (nframes == maxframes) {
+    maxframes += 1024;
+    memory->grow(frame_step,maxframes,"read_dump:frame_step");
+    memory->grow(frame_offset,maxframes,"read_dump:frame_offset");
+  }
+  frame_step[nframes] = ntimestep;
+  frame_offset[nframes] = offset;
+  nframes++;
+}
+
+/* ----------------------------------------------------------------------
+   read N bytes from file, error if file ends before
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_bytes(void *ptr, bigint n)
+{
+  if (n <= 0) return;
+  if (fread(ptr,sizeof(char),n,fp) != (size_t) n)
+    error->one(FLERR,"Unexpected end of dump file");
+}
@@ -0,0 +1,95 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef READER_CLASS
+
+ReaderStyle(columnar,ReaderColumnar)
+
+#else
+
+#ifndef LMP_READER_COLUMNAR_H
+#define LMP_READER_COLUMNAR_H
+
+#include "reader_native.h"
+
+namespace LAMMPS_NS {
+
+class ReaderColumnar : public ReaderNative {
+ public:
+  ReaderColumnar(class LAMMPS *);
+  ~ReaderColumnar();
+
+  void open_file(const char *);
+
+  int read_time(bigint &);
+  void skip();
+  bigint read_header(double [3][3], int &, int &, int, int, int *, char **,
+                     int, int, int &, int &, int &, int &);
+  void read_atoms(int, int, double **);
+  void skip_atoms(bigint, int);
+
+ private:
+  int nframes,maxframes;     // # of frames in file and allocated
+  int iframe;                // next frame to read
+  bigint *frame_step;        // timestep of each frame
+  bigint *frame_offset;      // byte offset of each frame in file
+
+  bigint natoms;             // # of atoms in current frame
+  bigint irow;               // next atom to read in current frame
+  int chunkrows;             // # of atoms per chunk in current frame
+  int nchunks;               // # of chunks per column in current frame
+  bigint *chunkbytes;        // size in file of each chunk
+  bigint *chunkoffset;       // byte offset of each chunk in file
+  int maxchunks;
+
+  int nfield;                // # of requested fields
+  int *cached;               // chunk loaded for each field, -1 if none
+  double **values;           // loaded chunk of column of each field
+  int maxrows;               // # of rows allocated in values
+  char *zbuf;                // compressed chunk as read from file
+  char *shuffle;             // byte planes of chunk after inflating
+  bigint maxzbuf;
+
+  int read_index();
+  void scan_frames();
+  void add_frame(bigint, bigint);
+  void load_chunk(int, int);
+  void read_bytes(void *, bigint);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot open file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+E: Dump file is not a columnar dump file
+
+The file does not start with the signature written by dump style
+columnar.
+
+E: Dump file is incorrectly formatted
+
+Self-explanatory.
+
+E: Unexpected end of dump file
+
+A read operation from the file failed.
+
+*/
@@ -112,6 +112,7 @@ fi
 
 if (test $1 = "SNAP") then
   depend KOKKOS
+  depend USER-OMP
 fi
 
 if (test $1 = "USER-CGSDK") then
@@ -132,6 +133,10 @@ if (test $1 = "USER-FEP") then
   depend USER-OMP
 fi
 
+if (test $1 = "USER-MEAMC") then
+  depend USER-OMP
+fi
+
 if (test $1 = "USER-MISC") then
   depend GPU
   depend USER-OMP
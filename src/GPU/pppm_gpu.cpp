@@ -50,7 +50,8 @@ using namespace MathConst;
 #define EPS_HOC 1.0e-7
 
 enum{REVERSE_RHO_GPU,REVERSE_RHO};
-enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM};
+enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM,
+     FORWARD_IK_ALL,FORWARD_AD_ALL};
 
 #ifdef FFT_SINGLE
 #define ZEROF 0.0f
@@ -261,17 +262,14 @@ void PPPMGPU::compute(int eflag, int vflag)
 
   // all procs communicate E-field values
   // to fill ghost cells surrounding their 3d bricks
-
-  if (differentiation_flag == 1) cg->forward_comm(this,FORWARD_AD);
-  else cg->forward_comm(this,FORWARD_IK);
-
-  // extra per-atom energy/virial communication
-
-  if (evflag_atom) {
-    if (differentiation_flag == 1 && vflag_atom)
-      cg_peratom->forward_comm(this,FORWARD_AD_PERATOM);
-    else if (differentiation_flag == 0)
-      cg_peratom->forward_comm(this,FORWARD_IK_PERATOM);
+  // per-atom energy/virial values are sent in the same messages
+
+  if (differentiation_flag == 1) {
+    if (vflag_atom) cg_peratom->forward_comm(this,FORWARD_AD_ALL);
+    else cg->forward_comm(this,FORWARD_AD);
+  } else {
+    if (evflag_atom) cg_peratom->forward_comm(this,FORWARD_IK_ALL);
+    else cg->forward_comm(this,FORWARD_IK);
   }
 
   poisson_time += MPI_Wtime()-t3;
@@ -548,6 +546,12 @@ void PPPMGPU::pack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
       buf[n++] = v4src[list[i]];
       buf[n++] = v5src[list[i]];
     }
+  } else if (flag == FORWARD_IK_ALL) {
+    pack_forward(FORWARD_IK,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+  } else if (flag == FORWARD_AD_ALL) {
+    pack_forward(FORWARD_AD,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
   }
 }
 
@@ -606,6 +610,12 @@ void PPPMGPU::unpack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
       v4src[list[i]] = buf[n++];
       v5src[list[i]] = buf[n++];
     }
+  } else if (flag == FORWARD_IK_ALL) {
+    unpack_forward(FORWARD_IK,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+  } else if (flag == FORWARD_AD_ALL) {
+    unpack_forward(FORWARD_AD,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
   }
 }
 
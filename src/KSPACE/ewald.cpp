@@ -21,6 +21,7 @@
 #include "ewald.h"
 #include <mpi.h>
 #include <cmath>
+#include <cstdlib>
 #include "atom.h"
 #include "comm.h"
 #include "force.h"
@@ -40,7 +41,8 @@ using namespace MathConst;
 Ewald::Ewald(LAMMPS *lmp) : KSpace(lmp),
   kxvecs(NULL), kyvecs(NULL), kzvecs(NULL), ug(NULL), eg(NULL), vg(NULL),
   ek(NULL), sfacrl(NULL), sfacim(NULL), sfacrl_all(NULL), sfacim_all(NULL),
-  cs(NULL), sn(NULL), sfacrl_A(NULL), sfacim_A(NULL), sfacrl_A_all(NULL),
+  cs(NULL), sn(NULL), sfacrl_mc(NULL), sfacim_mc(NULL), mc_cs(NULL),
+  mc_sn(NULL), sfacrl_A(NULL), sfacim_A(NULL), sfacrl_A_all(NULL),
   sfacim_A_all(NULL), sfacrl_B(NULL), sfacim_B(NULL), sfacrl_B_all(NULL),
   sfacim_B_all(NULL)
 {
@@ -48,6 +50,9 @@ Ewald::Ewald(LAMMPS *lmp) : KSpace(lmp),
   kmax_created = 0;
   ewaldflag = 1;
   group_group_enable = 1;
+  mcflag = 1;
+  mc_valid = mc_trial = 0;
+  mc_kmax = -1;
 
   accuracy_relative = 0.0;
 
@@ -82,6 +87,8 @@ Ewald::~Ewald()
   memory->destroy(ek);
   memory->destroy3d_offset(cs,-kmax_created);
   memory->destroy3d_offset(sn,-kmax_created);
+  memory->destroy(mc_cs);
+  memory->destroy(mc_sn);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -181,6 +188,7 @@ void Ewald::init()
   double spr = 2.0 *q2_over_sqrt * exp(-g_ewald*g_ewald*cutoff*cutoff);
   double tpr = estimate_table_accuracy(q2_over_sqrt,spr);
   double estimated_accuracy = sqrt(lpr*lpr + spr*spr + tpr*tpr);
+  accuracy_estimate = estimated_accuracy;
 
   // stats
 
@@ -216,6 +224,8 @@ void Ewald::init()
 
 void Ewald::setup()
 {
+  mc_valid = 0;
+
   // volume-dependent factors
 
   double xprd = domain->xprd;
@@ -500,6 +510,203 @@ void Ewald::compute(int eflag, int vflag)
   if (slabflag == 1) slabcorr();
 }
 
+/* ----------------------------------------------------------------------
+   cache structure factors and charge sums of current atoms
+   for incremental energies of Monte Carlo trial moves
+------------------------------------------------------------------------- */
+
+void Ewald::mc_setup()
+{
+  int i;
+
+  if (atom->nmax > nmax) {
+    memory->destroy(ek);
+    memory->destroy3d_offset(cs,-kmax_created);
+    memory->destroy3d_offset(sn,-kmax_created);
+    nmax = atom->nmax;
+    memory->create(ek,nmax,3,"ewald:ek");
+    memory->create3d_offset(cs,-kmax,kmax,3,nmax,"ewald:cs");
+    memory->create3d_offset(sn,-kmax,kmax,3,nmax,"ewald:sn");
+    kmax_created = kmax;
+  }
+
+  if (kmax > mc_kmax) {
+    memory->destroy(mc_cs);
+    memory->destroy(mc_sn);
+    mc_kmax = kmax;
+    memory->create(mc_cs,3,mc_kmax+1,"ewald:mc_cs");
+    memory->create(mc_sn,3,mc_kmax+1,"ewald:mc_sn");
+  }
+
+  if (triclinic == 0)
+    eik_dot_r();
+  else
+    eik_dot_r_triclinic();
+
+  MPI_Allreduce(sfacrl,sfacrl_all,kcount,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(sfacim,sfacim_all,kcount,MPI_DOUBLE,MPI_SUM,world);
+
+  double *q = atom->q;
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+
+  double sum[4];
+  sum[0] = sum[1] = sum[2] = sum[3] = 0.0;
+  for (i = 0; i < nlocal; i++) {
+    sum[0] += q[i];
+    sum[1] += q[i]*q[i];
+    sum[2] += q[i]*x[i][2];
+    sum[3] += q[i]*x[i][2]*x[i][2];
+  }
+  MPI_Allreduce(sum,mc_sum,4,MPI_DOUBLE,MPI_SUM,world);
+
+  mc_energy = mc_energy_sums(sfacrl_all,sfacim_all,mc_sum);
+  energy = mc_energy;
+  nmc_local = 0;
+  mc_valid = 1;
+  mc_trial = 0;
+}
+
+/* ----------------------------------------------------------------------
+   energy change of MC trial move of charges listed via mc_remove/mc_add
+   updates cached structure factors in O(K) per listed charge
+   sets energy to total energy after trial move
+------------------------------------------------------------------------- */
+
+double Ewald::mc_energy_change()
+{
+  int i,k,m,ic;
+
+  if (!mc_valid)
+    error->all(FLERR,"Kspace incremental energy requires prior setup");
+
+  mc_gather();
+
+  if (nmc == 0) {
+    mc_trial = 0;
+    energy = mc_energy;
+    return 0.0;
+  }
+
+  for (k = 0; k < kcount; k++) {
+    sfacrl_mc[k] = sfacrl_all[k];
+    sfacim_mc[k] = sfacim_all[k];
+  }
+  for (i = 0; i < 4; i++) mc_sum_trial[i] = mc_sum[i];
+
+  double phase[3],unitk_lamda[3];
+  int max_kvecs[3];
+  max_kvecs[0] = kxmax;
+  max_kvecs[1] = kymax;
+  max_kvecs[2] = kzmax;
+
+  for (m = 0; m < nmc; m++) {
+    double *mc = &mc_all[5*m];
+    double qsign = mc[0]*mc[1];
+    double *xm = &mc[2];
+
+    mc_sum_trial[0] += qsign;
+    mc_sum_trial[1] += mc[1]*mc[0]*mc[0];
+    mc_sum_trial[2] += qsign*xm[2];
+    mc_sum_trial[3] += qsign*xm[2]*xm[2];
+
+    // phase of unit K-vector along each reciprocal lattice direction
+
+    for (ic = 0; ic < 3; ic++) {
+      if (triclinic == 0) phase[ic] = unitk[ic]*xm[ic];
+      else {
+        unitk_lamda[0] = unitk_lamda[1] = unitk_lamda[2] = 0.0;
+        unitk_lamda[ic] = 2.0*MY_PI;
+        x2lamdaT(&unitk_lamda[0],&unitk_lamda[0]);
+        phase[ic] = unitk_lamda[0]*xm[0] + unitk_lamda[1]*xm[1] +
+          unitk_lamda[2]*xm[2];
+      }
+      mc_cs[ic][0] = 1.0;
+      mc_sn[ic][0] = 0.0;
+      if (max_kvecs[ic] < 1) continue;
+      mc_cs[ic][1] = cos(phase[ic]);
+      mc_sn[ic][1] = sin(phase[ic]);
+      for (k = 2; k <= max_kvecs[ic]; k++) {
+        mc_cs[ic][k] = mc_cs[ic][k-1]*mc_cs[ic][1] -
+          mc_sn[ic][k-1]*mc_sn[ic][1];
+        mc_sn[ic][k] = mc_sn[ic][k-1]*mc_cs[ic][1] +
+          mc_cs[ic][k-1]*mc_sn[ic][1];
+      }
+    }
+
+    // K-vector components may be negative, sin is odd
+
+    int kx,ky,kz;
+    double cx,sx,cy,sy,cz,sz,cypz,sypz;
+    for (k = 0; k < kcount; k++) {
+      kx = kxvecs[k];
+      ky = kyvecs[k];
+      kz = kzvecs[k];
+      cx = mc_cs[0][abs(kx)];
+      sx = (kx < 0) ? -mc_sn[0][-kx] : mc_sn[0][kx];
+      cy = mc_cs[1][abs(ky)];
+      sy = (ky < 0) ? -mc_sn[1][-ky] : mc_sn[1][ky];
+      cz = mc_cs[2][abs(kz)];
+      sz = (kz < 0) ? -mc_sn[2][-kz] : mc_sn[2][kz];
+      cypz = cy*cz - sy*sz;
+      sypz = sy*cz + cy*sz;
+      sfacrl_mc[k] += qsign*(cx*cypz - sx*sypz);
+      sfacim_mc[k] += qsign*(sx*cypz + cx*sypz);
+    }
+  }
+
+  mc_energy_trial = mc_energy_sums(sfacrl_mc,sfacim_mc,mc_sum_trial);
+  mc_trial = 1;
+  energy = mc_energy_trial;
+  return mc_energy_trial - mc_energy;
+}
+
+/* ----------------------------------------------------------------------
+   commit or discard the last MC trial move
+------------------------------------------------------------------------- */
+
+void Ewald::mc_accept()
+{
+  if (!mc_trial) return;
+
+  double *tmp;
+  tmp = sfacrl_all; sfacrl_all = sfacrl_mc; sfacrl_mc = tmp;
+  tmp = sfacim_all; sfacim_all = sfacim_mc; sfacim_mc = tmp;
+  for (int i = 0; i < 4; i++) mc_sum[i] = mc_sum_trial[i];
+  mc_energy = mc_energy_trial;
+  energy = mc_energy;
+  mc_trial = 0;
+}
+
+void Ewald::mc_reject()
+{
+  energy = mc_energy;
+  mc_trial = 0;
+}
+
+/* ----------------------------------------------------------------------
+   total Kspace energy from structure factors and
+   sums of q, q^2, q*z, q*z^2 over all charges
+------------------------------------------------------------------------- */
+
+double Ewald::mc_energy_sums(double *rl, double *im, double *sum)
+{
+  double eng = 0.0;
+  for (int k = 0; k < kcount; k++)
+    eng += ug[k] * (rl[k]*rl[k] + im[k]*im[k]);
+
+  eng -= g_ewald*sum[1]/MY_PIS +
+    MY_PI2*sum[0]*sum[0] / (g_ewald*g_ewald*volume);
+
+  if (slabflag == 1) {
+    double zprd = domain->zprd;
+    eng += MY_2PI*(sum[2]*sum[2] - sum[0]*sum[3] -
+                   sum[0]*sum[0]*zprd*zprd/12.0)/volume;
+  }
+
+  return qqrd2e*scale*eng;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Ewald::eik_dot_r()
@@ -1148,6 +1355,8 @@ void Ewald::allocate()
   sfacim = new double[kmax3d];
   sfacrl_all = new double[kmax3d];
   sfacim_all = new double[kmax3d];
+  sfacrl_mc = new double[kmax3d];
+  sfacim_mc = new double[kmax3d];
 }
 
 /* ----------------------------------------------------------------------
@@ -1168,6 +1377,8 @@ void Ewald::deallocate()
   delete [] sfacim;
   delete [] sfacrl_all;
   delete [] sfacim_all;
+  delete [] sfacrl_mc;
+  delete [] sfacim_mc;
 }
 
 /* ----------------------------------------------------------------------
@@ -36,6 +36,11 @@ class Ewald : public KSpace {
 
   void compute_group_group(int, int, int);
 
+  virtual void mc_setup();
+  virtual double mc_energy_change();
+  virtual void mc_accept();
+  virtual void mc_reject();
+
  protected:
   int kxmax,kymax,kzmax;
   int kcount,kmax,kmax3d,kmax_created;
@@ -51,6 +56,18 @@ class Ewald : public KSpace {
   double *sfacrl,*sfacim,*sfacrl_all,*sfacim_all;
   double ***cs,***sn;
 
+  // incremental MC energies
+
+  int mc_valid;                     // 1 if structure factors are cached
+  int mc_trial;                     // 1 if trial structure factors are set
+  int mc_kmax;                      // size of phase factor tables
+  double *sfacrl_mc,*sfacim_mc;     // structure factors of trial move
+  double **mc_cs,**mc_sn;           // phase factors of one charge
+  double mc_sum[4],mc_sum_trial[4]; // qsum, qsqsum, sum qz, sum qz^2
+  double mc_energy,mc_energy_trial;
+
+  double mc_energy_sums(double *, double *, double *);
+
   // group-group interactions
 
   int group_allocate_flag;
@@ -114,6 +131,11 @@ E: Cannot (yet) use Ewald with triclinic box and slab correction
 
 This feature is not yet supported.
 
+E: Kspace incremental energy requires prior setup
+
+The command requesting incremental energies of Monte Carlo moves
+did not cache the structure factors of the current atoms first.
+
 E: KSpace style is incompatible with Pair style
 
 Setting a kspace style requires that a pair style with matching
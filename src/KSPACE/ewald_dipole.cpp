@@ -43,6 +43,7 @@ EwaldDipole::EwaldDipole(LAMMPS *lmp) : Ewald(lmp),
 {
   ewaldflag = dipoleflag = 1;
   group_group_enable = 0;
+  mcflag = 0;
   tk = NULL;
   vc = NULL;
 }
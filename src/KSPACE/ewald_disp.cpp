@@ -43,7 +43,8 @@ using namespace MathSpecial;
 
 EwaldDisp::EwaldDisp(LAMMPS *lmp) : KSpace(lmp),
   kenergy(NULL), kvirial(NULL), energy_self_peratom(NULL), virial_self_peratom(NULL),
-  ekr_local(NULL), hvec(NULL), kvec(NULL), B(NULL), cek_local(NULL), cek_global(NULL)
+  ekr_local(NULL), hvec(NULL), kvec(NULL), B(NULL), cek_local(NULL), cek_global(NULL),
+  cek_mc(NULL)
 {
   ewaldflag = dispersionflag = dipoleflag = 1;
 
@@ -61,6 +62,7 @@ EwaldDisp::EwaldDisp(LAMMPS *lmp) : KSpace(lmp),
   q2 = 0;
   b2 = 0;
   M2 = 0;
+  mc_valid = mc_trial = 0;
 }
 
 void EwaldDisp::settings(int narg, char **arg)
@@ -178,6 +180,11 @@ void EwaldDisp::init()
   if (!function[1] && !function[2]) dispersionflag = 0;
   if (!function[3]) dipoleflag = 0;
 
+  // incremental MC energies only for Coulombics
+
+  mcflag = function[0] && !function[1] && !function[2] && !function[3];
+  mc_valid = 0;
+
   // compute two charge force
 
   two_charge();
@@ -245,6 +252,8 @@ void EwaldDisp::init()
 
 void EwaldDisp::setup()
 {
+  mc_valid = 0;
+
   volume = shape_det(domain->h)*slab_volfactor;
   memcpy(unit, domain->h_inv, sizeof(shape));
   shape_scalar_mult(unit, 2.0*MY_PI);
@@ -374,6 +383,8 @@ void EwaldDisp::reallocate()
     bytes += (nkvec-nkvec_max)*nsums*sizeof(complex);
     cek_global = new complex[nkvec*nsums];                // cek_global
     bytes += (nkvec-nkvec_max)*nsums*sizeof(complex);
+    cek_mc = new complex[nkvec*nsums];                    // cek_mc
+    bytes += (nkvec-nkvec_max)*nsums*sizeof(complex);
     nkvec_max = nkvec;
   }
 
@@ -445,6 +456,7 @@ void EwaldDisp::deallocate()                                // free memory
   delete [] kvirial;                kvirial = NULL;
   delete [] cek_local;                cek_local = NULL;
   delete [] cek_global;                cek_global = NULL;
+  delete [] cek_mc;                cek_mc = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -798,6 +810,160 @@ void EwaldDisp::compute_ek()
   delete [] z;
 }
 
+/* ----------------------------------------------------------------------
+   cache structure factors and charge sums of current atoms
+   for incremental energies of Monte Carlo trial moves
+   only supported for Coulombic interactions
+------------------------------------------------------------------------- */
+
+void EwaldDisp::mc_setup()
+{
+  if (!mcflag)
+    error->all(FLERR,"Kspace style ewald/disp supports incremental "
+               "energies only for Coulombic interactions");
+
+  reallocate_atoms();
+  compute_ek();
+
+  double *q = atom->q;
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+
+  double sum[4];
+  sum[0] = sum[1] = sum[2] = sum[3] = 0.0;
+  for (int i = 0; i < nlocal; i++) {
+    sum[0] += q[i];
+    sum[1] += q[i]*q[i];
+    sum[2] += q[i]*x[i][2];
+    sum[3] += q[i]*x[i][2]*x[i][2];
+  }
+  MPI_Allreduce(sum,mc_sum,4,MPI_DOUBLE,MPI_SUM,world);
+
+  mc_energy = mc_energy_sums(cek_global,mc_sum);
+  energy = mc_energy;
+  nmc_local = 0;
+  mc_valid = 1;
+  mc_trial = 0;
+}
+
+/* ----------------------------------------------------------------------
+   energy change of MC trial move of charges listed via mc_remove/mc_add
+   updates cached structure factors in O(K) per listed charge
+   sets energy to total energy after trial move
+------------------------------------------------------------------------- */
+
+double EwaldDisp::mc_energy_change()
+{
+  if (!mc_valid)
+    error->all(FLERR,"Kspace incremental energy requires prior setup");
+
+  mc_gather();
+
+  if (nmc == 0) {
+    mc_trial = 0;
+    energy = mc_energy;
+    return 0.0;
+  }
+
+  memcpy(cek_mc, cek_global, nkvec*sizeof(complex));
+  for (int i = 0; i < 4; i++) mc_sum_trial[i] = mc_sum[i];
+
+  cvector *z = new cvector[2*nbox+1];
+  cvector z1, *zx, *zy, *zz, *zn = z+2*nbox;
+  complex zxy = COMPLEX_NULL, zxyz;
+  kvector *k, *nk = kvec+nkvec;
+  int kx, ky;
+
+  for (int m = 0; m < nmc; m++) {
+    double *mc = &mc_all[5*m];
+    double qsign = mc[0]*mc[1];
+    double *x = &mc[2];
+
+    mc_sum_trial[0] += qsign;
+    mc_sum_trial[1] += mc[1]*mc[0]*mc[0];
+    mc_sum_trial[2] += qsign*x[2];
+    mc_sum_trial[3] += qsign*x[2]*x[2];
+
+    zx = (zy = (zz = z+nbox)+1)-2;                        // same as compute_ek()
+    C_SET(zz->x, 1, 0); C_SET(zz->y, 1, 0); C_SET(zz->z, 1, 0);
+    C_ANGLE(z1.x, unit[0]*x[0]+unit[5]*x[1]+unit[4]*x[2]);
+    C_ANGLE(z1.y, unit[1]*x[1]+unit[3]*x[2]);
+    C_ANGLE(z1.z, x[2]*unit[2]);
+    for (; zz<zn; --zx, ++zy, ++zz) {
+      C_RMULT(zy->x, zz->x, z1.x);
+      C_RMULT(zy->y, zz->y, z1.y); C_CONJ(zx->y, zy->y);
+      C_RMULT(zy->z, zz->z, z1.z); C_CONJ(zx->z, zy->z);
+    }
+
+    kx = ky = -1;
+    complex *cek = cek_mc, cx = COMPLEX_NULL;
+    for (k=kvec; k<nk; ++k, ++cek) {
+      if (ky!=k->y) {
+        if (kx!=k->x) cx = z[kx = k->x].x;
+        C_RMULT(zxy, z[ky = k->y].y, cx);
+      }
+      C_RMULT(zxyz, z[k->z].z, zxy);
+      cek->re += zxyz.re*qsign; cek->im += zxyz.im*qsign;
+    }
+  }
+  delete [] z;
+
+  mc_energy_trial = mc_energy_sums(cek_mc,mc_sum_trial);
+  mc_trial = 1;
+  energy = mc_energy_trial;
+  return mc_energy_trial - mc_energy;
+}
+
+/* ----------------------------------------------------------------------
+   commit or discard the last MC trial move
+------------------------------------------------------------------------- */
+
+void EwaldDisp::mc_accept()
+{
+  if (!mc_trial) return;
+
+  complex *tmp = cek_global;
+  cek_global = cek_mc;
+  cek_mc = tmp;
+  for (int i = 0; i < 4; i++) mc_sum[i] = mc_sum_trial[i];
+  mc_energy = mc_energy_trial;
+  energy = mc_energy;
+  mc_trial = 0;
+}
+
+void EwaldDisp::mc_reject()
+{
+  energy = mc_energy;
+  mc_trial = 0;
+}
+
+/* ----------------------------------------------------------------------
+   total Coulombic Kspace energy from structure factors and
+   sums of q, q^2, q*z, q*z^2 over all charges
+------------------------------------------------------------------------- */
+
+double EwaldDisp::mc_energy_sums(complex *cek, double *qsums)
+{
+  const double qscale = force->qqrd2e * scale;
+  double g1 = g_ewald, g2 = g1*g1;
+
+  double eng = 0.0;
+  for (int k=0; k<nkvec; ++k)
+    eng += kenergy[k]*(cek[k].re*cek[k].re+cek[k].im*cek[k].im);
+  eng *= 4.0*MY_PI*qscale/volume;
+
+  eng -= qsums[1]*qscale*g1/MY_PIS + 0.5*MY_PI*qscale/(g2*volume)*
+    qsums[0]*qsums[0];
+
+  if (slabflag == 1) {
+    double zprd = domain->zprd;
+    eng += qscale*MY_2PI*(qsums[2]*qsums[2] - qsums[0]*qsums[3] -
+                          qsums[0]*qsums[0]*zprd*zprd/12.0)/volume;
+  }
+
+  return eng;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void EwaldDisp::compute_force()
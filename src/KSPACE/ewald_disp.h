@@ -44,6 +44,11 @@ class EwaldDisp : public KSpace {
   void compute(int, int);
   double memory_usage() {return bytes;}
 
+  void mc_setup();
+  double mc_energy_change();
+  void mc_accept();
+  void mc_reject();
+
  private:
   double unit[6];
   int function[EWALD_NFUNCS], first_output;
@@ -66,6 +71,12 @@ class EwaldDisp : public KSpace {
   struct Sum { double x, x2; } sum[EWALD_MAX_NSUMS];
   complex *cek_local, *cek_global;
 
+  int mc_valid, mc_trial;               // incremental MC energies
+  complex *cek_mc;
+  double mc_sum[4], mc_sum_trial[4];
+  double mc_energy, mc_energy_trial;
+  double mc_energy_sums(complex *, double *);
+
   double rms(int, double, bigint, double, double, double);
   void reallocate();
   void allocate_peratom();
@@ -136,6 +147,16 @@ E: Cannot (yet) use 'electron' units with dipoles
 
 This feature is not yet supported.
 
+E: Kspace style ewald/disp supports incremental energies only for Coulombic interactions
+
+Incremental energies of Monte Carlo moves, e.g. by fix gcmc, require
+that only long-range Coulombics are computed by kspace style ewald/disp.
+
+E: Kspace incremental energy requires prior setup
+
+The command requesting incremental energies of Monte Carlo moves
+did not cache the structure factors of the current atoms first.
+
 E: Cannot use Ewald/disp solver on system with no charge, dipole, or LJ particles
 
 No atoms in system have a non-zero charge or dipole, or are LJ
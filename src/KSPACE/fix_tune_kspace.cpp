@@ -29,10 +29,12 @@
 #include "neighbor.h"
 #include "modify.h"
 #include "compute.h"
+#include "comm.h"
 
 #define SWAP(a,b) {temp=(a);(a)=(b);(b)=temp;}
 #define SIGN(a,b) ((b) >= 0.0 ? fabs(a) : -fabs(a))
 #define GOLD 1.618034
+#define SMALL 1.0e-6
 
 using namespace std;
 using namespace LAMMPS_NS;
@@ -43,7 +45,7 @@ using namespace FixConst;
 FixTuneKspace::FixTuneKspace(LAMMPS *lmp, int narg, char **arg) :
   Fix(lmp, narg, arg)
 {
-  if (narg < 3) error->all(FLERR,"Illegal fix tune/kspace command");
+  if (narg < 4) error->all(FLERR,"Illegal fix tune/kspace command");
 
   global_freq = 1;
   firststep = 0;
@@ -55,12 +57,93 @@ FixTuneKspace::FixTuneKspace(LAMMPS *lmp, int narg, char **arg) :
   need_fd2_brent = false;
 
   ewald_time = pppm_time = msm_time = 0.0;
+  ewald_acc = pppm_acc = msm_acc = 0.0;
+
+  search_flag = 0;
+  nrcut = norder = nmesh = 0;
+  rcut_scale = NULL;
+  order_list = NULL;
+  mesh_scale = NULL;
+
+  ncandidate = 0;
+  icandidate = -1;
+  cand_rcut = cand_mesh = cand_time = cand_acc = NULL;
+  cand_order = NULL;
+  tune_order = 0;
+  tune_mesh[0] = tune_mesh[1] = tune_mesh[2] = 0;
+  auto_mesh[0] = auto_mesh[1] = auto_mesh[2] = 0;
 
   // parse arguments
 
   nevery = force->inumeric(FLERR,arg[3]);
   if (nevery <= 0) error->all(FLERR,"Illegal fix tune/kspace command");
 
+  int iarg = 4;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"search") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix tune/kspace command");
+      if (strcmp(arg[iarg+1],"solver") == 0) search_flag = 0;
+      else if (strcmp(arg[iarg+1],"joint") == 0) search_flag = 1;
+      else error->all(FLERR,"Illegal fix tune/kspace command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"rcut") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix tune/kspace command");
+      nrcut = force->inumeric(FLERR,arg[iarg+1]);
+      if (nrcut <= 0 || iarg+2+nrcut > narg)
+        error->all(FLERR,"Illegal fix tune/kspace command");
+      memory->destroy(rcut_scale);
+      memory->create(rcut_scale,nrcut,"tune/kspace:rcut_scale");
+      for (int i = 0; i < nrcut; i++) {
+        rcut_scale[i] = force->numeric(FLERR,arg[iarg+2+i]);
+        if (rcut_scale[i] <= 0.0)
+          error->all(FLERR,"Illegal fix tune/kspace command");
+      }
+      iarg += 2 + nrcut;
+    } else if (strcmp(arg[iarg],"order") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix tune/kspace command");
+      norder = force->inumeric(FLERR,arg[iarg+1]);
+      if (norder <= 0 || iarg+2+norder > narg)
+        error->all(FLERR,"Illegal fix tune/kspace command");
+      memory->destroy(order_list);
+      memory->create(order_list,norder,"tune/kspace:order_list");
+      for (int i = 0; i < norder; i++) {
+        order_list[i] = force->inumeric(FLERR,arg[iarg+2+i]);
+        if (order_list[i] < 2)
+          error->all(FLERR,"Illegal fix tune/kspace command");
+      }
+      iarg += 2 + norder;
+    } else if (strcmp(arg[iarg],"mesh") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix tune/kspace command");
+      nmesh = force->inumeric(FLERR,arg[iarg+1]);
+      if (nmesh <= 0 || iarg+2+nmesh > narg)
+        error->all(FLERR,"Illegal fix tune/kspace command");
+      memory->destroy(mesh_scale);
+      memory->create(mesh_scale,nmesh,"tune/kspace:mesh_scale");
+      for (int i = 0; i < nmesh; i++) {
+        mesh_scale[i] = force->numeric(FLERR,arg[iarg+2+i]);
+        if (mesh_scale[i] < 1.0)
+          error->all(FLERR,"Illegal fix tune/kspace command");
+      }
+      iarg += 2 + nmesh;
+    } else error->all(FLERR,"Illegal fix tune/kspace command");
+  }
+
+  // defaults of the joint search
+  // order defaults depend on the solver and are set in setup_candidates()
+
+  if (nrcut == 0) {
+    nrcut = 3;
+    memory->create(rcut_scale,nrcut,"tune/kspace:rcut_scale");
+    rcut_scale[0] = 0.8;
+    rcut_scale[1] = 1.0;
+    rcut_scale[2] = 1.25;
+  }
+  if (nmesh == 0) {
+    nmesh = 1;
+    memory->create(mesh_scale,nmesh,"tune/kspace:mesh_scale");
+    mesh_scale[0] = 1.25;
+  }
+
   // set up reneighboring
 
   force_reneighbor = 1;
@@ -69,6 +152,20 @@ FixTuneKspace::FixTuneKspace(LAMMPS *lmp, int narg, char **arg) :
 
 /* ---------------------------------------------------------------------- */
 
+FixTuneKspace::~FixTuneKspace()
+{
+  memory->destroy(rcut_scale);
+  memory->destroy(order_list);
+  memory->destroy(mesh_scale);
+  memory->destroy(cand_rcut);
+  memory->destroy(cand_order);
+  memory->destroy(cand_mesh);
+  memory->destroy(cand_time);
+  memory->destroy(cand_acc);
+}
+
+/* ---------------------------------------------------------------------- */
+
 int FixTuneKspace::setmask()
 {
   int mask = 0;
@@ -93,6 +190,8 @@ void FixTuneKspace::init()
     error->all(FLERR,"Cannot use fix tune/kspace with TIP4P water");
   if (force->kspace->dipoleflag)
     error->all(FLERR,"Cannot use fix tune/kspace with dipole long-range solver");
+  if (strstr(update->integrate_style,"verlet/split"))
+    error->all(FLERR,"Cannot use fix tune/kspace with run_style verlet/split");
 
   double old_acc = force->kspace->accuracy/force->kspace->two_charge_force;
   char old_acc_str[16];
@@ -130,6 +229,7 @@ void FixTuneKspace::pre_exchange()
     snprintf(new_pair_style,64,"%s/long",base_pair_style);
     update_pair_style(new_pair_style,pair_cut_coul);
     update_kspace_style(new_kspace_style,new_acc_str);
+    ewald_acc = force->kspace->accuracy_estimate;
   } else if (niter == 2) {
     // test PPPM
     store_old_kspace_settings();
@@ -137,6 +237,7 @@ void FixTuneKspace::pre_exchange()
     snprintf(new_pair_style,64,"%s/long",base_pair_style);
     update_pair_style(new_pair_style,pair_cut_coul);
     update_kspace_style(new_kspace_style,new_acc_str);
+    pppm_acc = force->kspace->accuracy_estimate;
   } else if (niter == 3) {
     // test MSM
     store_old_kspace_settings();
@@ -144,11 +245,12 @@ void FixTuneKspace::pre_exchange()
     snprintf(new_pair_style,64,"%s/msm",base_pair_style);
     update_pair_style(new_pair_style,pair_cut_coul);
     update_kspace_style(new_kspace_style,new_acc_str);
+    msm_acc = force->kspace->accuracy_estimate;
   } else if (niter == 4) {
     store_old_kspace_settings();
-    if (screen) fprintf(screen,"ewald_time = %g\npppm_time = %g\nmsm_time = %g",
+    if (screen && comm->me == 0) fprintf(screen,"ewald_time = %g\npppm_time = %g\nmsm_time = %g\n",
                         ewald_time, pppm_time, msm_time);
-    if (logfile) fprintf(logfile,"ewald_time = %g\npppm_time = %g\nmsm_time = %g",
+    if (logfile && comm->me == 0) fprintf(logfile,"ewald_time = %g\npppm_time = %g\nmsm_time = %g\n",
                          ewald_time, pppm_time, msm_time);
     // switch to fastest one
     strcpy(new_kspace_style,"ewald");
@@ -159,13 +261,24 @@ void FixTuneKspace::pre_exchange()
       strcpy(new_kspace_style,"msm");
       snprintf(new_pair_style,64,"%s/msm",base_pair_style);
     }
-    update_pair_style(new_pair_style,pair_cut_coul);
-    update_kspace_style(new_kspace_style,new_acc_str);
+    if (search_flag) {
+      setup_candidates();
+      icandidate = 0;
+      apply_candidate(icandidate);
+    } else {
+      update_pair_style(new_pair_style,pair_cut_coul);
+      update_kspace_style(new_kspace_style,new_acc_str);
+    }
+  } else if (icandidate >= 0) {
+    cand_time[icandidate] = time;
+    icandidate++;
+    if (icandidate < ncandidate) apply_candidate(icandidate);
+    else select_candidate();
   } else {
     adjust_rcut(time);
   }
 
-  last_spcpu = timer->elapsed(Timer::TOTAL);
+  last_spcpu = elapsed_time();
 }
 
 /* ----------------------------------------------------------------------
@@ -183,19 +296,38 @@ double FixTuneKspace::get_timing_info()
     dvalue = 0.0;
     firststep = 1;
   } else {
-    new_cpu = timer->elapsed(Timer::TOTAL);
+    new_cpu = elapsed_time();
     double cpu_diff = new_cpu - last_spcpu;
     int step_diff = new_step - last_step;
     if (step_diff > 0.0) dvalue = cpu_diff/step_diff;
     else dvalue = 0.0;
   }
 
+  // all procs must take the same decisions, slowest proc sets the pace
+
+  double dvalue_all;
+  MPI_Allreduce(&dvalue,&dvalue_all,1,MPI_DOUBLE,MPI_MAX,world);
+  dvalue = dvalue_all;
+
   last_step = new_step;
   last_spcpu = new_cpu;
 
   return dvalue;
 }
 
+/* ----------------------------------------------------------------------
+   wall time spent so far in the parts of a timestep affected by tuning
+   excludes fix and output time, which includes the cost of tuning itself
+------------------------------------------------------------------------- */
+
+double FixTuneKspace::elapsed_time()
+{
+  if (!timer->has_normal()) return timer->elapsed(Timer::TOTAL);
+
+  return timer->get_wall(Timer::PAIR) + timer->get_wall(Timer::KSPACE) +
+    timer->get_wall(Timer::NEIGH) + timer->get_wall(Timer::COMM);
+}
+
 /* ----------------------------------------------------------------------
    store old kspace settings: style, accuracy, order, etc
 ------------------------------------------------------------------------- */
@@ -240,8 +372,8 @@ void FixTuneKspace::update_pair_style(char *new_pair_style,
   p_pair_settings_file = tmpfile();
   force->pair->write_restart(p_pair_settings_file);
   rewind(p_pair_settings_file);
-  if (screen) fprintf(screen,"Creating new pair style: %s\n",new_pair_style);
-  if (logfile) fprintf(logfile,"Creating new pair style: %s\n",new_pair_style);
+  if (screen && comm->me == 0) fprintf(screen,"Creating new pair style: %s\n",new_pair_style);
+  if (logfile && comm->me == 0) fprintf(logfile,"Creating new pair style: %s\n",new_pair_style);
   // delete old pair style and create new one
   force->create_pair(new_pair_style,1);
 
@@ -250,8 +382,8 @@ void FixTuneKspace::update_pair_style(char *new_pair_style,
 
   double *pcutoff = (double *) force->pair->extract("cut_coul",itmp);
   double current_cutoff = *pcutoff;
-  if (screen) fprintf(screen,"Coulomb cutoff for real space: %g\n", current_cutoff);
-  if (logfile) fprintf(logfile,"Coulomb cutoff for real space: %g\n", current_cutoff);
+  if (screen && comm->me == 0) fprintf(screen,"Coulomb cutoff for real space: %g\n", current_cutoff);
+  if (logfile && comm->me == 0) fprintf(logfile,"Coulomb cutoff for real space: %g\n", current_cutoff);
 
   // close temporary file
   fclose(p_pair_settings_file);
@@ -285,6 +417,26 @@ void FixTuneKspace::update_kspace_style(char *new_kspace_style,
   force->kspace->slabflag = old_slabflag;
   force->kspace->slab_volfactor = old_slab_volfactor;
 
+  // apply order and grid of the joint search via kspace_modify settings
+
+  if (tune_order > 0 || tune_mesh[0] > 0) {
+    char str[4][16];
+    char *marg[4];
+    for (int m = 0; m < 4; m++) marg[m] = str[m];
+    if (tune_order > 0) {
+      strcpy(str[0],"order");
+      snprintf(str[1],16,"%d",tune_order);
+      force->kspace->modify_params(2,marg);
+    }
+    if (tune_mesh[0] > 0) {
+      strcpy(str[0],"mesh");
+      snprintf(str[1],16,"%d",tune_mesh[0]);
+      snprintf(str[2],16,"%d",tune_mesh[1]);
+      snprintf(str[3],16,"%d",tune_mesh[2]);
+      force->kspace->modify_params(4,marg);
+    }
+  }
+
   // initialize new kspace style, pair style, molecular styles
 
   force->init();
@@ -296,6 +448,13 @@ void FixTuneKspace::update_kspace_style(char *new_kspace_style,
 
   neighbor->init();
 
+  // the Coulomb cutoff may have grown, so the ghost cutoff and bins
+  // must be recomputed before the next reneighboring
+
+  comm->init();
+  comm->setup();
+  if (neighbor->style) neighbor->setup_bins();
+
   // Re-init computes to update pointers to virials, etc.
 
   for (int i = 0; i < modify->ncompute; i++) modify->compute[i]->init();
@@ -319,8 +478,8 @@ void FixTuneKspace::adjust_rcut(double time)
   int itmp;
   double *p_cutoff = (double *) force->pair->extract("cut_coul",itmp);
   double current_cutoff = *p_cutoff;
-  if (screen) fprintf(screen,"Old Coulomb cutoff for real space: %g\n",current_cutoff);
-  if (logfile) fprintf(logfile,"Old Coulomb cutoff for real space: %g\n",current_cutoff);
+  if (screen && comm->me == 0) fprintf(screen,"Old Coulomb cutoff for real space: %g\n",current_cutoff);
+  if (logfile && comm->me == 0) fprintf(logfile,"Old Coulomb cutoff for real space: %g\n",current_cutoff);
 
   // use Brent's method from Numerical Recipes to find optimal real space cutoff
 
@@ -390,14 +549,211 @@ void FixTuneKspace::adjust_rcut(double time)
   // report the new cutoff
   double *new_cutoff = (double *) force->pair->extract("cut_coul",itmp);
   current_cutoff = *new_cutoff;
-  if (screen) fprintf(screen,"Adjusted Coulomb cutoff for real space: %g\n", current_cutoff);
-  if (logfile) fprintf(logfile,"Adjusted Coulomb cutoff for real space: %g\n", current_cutoff);
+  if (screen && comm->me == 0) fprintf(screen,"Adjusted Coulomb cutoff for real space: %g\n", current_cutoff);
+  if (logfile && comm->me == 0) fprintf(logfile,"Adjusted Coulomb cutoff for real space: %g\n", current_cutoff);
 
   store_old_kspace_settings();
   update_pair_style(new_pair_style,pair_cut_coul);
   update_kspace_style(new_kspace_style,new_acc_str);
 }
 
+/* ----------------------------------------------------------------------
+   build list of (cutoff, order, grid) candidates for the chosen solver
+   grid refinements vary fastest, so the automatic grid of each
+     (cutoff, order) pair is known when its refinements are applied
+------------------------------------------------------------------------- */
+
+void FixTuneKspace::setup_candidates()
+{
+  int pppm = (strcmp(new_kspace_style,"pppm") == 0);
+  int msm = (strcmp(new_kspace_style,"msm") == 0);
+
+  // orders allowed by the solver, defaults if none were given
+
+  int norder_all = 1;
+  int orders[16];
+  orders[0] = 0;
+  if (pppm || msm) {
+    norder_all = 0;
+    if (norder) {
+      for (int i = 0; i < norder && norder_all < 16; i++) {
+        int o = order_list[i];
+        if (pppm && o > 7) continue;
+        if (msm && (o < 4 || o > 10 || o % 2)) continue;
+        orders[norder_all++] = o;
+      }
+    }
+    if (norder_all == 0) {
+      if (pppm) {
+        orders[0] = 3; orders[1] = 5; orders[2] = 7;
+      } else {
+        orders[0] = 6; orders[1] = 8; orders[2] = 10;
+      }
+      norder_all = 3;
+    }
+  }
+
+  int nmesh_all = 1;
+  if (pppm)
+    for (int i = 0; i < nmesh; i++)
+      if (mesh_scale[i] > 1.0) nmesh_all++;
+
+  ncandidate = nrcut * norder_all * nmesh_all;
+  memory->destroy(cand_rcut);
+  memory->destroy(cand_order);
+  memory->destroy(cand_mesh);
+  memory->destroy(cand_time);
+  memory->destroy(cand_acc);
+  memory->create(cand_rcut,ncandidate,"tune/kspace:cand_rcut");
+  memory->create(cand_order,ncandidate,"tune/kspace:cand_order");
+  memory->create(cand_mesh,ncandidate,"tune/kspace:cand_mesh");
+  memory->create(cand_time,ncandidate,"tune/kspace:cand_time");
+  memory->create(cand_acc,ncandidate,"tune/kspace:cand_acc");
+
+  rcut_base = pair_cut_coul;
+
+  int n = 0;
+  for (int i = 0; i < nrcut; i++)
+    for (int j = 0; j < norder_all; j++) {
+      cand_rcut[n] = rcut_scale[i]*rcut_base;
+      cand_order[n] = orders[j];
+      cand_mesh[n] = 1.0;
+      n++;
+      if (!pppm) continue;
+      for (int k = 0; k < nmesh; k++) {
+        if (mesh_scale[k] <= 1.0) continue;
+        cand_rcut[n] = rcut_scale[i]*rcut_base;
+        cand_order[n] = orders[j];
+        cand_mesh[n] = mesh_scale[k];
+        n++;
+      }
+    }
+
+  for (int i = 0; i < ncandidate; i++) cand_time[i] = cand_acc[i] = 0.0;
+
+  // candidates must be as accurate as the requested accuracy or
+  //   the default settings of the chosen solver, whichever is looser
+
+  double solver_acc = ewald_acc;
+  if (pppm) solver_acc = pppm_acc;
+  else if (msm) solver_acc = msm_acc;
+  acc_limit = MAX(force->kspace->accuracy,solver_acc);
+
+  if (screen && comm->me == 0)
+    fprintf(screen,"Timing %d candidate settings of kspace style %s\n",
+            ncandidate,new_kspace_style);
+  if (logfile && comm->me == 0)
+    fprintf(logfile,"Timing %d candidate settings of kspace style %s\n",
+            ncandidate,new_kspace_style);
+}
+
+/* ----------------------------------------------------------------------
+   switch to settings of candidate I
+------------------------------------------------------------------------- */
+
+void FixTuneKspace::apply_candidate(int i)
+{
+  pair_cut_coul = cand_rcut[i];
+  tune_order = cand_order[i];
+  tune_mesh[0] = tune_mesh[1] = tune_mesh[2] = 0;
+  if (cand_mesh[i] > 1.0)
+    for (int d = 0; d < 3; d++)
+      tune_mesh[d] = factorable(static_cast<int> (ceil(cand_mesh[i]*auto_mesh[d])));
+
+  update_pair_style(new_pair_style,pair_cut_coul);
+  update_kspace_style(new_kspace_style,new_acc_str);
+
+  KSpace *kspace = force->kspace;
+  cand_acc[i] = kspace->accuracy_estimate;
+  if (tune_order > 0) cand_order[i] = kspace->order;
+  if (cand_mesh[i] == 1.0 && kspace->pppmflag) {
+    auto_mesh[0] = kspace->nx_pppm;
+    auto_mesh[1] = kspace->ny_pppm;
+    auto_mesh[2] = kspace->nz_pppm;
+  }
+
+  if (screen && comm->me == 0) {
+    fprintf(screen,"Candidate %d: Coulomb cutoff %g order %d",
+            i+1,pair_cut_coul,kspace->order);
+    if (kspace->pppmflag)
+      fprintf(screen," grid %d %d %d",
+              kspace->nx_pppm,kspace->ny_pppm,kspace->nz_pppm);
+    fprintf(screen," estimated accuracy %g\n",cand_acc[i]);
+  }
+  if (logfile && comm->me == 0) {
+    fprintf(logfile,"Candidate %d: Coulomb cutoff %g order %d",
+            i+1,pair_cut_coul,kspace->order);
+    if (kspace->pppmflag)
+      fprintf(logfile," grid %d %d %d",
+              kspace->nx_pppm,kspace->ny_pppm,kspace->nz_pppm);
+    fprintf(logfile," estimated accuracy %g\n",cand_acc[i]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   lock in the fastest candidate that meets the accuracy limit
+   fall back to the default settings of the solver if none does
+------------------------------------------------------------------------- */
+
+void FixTuneKspace::select_candidate()
+{
+  int ibest = -1;
+  for (int i = 0; i < ncandidate; i++) {
+    if (cand_acc[i] > acc_limit*(1.0+SMALL)) continue;
+    if (ibest < 0 || cand_time[i] < cand_time[ibest]) ibest = i;
+  }
+
+  if (screen && comm->me == 0) {
+    fprintf(screen,"Candidate timings (time/step, estimated accuracy):\n");
+    for (int i = 0; i < ncandidate; i++)
+      fprintf(screen,"  %d: %g %g%s\n",i+1,cand_time[i],cand_acc[i],
+              cand_acc[i] > acc_limit*(1.0+SMALL) ? " (not accurate enough)" : "");
+  }
+  if (logfile && comm->me == 0) {
+    fprintf(logfile,"Candidate timings (time/step, estimated accuracy):\n");
+    for (int i = 0; i < ncandidate; i++)
+      fprintf(logfile,"  %d: %g %g%s\n",i+1,cand_time[i],cand_acc[i],
+              cand_acc[i] > acc_limit*(1.0+SMALL) ? " (not accurate enough)" : "");
+  }
+
+  if (ibest >= 0) {
+    if (screen && comm->me == 0) fprintf(screen,"Selected candidate %d\n",ibest+1);
+    if (logfile && comm->me == 0) fprintf(logfile,"Selected candidate %d\n",ibest+1);
+    apply_candidate(ibest);
+  } else {
+    if (screen && comm->me == 0) fprintf(screen,"No candidate met the accuracy, "
+                        "using default settings\n");
+    if (logfile && comm->me == 0) fprintf(logfile,"No candidate met the accuracy, "
+                         "using default settings\n");
+    tune_order = 0;
+    tune_mesh[0] = tune_mesh[1] = tune_mesh[2] = 0;
+    pair_cut_coul = rcut_base;
+    update_pair_style(new_pair_style,pair_cut_coul);
+    update_kspace_style(new_kspace_style,new_acc_str);
+  }
+
+  icandidate = -1;
+  converged = true;
+}
+
+/* ----------------------------------------------------------------------
+   smallest grid size >= N that only has factors 2, 3 and 5
+------------------------------------------------------------------------- */
+
+int FixTuneKspace::factorable(int n)
+{
+  const int nfactors = 3;
+  const int factors[nfactors] = {2,3,5};
+
+  while (1) {
+    int remain = n;
+    for (int i = 0; i < nfactors; i++)
+      while (remain > 1 && remain % factors[i] == 0) remain /= factors[i];
+    if (remain == 1) return n;
+    n++;
+  }
+}
+
 /* ----------------------------------------------------------------------
    bracket a minimum using parabolic extrapolation
 ------------------------------------------------------------------------- */
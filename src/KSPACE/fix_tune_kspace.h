@@ -27,7 +27,7 @@ namespace LAMMPS_NS {
 class FixTuneKspace : public Fix {
  public:
   FixTuneKspace(class LAMMPS *, int, char **);
-  ~FixTuneKspace() {}
+  ~FixTuneKspace();
   int setmask();
   void init();
   void pre_exchange();
@@ -36,6 +36,9 @@ class FixTuneKspace : public Fix {
   void update_pair_style(char *, double);
   void update_kspace_style(char *, char *);
   void adjust_rcut(double);
+  void setup_candidates();
+  void apply_candidate(int);
+  void select_candidate();
   void mnbrak();
   void brent0();
   void brent1();
@@ -50,6 +53,7 @@ class FixTuneKspace : public Fix {
   int niter;          // number of kspace switches
 
   double ewald_time,pppm_time,msm_time;
+  double ewald_acc,pppm_acc,msm_acc;  // estimated accuracy of each solver
   double pair_cut_coul;
   char new_acc_str[16];
   char new_kspace_style[64];
@@ -71,6 +75,31 @@ class FixTuneKspace : public Fix {
   bool keep_bracketing,first_brent_pass;
   bool converged,need_fd2_brent;
 
+  // joint search over cutoff, order and grid of the fastest solver
+
+  int search_flag;        // 0 = Brent search of cutoff, 1 = joint search
+  int nrcut,norder,nmesh;
+  double *rcut_scale;     // Coulomb cutoff scale factors
+  int *order_list;        // interpolation orders, NULL = solver default
+  double *mesh_scale;     // PPPM grid refinement factors
+
+  int ncandidate;         // # of candidate settings
+  int icandidate;         // candidate being timed, -1 if none
+  double *cand_rcut;      // Coulomb cutoff of each candidate
+  int *cand_order;        // order of each candidate, 0 = solver default
+  double *cand_mesh;      // grid refinement of each candidate, 1.0 = auto
+  double *cand_time;      // measured time per step of each candidate
+  double *cand_acc;       // estimated accuracy of each candidate
+  double acc_limit;       // candidates must be at least this accurate
+  double rcut_base;       // Coulomb cutoff before the joint search
+
+  int tune_order;         // order applied by update_kspace_style(), 0 = auto
+  int tune_mesh[3];       // grid applied by update_kspace_style(), 0 = auto
+  int auto_mesh[3];       // PPPM grid chosen automatically for last order
+
+  double elapsed_time();
+  int factorable(int);
+
   inline void shft3(double &a, double &b, double &c, const double d)
   {
     a=b;
@@ -100,6 +129,12 @@ E: Cannot use fix tune/kspace without a pair style
 
 This fix (tune/kspace) can only be used when a pair style has been specified.
 
+E: Cannot use fix tune/kspace with run_style verlet/split
+
+The partitioning of processors between the real space and kspace
+calculations is fixed when LAMMPS is launched and cannot be tuned at
+run time.
+
 E: Bad real space Coulomb cutoff in fix tune/kspace
 
 Fix tune/kspace tried to find the optimal real space Coulomb cutoff using
@@ -0,0 +1,2138 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   Fast multipole method with Cartesian Taylor expansions
+
+   The Coulomb kernel is split as in MSM: the pair coul/msm styles compute
+   1/r - gamma(r/a)/a inside the cutoff a and this solver computes the
+   smooth remainder gamma(r/a)/a (= 1/r beyond a) between all pairs.
+
+   Near field: the box is divided into coarse cells of size >= a/2.  The
+   charges (owned + ghost) of each coarse cell are sorted into an adaptive
+   octree.  Each target cell interacts with the cells of its near block
+   via a dual tree traversal; node pairs that are well separated and
+   further apart than a use M2L, all other leaf pairs are summed directly.
+   Only ghost atoms are needed, so any comm style can be used.
+
+   Far field: the coarse cells form an implicit octree over cell indices,
+   which is traversed for the nodes holding owned charges and each
+   explicit image of the box (|n| <= 2 in periodic dims).  Each proc
+   stores only its own nodes and the source nodes its traversal needs
+   (locally essential tree).  Partial multipoles are summed on the proc
+   owning a node's center and fetched from there via rendezvous comm.
+
+   Periodic images beyond that are summed with a hierarchy of 3x3x3
+   super cells of the box multipole.  For 3d periodic systems the
+   conditionally convergent dipole term uses the tin-foil Ewald result.
+------------------------------------------------------------------------- */
+
+#include "fmm.h"
+#include <mpi.h>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "pair.h"
+#include "neighbor.h"
+#include "memory.h"
+#include "error.h"
+#include "math_const.h"
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+#define SMALL 0.00001
+#define MAXORDER 12
+#define MAXDEPTH 20
+#define OFFSET 1048576
+#define KEYBITS 21
+#define NIMAGE 2
+#define RING 7          // = 3*NIMAGE+1, so super cell rings tile space
+#define DELTA_STRAIN 1.0e-5
+#define P2P_COST 4
+#define RVOUS 0         // 0 for irregular, 1 for all2all
+
+/* ---------------------------------------------------------------------- */
+
+FMM::FMM(LAMMPS *lmp) : KSpace(lmp),
+  cx(NULL), cy(NULL), cz(NULL), cdeg(NULL), cindex(NULL), cdown(NULL),
+  cdown2(NULL), cup(NULL), fac(NULL), facinv(NULL), m2l_first(NULL),
+  m2l_a(NULL), m2l_fac(NULL), mfac(NULL), afac(NULL), mshift(NULL),
+  shift_hi(NULL), shift_lo(NULL), shift_d(NULL), shift_c(NULL),
+  perm(NULL), permtmp(NULL), octant(NULL), atomkey(NULL), phi(NULL), grad(NULL),
+  mpole(NULL), tpole(NULL), lpole(NULL), gmine(NULL), glpole(NULL),
+  gpole(NULL), rvous_pole(NULL),
+  mbox(NULL), lbox(NULL), mk1(NULL), mk2(NULL), sk(NULL), work1(NULL),
+  work2(NULL), work3(NULL), dpow(NULL)
+{
+  msmflag = 1;
+  triclinic_support = 0;
+  warn_nonneutral = 0;
+
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  // order is the order of the splitting function shared with coul/msm
+
+  order = 10;
+
+  porder = 0;
+  porder_user = 0;
+  theta = 0.5;
+  nleaf = 32;
+  nlattice = 8;
+
+  ncoef = 0;
+  nm2l = nshift = 0;
+  nmax = maxnode = maxgnode = maxsource = 0;
+  groot = -1;
+  for (int i = 0; i < 13; i++) sring[i] = NULL;
+  lattice_valid = lattice_strain_valid = 0;
+  cutghostuser_save = cutghostuser_set = -1.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FMM::settings(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal kspace_style fmm command");
+  accuracy_relative = fabs(force->numeric(FLERR,arg[0]));
+}
+
+/* ----------------------------------------------------------------------
+   free all memory
+------------------------------------------------------------------------- */
+
+FMM::~FMM()
+{
+  deallocate_tables();
+  memory->destroy(perm);
+  memory->destroy(permtmp);
+  memory->destroy(octant);
+  memory->destroy(atomkey);
+  memory->destroy(phi);
+  memory->destroy(grad);
+  memory->destroy(mpole);
+  memory->destroy(tpole);
+  memory->destroy(lpole);
+  memory->destroy(gmine);
+  memory->destroy(glpole);
+  memory->destroy(gpole);
+  memory->sfree(rvous_pole);
+
+  // restore the user communication cutoff unless it was changed since
+  // comm is already gone if called when LAMMPS is destroyed
+
+  if (comm && comm->cutghostuser == cutghostuser_set)
+    comm->cutghostuser = cutghostuser_save;
+}
+
+/* ----------------------------------------------------------------------
+   called once before run
+------------------------------------------------------------------------- */
+
+void FMM::init()
+{
+  if (me == 0) {
+    if (screen) fprintf(screen,"FMM initialization ...\n");
+    if (logfile) fprintf(logfile,"FMM initialization ...\n");
+  }
+
+  // error check
+
+  triclinic_check();
+  if (domain->dimension == 2)
+    error->all(FLERR,"Cannot (yet) use kspace_style fmm with 2d simulation");
+  if (!atom->q_flag) error->all(FLERR,"Kspace style requires atom attribute q");
+
+  if ((slabflag == 1) && (me == 0))
+    error->warning(FLERR,"Slab correction not needed for kspace_style fmm");
+
+  if (order < 4 || order > 10 || order%2 != 0)
+    error->all(FLERR,"FMM order must be 4, 6, 8, or 10");
+  if (porder_user && (porder_user < 2 || porder_user > MAXORDER))
+    error->all(FLERR,"FMM expansion order must be between 2 and 12");
+
+  // compute two charge force
+
+  two_charge();
+
+  // extract short-range Coulombic cutoff from pair style
+
+  pair_check();
+
+  int itmp;
+  double *p_cutoff = (double *) force->pair->extract("cut_coul",itmp);
+  if (p_cutoff == NULL)
+    error->all(FLERR,"KSpace style is incompatible with Pair style");
+  cutoff = *p_cutoff;
+
+  // periodic systems must be charge neutral
+  // for fully non-periodic systems any net charge is handled exactly
+
+  periodic[0] = domain->xperiodic;
+  periodic[1] = domain->yperiodic;
+  periodic[2] = domain->zperiodic;
+  nperiodic = periodic[0] + periodic[1] + periodic[2];
+  if (nperiodic == 0) warn_nonneutral = 2;
+
+  scale = 1.0;
+  qqrd2e = force->qqrd2e;
+  qsum_qsq();
+  natoms_original = atom->natoms;
+
+  // set accuracy (force units) from accuracy_relative or accuracy_absolute
+
+  if (accuracy_absolute >= 0.0) accuracy = accuracy_absolute;
+  else accuracy = accuracy_relative * two_charge_force;
+
+  // setup coarse cells and expansion order
+
+  setup();
+  set_order();
+  allocate_tables();
+
+  // near field needs ghost atoms out to the edge of the near block
+  // raise the user communication cutoff while this style is defined,
+  // keep the value the user set, so it can be restored
+
+  if (comm->cutghostuser != cutghostuser_set)
+    cutghostuser_save = comm->cutghostuser;
+  comm->cutghostuser = cutghostuser_save;
+
+  if (comm->cutghostuser < cutghost_need) {
+    comm->cutghostuser = cutghost_need;
+    if (me == 0) {
+      if (screen)
+        fprintf(screen,"  communication cutoff raised to %g\n",cutghost_need);
+      if (logfile)
+        fprintf(logfile,"  communication cutoff raised to %g\n",cutghost_need);
+    }
+  }
+  cutghostuser_set = comm->cutghostuser;
+
+  bigint natoms = atom->natoms;
+  double q2_over_sqrt = q2 / sqrt(natoms*cutoff*volume);
+  double fmm_error = estimate_error(porder);
+  double short_range_error = 0.0;
+  double table_error =
+    estimate_table_accuracy(q2_over_sqrt,short_range_error);
+  double estimated_error = sqrt(fmm_error*fmm_error + table_error*table_error);
+
+  if (me == 0) {
+    if (screen) {
+      fprintf(screen,"  coarse cells = %d %d %d\n",ncell[0],ncell[1],ncell[2]);
+      fprintf(screen,"  expansion order = %d\n",porder);
+      fprintf(screen,"  estimated absolute RMS force accuracy = %g\n",
+              estimated_error);
+      fprintf(screen,"  estimated relative force accuracy = %g\n",
+              estimated_error/two_charge_force);
+    }
+    if (logfile) {
+      fprintf(logfile,"  coarse cells = %d %d %d\n",ncell[0],ncell[1],ncell[2]);
+      fprintf(logfile,"  expansion order = %d\n",porder);
+      fprintf(logfile,"  estimated absolute RMS force accuracy = %g\n",
+              estimated_error);
+      fprintf(logfile,"  estimated relative force accuracy = %g\n",
+              estimated_error/two_charge_force);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   adjust FMM coeffs, called initially and whenever volume has changed
+------------------------------------------------------------------------- */
+
+void FMM::setup()
+{
+  volume = domain->xprd * domain->yprd * domain->zprd;
+  set_cells(0.0);
+  lattice_valid = lattice_strain_valid = 0;
+}
+
+/* ----------------------------------------------------------------------
+   coarse cells of size >= a/2 and the near block that covers the cutoff
+   the near block must fit inside one periodic image on each side
+   if cutlimit > 0, use finer cells where the near block would need
+   ghost atoms beyond cutlimit, e.g. after the box has grown
+------------------------------------------------------------------------- */
+
+void FMM::set_cells(double cutlimit)
+{
+  double *prd = domain->prd;
+  double skin = neighbor->skin;
+  double need = 0.0;
+
+  for (int d = 0; d < 3; d++) {
+    int n = MAX(1,static_cast<int> (2.0*prd[d]/cutoff));
+    double needd;
+    while (1) {
+      if (n >= OFFSET/2)
+        error->all(FLERR,"Too many coarse cells for kspace_style fmm");
+      ncell[d] = n;
+      hcell[d] = prd[d]/n;
+      hcellinv[d] = 1.0/hcell[d];
+      nnear[d] = static_cast<int> (ceil(cutoff*hcellinv[d] - SMALL));
+      if (periodic[d]) needd = (nnear[d]+1)*hcell[d];
+      else {
+        nnear[d] = MIN(nnear[d],n+1);
+        needd = MIN((nnear[d]+1)*hcell[d],prd[d]);
+      }
+      if (cutlimit <= 0.0 || needd + skin <= cutlimit) break;
+      n++;
+    }
+    if (periodic[d] && ncell[d] < nnear[d] + 2)
+      error->all(FLERR,"Periodic box is too small for kspace_style fmm");
+    need = MAX(need,needd);
+  }
+
+  cutghost_need = need + skin;
+}
+
+/* ----------------------------------------------------------------------
+   choose expansion order from accuracy unless set by kspace_modify
+------------------------------------------------------------------------- */
+
+void FMM::set_order()
+{
+  if (porder_user) {
+    porder = porder_user;
+    return;
+  }
+
+  for (porder = 2; porder < MAXORDER; porder++)
+    if (estimate_error(porder) <= accuracy) break;
+
+  if (porder == MAXORDER && estimate_error(porder) > accuracy && me == 0)
+    error->warning(FLERR,"FMM accuracy not reached with max expansion order");
+}
+
+/* ----------------------------------------------------------------------
+   estimate RMS force error of the multipole expansions for order p
+   forced M2L between coarse cells just outside the near block set the
+   worst-case ratio of cell size to distance
+------------------------------------------------------------------------- */
+
+double FMM::estimate_error(int p)
+{
+  double diag = sqrt(hcell[0]*hcell[0] + hcell[1]*hcell[1] +
+                     hcell[2]*hcell[2]);
+  double dmin = 0.0;
+  for (int d = 0; d < 3; d++)
+    if (periodic[d] || ncell[d] > nnear[d]) {
+      double dist = (nnear[d]+1)*hcell[d];
+      if (dmin == 0.0 || dist < dmin) dmin = dist;
+    }
+
+  double ratio = theta;
+  if (dmin > 0.0) ratio = MAX(ratio,diag/dmin);
+  ratio = MIN(ratio,0.9);
+
+  // empirical fit of RMS force errors against converged Ewald sums
+
+  bigint natoms = atom->natoms;
+  double q2_over_sqrt = q2 / sqrt(natoms*cutoff*volume);
+  return 1.3 * q2_over_sqrt * pow(ratio,1.6*(p+1));
+}
+
+/* ----------------------------------------------------------------------
+   FMM specific kspace_modify keywords
+------------------------------------------------------------------------- */
+
+int FMM::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"fmm/order") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal kspace_modify command");
+    porder_user = force->inumeric(FLERR,arg[1]);
+    if (porder_user != 0 && (porder_user < 2 || porder_user > MAXORDER))
+      error->all(FLERR,"Illegal kspace_modify command");
+    return 2;
+  } else if (strcmp(arg[0],"fmm/theta") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal kspace_modify command");
+    theta = force->numeric(FLERR,arg[1]);
+    if (theta <= 0.0 || theta >= 1.0)
+      error->all(FLERR,"Illegal kspace_modify command");
+    return 2;
+  } else if (strcmp(arg[0],"fmm/leaf") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal kspace_modify command");
+    nleaf = force->inumeric(FLERR,arg[1]);
+    if (nleaf < 1) error->all(FLERR,"Illegal kspace_modify command");
+    return 2;
+  } else if (strcmp(arg[0],"fmm/images") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal kspace_modify command");
+    nlattice = force->inumeric(FLERR,arg[1]);
+    if (nlattice < 0) error->all(FLERR,"Illegal kspace_modify command");
+    return 2;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   multi-index tables and sparse M2M/M2L/L2L operators for order porder
+   coefficients are ordered by total degree
+   M[b] = sum q v^b about source center, phi(u) = sum L[a] u^a
+   L[a] = sum_b M[b] (-1)^|a| C(a+b,a) D[a+b](R), R = target - source
+   with D[n] = (-1)^|n| d^n(1/r)/n! from the standard recurrence
+------------------------------------------------------------------------- */
+
+void FMM::allocate_tables()
+{
+  deallocate_tables();
+
+  const int p = porder;
+  const int np = p+1;
+
+  ncoef = (p+1)*(p+2)*(p+3)/6;
+  memory->create(cx,ncoef,"fmm:cx");
+  memory->create(cy,ncoef,"fmm:cy");
+  memory->create(cz,ncoef,"fmm:cz");
+  memory->create(cdeg,ncoef,"fmm:cdeg");
+  memory->create(cindex,np*np*np,"fmm:cindex");
+  memory->create(cdown,ncoef,3,"fmm:cdown");
+  memory->create(cdown2,ncoef,3,"fmm:cdown2");
+  memory->create(cup,ncoef,3,"fmm:cup");
+
+  for (int i = 0; i < np*np*np; i++) cindex[i] = -1;
+
+  int n = 0;
+  for (int deg = 0; deg <= p; deg++)
+    for (int ix = deg; ix >= 0; ix--)
+      for (int iy = deg-ix; iy >= 0; iy--) {
+        int iz = deg-ix-iy;
+        cx[n] = ix;
+        cy[n] = iy;
+        cz[n] = iz;
+        cdeg[n] = deg;
+        cindex[(ix*np+iy)*np+iz] = n;
+        n++;
+      }
+
+  for (int c = 0; c < ncoef; c++) {
+    int idx[3] = {cx[c],cy[c],cz[c]};
+    for (int d = 0; d < 3; d++) {
+      idx[d]--;
+      cdown[c][d] = -1;
+      if (idx[d] >= 0) cdown[c][d] = cindex[(idx[0]*np+idx[1])*np+idx[2]];
+      idx[d]--;
+      cdown2[c][d] = -1;
+      if (idx[d] >= 0) cdown2[c][d] = cindex[(idx[0]*np+idx[1])*np+idx[2]];
+      idx[d] += 3;
+      cup[c][d] = -1;
+      if (cdeg[c] < p) cup[c][d] = cindex[(idx[0]*np+idx[1])*np+idx[2]];
+      idx[d]--;
+    }
+  }
+
+  // multi-index factorials
+
+  memory->create(fac,ncoef,"fmm:fac");
+  memory->create(facinv,ncoef,"fmm:facinv");
+  for (int c = 0; c < ncoef; c++) {
+    fac[c] = factorial(cx[c])*factorial(cy[c])*factorial(cz[c]);
+    facinv[c] = 1.0/fac[c];
+  }
+
+  // M2L as L[a] = (-1)^|a|/a! sum_b M[b]/b! (a+b)! D[a+b]
+  // coefficients are ordered by degree, so b runs over a contiguous range
+
+  memory->create(m2l_first,ncoef+1,"fmm:m2l_first");
+  memory->create(m2l_fac,ncoef,"fmm:m2l_fac");
+
+  nm2l = 0;
+  for (int a = 0; a < ncoef; a++) {
+    m2l_first[a] = nm2l;
+    for (int b = 0; b < ncoef; b++)
+      if (cdeg[a]+cdeg[b] <= p) nm2l++;
+    m2l_fac[a] = ((cdeg[a] % 2) ? -1.0 : 1.0) * facinv[a];
+  }
+  m2l_first[ncoef] = nm2l;
+
+  memory->create(m2l_a,nm2l,"fmm:m2l_a");
+
+  n = 0;
+  for (int a = 0; a < ncoef; a++)
+    for (int b = 0; b < ncoef; b++) {
+      if (cdeg[a]+cdeg[b] > p) continue;
+      m2l_a[n++] = cindex[((cx[a]+cx[b])*np+cy[a]+cy[b])*np+cz[a]+cz[b]];
+    }
+
+  // shift triples (hi >= lo componentwise), shared by M2M and L2L
+
+  nshift = 0;
+  for (int hi = 0; hi < ncoef; hi++)
+    for (int lo = 0; lo < ncoef; lo++)
+      if (cx[lo] <= cx[hi] && cy[lo] <= cy[hi] && cz[lo] <= cz[hi]) nshift++;
+
+  memory->create(shift_hi,nshift,"fmm:shift_hi");
+  memory->create(shift_lo,nshift,"fmm:shift_lo");
+  memory->create(shift_d,nshift,"fmm:shift_d");
+  memory->create(shift_c,nshift,"fmm:shift_c");
+
+  n = 0;
+  for (int hi = 0; hi < ncoef; hi++)
+    for (int lo = 0; lo < ncoef; lo++) {
+      if (cx[lo] > cx[hi] || cy[lo] > cy[hi] || cz[lo] > cz[hi]) continue;
+      shift_hi[n] = hi;
+      shift_lo[n] = lo;
+      shift_d[n] = cindex[((cx[hi]-cx[lo])*np+(cy[hi]-cy[lo]))*np +
+                          (cz[hi]-cz[lo])];
+      shift_c[n] = binomial(cx[hi],cx[lo])*binomial(cy[hi],cy[lo]) *
+        binomial(cz[hi],cz[lo]);
+      n++;
+    }
+
+  memory->create(work1,ncoef,"fmm:work1");
+  memory->create(work2,3*ncoef,"fmm:work2");
+  memory->create(work3,ncoef,"fmm:work3");
+  memory->create(mfac,ncoef,"fmm:mfac");
+  memory->create(afac,ncoef,"fmm:afac");
+  memory->create(mshift,3*ncoef,"fmm:mshift");
+  memory->create(dpow,ncoef,"fmm:dpow");
+  memory->create(mbox,ncoef,"fmm:mbox");
+  memory->create(lbox,ncoef,"fmm:lbox");
+  memory->create(mk1,ncoef,"fmm:mk1");
+  memory->create(mk2,ncoef,"fmm:mk2");
+  memory->create(sk,ncoef,"fmm:sk");
+  for (int i = 0; i < 13; i++) memory->create(sring[i],ncoef,"fmm:sring");
+
+  // per-node arrays depend on ncoef
+
+  memory->destroy(mpole);
+  memory->destroy(tpole);
+  memory->destroy(lpole);
+  memory->destroy(gmine);
+  memory->destroy(glpole);
+  memory->destroy(gpole);
+  maxnode = maxgnode = maxsource = 0;
+  lattice_valid = lattice_strain_valid = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FMM::deallocate_tables()
+{
+  memory->destroy(cx);
+  memory->destroy(cy);
+  memory->destroy(cz);
+  memory->destroy(cdeg);
+  memory->destroy(cindex);
+  memory->destroy(cdown);
+  memory->destroy(cdown2);
+  memory->destroy(cup);
+  memory->destroy(m2l_first);
+  memory->destroy(m2l_a);
+  memory->destroy(m2l_fac);
+  memory->destroy(fac);
+  memory->destroy(facinv);
+  memory->destroy(mfac);
+  memory->destroy(afac);
+  memory->destroy(mshift);
+  memory->destroy(shift_hi);
+  memory->destroy(shift_lo);
+  memory->destroy(shift_d);
+  memory->destroy(shift_c);
+  memory->destroy(work1);
+  memory->destroy(work2);
+  memory->destroy(work3);
+  memory->destroy(dpow);
+  memory->destroy(mbox);
+  memory->destroy(lbox);
+  memory->destroy(mk1);
+  memory->destroy(mk2);
+  memory->destroy(sk);
+  for (int i = 0; i < 13; i++) memory->destroy(sring[i]);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FMM::binomial(int n, int k)
+{
+  double b = 1.0;
+  for (int i = 1; i <= k; i++) b = b*(n-k+i)/i;
+  return b;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FMM::factorial(int n)
+{
+  double f = 1.0;
+  for (int i = 2; i <= n; i++) f *= i;
+  return f;
+}
+
+/* ----------------------------------------------------------------------
+   compute the FMM long-range force, energy, virial
+------------------------------------------------------------------------- */
+
+void FMM::compute(int eflag, int vflag)
+{
+  int i;
+
+  // set energy/virial flags
+
+  ev_init(eflag,vflag);
+
+  if (vflag_atom)
+    error->all(FLERR,"Cannot (yet) compute per-atom virial with "
+               "kspace_style fmm");
+
+  // if atom count has changed, update qsum and qsqsum
+
+  if (atom->natoms != natoms_original) {
+    qsum_qsq();
+    natoms_original = atom->natoms;
+  }
+
+  // return if there are no charges
+
+  if (qsqsum == 0.0) return;
+
+  // shrink-wrapped boxes change without a call to setup()
+  // use finer coarse cells if the box has grown beyond the ghost cutoff
+
+  if (domain->nonperiodic == 2) set_cells(0.0);
+  double cutlimit = MIN(comm->cutghost[0],
+                        MIN(comm->cutghost[1],comm->cutghost[2]));
+  if (cutlimit < cutghost_need) {
+    set_cells(cutlimit);
+    if (cutlimit < cutghost_need)
+      error->all(FLERR,"Ghost cutoff is too short for kspace_style fmm");
+  }
+
+  grow_atoms();
+
+  int nlocal = atom->nlocal;
+  for (i = 0; i < nlocal; i++) {
+    phi[i] = 0.0;
+    grad[i][0] = grad[i][1] = grad[i][2] = 0.0;
+  }
+
+  // multipoles of local trees and of my nodes of the coarse cell tree
+
+  build_local();
+  upward_local();
+  build_global();
+
+  // local expansions: near block, far cells and explicit images,
+  // then the periodic lattice beyond the explicit images
+
+  memset(lpole,0,nodes.size()*ncoef*sizeof(double));
+
+  near_field();
+  far_field();
+
+  if (nperiodic) {
+    if (!lattice_valid) lattice_setup(0);
+    lattice_local(0,mbox,lbox);
+
+    if (groot >= 0) {
+      GNode &root = gnodes[groot];
+      double d[3];
+      d[0] = root.center[0] - boxcenter[0];
+      d[1] = root.center[1] - boxcenter[1];
+      d[2] = root.center[2] - boxcenter[2];
+      l2l(d,lbox,&glpole[groot*ncoef]);
+    }
+
+    if (vflag_global && me == 0) virial_lattice();
+  }
+
+  downward_global();
+  downward_local();
+
+  // apply forces, accumulate energy
+
+  const double qscale = qqrd2e * scale;
+  double *q = atom->q;
+  double **f = atom->f;
+
+  for (i = 0; i < nlocal; i++) {
+    f[i][0] -= qscale*q[i]*grad[i][0];
+    f[i][1] -= qscale*q[i]*grad[i][1];
+    f[i][2] -= qscale*q[i]*grad[i][2];
+  }
+
+  if (eflag_global) {
+    double e = 0.0;
+    for (i = 0; i < nlocal; i++) e += q[i]*phi[i];
+    double energy_all;
+    MPI_Allreduce(&e,&energy_all,1,MPI_DOUBLE,MPI_SUM,world);
+    energy = 0.5*qscale*energy_all;
+  }
+
+  if (eflag_atom)
+    for (i = 0; i < nlocal; i++) eatom[i] += 0.5*qscale*q[i]*phi[i];
+
+  if (vflag_global) {
+    double virial_all[6];
+    MPI_Allreduce(virial,virial_all,6,MPI_DOUBLE,MPI_SUM,world);
+    for (i = 0; i < 6; i++) virial[i] = qscale*virial_all[i];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FMM::grow_atoms()
+{
+  int nall = atom->nlocal + atom->nghost;
+  if (atom->nmax > nmax || nall > nmax) {
+    memory->destroy(perm);
+    memory->destroy(permtmp);
+    memory->destroy(octant);
+    memory->destroy(atomkey);
+    memory->destroy(phi);
+    memory->destroy(grad);
+    nmax = MAX(atom->nmax,nall);
+    memory->create(perm,nmax,"fmm:perm");
+    memory->create(permtmp,nmax,"fmm:permtmp");
+    memory->create(octant,nmax,"fmm:octant");
+    memory->create(atomkey,nmax,"fmm:atomkey");
+    memory->create(phi,nmax,"fmm:phi");
+    memory->create(grad,nmax,3,"fmm:grad");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FMM::grow_nodes(int n)
+{
+  if (n <= maxnode) return;
+  maxnode = static_cast<int> (1.2*n) + 1;
+  memory->destroy(mpole);
+  memory->destroy(tpole);
+  memory->destroy(lpole);
+  memory->create(mpole,(bigint) maxnode*ncoef,"fmm:mpole");
+  memory->create(tpole,(bigint) maxnode*ncoef,"fmm:tpole");
+  memory->create(lpole,(bigint) maxnode*ncoef,"fmm:lpole");
+}
+
+/* ---------------------------------------------------------------------- */
+
+inline bigint FMM::cellkey(int ix, int iy, int iz) const
+{
+  return ((bigint) (ix+OFFSET) << (2*KEYBITS)) |
+    ((bigint) (iy+OFFSET) << KEYBITS) | (bigint) (iz+OFFSET);
+}
+
+/* ----------------------------------------------------------------------
+   sort owned and ghost charges into coarse cells and build an adaptive
+   octree inside each cell, cells are in unwrapped coordinates
+------------------------------------------------------------------------- */
+
+void FMM::build_local()
+{
+  double **x = atom->x;
+  double *q = atom->q;
+  double *boxlo = domain->boxlo;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+
+  int n = 0;
+  int flag = 0;
+  for (int i = 0; i < nall; i++) {
+    if (q[i] == 0.0) continue;
+    int ix = static_cast<int> (floor((x[i][0]-boxlo[0])*hcellinv[0]));
+    int iy = static_cast<int> (floor((x[i][1]-boxlo[1])*hcellinv[1]));
+    int iz = static_cast<int> (floor((x[i][2]-boxlo[2])*hcellinv[2]));
+    if (i < nlocal) {
+      if (ix < -1 || ix > ncell[0] || iy < -1 || iy > ncell[1] ||
+          iz < -1 || iz > ncell[2]) flag = 1;
+    } else if (abs(ix) >= OFFSET/2 || abs(iy) >= OFFSET/2 ||
+               abs(iz) >= OFFSET/2) continue;
+    atomkey[i] = cellkey(ix,iy,iz);
+    perm[n++] = i;
+  }
+
+  if (flag) error->one(FLERR,"Out of range atoms - cannot compute FMM");
+
+  const bigint *key = atomkey;
+  std::sort(perm,perm+n,[key](int a, int b) { return key[a] < key[b]; });
+
+  nodes.clear();
+  cellmap.clear();
+
+  int first = 0;
+  while (first < n) {
+    bigint k = atomkey[perm[first]];
+    int last = first+1;
+    while (last < n && atomkey[perm[last]] == k) last++;
+
+    int i = perm[first];
+    double lo[3],hi[3];
+    for (int d = 0; d < 3; d++) {
+      int ic = static_cast<int> (floor((x[i][d]-boxlo[d])*hcellinv[d]));
+      lo[d] = boxlo[d] + ic*hcell[d];
+      hi[d] = lo[d] + hcell[d];
+    }
+
+    int root = nodes.size();
+    nodes.resize(root+1);
+    build_node(root,first,last-first,lo,hi,0);
+    cellmap[k] = root;
+    first = last;
+  }
+
+  grow_nodes(nodes.size());
+}
+
+/* ----------------------------------------------------------------------
+   fill node inode with charges perm[first:first+count] inside the
+   geometric box lo/hi and split into octants if needed
+------------------------------------------------------------------------- */
+
+void FMM::build_node(int inode, int first, int count, double *glo,
+                     double *ghi, int depth)
+{
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+
+  Node *node = &nodes[inode];
+  node->first = first;
+  node->count = count;
+  node->child = -1;
+  node->nchild = 0;
+  for (int d = 0; d < 3; d++) {
+    node->center[d] = 0.5*(glo[d]+ghi[d]);
+    node->lo[d] = ghi[d];
+    node->hi[d] = glo[d];
+  }
+
+  int nown = 0;
+  double rsqmax = 0.0;
+  for (int m = first; m < first+count; m++) {
+    int i = perm[m];
+    if (i < nlocal) nown++;
+    double rsq = 0.0;
+    for (int d = 0; d < 3; d++) {
+      node->lo[d] = MIN(node->lo[d],x[i][d]);
+      node->hi[d] = MAX(node->hi[d],x[i][d]);
+      double del = x[i][d] - node->center[d];
+      rsq += del*del;
+    }
+    rsqmax = MAX(rsqmax,rsq);
+  }
+  node->nown = nown;
+  node->radius = sqrt(rsqmax);
+
+  if (count <= nleaf || depth >= MAXDEPTH) return;
+
+  // counting sort of charges into octants
+
+  int ncount[8],start[8];
+  for (int k = 0; k < 8; k++) ncount[k] = 0;
+  for (int m = first; m < first+count; m++) {
+    int i = perm[m];
+    int oct = 0;
+    for (int d = 0; d < 3; d++)
+      if (x[i][d] >= node->center[d]) oct |= 1 << d;
+    permtmp[m] = oct;
+    ncount[oct]++;
+  }
+
+  int nchild = 0;
+  start[0] = first;
+  for (int k = 0; k < 8; k++) {
+    if (k) start[k] = start[k-1] + ncount[k-1];
+    if (ncount[k]) nchild++;
+  }
+
+  int offset[8];
+  for (int k = 0; k < 8; k++) offset[k] = start[k];
+  for (int m = first; m < first+count; m++)
+    octant[offset[permtmp[m]]++] = perm[m];
+  memcpy(&perm[first],&octant[first],count*sizeof(int));
+
+  int child = nodes.size();
+  nodes.resize(child+nchild);
+  node = &nodes[inode];
+  node->child = child;
+  node->nchild = nchild;
+
+  double center[3];
+  for (int d = 0; d < 3; d++) center[d] = node->center[d];
+
+  int ichild = child;
+  for (int k = 0; k < 8; k++) {
+    if (ncount[k] == 0) continue;
+    double clo[3],chi[3];
+    for (int d = 0; d < 3; d++) {
+      if (k & (1 << d)) {
+        clo[d] = center[d];
+        chi[d] = ghi[d];
+      } else {
+        clo[d] = glo[d];
+        chi[d] = center[d];
+      }
+    }
+    build_node(ichild++,start[k],ncount[k],clo,chi,depth+1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   multipoles of all local nodes (mpole) and of their owned charges
+   only (tpole), children are stored after their parents
+------------------------------------------------------------------------- */
+
+void FMM::upward_local()
+{
+  double **x = atom->x;
+  double *q = atom->q;
+  int nlocal = atom->nlocal;
+  int nnodes = nodes.size();
+
+  for (int inode = nnodes-1; inode >= 0; inode--) {
+    Node &node = nodes[inode];
+    double *m = &mpole[inode*ncoef];
+    double *t = &tpole[inode*ncoef];
+    memset(m,0,ncoef*sizeof(double));
+    memset(t,0,ncoef*sizeof(double));
+
+    if (node.nchild == 0) {
+      for (int k = node.first; k < node.first+node.count; k++) {
+        int i = perm[k];
+        double v[3];
+        v[0] = x[i][0] - node.center[0];
+        v[1] = x[i][1] - node.center[1];
+        v[2] = x[i][2] - node.center[2];
+        powers(v,dpow);
+        for (int c = 0; c < ncoef; c++) m[c] += q[i]*dpow[c];
+        if (i < nlocal)
+          for (int c = 0; c < ncoef; c++) t[c] += q[i]*dpow[c];
+      }
+    } else {
+      for (int ic = node.child; ic < node.child+node.nchild; ic++) {
+        Node &child = nodes[ic];
+        double d[3];
+        d[0] = child.center[0] - node.center[0];
+        d[1] = child.center[1] - node.center[1];
+        d[2] = child.center[2] - node.center[2];
+        m2m(d,&mpole[ic*ncoef],m);
+        if (child.nown) m2m(d,&tpole[ic*ncoef],t);
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   interactions of each target cell with the cells of its near block
+------------------------------------------------------------------------- */
+
+void FMM::near_field()
+{
+  const bigint mask = (1 << KEYBITS) - 1;
+
+  for (std::map<bigint,int>::iterator it = cellmap.begin();
+       it != cellmap.end(); ++it) {
+    int root = it->second;
+    if (nodes[root].nown == 0) continue;
+    bigint key = it->first;
+    int ix = static_cast<int> ((key >> (2*KEYBITS)) & mask) - OFFSET;
+    int iy = static_cast<int> ((key >> KEYBITS) & mask) - OFFSET;
+    int iz = static_cast<int> (key & mask) - OFFSET;
+
+    for (int jx = ix-nnear[0]; jx <= ix+nnear[0]; jx++)
+      for (int jy = iy-nnear[1]; jy <= iy+nnear[1]; jy++)
+        for (int jz = iz-nnear[2]; jz <= iz+nnear[2]; jz++) {
+          std::map<bigint,int>::iterator src = cellmap.find(cellkey(jx,jy,jz));
+          if (src == cellmap.end()) continue;
+          interact(root,src->second);
+        }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   dual tree traversal of target node A and source node B
+------------------------------------------------------------------------- */
+
+void FMM::interact(int ia, int ib)
+{
+  Node &a = nodes[ia];
+  Node &b = nodes[ib];
+  if (a.nown == 0) return;
+
+  double gapsq = 0.0;
+  for (int d = 0; d < 3; d++) {
+    double gap = MAX(a.lo[d]-b.hi[d],b.lo[d]-a.hi[d]);
+    if (gap > 0.0) gapsq += gap*gap;
+  }
+
+  // direct sum is cheaper than M2L for leaves with few charges
+
+  if (a.nchild == 0 && b.nchild == 0 && P2P_COST*a.nown*b.count < nm2l) {
+    p2p(ia,ib);
+    return;
+  }
+
+  double r[3];
+  r[0] = a.center[0] - b.center[0];
+  r[1] = a.center[1] - b.center[1];
+  r[2] = a.center[2] - b.center[2];
+  double dist = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+
+  if (gapsq >= cutoff*cutoff && a.radius + b.radius < theta*dist) {
+    m2l_virial(r,&mpole[ib*ncoef],&lpole[ia*ncoef],&tpole[ia*ncoef]);
+    return;
+  }
+
+  if (a.nchild == 0 && b.nchild == 0) {
+    p2p(ia,ib);
+    return;
+  }
+
+  if (b.nchild == 0 || (a.nchild && a.radius >= b.radius)) {
+    int child = a.child;
+    int nchild = a.nchild;
+    for (int ic = child; ic < child+nchild; ic++) interact(ic,ib);
+  } else {
+    int child = b.child;
+    int nchild = b.nchild;
+    for (int ic = child; ic < child+nchild; ic++) interact(ia,ic);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   M2L from source multipole m into local expansion l of a target node
+   with virial of the ordered pair interactions if requested,
+   t = multipole of the owned charges in the target node
+------------------------------------------------------------------------- */
+
+void FMM::m2l_virial(const double *r, const double *m, double *l,
+                     const double *t)
+{
+  derivatives(r,work3);
+
+  if (!vflag_global) {
+    m2l_coeff(work3,m,l);
+    return;
+  }
+
+  memset(work1,0,ncoef*sizeof(double));
+  m2l_coeff(work3,m,work1);
+  for (int c = 0; c < ncoef; c++) l[c] += work1[c];
+  virial_m2l(r,work3,m,work1,t,virial);
+}
+
+/* ----------------------------------------------------------------------
+   direct sum of smooth kernel between owned charges in leaf A and all
+   charges in leaf B
+------------------------------------------------------------------------- */
+
+void FMM::p2p(int ia, int ib)
+{
+  double **x = atom->x;
+  double *q = atom->q;
+  int nlocal = atom->nlocal;
+  const double a = cutoff;
+  const double ainv = 1.0/a;
+  const double cutsq = a*a;
+
+  Node &na = nodes[ia];
+  Node &nb = nodes[ib];
+
+  for (int k = na.first; k < na.first+na.count; k++) {
+    int i = perm[k];
+    if (i >= nlocal) continue;
+    double xi = x[i][0];
+    double yi = x[i][1];
+    double zi = x[i][2];
+    double pot = 0.0;
+    double gx = 0.0, gy = 0.0, gz = 0.0;
+    double v[6] = {0.0,0.0,0.0,0.0,0.0,0.0};
+
+    for (int m = nb.first; m < nb.first+nb.count; m++) {
+      int j = perm[m];
+      if (j == i) continue;
+      double delx = xi - x[j][0];
+      double dely = yi - x[j][1];
+      double delz = zi - x[j][2];
+      double rsq = delx*delx + dely*dely + delz*delz;
+      double g,dgr;
+      if (rsq < cutsq) {
+        double r = sqrt(rsq);
+        double rho = r*ainv;
+        g = gamma(rho)*ainv;
+        dgr = (r > 0.0) ? dgamma(rho)*ainv*ainv/r : 0.0;
+      } else {
+        double r2inv = 1.0/rsq;
+        g = sqrt(r2inv);
+        dgr = -g*r2inv;
+      }
+      pot += q[j]*g;
+      double fg = q[j]*dgr;
+      gx += fg*delx;
+      gy += fg*dely;
+      gz += fg*delz;
+      if (vflag_global) {
+        v[0] += fg*delx*delx;
+        v[1] += fg*dely*dely;
+        v[2] += fg*delz*delz;
+        v[3] += fg*delx*dely;
+        v[4] += fg*delx*delz;
+        v[5] += fg*dely*delz;
+      }
+    }
+
+    phi[i] += pot;
+    grad[i][0] += gx;
+    grad[i][1] += gy;
+    grad[i][2] += gz;
+    if (vflag_global)
+      for (int n = 0; n < 6; n++) virial[n] -= 0.5*q[i]*v[n];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   nodes of the coarse cell tree that hold my owned charges (targets)
+   and their multipoles, partial multipoles of all procs are summed
+   in the rendezvous decomposition
+------------------------------------------------------------------------- */
+
+void FMM::build_global()
+{
+  int i;
+
+  // # of levels, so the top level has a single node
+
+  nlevel = 1;
+  for (int d = 0; d < 3; d++)
+    while ((ncell[d]+1) >> (nlevel-1)) nlevel++;
+
+  gnodes.clear();
+  gchild.clear();
+  gmap.assign(nlevel,std::map<bigint,int>());
+  smap.assign(nlevel,std::map<bigint,int>());
+
+  // shifted cell indices that hold charges on any proc in each dim
+  // node boxes are clipped to them, which also skips empty slabs
+
+  const bigint mask = (1 << KEYBITS) - 1;
+
+  int offset[3];
+  offset[0] = 0;
+  offset[1] = ncell[0]+2;
+  offset[2] = offset[1] + ncell[1]+2;
+  int nused = offset[2] + ncell[2]+2;
+  std::vector<int> used(nused,0),usedall(nused);
+
+  for (std::map<bigint,int>::iterator it = cellmap.begin();
+       it != cellmap.end(); ++it) {
+    if (nodes[it->second].nown == 0) continue;
+    bigint key = it->first;
+    used[offset[0] + ((key >> (2*KEYBITS)) & mask) - OFFSET + 1] = 1;
+    used[offset[1] + ((key >> KEYBITS) & mask) - OFFSET + 1] = 1;
+    used[offset[2] + (key & mask) - OFFSET + 1] = 1;
+  }
+
+  MPI_Allreduce(&used[0],&usedall[0],nused,MPI_INT,MPI_MAX,world);
+
+  for (int d = 0; d < 3; d++) {
+    int n = ncell[d]+2;
+    cfirst[d].resize(n);
+    clast[d].resize(n);
+    int last = -1;
+    for (i = 0; i < n; i++) {
+      if (usedall[offset[d]+i]) last = i;
+      clast[d][i] = last;
+    }
+    int first = n;
+    for (i = n-1; i >= 0; i--) {
+      if (usedall[offset[d]+i]) first = i;
+      cfirst[d][i] = first;
+    }
+  }
+
+  // leaves are the coarse cells with owned charges
+
+  for (std::map<bigint,int>::iterator it = cellmap.begin();
+       it != cellmap.end(); ++it) {
+    if (nodes[it->second].nown == 0) continue;
+    bigint key = it->first;
+    int ix = static_cast<int> ((key >> (2*KEYBITS)) & mask) - OFFSET + 1;
+    int iy = static_cast<int> ((key >> KEYBITS) & mask) - OFFSET + 1;
+    int iz = static_cast<int> (key & mask) - OFFSET + 1;
+    GNode node;
+    gnode_setup(node,0,ix,iy,iz);
+    node.local = it->second;
+    gmap[0][cellkey(ix,iy,iz)] = gnodes.size();
+    gnodes.push_back(node);
+  }
+
+  // add parents level by level, so children are stored before parents
+
+  int first = 0;
+  for (int level = 1; level < nlevel; level++) {
+    int last = gnodes.size();
+    for (i = first; i < last; i++) {
+      int jx = gnodes[i].idx[0] >> 1;
+      int jy = gnodes[i].idx[1] >> 1;
+      int jz = gnodes[i].idx[2] >> 1;
+      bigint key = cellkey(jx,jy,jz);
+      std::map<bigint,int>::iterator it = gmap[level].find(key);
+      int iparent;
+      if (it == gmap[level].end()) {
+        GNode node;
+        gnode_setup(node,level,jx,jy,jz);
+        iparent = gnodes.size();
+        gmap[level][key] = iparent;
+        gnodes.push_back(node);
+      } else iparent = it->second;
+      gnodes[i].parent = iparent;
+    }
+    first = last;
+  }
+
+  int ngnode = gnodes.size();
+  groot = ngnode-1;
+
+  // children of each node as a contiguous range of gchild
+
+  for (i = 0; i < ngnode; i++)
+    if (gnodes[i].parent >= 0) gnodes[gnodes[i].parent].nchild++;
+  int n = 0;
+  for (i = 0; i < ngnode; i++) {
+    gnodes[i].child = n;
+    n += gnodes[i].nchild;
+    gnodes[i].nchild = 0;
+  }
+  gchild.resize(n);
+  for (i = 0; i < ngnode; i++) {
+    int iparent = gnodes[i].parent;
+    if (iparent < 0) continue;
+    GNode &parent = gnodes[iparent];
+    gchild[parent.child + parent.nchild++] = i;
+  }
+
+  if (ngnode > maxgnode) {
+    maxgnode = static_cast<int> (1.2*ngnode) + 1;
+    memory->destroy(gmine);
+    memory->destroy(glpole);
+    memory->create(gmine,(bigint) maxgnode*ncoef,"fmm:gmine");
+    memory->create(glpole,(bigint) maxgnode*ncoef,"fmm:glpole");
+  }
+
+  // multipoles of my owned charges, upward from the coarse cells
+
+  for (i = 0; i < ngnode; i++) {
+    GNode &node = gnodes[i];
+    double *m = &gmine[i*ncoef];
+    if (node.level == 0) {
+      memcpy(m,&tpole[node.local*ncoef],ncoef*sizeof(double));
+      continue;
+    }
+    memset(m,0,ncoef*sizeof(double));
+    for (int ic = node.child; ic < node.child+node.nchild; ic++) {
+      GNode &child = gnodes[gchild[ic]];
+      double d[3];
+      d[0] = child.center[0] - node.center[0];
+      d[1] = child.center[1] - node.center[1];
+      d[2] = child.center[2] - node.center[2];
+      m2m(d,&gmine[gchild[ic]*ncoef],m);
+    }
+  }
+
+  // send partial multipoles to the home proc of each node for summing
+  // datum = level, key, multipole
+
+  comm->coord2proc_setup();
+
+  int nper = ncoef+2;
+  int *proclist;
+  memory->create(proclist,MAX(ngnode,1),"fmm:proclist");
+  double *inbuf = (double *)
+    memory->smalloc((bigint) MAX(ngnode,1)*nper*sizeof(double),"fmm:inbuf");
+
+  for (i = 0; i < ngnode; i++) {
+    GNode &node = gnodes[i];
+    double *datum = &inbuf[(bigint) i*nper];
+    datum[0] = ubuf(node.level).d;
+    datum[1] = ubuf(cellkey(node.idx[0],node.idx[1],node.idx[2])).d;
+    memcpy(&datum[2],&gmine[i*ncoef],ncoef*sizeof(double));
+    proclist[i] = gnode_home(node);
+  }
+
+  char *outbuf = NULL;
+  comm->rendezvous(RVOUS,ngnode,(char *) inbuf,nper*sizeof(double),
+                   0,proclist,rendezvous_reduce,0,outbuf,0,(void *) this);
+
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
+
+  // multipole of the whole box about its center for the lattice sums
+
+  if (nperiodic) {
+    memset(work1,0,ncoef*sizeof(double));
+    for (int dim = 0; dim < 3; dim++)
+      boxcenter[dim] = 0.5*(domain->boxlo[dim]+domain->boxhi[dim]);
+    if (groot >= 0) {
+      GNode &root = gnodes[groot];
+      double d[3];
+      d[0] = root.center[0] - boxcenter[0];
+      d[1] = root.center[1] - boxcenter[1];
+      d[2] = root.center[2] - boxcenter[2];
+      m2m(d,&gmine[groot*ncoef],work1);
+    }
+    MPI_Allreduce(work1,mbox,ncoef,MPI_DOUBLE,MPI_SUM,world);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   geometry of coarse cell tree node (level,ix,iy,iz)
+   the bounding box is clipped to the cells with charges in each dim
+   return 0 if there are none
+------------------------------------------------------------------------- */
+
+int FMM::gnode_setup(GNode &node, int level, int ix, int iy, int iz)
+{
+  double *boxlo = domain->boxlo;
+
+  node.level = level;
+  node.idx[0] = ix;
+  node.idx[1] = iy;
+  node.idx[2] = iz;
+
+  double rsq = 0.0;
+  for (int d = 0; d < 3; d++) {
+    int first = cfirst[d][node.idx[d] << level];
+    int last = clast[d][MIN(((node.idx[d]+1) << level) - 1,ncell[d]+1)];
+    if (first > last) return 0;
+    node.ilo[d] = first-1;
+    node.ihi[d] = last-1;
+    double lo = boxlo[d] + node.ilo[d]*hcell[d];
+    double hi = lo + (node.ihi[d]-node.ilo[d]+1)*hcell[d];
+    node.center[d] = 0.5*(lo+hi);
+    rsq += 0.25*(hi-lo)*(hi-lo);
+  }
+  node.radius = sqrt(rsq);
+
+  node.child = -1;
+  node.nchild = 0;
+  node.parent = -1;
+  node.local = -1;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   home proc of a cell tree node in the rendezvous decomposition
+   = owner of its center, so partial multipoles and requests of a
+   node mostly come from the same or neighboring procs
+------------------------------------------------------------------------- */
+
+int FMM::gnode_home(const GNode &node)
+{
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+
+  double x[3];
+  for (int d = 0; d < 3; d++)
+    x[d] = MAX(boxlo[d],MIN(node.center[d],boxhi[d]));
+
+  int igx,igy,igz;
+  return comm->coord2proc(x,igx,igy,igz);
+}
+
+/* ----------------------------------------------------------------------
+   interactions between coarse cells outside each other's near block,
+   including explicit periodic images up to NIMAGE boxes away
+   the first traversal collects the source nodes my targets need,
+   their multipoles are fetched before the second traversal applies M2L
+------------------------------------------------------------------------- */
+
+void FMM::far_field()
+{
+  int ngnode = gnodes.size();
+  if (ngnode) memset(glpole,0,ngnode*ncoef*sizeof(double));
+
+  double *prd = domain->prd;
+  int nimg[3];
+  for (int d = 0; d < 3; d++) nimg[d] = periodic[d] ? NIMAGE : 0;
+
+  GNode top;
+  gnode_setup(top,nlevel-1,0,0,0);
+
+  int ishift[3];
+  double shift[3];
+  for (int eval = 0; eval < 2; eval++) {
+    if (eval) fetch_sources();
+    if (groot < 0) continue;
+
+    for (int nx = -nimg[0]; nx <= nimg[0]; nx++)
+      for (int ny = -nimg[1]; ny <= nimg[1]; ny++)
+        for (int nz = -nimg[2]; nz <= nimg[2]; nz++) {
+          ishift[0] = nx*ncell[0];
+          ishift[1] = ny*ncell[1];
+          ishift[2] = nz*ncell[2];
+          shift[0] = nx*prd[0];
+          shift[1] = ny*prd[1];
+          shift[2] = nz*prd[2];
+          interact_global(groot,top,ishift,shift,eval);
+        }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   request summed multipoles of all source nodes in smap from their
+   home procs, sources without charges are not returned and keep -1
+------------------------------------------------------------------------- */
+
+void FMM::fetch_sources()
+{
+  int i;
+
+  int nrequest = 0;
+  for (int level = 0; level < nlevel; level++)
+    nrequest += smap[level].size();
+
+  int *proclist;
+  memory->create(proclist,MAX(nrequest,1),"fmm:proclist");
+  SourceRvous *inbuf = (SourceRvous *)
+    memory->smalloc((bigint) MAX(nrequest,1)*sizeof(SourceRvous),
+                    "fmm:inbuf");
+
+  const bigint mask = (1 << KEYBITS) - 1;
+  GNode node;
+
+  int n = 0;
+  for (int level = 0; level < nlevel; level++)
+    for (std::map<bigint,int>::iterator it = smap[level].begin();
+         it != smap[level].end(); ++it) {
+      bigint key = it->first;
+      int ix = static_cast<int> ((key >> (2*KEYBITS)) & mask) - OFFSET;
+      int iy = static_cast<int> ((key >> KEYBITS) & mask) - OFFSET;
+      int iz = static_cast<int> (key & mask) - OFFSET;
+      gnode_setup(node,level,ix,iy,iz);
+      inbuf[n].key = key;
+      inbuf[n].level = level;
+      inbuf[n].proc = me;
+      proclist[n++] = gnode_home(node);
+    }
+
+  // datum returned = level, key, multipole
+
+  int nper = ncoef+2;
+  char *buf = NULL;
+  int nreturn = comm->rendezvous(RVOUS,nrequest,(char *) inbuf,
+                                 sizeof(SourceRvous),0,proclist,
+                                 rendezvous_sources,0,buf,
+                                 nper*sizeof(double),(void *) this);
+  double *outbuf = (double *) buf;
+
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
+
+  if (nreturn > maxsource) {
+    maxsource = static_cast<int> (1.2*nreturn) + 1;
+    memory->destroy(gpole);
+    memory->create(gpole,(bigint) maxsource*ncoef,"fmm:gpole");
+  }
+
+  for (i = 0; i < nreturn; i++) {
+    double *datum = &outbuf[(bigint) i*nper];
+    int level = (int) ubuf(datum[0]).i;
+    bigint key = (bigint) ubuf(datum[1]).i;
+    smap[level][key] = i;
+    memcpy(&gpole[i*ncoef],&datum[2],ncoef*sizeof(double));
+  }
+
+  memory->sfree(outbuf);
+
+  // summed multipoles in rendezvous decomposition are no longer needed
+
+  memory->sfree(rvous_pole);
+  rvous_pole = NULL;
+  rvous_map.clear();
+}
+
+/* ----------------------------------------------------------------------
+   dual tree traversal of target node A and image of source node B
+   B is shifted by ishift cells, shift distance
+   eval = 0 records the source of each M2L in smap, eval = 1 applies it
+   the source tree is implicit, nodes found empty are skipped
+------------------------------------------------------------------------- */
+
+void FMM::interact_global(int ia, const GNode &b, int *ishift, double *shift,
+                          int eval)
+{
+  GNode &a = gnodes[ia];
+
+  int near = 1;
+  for (int d = 0; d < 3; d++)
+    if (b.ihi[d]+ishift[d] < a.ilo[d]-nnear[d] ||
+        b.ilo[d]+ishift[d] > a.ihi[d]+nnear[d]) near = 0;
+
+  if (!near) {
+    double r[3];
+    r[0] = a.center[0] - b.center[0] - shift[0];
+    r[1] = a.center[1] - b.center[1] - shift[1];
+    r[2] = a.center[2] - b.center[2] - shift[2];
+    double dist = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+    if ((a.level == 0 && b.level == 0) || a.radius + b.radius < theta*dist) {
+      bigint key = cellkey(b.idx[0],b.idx[1],b.idx[2]);
+      if (!eval) smap[b.level].insert(std::make_pair(key,-1));
+      else {
+        int isource = smap[b.level][key];
+        if (isource >= 0)
+          m2l_virial(r,&gpole[isource*ncoef],&glpole[ia*ncoef],
+                     &gmine[ia*ncoef]);
+      }
+      return;
+    }
+  } else if (a.level == 0 && b.level == 0) return;
+
+  if (b.level == 0 || (a.level && a.radius >= b.radius)) {
+    int child = a.child;
+    int nchild = a.nchild;
+    for (int ic = child; ic < child+nchild; ic++)
+      interact_global(gchild[ic],b,ishift,shift,eval);
+  } else {
+    int lo[3],hi[3];
+    for (int d = 0; d < 3; d++) {
+      lo[d] = 2*b.idx[d];
+      hi[d] = MIN(lo[d]+1,(ncell[d]+1) >> (b.level-1));
+    }
+    GNode child;
+    for (int jx = lo[0]; jx <= hi[0]; jx++)
+      for (int jy = lo[1]; jy <= hi[1]; jy++)
+        for (int jz = lo[2]; jz <= hi[2]; jz++) {
+          if (gnode_setup(child,b.level-1,jx,jy,jz))
+            interact_global(ia,child,ishift,shift,eval);
+        }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pass local expansions down the target nodes to the local coarse cells
+   parents are stored after their children
+------------------------------------------------------------------------- */
+
+void FMM::downward_global()
+{
+  for (int inode = gnodes.size()-1; inode >= 0; inode--) {
+    GNode &node = gnodes[inode];
+    double *l = &glpole[inode*ncoef];
+
+    if (node.parent >= 0) {
+      GNode &parent = gnodes[node.parent];
+      double d[3];
+      d[0] = node.center[0] - parent.center[0];
+      d[1] = node.center[1] - parent.center[1];
+      d[2] = node.center[2] - parent.center[2];
+      l2l(d,&glpole[node.parent*ncoef],l);
+    }
+
+    if (node.level == 0) {
+      double *lout = &lpole[node.local*ncoef];
+      for (int c = 0; c < ncoef; c++) lout[c] += l[c];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sum partial multipoles of the cell tree nodes assigned to me
+   inbuf = list of N (level,key,multipole) datums
+   sums are kept in rvous_pole until fetch_sources() is done
+------------------------------------------------------------------------- */
+
+int FMM::rendezvous_reduce(int n, char *inbuf, int &flag,
+                           int *& /*proclist*/, char *& /*outbuf*/,
+                           void *ptr)
+{
+  FMM *fptr = (FMM *) ptr;
+  Memory *memory = fptr->memory;
+  int ncoef = fptr->ncoef;
+  int nper = ncoef+2;
+
+  std::vector<std::map<bigint,int> > &rmap = fptr->rvous_map;
+  rmap.assign(fptr->nlevel,std::map<bigint,int>());
+
+  memory->sfree(fptr->rvous_pole);
+  double *sum = (double *)
+    memory->smalloc((bigint) MAX(n,1)*ncoef*sizeof(double),"fmm:rvous_pole");
+  fptr->rvous_pole = sum;
+
+  double *in = (double *) inbuf;
+  int nsum = 0;
+
+  for (int i = 0; i < n; i++) {
+    double *datum = &in[(bigint) i*nper];
+    int level = (int) ubuf(datum[0]).i;
+    bigint key = (bigint) ubuf(datum[1]).i;
+    std::map<bigint,int>::iterator it = rmap[level].find(key);
+    if (it == rmap[level].end()) {
+      rmap[level][key] = nsum;
+      memcpy(&sum[(bigint) nsum*ncoef],&datum[2],ncoef*sizeof(double));
+      nsum++;
+    } else {
+      double *m = &sum[(bigint) it->second*ncoef];
+      for (int c = 0; c < ncoef; c++) m[c] += datum[2+c];
+    }
+  }
+
+  // flag = 0: no second comm needed in rendezvous
+
+  flag = 0;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   return summed multipoles of the requested nodes assigned to me
+   inbuf = list of N SourceRvous datums
+   outbuf = (level,key,multipole) datums of nodes with charges
+------------------------------------------------------------------------- */
+
+int FMM::rendezvous_sources(int n, char *inbuf, int &flag, int *&proclist,
+                            char *&outbuf, void *ptr)
+{
+  FMM *fptr = (FMM *) ptr;
+  Memory *memory = fptr->memory;
+  int ncoef = fptr->ncoef;
+  int nper = ncoef+2;
+  std::vector<std::map<bigint,int> > &rmap = fptr->rvous_map;
+  double *sum = fptr->rvous_pole;
+
+  SourceRvous *in = (SourceRvous *) inbuf;
+  memory->create(proclist,MAX(n,1),"fmm:proclist");
+  double *out = (double *)
+    memory->smalloc((bigint) MAX(n,1)*nper*sizeof(double),"fmm:outbuf");
+
+  int nout = 0;
+  for (int i = 0; i < n; i++) {
+    std::map<bigint,int> &levelmap = rmap[in[i].level];
+    std::map<bigint,int>::iterator it = levelmap.find(in[i].key);
+    if (it == levelmap.end()) continue;
+    double *datum = &out[(bigint) nout*nper];
+    datum[0] = ubuf(in[i].level).d;
+    datum[1] = ubuf(in[i].key).d;
+    memcpy(&datum[2],&sum[(bigint) it->second*ncoef],ncoef*sizeof(double));
+    proclist[nout++] = in[i].proc;
+  }
+
+  outbuf = (char *) out;
+
+  // flag = 2: new outbuf
+
+  flag = 2;
+  return nout;
+}
+
+/* ----------------------------------------------------------------------
+   pass local expansions down the local trees and evaluate at owned charges
+------------------------------------------------------------------------- */
+
+void FMM::downward_local()
+{
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+  int nnodes = nodes.size();
+
+  for (int inode = 0; inode < nnodes; inode++) {
+    Node &node = nodes[inode];
+    if (node.nown == 0) continue;
+    double *l = &lpole[inode*ncoef];
+
+    if (node.nchild) {
+      for (int ic = node.child; ic < node.child+node.nchild; ic++) {
+        Node &child = nodes[ic];
+        if (child.nown == 0) continue;
+        double d[3];
+        d[0] = child.center[0] - node.center[0];
+        d[1] = child.center[1] - node.center[1];
+        d[2] = child.center[2] - node.center[2];
+        l2l(d,l,&lpole[ic*ncoef]);
+      }
+      continue;
+    }
+
+    for (int k = node.first; k < node.first+node.count; k++) {
+      int i = perm[k];
+      if (i >= nlocal) continue;
+      double u[3];
+      u[0] = x[i][0] - node.center[0];
+      u[1] = x[i][1] - node.center[1];
+      u[2] = x[i][2] - node.center[2];
+      powers(u,dpow);
+      double pot = 0.0;
+      double g[3] = {0.0,0.0,0.0};
+      for (int c = 0; c < ncoef; c++) {
+        pot += l[c]*dpow[c];
+        if (cx[c]) g[0] += l[c]*cx[c]*dpow[cdown[c][0]];
+        if (cy[c]) g[1] += l[c]*cy[c]*dpow[cdown[c][1]];
+        if (cz[c]) g[2] += l[c]*cz[c]*dpow[cdown[c][2]];
+      }
+      phi[i] += pot;
+      grad[i][0] += g[0];
+      grad[i][1] += g[1];
+      grad[i][2] += g[2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   lattice sums for box edges strained by component (ih-1)%6
+   ih = 0 is the unstrained box, 1-6 positive, 7-12 negative strain
+   sring = sum over images t in [-RING,RING] outside [-NIMAGE,NIMAGE]
+   tfar = 3d dipole tensor of all images outside [-NIMAGE,NIMAGE]
+------------------------------------------------------------------------- */
+
+void FMM::lattice_setup(int ih)
+{
+  double h[3][3];
+  strained_box(ih,h);
+
+  double *s = sring[ih];
+  memset(s,0,ncoef*sizeof(double));
+
+  int nr[3];
+  for (int d = 0; d < 3; d++) nr[d] = periodic[d] ? RING : 0;
+
+  double r[3];
+  for (int tx = -nr[0]; tx <= nr[0]; tx++)
+    for (int ty = -nr[1]; ty <= nr[1]; ty++)
+      for (int tz = -nr[2]; tz <= nr[2]; tz++) {
+        if (abs(tx) <= NIMAGE && abs(ty) <= NIMAGE && abs(tz) <= NIMAGE)
+          continue;
+        for (int d = 0; d < 3; d++)
+          r[d] = -(h[d][0]*tx + h[d][1]*ty + h[d][2]*tz);
+        derivatives(r,work2);
+        for (int c = 0; c < ncoef; c++) s[c] += work2[c];
+      }
+
+  // charge and dipole terms vanish for neutral systems
+  // 3d dipole-dipole term is replaced by the tin-foil Ewald tensor
+
+  int maxdeg = (nperiodic == 3) ? 2 : 1;
+  for (int c = 0; c < ncoef; c++)
+    if (cdeg[c] <= maxdeg) s[c] = 0.0;
+
+  if (nperiodic == 3) {
+    double t[3][3];
+    ewald_dipole_tensor(h,tfar[ih]);
+    for (int nx = -NIMAGE; nx <= NIMAGE; nx++)
+      for (int ny = -NIMAGE; ny <= NIMAGE; ny++)
+        for (int nz = -NIMAGE; nz <= NIMAGE; nz++) {
+          if (nx == 0 && ny == 0 && nz == 0) continue;
+          for (int d = 0; d < 3; d++)
+            r[d] = h[d][0]*nx + h[d][1]*ny + h[d][2]*nz;
+          double rsq = r[0]*r[0] + r[1]*r[1] + r[2]*r[2];
+          double rinv = 1.0/sqrt(rsq);
+          double r5inv = rinv*rinv*rinv/rsq;
+          for (int a = 0; a < 3; a++)
+            for (int b = 0; b < 3; b++) {
+              t[a][b] = 3.0*r[a]*r[b]*r5inv;
+              if (a == b) t[a][b] -= rsq*r5inv;
+              tfar[ih][a][b] -= t[a][b];
+            }
+        }
+
+    // super cell multipoles carry part of the dipole field as Taylor
+    // corrections, which grow with the # of levels for non-cubic boxes,
+    // remove it so the total dipole field is the tin-foil result
+
+    for (int b = 0; b < 3; b++) {
+      memset(work1,0,ncoef*sizeof(double));
+      work1[1+b] = 1.0;
+      lattice_sum(ih,work1,work3);
+      for (int a = 0; a < 3; a++) tfar[ih][a][b] += work3[1+a];
+    }
+  }
+
+  if (ih == 0) lattice_valid = 1;
+}
+
+/* ----------------------------------------------------------------------
+   box edge vectors (as columns) for strain index ih
+------------------------------------------------------------------------- */
+
+void FMM::strained_box(int ih, double h[3][3])
+{
+  double eps[3][3];
+  for (int a = 0; a < 3; a++)
+    for (int b = 0; b < 3; b++) eps[a][b] = (a == b) ? 1.0 : 0.0;
+
+  if (ih > 0) {
+    int s = (ih-1) % 6;
+    double delta = (ih <= 6) ? DELTA_STRAIN : -DELTA_STRAIN;
+    if (s < 3) eps[s][s] += delta;
+    else {
+      int a = (s == 5) ? 1 : 0;
+      int b = (s == 3) ? 1 : 2;
+      eps[a][b] += 0.5*delta;
+      eps[b][a] += 0.5*delta;
+    }
+  }
+
+  for (int a = 0; a < 3; a++)
+    for (int b = 0; b < 3; b++) h[a][b] = eps[a][b]*domain->prd[b];
+}
+
+/* ----------------------------------------------------------------------
+   local expansion about the box center due to all periodic images
+   beyond NIMAGE, for box multipole m and strain index ih
+------------------------------------------------------------------------- */
+
+void FMM::lattice_local(int ih, double *m, double *l)
+{
+  lattice_sum(ih,m,l);
+
+  // uniform field of the far image dipoles, tin-foil boundary
+  // coefficients 1-3 are the x,y,z dipole components
+
+  if (nperiodic == 3)
+    for (int a = 0; a < 3; a++)
+      l[1+a] -= tfar[ih][a][0]*m[1] + tfar[ih][a][1]*m[2] +
+        tfar[ih][a][2]*m[3];
+}
+
+/* ----------------------------------------------------------------------
+   hierarchical image sum without the 3d dipole-dipole term
+   level k rings consist of 3^k x 3^k x 3^k super cells of the box
+------------------------------------------------------------------------- */
+
+void FMM::lattice_sum(int ih, double *m, double *l)
+{
+  double h[3][3];
+  strained_box(ih,h);
+
+  memset(l,0,ncoef*sizeof(double));
+  memcpy(mk1,m,ncoef*sizeof(double));
+
+  int ns[3];
+  for (int d = 0; d < 3; d++) ns[d] = periodic[d] ? 1 : 0;
+
+  double size = 1.0;
+  for (int k = 0; k < nlattice; k++) {
+    for (int c = 0; c < ncoef; c++)
+      sk[c] = sring[ih][c] * pow(size,-(cdeg[c]+1));
+    m2l_coeff(sk,mk1,l);
+
+    memset(mk2,0,ncoef*sizeof(double));
+    double d[3];
+    for (int sx = -ns[0]; sx <= ns[0]; sx++)
+      for (int sy = -ns[1]; sy <= ns[1]; sy++)
+        for (int sz = -ns[2]; sz <= ns[2]; sz++) {
+          for (int dim = 0; dim < 3; dim++)
+            d[dim] = size*(h[dim][0]*sx + h[dim][1]*sy + h[dim][2]*sz);
+          m2m(d,mk1,mk2);
+        }
+    memcpy(mk1,mk2,ncoef*sizeof(double));
+    size *= 3.0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   virial of the lattice part from the global box multipole
+   position part from the local expansion, box part by finite
+   differences of the lattice energy with respect to strain
+------------------------------------------------------------------------- */
+
+void FMM::virial_lattice()
+{
+  static const int va[6] = {0,1,2,0,0,1};
+  static const int vb[6] = {0,1,2,1,2,2};
+
+  // position part: -sum_i q_i u_a d_b phi
+
+  for (int n = 0; n < 6; n++) {
+    int a = va[n];
+    int b = vb[n];
+    double uab = 0.0, uba = 0.0;
+    for (int c = 0; c < ncoef; c++) {
+      if (cdown[c][b] >= 0)
+        uab += lbox[c]*(b == 0 ? cx[c] : (b == 1 ? cy[c] : cz[c])) *
+          mbox[cup[cdown[c][b]][a]];
+      if (cdown[c][a] >= 0)
+        uba += lbox[c]*(a == 0 ? cx[c] : (a == 1 ? cy[c] : cz[c])) *
+          mbox[cup[cdown[c][a]][b]];
+    }
+    virial[n] -= 0.5*(uab+uba);
+  }
+
+  // box part: W = -dE/d(strain) at fixed box multipole
+
+  for (int s = 0; s < 6; s++) {
+    double e[2];
+    for (int sign = 0; sign < 2; sign++) {
+      int ih = 1 + s + 6*sign;
+      if (!lattice_strain_valid) lattice_setup(ih);
+      lattice_local(ih,mbox,work2);
+      e[sign] = 0.0;
+      for (int c = 0; c < ncoef; c++) e[sign] += 0.5*work2[c]*mbox[c];
+    }
+    virial[s] -= (e[0]-e[1])/(2.0*DELTA_STRAIN);
+  }
+  lattice_strain_valid = 1;
+}
+
+/* ----------------------------------------------------------------------
+   tin-foil Ewald sum over all n != 0 of d_a d_b (1/r) at r = h n
+------------------------------------------------------------------------- */
+
+void FMM::ewald_dipole_tensor(double h[3][3], double t[3][3])
+{
+  int a,b;
+
+  double len[3],lmin;
+  for (b = 0; b < 3; b++)
+    len[b] = sqrt(h[0][b]*h[0][b] + h[1][b]*h[1][b] + h[2][b]*h[2][b]);
+  lmin = MIN(len[0],MIN(len[1],len[2]));
+
+  double vol = h[0][0]*(h[1][1]*h[2][2] - h[1][2]*h[2][1]) -
+    h[0][1]*(h[1][0]*h[2][2] - h[1][2]*h[2][0]) +
+    h[0][2]*(h[1][0]*h[2][1] - h[1][1]*h[2][0]);
+  vol = fabs(vol);
+
+  const double alpha = 3.5/lmin;
+  const double alpha2 = alpha*alpha;
+
+  for (a = 0; a < 3; a++)
+    for (b = 0; b < 3; b++) t[a][b] = 0.0;
+
+  // self term of the real space sum
+
+  for (a = 0; a < 3; a++) t[a][a] += 4.0*alpha2*alpha/(3.0*MY_PIS);
+
+  // real space sum
+
+  int nr = static_cast<int> (ceil(6.0/(alpha*lmin))) + 1;
+  double r[3];
+  for (int nx = -nr; nx <= nr; nx++)
+    for (int ny = -nr; ny <= nr; ny++)
+      for (int nz = -nr; nz <= nr; nz++) {
+        if (nx == 0 && ny == 0 && nz == 0) continue;
+        for (a = 0; a < 3; a++)
+          r[a] = h[a][0]*nx + h[a][1]*ny + h[a][2]*nz;
+        double rsq = r[0]*r[0] + r[1]*r[1] + r[2]*r[2];
+        double rr = sqrt(rsq);
+        double expo = exp(-alpha2*rsq);
+        double erfcr = erfc(alpha*rr);
+        double f1 = -erfcr/rsq - 2.0*alpha/MY_PIS*expo/rr;
+        double f2 = 2.0*erfcr/(rsq*rr) + 4.0*alpha/MY_PIS*expo/rsq +
+          4.0*alpha2*alpha/MY_PIS*expo;
+        for (a = 0; a < 3; a++)
+          for (b = 0; b < 3; b++) {
+            t[a][b] += (f2 - f1/rr)*r[a]*r[b]/rsq;
+            if (a == b) t[a][b] += f1/rr;
+          }
+      }
+
+  // reciprocal vectors as rows of 2 pi h^-1
+
+  double hinv[3][3];
+  hinv[0][0] = h[1][1]*h[2][2] - h[1][2]*h[2][1];
+  hinv[0][1] = h[0][2]*h[2][1] - h[0][1]*h[2][2];
+  hinv[0][2] = h[0][1]*h[1][2] - h[0][2]*h[1][1];
+  hinv[1][0] = h[1][2]*h[2][0] - h[1][0]*h[2][2];
+  hinv[1][1] = h[0][0]*h[2][2] - h[0][2]*h[2][0];
+  hinv[1][2] = h[0][2]*h[1][0] - h[0][0]*h[1][2];
+  hinv[2][0] = h[1][0]*h[2][1] - h[1][1]*h[2][0];
+  hinv[2][1] = h[0][1]*h[2][0] - h[0][0]*h[2][1];
+  hinv[2][2] = h[0][0]*h[1][1] - h[0][1]*h[1][0];
+  double det = h[0][0]*hinv[0][0] + h[0][1]*hinv[1][0] + h[0][2]*hinv[2][0];
+  for (a = 0; a < 3; a++)
+    for (b = 0; b < 3; b++) hinv[a][b] *= MY_2PI/det;
+
+  int mmax[3];
+  for (a = 0; a < 3; a++)
+    mmax[a] = static_cast<int> (ceil(12.0*alpha*len[a]/MY_2PI)) + 1;
+
+  double k[3];
+  for (int mx = -mmax[0]; mx <= mmax[0]; mx++)
+    for (int my = -mmax[1]; my <= mmax[1]; my++)
+      for (int mz = -mmax[2]; mz <= mmax[2]; mz++) {
+        if (mx == 0 && my == 0 && mz == 0) continue;
+        for (a = 0; a < 3; a++)
+          k[a] = hinv[0][a]*mx + hinv[1][a]*my + hinv[2][a]*mz;
+        double ksq = k[0]*k[0] + k[1]*k[1] + k[2]*k[2];
+        double pre = MY_4PI/vol * exp(-0.25*ksq/alpha2)/ksq;
+        for (a = 0; a < 3; a++)
+          for (b = 0; b < 3; b++) t[a][b] -= pre*k[a]*k[b];
+      }
+}
+
+/* ----------------------------------------------------------------------
+   Taylor coefficients D[n](r) = (-1)^|n| d^n (1/r) / n! up to porder
+------------------------------------------------------------------------- */
+
+void FMM::derivatives(const double *r, double *a)
+{
+  double rsq = r[0]*r[0] + r[1]*r[1] + r[2]*r[2];
+  double rsqinv = 1.0/rsq;
+  a[0] = sqrt(rsqinv);
+
+  for (int c = 1; c < ncoef; c++) {
+    int n = cdeg[c];
+    double sum1 = 0.0, sum2 = 0.0;
+    for (int d = 0; d < 3; d++) {
+      if (cdown[c][d] >= 0) sum1 += r[d]*a[cdown[c][d]];
+      if (cdown2[c][d] >= 0) sum2 += a[cdown2[c][d]];
+    }
+    a[c] = ((2*n-1)*sum1 - (n-1)*sum2) * rsqinv / n;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   all monomials v^c up to porder
+------------------------------------------------------------------------- */
+
+void FMM::powers(const double *v, double *p)
+{
+  p[0] = 1.0;
+  for (int c = 1; c < ncoef; c++) {
+    if (cx[c]) p[c] = p[cdown[c][0]]*v[0];
+    else if (cy[c]) p[c] = p[cdown[c][1]]*v[1];
+    else p[c] = p[cdown[c][2]]*v[2];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   shift multipole m by d = child center - parent center, add to mout
+------------------------------------------------------------------------- */
+
+void FMM::m2m(const double *d, const double *m, double *mout)
+{
+  powers(d,dpow);
+  for (int n = 0; n < nshift; n++)
+    mout[shift_hi[n]] += shift_c[n]*dpow[shift_d[n]]*m[shift_lo[n]];
+}
+
+/* ----------------------------------------------------------------------
+   shift local expansion l by d = child center - parent center
+------------------------------------------------------------------------- */
+
+void FMM::l2l(const double *d, const double *l, double *lout)
+{
+  powers(d,dpow);
+  for (int n = 0; n < nshift; n++)
+    lout[shift_lo[n]] += shift_c[n]*dpow[shift_d[n]]*l[shift_hi[n]];
+}
+
+/* ----------------------------------------------------------------------
+   local expansion from multipole m given Taylor coefficients a
+------------------------------------------------------------------------- */
+
+void FMM::m2l_coeff(const double *a, const double *m, double *l)
+{
+  for (int c = 0; c < ncoef; c++) {
+    mfac[c] = m[c]*facinv[c];
+    afac[c] = a[c]*fac[c];
+  }
+
+  for (int c = 0; c < ncoef; c++) {
+    const int *aidx = &m2l_a[m2l_first[c]];
+    const int nb = m2l_first[c+1] - m2l_first[c];
+    double sum = 0.0;
+    for (int b = 0; b < nb; b++) sum += mfac[b]*afac[aidx[b]];
+    l[c] += m2l_fac[c]*sum;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   virial of M2L between target charges with owned multipole t and
+   source multipole m, r = target - source center, a = Taylor coeffs
+   l = resulting local expansion
+   sum over ordered pairs of 1/2 (r + u_i - v_j) F_ij
+------------------------------------------------------------------------- */
+
+void FMM::virial_m2l(const double *r, const double *a, const double *m,
+                     const double *l, const double *t, double *v)
+{
+  static const int va[6] = {0,1,2,0,0,1};
+  static const int vb[6] = {0,1,2,1,2,2};
+
+  double s[3] = {0.0,0.0,0.0};
+  double u[3][3] = {{0.0,0.0,0.0},{0.0,0.0,0.0},{0.0,0.0,0.0}};
+  double w[3][3] = {{0.0,0.0,0.0},{0.0,0.0,0.0},{0.0,0.0,0.0}};
+
+  // s_b = sum_i q_i d_b phi, u_ab = sum_i q_i u_a d_b phi
+
+  for (int c = 0; c < ncoef; c++) {
+    if (l[c] == 0.0) continue;
+    int idx[3] = {cx[c],cy[c],cz[c]};
+    for (int b = 0; b < 3; b++) {
+      if (idx[b] == 0) continue;
+      int down = cdown[c][b];
+      double lb = l[c]*idx[b];
+      s[b] += lb*t[down];
+      for (int aa = 0; aa < 3; aa++) {
+        u[aa][b] += lb*t[cup[down][aa]];
+      }
+    }
+  }
+
+  // w_ab = sum_i sum_j q_i v_j,a d_b phi_j, from source moments m[. + e_a]
+
+  double *wl[3] = {work2,work2+ncoef,work2+2*ncoef};
+  double *mup[3] = {mshift,mshift+ncoef,mshift+2*ncoef};
+  for (int c = 0; c < ncoef; c++) {
+    afac[c] = a[c]*fac[c];
+    for (int aa = 0; aa < 3; aa++)
+      mup[aa][c] = (cup[c][aa] >= 0) ? m[cup[c][aa]]*facinv[c] : 0.0;
+  }
+
+  for (int c = 0; c < ncoef; c++) {
+    const int *aidx = &m2l_a[m2l_first[c]];
+    const int nb = m2l_first[c+1] - m2l_first[c];
+    double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0;
+    for (int b = 0; b < nb; b++) {
+      double ab = afac[aidx[b]];
+      sum0 += mup[0][b]*ab;
+      sum1 += mup[1][b]*ab;
+      sum2 += mup[2][b]*ab;
+    }
+    wl[0][c] = m2l_fac[c]*sum0;
+    wl[1][c] = m2l_fac[c]*sum1;
+    wl[2][c] = m2l_fac[c]*sum2;
+  }
+
+  for (int aa = 0; aa < 3; aa++)
+    for (int c = 1; c < ncoef; c++) {
+      if (cx[c]) w[aa][0] += wl[aa][c]*cx[c]*t[cdown[c][0]];
+      if (cy[c]) w[aa][1] += wl[aa][c]*cy[c]*t[cdown[c][1]];
+      if (cz[c]) w[aa][2] += wl[aa][c]*cz[c]*t[cdown[c][2]];
+    }
+
+  // F_i,b = -q_i d_b phi
+
+  for (int n = 0; n < 6; n++) {
+    int aa = va[n];
+    int b = vb[n];
+    double vab = r[aa]*s[b] + u[aa][b] - w[aa][b];
+    double vba = r[b]*s[aa] + u[b][aa] - w[b][aa];
+    v[n] -= 0.25*(vab+vba);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local data
+------------------------------------------------------------------------- */
+
+double FMM::memory_usage()
+{
+  double bytes = 0.0;
+  bytes += 3*nmax * sizeof(int);
+  bytes += nmax * sizeof(bigint);
+  bytes += 4*nmax * sizeof(double);
+  bytes += 3.0*maxnode*ncoef * sizeof(double);
+  bytes += (double) maxnode * sizeof(Node);
+  bytes += 2.0*maxgnode*ncoef * sizeof(double);
+  bytes += (double) maxgnode * sizeof(GNode);
+  bytes += (double) maxsource*ncoef * sizeof(double);
+  bytes += (double) nm2l * sizeof(int);
+  bytes += (double) nshift * (3*sizeof(int) + sizeof(double));
+  return bytes;
+}
@@ -0,0 +1,284 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef KSPACE_CLASS
+
+KSpaceStyle(fmm,FMM)
+
+#else
+
+#ifndef LMP_FMM_H
+#define LMP_FMM_H
+
+#include "kspace.h"
+#include <map>
+#include <vector>
+
+namespace LAMMPS_NS {
+
+class FMM : public KSpace {
+ public:
+  FMM(class LAMMPS *);
+  virtual ~FMM();
+  void init();
+  void setup();
+  virtual void settings(int, char **);
+  virtual void compute(int, int);
+  virtual int modify_param(int, char **);
+  double memory_usage();
+
+ protected:
+  int me,nprocs;
+  double cutoff;                  // Coulomb cutoff = splitting distance
+  double volume;
+
+  int porder;                     // order of Cartesian multipole expansions
+  int porder_user;                // user-requested order, 0 = from accuracy
+  double theta;                   // opening angle of the acceptance criterion
+  int nleaf;                      // max # of charges in a local tree leaf
+  int nlattice;                   // # of hierarchical periodic image levels
+
+  // coarse cells, uniform over the box, size >= cutoff/2
+
+  int ncell[3];                   // # of coarse cells in each dim
+  double hcell[3],hcellinv[3];    // coarse cell size and its inverse
+  int nnear[3];                   // extent of near block in cells per dim
+  int periodic[3];                // 1 if dim is periodic
+  double cutghost_need;           // ghost cutoff needed by near field
+  double cutghostuser_save;       // comm cutoff set by the user
+  double cutghostuser_set;        // comm cutoff set by init()
+
+  // multi-index bookkeeping for Cartesian Taylor expansions
+
+  int ncoef;                      // # of coefficients up to order porder
+  int *cx,*cy,*cz,*cdeg;          // multi-index of each coefficient
+  int *cindex;                    // multi-index -> coefficient
+  int **cdown;                    // coeff of index - e_d, -1 if none
+  int **cdown2;                   // coeff of index - 2 e_d, -1 if none
+  int **cup;                      // coeff of index + e_d, -1 if none
+
+  double *fac,*facinv;            // multi-index factorials and inverses
+  int nm2l;                       // # of terms of M2L operator
+  int *m2l_first;                 // first term of each local coefficient
+  int *m2l_a;                     // derivative coefficient of each term
+  double *m2l_fac;                // (-1)^|a| / a! of each local coefficient
+  double *mfac,*afac;             // scaled multipole and derivatives
+  double *mshift;                 // multipole moments shifted by e_x,e_y,e_z
+  int nshift;                     // M2M and L2L operator as sparse triples
+  int *shift_hi,*shift_lo,*shift_d;
+  double *shift_c;
+
+  // tree node of local (owned + ghost) charges inside one coarse cell
+
+  struct Node {
+    double center[3];             // expansion center = geometric center
+    double lo[3],hi[3];           // tight bounding box of charges
+    double radius;                // max distance of a charge from center
+    int first,count;              // range in perm list
+    int nown;                     // # of owned charges
+    int child,nchild;             // children are contiguous
+  };
+
+  // node of the tree over coarse cells, cell indices are shifted by 1
+  // so they are >= 0, node (level,idx) holds the cells with shifted
+  // indices >> level = idx, the top level has a single node
+
+  struct GNode {
+    int level;
+    int idx[3];                   // node index within its level
+    double center[3];             // center of geometric bounding box
+    double radius;
+    int ilo[3],ihi[3];            // range of coarse cell indices
+    int child,nchild;             // children in gchild list
+    int parent;                   // parent node, -1 for the top node
+    int local;                    // local root node of a cell, -1 if none
+  };
+
+  std::vector<Node> nodes;
+  std::map<bigint,int> cellmap;   // local coarse cell key -> root node
+
+  // locally essential tree: each proc stores only the cell tree nodes
+  // that hold its owned charges (targets) and the source nodes its
+  // far-field interactions need, multipoles are summed and handed out
+  // by rendezvous comm
+
+  int nlevel;                     // # of levels of the cell tree
+  std::vector<GNode> gnodes;      // target nodes, children before parents
+  std::vector<int> gchild;
+  int groot;                      // top target node, -1 if none
+  std::vector<std::map<bigint,int> > gmap;  // key -> target node per level
+  std::vector<std::map<bigint,int> > smap;  // key -> source node per level
+  std::vector<int> cfirst[3];     // first cell index >= i with charges
+  std::vector<int> clast[3];      // last cell index <= i with charges
+
+  int nmax;                       // size of per-atom arrays
+  int *perm;                      // charges sorted by cell and octant
+  int *permtmp,*octant;
+  bigint *atomkey;                // coarse cell key of each charge
+  double *phi;                    // potential at owned charges
+  double **grad;                  // potential gradient at owned charges
+
+  int maxnode;
+  double *mpole;                  // multipoles of local nodes
+  double *tpole;                  // multipoles of owned charges per node
+  double *lpole;                  // local expansions of local nodes
+
+  int maxgnode;
+  double *gmine;                  // multipoles of owned charges of targets
+  double *glpole;                 // local expansions of target nodes
+  int maxsource;
+  double *gpole;                  // multipoles of source nodes
+
+  // data used by rendezvous callback methods
+
+  double *rvous_pole;             // summed multipoles in rvous decomp
+  std::vector<std::map<bigint,int> > rvous_map;
+
+  struct SourceRvous {
+    bigint key;
+    int level,proc;
+  };
+
+  // periodic lattice sums
+
+  int nperiodic;
+  double boxcenter[3];
+  double *sring[13];              // ring sums for base and strained boxes
+  double tfar[13][3][3];          // 3d dipole-dipole far-image tensor
+  int lattice_valid;              // 1 if ring sums of base box are current
+  int lattice_strain_valid;       // 1 if ring sums of strained boxes are
+  double *mbox,*lbox;             // global box multipole, lattice local exp
+  double *mk1,*mk2,*sk;           // super cell multipoles and ring sums
+  double *work1,*work2,*work3;
+  double *dpow;
+
+  void set_order();
+  void set_cells(double);
+  double estimate_error(int);
+  void allocate_tables();
+  void deallocate_tables();
+  double binomial(int, int);
+  double factorial(int);
+  void grow_atoms();
+  void grow_nodes(int);
+
+  inline bigint cellkey(int, int, int) const;
+  void build_local();
+  void build_node(int, int, int, double *, double *, int);
+  void upward_local();
+  void build_global();
+  void near_field();
+  void interact(int, int);
+  void p2p(int, int);
+  int gnode_setup(GNode &, int, int, int, int);
+  int gnode_home(const GNode &);
+  void far_field();
+  void fetch_sources();
+  void interact_global(int, const GNode &, int *, double *, int);
+  void downward_global();
+  void downward_local();
+
+  void lattice_setup(int);
+  void strained_box(int, double h[3][3]);
+  void lattice_local(int, double *, double *);
+  void lattice_sum(int, double *, double *);
+  void virial_lattice();
+  void ewald_dipole_tensor(double h[3][3], double t[3][3]);
+
+  void derivatives(const double *, double *);
+  void powers(const double *, double *);
+  void m2m(const double *, const double *, double *);
+  void m2l_coeff(const double *, const double *, double *);
+  void m2l_virial(const double *, const double *, double *, const double *);
+  void l2l(const double *, const double *, double *);
+  void virial_m2l(const double *, const double *, const double *,
+                  const double *, const double *, double *);
+
+  // callback functions for rendezvous communication
+
+  static int rendezvous_reduce(int, char *, int &, int *&, char *&, void *);
+  static int rendezvous_sources(int, char *, int &, int *&, char *&, void *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Cannot (yet) use kspace_style fmm with 2d simulation
+
+Self-explanatory.
+
+E: Kspace style requires atom attribute q
+
+The atom style defined does not have these attributes.
+
+E: FMM order must be 4, 6, 8, or 10
+
+The kspace_modify order keyword selects the order of the splitting
+function shared with the pair coul/msm styles.
+
+E: FMM expansion order must be between 2 and 12
+
+Self-explanatory.
+
+E: KSpace style is incompatible with Pair style
+
+Setting a kspace style requires that a pair style with matching
+long-range Coulombic components be used.  Kspace style fmm uses
+the pair coul/msm styles.
+
+E: Periodic box is too small for kspace_style fmm
+
+Each periodic box length must be at least twice the Coulomb cutoff.
+
+E: Cannot (yet) compute per-atom virial with kspace_style fmm
+
+Self-explanatory.
+
+E: Too many coarse cells for kspace_style fmm
+
+The box is too large compared to the Coulomb cutoff.
+
+W: FMM accuracy not reached with max expansion order
+
+The requested accuracy is tighter than the expansions can deliver
+with the current cutoff.  Use a larger Coulomb cutoff or a smaller
+fmm/theta value.
+
+W: Slab correction not needed for kspace_style fmm
+
+Slab correction is not needed for FMM since non-periodic dimensions
+are treated as free boundaries.
+
+E: Ghost cutoff is too short for kspace_style fmm
+
+The near-field of the FMM solver needs ghost atoms further out than
+the communication cutoff that was set.  This can happen when the box
+grows during a run.  Use the comm_modify cutoff command to set a
+larger value.
+
+E: Out of range atoms - cannot compute FMM
+
+One or more atoms are more than one coarse cell outside of the
+simulation box.  This indicates bad dynamics.
+
+*/
@@ -123,6 +123,12 @@ GridComm::~GridComm()
   for (int i = 0; i < nswap; i++) {
     memory->destroy(swap[i].packlist);
     memory->destroy(swap[i].unpacklist);
+    if (swap[i].sendproc != me) {
+      MPI_Request_free(&swap[i].forward_request[0]);
+      MPI_Request_free(&swap[i].forward_request[1]);
+      MPI_Request_free(&swap[i].reverse_request[0]);
+      MPI_Request_free(&swap[i].reverse_request[1]);
+    }
   }
   memory->sfree(swap);
 
@@ -199,12 +205,32 @@ int GridComm::ghost_overlap()
   return nearest_all;
 }
 
+/* ----------------------------------------------------------------------
+   check if any proc sends or receives grid values in its swaps
+   must be called after setup()
+   if no, forward/reverse comm would only copy empty planes, return 0
+------------------------------------------------------------------------- */
+
+int GridComm::ghost_exchange()
+{
+  int exchange = 0;
+  for (int m = 0; m < nswap; m++)
+    if (swap[m].npack || swap[m].nunpack) exchange = 1;
+
+  int exchange_all;
+  MPI_Allreduce(&exchange,&exchange_all,1,MPI_INT,MPI_MAX,gridcomm);
+
+  return exchange_all;
+}
+
 /* ----------------------------------------------------------------------
    create swap stencil for grid own/ghost communication
    swaps covers all 3 dimensions and both directions
    swaps cover multiple iterations in a direction if need grid pts
      from further away than nearest-neighbor proc
    same swap list used by forward and reverse communication
+   persistent requests for each swap are created once here,
+     so each forward/reverse comm only starts and completes them
 ------------------------------------------------------------------------- */
 
 void GridComm::setup()
@@ -479,6 +505,22 @@ void GridComm::setup()
   nbuf *= MAX(nforward,nreverse);
   memory->create(buf1,nbuf,"Commgrid:buf1");
   memory->create(buf2,nbuf,"Commgrid:buf2");
+
+  // persistent requests for swaps with another proc
+  // message sizes are fixed by nforward,nreverse and the swap stencil
+  // recv is listed first so it is posted before the matching send
+
+  for (int m = 0; m < nswap; m++) {
+    if (swap[m].sendproc == me) continue;
+    MPI_Recv_init(buf2,nforward*swap[m].nunpack,MPI_FFT_SCALAR,
+                  swap[m].recvproc,0,gridcomm,&swap[m].forward_request[0]);
+    MPI_Send_init(buf1,nforward*swap[m].npack,MPI_FFT_SCALAR,
+                  swap[m].sendproc,0,gridcomm,&swap[m].forward_request[1]);
+    MPI_Recv_init(buf2,nreverse*swap[m].npack,MPI_FFT_SCALAR,
+                  swap[m].sendproc,0,gridcomm,&swap[m].reverse_request[0]);
+    MPI_Send_init(buf1,nreverse*swap[m].nunpack,MPI_FFT_SCALAR,
+                  swap[m].recvproc,0,gridcomm,&swap[m].reverse_request[1]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -494,11 +536,8 @@ void GridComm::forward_comm(KSpace *kspace, int which)
       kspace->pack_forward(which,buf1,swap[m].npack,swap[m].packlist);
 
     if (swap[m].sendproc != me) {
-      MPI_Irecv(buf2,nforward*swap[m].nunpack,MPI_FFT_SCALAR,
-                swap[m].recvproc,0,gridcomm,&request);
-      MPI_Send(buf1,nforward*swap[m].npack,MPI_FFT_SCALAR,
-               swap[m].sendproc,0,gridcomm);
-      MPI_Wait(&request,MPI_STATUS_IGNORE);
+      MPI_Startall(2,swap[m].forward_request);
+      MPI_Waitall(2,swap[m].forward_request,MPI_STATUS_IGNORE);
     }
 
     kspace->unpack_forward(which,buf2,swap[m].nunpack,swap[m].unpacklist);
@@ -519,11 +558,8 @@ void GridComm::reverse_comm(KSpace *kspace, int which)
       kspace->pack_reverse(which,buf1,swap[m].nunpack,swap[m].unpacklist);
 
     if (swap[m].recvproc != me) {
-      MPI_Irecv(buf2,nreverse*swap[m].npack,MPI_FFT_SCALAR,
-                swap[m].sendproc,0,gridcomm,&request);
-      MPI_Send(buf1,nreverse*swap[m].nunpack,MPI_FFT_SCALAR,
-               swap[m].recvproc,0,gridcomm);
-      MPI_Wait(&request,MPI_STATUS_IGNORE);
+      MPI_Startall(2,swap[m].reverse_request);
+      MPI_Waitall(2,swap[m].reverse_request,MPI_STATUS_IGNORE);
     }
 
     kspace->unpack_reverse(which,buf2,swap[m].npack,swap[m].packlist);
@@ -40,6 +40,7 @@ class GridComm : protected Pointers {
   ~GridComm();
   void ghost_notify();
   int ghost_overlap();
+  int ghost_exchange();
   void setup();
   void forward_comm(class KSpace *, int);
   void reverse_comm(class KSpace *, int);
@@ -49,7 +50,6 @@ class GridComm : protected Pointers {
   int me;
   int nforward,nreverse;
   MPI_Comm gridcomm;
-  MPI_Request request;
 
   // in = inclusive indices of 3d grid chunk that I own
   // out = inclusive indices of 3d grid chunk I own plus ghosts I use
@@ -73,6 +73,8 @@ class GridComm : protected Pointers {
     int nunpack;        // # of datums to unpack
     int *packlist;      // 3d array offsets to pack
     int *unpacklist;    // 3d array offsets to unpack
+    MPI_Request forward_request[2];   // persistent recv/send for forward comm
+    MPI_Request reverse_request[2];   // persistent recv/send for reverse comm
   };
 
   int nswap;
@@ -47,7 +47,7 @@ MSM::MSM(LAMMPS *lmp) : KSpace(lmp),
   ny_msm(NULL), nz_msm(NULL), nxlo_in(NULL), nylo_in(NULL), nzlo_in(NULL),
   nxhi_in(NULL), nyhi_in(NULL), nzhi_in(NULL), nxlo_out(NULL), nylo_out(NULL),
   nzlo_out(NULL), nxhi_out(NULL), nyhi_out(NULL), nzhi_out(NULL), ngrid(NULL),
-  active_flag(NULL), alpha(NULL), betax(NULL), betay(NULL), betaz(NULL), peratom_allocate_flag(0),
+  active_flag(NULL), ghost_flag(NULL), alpha(NULL), betax(NULL), betay(NULL), betaz(NULL), peratom_allocate_flag(0),
   levels(0), world_levels(NULL), qgrid(NULL), egrid(NULL), v0grid(NULL), v1grid(NULL),
   v2grid(NULL), v3grid(NULL), v4grid(NULL), v5grid(NULL), g_direct(NULL),
   v0_direct(NULL), v1_direct(NULL), v2_direct(NULL), v3_direct(NULL), v4_direct(NULL),
@@ -66,6 +66,7 @@ MSM::MSM(LAMMPS *lmp) : KSpace(lmp),
   procneigh_levels = NULL;
   world_levels = NULL;
   active_flag = NULL;
+  ghost_flag = NULL;
 
   phi1d = dphi1d = NULL;
 
@@ -90,6 +91,7 @@ MSM::MSM(LAMMPS *lmp) : KSpace(lmp),
   procneigh_levels = NULL;
   world_levels = NULL;
   active_flag = NULL;
+  ghost_flag = NULL;
 
   alpha = betax = betay = betaz = NULL;
   nx_msm = ny_msm = nz_msm = NULL;
@@ -214,6 +216,7 @@ void MSM::init()
   setup();
 
   double estimated_error = estimate_total_error();
+  accuracy_estimate = estimated_error;
 
   // output grid stats
 
@@ -435,6 +438,8 @@ void MSM::setup()
   allocate();
 
   // setup commgrid
+  // ghost_flag = 0 for levels where no proc exchanges ghost grid values,
+  //   e.g. a single proc on a non-periodic level, so comm can be skipped
 
   cg_all->ghost_notify();
   cg_all->setup();
@@ -442,6 +447,7 @@ void MSM::setup()
     if (!active_flag[n]) continue;
     cg[n]->ghost_notify();
     cg[n]->setup();
+    ghost_flag[n] = cg[n]->ghost_exchange();
   }
 
 }
@@ -523,11 +529,12 @@ void MSM::compute(int eflag, int vflag)
 
   // forward communicate charge density values to fill ghost grid points
   // compute direct sum interaction and then restrict to coarser grid
+  // ghost comm is skipped on levels without ghost grid values
 
   for (int n=0; n<=levels-2; n++) {
     if (!active_flag[n]) continue;
     current_level = n;
-    cg[n]->forward_comm(this,FORWARD_RHO);
+    if (ghost_flag[n]) cg[n]->forward_comm(this,FORWARD_RHO);
 
     direct(n);
     restriction(n);
@@ -539,10 +546,10 @@ void MSM::compute(int eflag, int vflag)
   if (active_flag[levels-1]) {
     if (domain->nonperiodic) {
       current_level = levels-1;
-      cg[levels-1]->forward_comm(this,FORWARD_RHO);
+      if (ghost_flag[levels-1]) cg[levels-1]->forward_comm(this,FORWARD_RHO);
       direct_top(levels-1);
-      cg[levels-1]->reverse_comm(this,REVERSE_AD);
-      if (vflag_atom)
+      if (ghost_flag[levels-1]) cg[levels-1]->reverse_comm(this,REVERSE_AD);
+      if (vflag_atom && ghost_flag[levels-1])
         cg_peratom[levels-1]->reverse_comm(this,REVERSE_AD_PERATOM);
     } else {
       // Here using MPI_Allreduce is cheaper than using commgrid
@@ -550,7 +557,7 @@ void MSM::compute(int eflag, int vflag)
       direct(levels-1);
       grid_swap_reverse(levels-1,egrid[levels-1]);
       current_level = levels-1;
-      if (vflag_atom)
+      if (vflag_atom && ghost_flag[levels-1])
         cg_peratom[levels-1]->reverse_comm(this,REVERSE_AD_PERATOM);
     }
   }
@@ -563,11 +570,11 @@ void MSM::compute(int eflag, int vflag)
     prolongation(n);
 
     current_level = n;
-    cg[n]->reverse_comm(this,REVERSE_AD);
+    if (ghost_flag[n]) cg[n]->reverse_comm(this,REVERSE_AD);
 
     // extra per-atom virial communication
 
-    if (vflag_atom)
+    if (vflag_atom && ghost_flag[n])
       cg_peratom[n]->reverse_comm(this,REVERSE_AD_PERATOM);
   }
 
@@ -809,6 +816,7 @@ void MSM::allocate_levels()
   memory->create(procneigh_levels,levels,3,2,"msm:procneigh_levels");
   world_levels = new MPI_Comm[levels];
   active_flag = new int[levels];
+  ghost_flag = new int[levels];
 
   alpha = new int[levels];
   betax = new int[levels];
@@ -852,6 +860,7 @@ void MSM::allocate_levels()
   for (int n=0; n<levels; n++) {
     cg[n] = NULL;
     world_levels[n] = MPI_COMM_NULL;
+    ghost_flag[n] = 0;
     cg_peratom[n] = NULL;
 
     qgrid[n] = NULL;
@@ -878,6 +887,7 @@ void MSM::deallocate_levels()
   memory->destroy(procneigh_levels);
   delete [] world_levels;
   delete [] active_flag;
+  delete [] ghost_flag;
   delete [] cg;
   delete [] cg_peratom;
 
@@ -2251,21 +2261,15 @@ void MSM::direct_peratom_top(int n)
 }
 
 /* ----------------------------------------------------------------------
-   MSM restriction procedure for intermediate grid levels, interpolate
-   charges from finer grid to coarser grid
+   1d interpolation weights phi1d between grid level n and n+1, used
+   by restriction and prolongation, index = offsets on the finer grid
 ------------------------------------------------------------------------- */
 
-void MSM::restriction(int n)
+void MSM::transfer_weights(int n, int *index)
 {
-  //fprintf(screen,"Restricting from level %i to %i\n\n",n,n+1);
-
   const int p = order-1;
 
-  double ***qgrid1 = qgrid[n];
-  double ***qgrid2 = qgrid[n+1];
-
   int k = 0;
-  int *index = new int[p+2];
   for (int nu=-p; nu<=p; nu++) {
     if (nu%2 == 0 && nu != 0) continue;
     phi1d[0][k] = compute_phi(nu*delxinv[n+1]/delxinv[n]);
@@ -2274,8 +2278,26 @@ void MSM::restriction(int n)
     index[k] = nu;
     k++;
   }
+}
+
+/* ----------------------------------------------------------------------
+   MSM restriction procedure for intermediate grid levels, interpolate
+   charges from finer grid to coarser grid
+------------------------------------------------------------------------- */
+
+void MSM::restriction(int n)
+{
+  //fprintf(screen,"Restricting from level %i to %i\n\n",n,n+1);
+
+  const int p = order-1;
+
+  double ***qgrid1 = qgrid[n];
+  double ***qgrid2 = qgrid[n+1];
+
+  int *index = new int[p+2];
+  transfer_weights(n,index);
 
-  int ip,jp,kp,ic,jc,kc,i,j;
+  int ip,jp,kp,ic,jc,kc,i,j,k;
   int ii,jj,kk;
   double phiz,phizy,q2sum;
 
@@ -2351,18 +2373,10 @@ void MSM::prolongation(int n)
   double ***v5grid1 = v5grid[n];
   double ***v5grid2 = v5grid[n+1];
 
-  int k = 0;
   int *index = new int[p+2];
-  for (int nu=-p; nu<=p; nu++) {
-    if (nu%2 == 0 && nu != 0) continue;
-    phi1d[0][k] = compute_phi(nu*delxinv[n+1]/delxinv[n]);
-    phi1d[1][k] = compute_phi(nu*delyinv[n+1]/delyinv[n]);
-    phi1d[2][k] = compute_phi(nu*delzinv[n+1]/delzinv[n]);
-    index[k] = nu;
-    k++;
-  }
+  transfer_weights(n,index);
 
-  int ip,jp,kp,ic,jc,kc,i,j;
+  int ip,jp,kp,ic,jc,kc,i,j,k;
   int ii,jj,kk;
   double phiz,phizy,phi3d;
   double etmp2,v0tmp2,v1tmp2,v2tmp2,v3tmp2,v4tmp2,v5tmp2;
@@ -51,6 +51,7 @@ class MSM : public KSpace {
   int *nxlo_out,*nylo_out,*nzlo_out;
   int *nxhi_out,*nyhi_out,*nzhi_out;
   int *ngrid,*active_flag;
+  int *ghost_flag;                  // 1 if level exchanges ghost grid values
   int *alpha,*betax,*betay,*betaz;
   int nxlo_out_all,nylo_out_all,nzlo_out_all;
   int nxhi_out_all,nyhi_out_all,nzhi_out_all;
@@ -109,10 +110,11 @@ class MSM : public KSpace {
   void make_rho();
   virtual void direct(int);
   void direct_peratom(int);
-  void direct_top(int);
+  virtual void direct_top(int);
   void direct_peratom_top(int);
-  void restriction(int);
-  void prolongation(int);
+  void transfer_weights(int, int *);
+  virtual void restriction(int);
+  virtual void prolongation(int);
   void grid_swap_forward(int,double*** &);
   void grid_swap_reverse(int,double*** &);
   void fieldforce();
@@ -50,7 +50,8 @@ using namespace MathSpecial;
 #define EPS_HOC 1.0e-7
 
 enum{REVERSE_RHO};
-enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM};
+enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM,
+     FORWARD_IK_ALL,FORWARD_AD_ALL};
 
 #ifdef FFT_SINGLE
 #define ZEROF 0.0f
@@ -343,6 +344,7 @@ void PPPM::init()
   // calculate the final accuracy
 
   double estimated_accuracy = final_accuracy();
+  accuracy_estimate = estimated_accuracy;
 
   // print stats
 
@@ -683,17 +685,14 @@ void PPPM::compute(int eflag, int vflag)
 
   // all procs communicate E-field values
   // to fill ghost cells surrounding their 3d bricks
+  // per-atom energy/virial values are sent in the same messages
 
-  if (differentiation_flag == 1) cg->forward_comm(this,FORWARD_AD);
-  else cg->forward_comm(this,FORWARD_IK);
-
-  // extra per-atom energy/virial communication
-
-  if (evflag_atom) {
-    if (differentiation_flag == 1 && vflag_atom)
-      cg_peratom->forward_comm(this,FORWARD_AD_PERATOM);
-    else if (differentiation_flag == 0)
-      cg_peratom->forward_comm(this,FORWARD_IK_PERATOM);
+  if (differentiation_flag == 1) {
+    if (vflag_atom) cg_peratom->forward_comm(this,FORWARD_AD_ALL);
+    else cg->forward_comm(this,FORWARD_AD);
+  } else {
+    if (evflag_atom) cg_peratom->forward_comm(this,FORWARD_IK_ALL);
+    else cg->forward_comm(this,FORWARD_IK);
   }
 
   // calculate the force on my particles
@@ -934,20 +933,21 @@ void PPPM::allocate_peratom()
   memory->create3d_offset(v5_brick,nzlo_out,nzhi_out,nylo_out,nyhi_out,
                           nxlo_out,nxhi_out,"pppm:v5_brick");
 
-  // create ghost grid object for rho and electric field communication
+  // create ghost grid object for combined electric field
+  //   and per-atom energy/virial communication
 
   int (*procneigh)[2] = comm->procneigh;
 
   if (differentiation_flag == 1)
     cg_peratom =
-      new GridComm(lmp,world,6,1,
+      new GridComm(lmp,world,7,1,
                    nxlo_in,nxhi_in,nylo_in,nyhi_in,nzlo_in,nzhi_in,
                    nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                    procneigh[0][0],procneigh[0][1],procneigh[1][0],
                    procneigh[1][1],procneigh[2][0],procneigh[2][1]);
   else
     cg_peratom =
-      new GridComm(lmp,world,7,1,
+      new GridComm(lmp,world,10,1,
                    nxlo_in,nxhi_in,nylo_in,nyhi_in,nzlo_in,nzhi_in,
                    nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                    procneigh[0][0],procneigh[0][1],procneigh[1][0],
@@ -2657,6 +2657,7 @@ void PPPM::fieldforce_peratom()
 
 /* ----------------------------------------------------------------------
    pack own values to buf to send to another proc
+   *_ALL flags pack E-field and per-atom values as two consecutive blocks
 ------------------------------------------------------------------------- */
 
 void PPPM::pack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
@@ -2710,6 +2711,12 @@ void PPPM::pack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
       buf[n++] = v4src[list[i]];
       buf[n++] = v5src[list[i]];
     }
+  } else if (flag == FORWARD_IK_ALL) {
+    pack_forward(FORWARD_IK,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+  } else if (flag == FORWARD_AD_ALL) {
+    pack_forward(FORWARD_AD,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
   }
 }
 
@@ -2768,6 +2775,12 @@ void PPPM::unpack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
       v4src[list[i]] = buf[n++];
       v5src[list[i]] = buf[n++];
     }
+  } else if (flag == FORWARD_IK_ALL) {
+    unpack_forward(FORWARD_IK,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+  } else if (flag == FORWARD_AD_ALL) {
+    unpack_forward(FORWARD_AD,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
   }
 }
 
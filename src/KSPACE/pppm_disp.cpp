@@ -48,7 +48,9 @@ enum{REVERSE_RHO, REVERSE_RHO_G, REVERSE_RHO_A, REVERSE_RHO_NONE};
 enum{FORWARD_IK, FORWARD_AD, FORWARD_IK_PERATOM, FORWARD_AD_PERATOM,
      FORWARD_IK_G, FORWARD_AD_G, FORWARD_IK_PERATOM_G, FORWARD_AD_PERATOM_G,
      FORWARD_IK_A, FORWARD_AD_A, FORWARD_IK_PERATOM_A, FORWARD_AD_PERATOM_A,
-     FORWARD_IK_NONE, FORWARD_AD_NONE, FORWARD_IK_PERATOM_NONE, FORWARD_AD_PERATOM_NONE};
+     FORWARD_IK_NONE, FORWARD_AD_NONE, FORWARD_IK_PERATOM_NONE, FORWARD_AD_PERATOM_NONE,
+     FORWARD_IK_ALL, FORWARD_AD_ALL, FORWARD_IK_ALL_G, FORWARD_AD_ALL_G,
+     FORWARD_IK_ALL_A, FORWARD_AD_ALL_A, FORWARD_IK_ALL_NONE, FORWARD_AD_ALL_NONE};
 
 
 #ifdef FFT_SINGLE
@@ -998,12 +1000,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                  virial_1, vg,vg2,
                  u_brick, v0_brick, v1_brick, v2_brick, v3_brick, v4_brick, v5_brick);
 
-      cg->forward_comm(this,FORWARD_AD);
+      if (vflag_atom) cg_peratom->forward_comm(this,FORWARD_AD_ALL);
+      else cg->forward_comm(this,FORWARD_AD);
 
       fieldforce_c_ad();
-
-      if (vflag_atom) cg_peratom->forward_comm(this, FORWARD_AD_PERATOM);
-
     } else {
       poisson_ik(work1, work2, density_fft, fft1, fft2,
                  nx_pppm, ny_pppm, nz_pppm, nfft,
@@ -1014,11 +1014,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                  vdx_brick, vdy_brick, vdz_brick, virial_1, vg,vg2,
                  u_brick, v0_brick, v1_brick, v2_brick, v3_brick, v4_brick, v5_brick);
 
-      cg->forward_comm(this, FORWARD_IK);
+      if (evflag_atom) cg_peratom->forward_comm(this,FORWARD_IK_ALL);
+      else cg->forward_comm(this,FORWARD_IK);
 
       fieldforce_c_ik();
-
-      if (evflag_atom) cg_peratom->forward_comm(this, FORWARD_IK_PERATOM);
     }
     if (evflag_atom) fieldforce_c_peratom();
   }
@@ -1045,12 +1044,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                  virial_6, vg_6, vg2_6,
                  u_brick_g, v0_brick_g, v1_brick_g, v2_brick_g, v3_brick_g, v4_brick_g, v5_brick_g);
 
-      cg_6->forward_comm(this,FORWARD_AD_G);
+      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_G);
+      else cg_6->forward_comm(this,FORWARD_AD_G);
 
       fieldforce_g_ad();
-
-      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_PERATOM_G);
-
     } else {
       poisson_ik(work1_6, work2_6, density_fft_g, fft1_6, fft2_6,
                  nx_pppm_6, ny_pppm_6, nz_pppm_6, nfft_6,
@@ -1061,12 +1058,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                  vdx_brick_g, vdy_brick_g, vdz_brick_g, virial_6, vg_6, vg2_6,
                  u_brick_g, v0_brick_g, v1_brick_g, v2_brick_g, v3_brick_g, v4_brick_g, v5_brick_g);
 
-      cg_6->forward_comm(this,FORWARD_IK_G);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_G);
+      else cg_6->forward_comm(this,FORWARD_IK_G);
 
       fieldforce_g_ik();
-
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_G);
     }
     if (evflag_atom) fieldforce_g_peratom();
   }
@@ -1100,12 +1095,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                     u_brick_a2, v0_brick_a2, v1_brick_a2, v2_brick_a2, v3_brick_a2, v4_brick_a2, v5_brick_a2,
                     u_brick_a4, v0_brick_a4, v1_brick_a4, v2_brick_a4, v3_brick_a4, v4_brick_a4, v5_brick_a4);
 
-      cg_6->forward_comm(this, FORWARD_AD_A);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_A);
+      else cg_6->forward_comm(this,FORWARD_AD_A);
 
       fieldforce_a_ad();
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_AD_PERATOM_A);
-
     }  else {
 
       poisson_ik(work1_6, work2_6, density_fft_a3, fft1_6, fft2_6,
@@ -1132,11 +1125,10 @@ void PPPMDisp::compute(int eflag, int vflag)
                     u_brick_a2, v0_brick_a2, v1_brick_a2, v2_brick_a2, v3_brick_a2, v4_brick_a2, v5_brick_a2,
                     u_brick_a4, v0_brick_a4, v1_brick_a4, v2_brick_a4, v3_brick_a4, v4_brick_a4, v5_brick_a4);
 
-      cg_6->forward_comm(this, FORWARD_IK_A);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_A);
+      else cg_6->forward_comm(this,FORWARD_IK_A);
 
       fieldforce_a_ik();
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_A);
     }
     if (evflag_atom) fieldforce_a_peratom();
   }
@@ -1163,12 +1155,10 @@ void PPPMDisp::compute(int eflag, int vflag)
         n += 2;
       }
 
-      cg_6->forward_comm(this,FORWARD_AD_NONE);
+      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_NONE);
+      else cg_6->forward_comm(this,FORWARD_AD_NONE);
 
       fieldforce_none_ad();
-
-      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_PERATOM_NONE);
-
     } else {
       int n = 0;
       for (int k = 0; k<nsplit_alloc/2; k++) {
@@ -1181,12 +1171,10 @@ void PPPMDisp::compute(int eflag, int vflag)
         n += 2;
       }
 
-      cg_6->forward_comm(this,FORWARD_IK_NONE);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_NONE);
+      else cg_6->forward_comm(this,FORWARD_IK_NONE);
 
       fieldforce_none_ik();
-
-      if (evflag_atom)
-        cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_NONE);
     }
     if (evflag_atom) fieldforce_none_peratom();
   }
@@ -2088,18 +2076,19 @@ void PPPMDisp::allocate_peratom()
     memory->create3d_offset(v5_brick,nzlo_out,nzhi_out,nylo_out,nyhi_out,
                             nxlo_out,nxhi_out,"pppm/disp:v5_brick");
 
-    // create ghost grid object for rho and electric field communication
+    // create ghost grid object for combined electric field
+    //   and per-atom energy/virial communication
 
     if (differentiation_flag == 1)
       cg_peratom =
-        new GridComm(lmp,world,6,1,
+        new GridComm(lmp,world,7,1,
                      nxlo_in,nxhi_in,nylo_in,nyhi_in,nzlo_in,nzhi_in,
                      nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
                      procneigh[1][1],procneigh[2][0],procneigh[2][1]);
     else
       cg_peratom =
-        new GridComm(lmp,world,7,1,
+        new GridComm(lmp,world,10,1,
                      nxlo_in,nxhi_in,nylo_in,nyhi_in,nzlo_in,nzhi_in,
                      nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
@@ -2127,18 +2116,19 @@ void PPPMDisp::allocate_peratom()
     memory->create3d_offset(v5_brick_g,nzlo_out_6,nzhi_out_6,nylo_out_6,nyhi_out_6,
                             nxlo_out_6,nxhi_out_6,"pppm/disp:v5_brick_g");
 
-    // create ghost grid object for rho and electric field communication
+    // create ghost grid object for combined electric field
+    //   and per-atom energy/virial communication
 
     if (differentiation_flag == 1)
       cg_peratom_6 =
-        new GridComm(lmp,world,6,1,
+        new GridComm(lmp,world,7,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
                      procneigh[1][1],procneigh[2][0],procneigh[2][1]);
     else
       cg_peratom_6 =
-        new GridComm(lmp,world,7,1,
+        new GridComm(lmp,world,10,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
@@ -2256,18 +2246,19 @@ void PPPMDisp::allocate_peratom()
     memory->create3d_offset(v5_brick_a6,nzlo_out_6,nzhi_out_6,nylo_out_6,nyhi_out_6,
                                 nxlo_out_6,nxhi_out_6,"pppm/disp:v5_brick_a6");
 
-    // create ghost grid object for rho and electric field communication
+    // create ghost grid object for combined electric field
+    //   and per-atom energy/virial communication
 
     if (differentiation_flag == 1)
       cg_peratom_6 =
-        new GridComm(lmp,world,42,1,
+        new GridComm(lmp,world,49,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
                      procneigh[1][1],procneigh[2][0],procneigh[2][1]);
     else
       cg_peratom_6 =
-        new GridComm(lmp,world,49,1,
+        new GridComm(lmp,world,70,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
@@ -2294,18 +2285,19 @@ void PPPMDisp::allocate_peratom()
     memory->create4d_offset(v5_brick_none,nsplit_alloc,nzlo_out_6,nzhi_out_6,nylo_out_6,nyhi_out_6,
                             nxlo_out_6,nxhi_out_6,"pppm/disp:v5_brick_none");
 
-    // create ghost grid object for rho and electric field communication
+    // create ghost grid object for combined electric field
+    //   and per-atom energy/virial communication
 
     if (differentiation_flag == 1)
       cg_peratom_6 =
-        new GridComm(lmp,world,6*nsplit_alloc,1,
+        new GridComm(lmp,world,7*nsplit_alloc,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
                      procneigh[1][1],procneigh[2][0],procneigh[2][1]);
     else
       cg_peratom_6 =
-        new GridComm(lmp,world,7*nsplit_alloc,1,
+        new GridComm(lmp,world,10*nsplit_alloc,1,
                      nxlo_in_6,nxhi_in_6,nylo_in_6,nyhi_in_6,nzlo_in_6,nzhi_in_6,
                      nxlo_out_6,nxhi_out_6,nylo_out_6,nyhi_out_6,nzlo_out_6,nzhi_out_6,
                      procneigh[0][0],procneigh[0][1],procneigh[1][0],
@@ -7274,6 +7266,49 @@ void PPPMDisp::pack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
     break;
   }
 
+  // E-field and per-atom values combined, as two consecutive blocks
+
+  case FORWARD_IK_ALL:
+    pack_forward(FORWARD_IK,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL:
+    pack_forward(FORWARD_AD,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_G:
+    pack_forward(FORWARD_IK_G,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM_G,&buf[3*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_G:
+    pack_forward(FORWARD_AD_G,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM_G,&buf[nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_A:
+    pack_forward(FORWARD_IK_A,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM_A,&buf[21*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_A:
+    pack_forward(FORWARD_AD_A,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM_A,&buf[7*nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_NONE:
+    pack_forward(FORWARD_IK_NONE,buf,nlist,list);
+    pack_forward(FORWARD_IK_PERATOM_NONE,&buf[3*nsplit_alloc*nlist],
+                 nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_NONE:
+    pack_forward(FORWARD_AD_NONE,buf,nlist,list);
+    pack_forward(FORWARD_AD_PERATOM_NONE,&buf[nsplit_alloc*nlist],
+                 nlist,list);
+    break;
   }
 }
 
@@ -7786,6 +7821,49 @@ void PPPMDisp::unpack_forward(int flag, FFT_SCALAR *buf, int nlist, int *list)
     break;
   }
 
+  // E-field and per-atom values combined, as two consecutive blocks
+
+  case FORWARD_IK_ALL:
+    unpack_forward(FORWARD_IK,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM,&buf[3*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL:
+    unpack_forward(FORWARD_AD,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM,&buf[nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_G:
+    unpack_forward(FORWARD_IK_G,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM_G,&buf[3*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_G:
+    unpack_forward(FORWARD_AD_G,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM_G,&buf[nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_A:
+    unpack_forward(FORWARD_IK_A,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM_A,&buf[21*nlist],nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_A:
+    unpack_forward(FORWARD_AD_A,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM_A,&buf[7*nlist],nlist,list);
+    break;
+
+  case FORWARD_IK_ALL_NONE:
+    unpack_forward(FORWARD_IK_NONE,buf,nlist,list);
+    unpack_forward(FORWARD_IK_PERATOM_NONE,&buf[3*nsplit_alloc*nlist],
+                   nlist,list);
+    break;
+
+  case FORWARD_AD_ALL_NONE:
+    unpack_forward(FORWARD_AD_NONE,buf,nlist,list);
+    unpack_forward(FORWARD_AD_PERATOM_NONE,&buf[nsplit_alloc*nlist],
+                   nlist,list);
+    break;
   }
 }
 
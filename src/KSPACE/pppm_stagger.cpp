@@ -36,7 +36,8 @@ using namespace MathSpecial;
 #define EPS_HOC 1.0e-7
 
 enum{REVERSE_RHO};
-enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM};
+enum{FORWARD_IK,FORWARD_AD,FORWARD_IK_PERATOM,FORWARD_AD_PERATOM,
+     FORWARD_IK_ALL,FORWARD_AD_ALL};
 
 #ifdef FFT_SINGLE
 #define ZEROF 0.0f
@@ -172,17 +173,14 @@ void PPPMStagger::compute(int eflag, int vflag)
 
     // all procs communicate E-field values
     // to fill ghost cells surrounding their 3d bricks
-
-    if (differentiation_flag == 1) cg->forward_comm(this,FORWARD_AD);
-    else cg->forward_comm(this,FORWARD_IK);
-
-    // extra per-atom energy/virial communication
-
-    if (evflag_atom) {
-      if (differentiation_flag == 1 && vflag_atom)
-        cg_peratom->forward_comm(this,FORWARD_AD_PERATOM);
-      else if (differentiation_flag == 0)
-        cg_peratom->forward_comm(this,FORWARD_IK_PERATOM);
+    // per-atom energy/virial values are sent in the same messages
+
+    if (differentiation_flag == 1) {
+      if (vflag_atom) cg_peratom->forward_comm(this,FORWARD_AD_ALL);
+      else cg->forward_comm(this,FORWARD_AD);
+    } else {
+      if (evflag_atom) cg_peratom->forward_comm(this,FORWARD_IK_ALL);
+      else cg->forward_comm(this,FORWARD_IK);
     }
 
     // calculate the force on my particles
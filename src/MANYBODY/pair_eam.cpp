@@ -40,6 +40,7 @@ PairEAM::PairEAM(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
   manybody_flag = 1;
+  local_energy_enable = 1;
   embedstep = -1;
 
   nmax = 0;
@@ -131,9 +132,9 @@ PairEAM::~PairEAM()
   memory->destroy(rhor);
   memory->destroy(z2r);
 
-  memory->destroy(frho_spline);
-  memory->destroy(rhor_spline);
-  memory->destroy(z2r_spline);
+  memory->destroy_shared(frho_spline);
+  memory->destroy_shared(rhor_spline);
+  memory->destroy_shared(z2r_spline);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -732,22 +733,29 @@ void PairEAM::array2spline()
   rdr = 1.0/dr;
   rdrho = 1.0/drho;
 
-  memory->destroy(frho_spline);
-  memory->destroy(rhor_spline);
-  memory->destroy(z2r_spline);
+  // spline tables are read-only after this and can be large,
+  //   so store one copy per node, filled by one proc
 
-  memory->create(frho_spline,nfrho,nrho+1,7,"pair:frho");
-  memory->create(rhor_spline,nrhor,nr+1,7,"pair:rhor");
-  memory->create(z2r_spline,nz2r,nr+1,7,"pair:z2r");
+  memory->destroy_shared(frho_spline);
+  memory->destroy_shared(rhor_spline);
+  memory->destroy_shared(z2r_spline);
 
-  for (int i = 0; i < nfrho; i++)
-    interpolate(nrho,drho,frho[i],frho_spline[i]);
+  memory->create_shared(frho_spline,nfrho,nrho+1,7,"pair:frho");
+  memory->create_shared(rhor_spline,nrhor,nr+1,7,"pair:rhor");
+  memory->create_shared(z2r_spline,nz2r,nr+1,7,"pair:z2r");
 
-  for (int i = 0; i < nrhor; i++)
-    interpolate(nr,dr,rhor[i],rhor_spline[i]);
+  if (memory->shared_writer()) {
+    for (int i = 0; i < nfrho; i++)
+      interpolate(nrho,drho,frho[i],frho_spline[i]);
 
-  for (int i = 0; i < nz2r; i++)
-    interpolate(nr,dr,z2r[i],z2r_spline[i]);
+    for (int i = 0; i < nrhor; i++)
+      interpolate(nr,dr,rhor[i],rhor_spline[i]);
+
+    for (int i = 0; i < nz2r; i++)
+      interpolate(nr,dr,z2r[i],z2r_spline[i]);
+  }
+
+  memory->shared_sync();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -856,6 +864,58 @@ double PairEAM::single(int i, int j, int itype, int jtype,
   return phi;
 }
 
+/* ----------------------------------------------------------------------
+   energy of atom I from its full list of neighbors
+   embedding energy of atom I plus half of its pair energies
+------------------------------------------------------------------------- */
+
+double PairEAM::energy_local(int i, int jnum, int *jlist)
+{
+  int j,jj,m,itype,jtype;
+  double delx,dely,delz,rsq,p,rhoi,phi;
+  double *coeff;
+
+  double **x = atom->x;
+  int *type = atom->type;
+
+  itype = type[i];
+  rhoi = 0.0;
+  phi = 0.0;
+
+  for (jj = 0; jj < jnum; jj++) {
+    j = jlist[jj];
+    delx = x[i][0] - x[j][0];
+    dely = x[i][1] - x[j][1];
+    delz = x[i][2] - x[j][2];
+    rsq = delx*delx + dely*dely + delz*delz;
+    if (rsq >= cutforcesq) continue;
+
+    jtype = type[j];
+    p = sqrt(rsq)*rdr + 1.0;
+    m = static_cast<int> (p);
+    m = MIN(m,nr-1);
+    p -= m;
+    p = MIN(p,1.0);
+    coeff = rhor_spline[type2rhor[jtype][itype]][m];
+    rhoi += ((coeff[3]*p + coeff[4])*p + coeff[5])*p + coeff[6];
+    coeff = z2r_spline[type2z2r[itype][jtype]][m];
+    phi += 0.5*scale[itype][jtype]/sqrt(rsq) *
+      (((coeff[3]*p + coeff[4])*p + coeff[5])*p + coeff[6]);
+  }
+
+  p = rhoi*rdrho + 1.0;
+  m = static_cast<int> (p);
+  m = MAX(1,MIN(m,nrho-1));
+  p -= m;
+  p = MIN(p,1.0);
+  coeff = frho_spline[type2frho[itype]][m];
+  double embed = ((coeff[3]*p + coeff[4])*p + coeff[5])*p + coeff[6];
+  if (rhoi > rhomax) embed += ((coeff[0]*p + coeff[1])*p + coeff[2]) *
+                       (rhoi-rhomax);
+
+  return phi + scale[itype][itype]*embed;
+}
+
 /* ---------------------------------------------------------------------- */
 
 int PairEAM::pack_forward_comm(int n, int *list, double *buf,
@@ -53,6 +53,7 @@ class PairEAM : public Pair {
   void init_style();
   double init_one(int, int);
   double single(int, int, int, int, double, double, double, double &);
+  double energy_local(int, int, int *);
   virtual void *extract(const char *, int &);
 
   virtual int pack_forward_comm(int, int *, double *, int, int *);
@@ -0,0 +1,37 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(eam/alloy/fast,PairEAMAlloyFast)
+
+#else
+
+#ifndef LMP_PAIR_EAM_ALLOY_FAST_H
+#define LMP_PAIR_EAM_ALLOY_FAST_H
+
+#include "pair_eam_alloy.h"
+#include "pair_eam_fast.h"
+
+namespace LAMMPS_NS {
+
+class PairEAMAlloyFast : public PairEAMAlloy, public PairEAMFast {
+ public:
+  PairEAMAlloyFast(class LAMMPS *);
+  virtual ~PairEAMAlloyFast() {}
+};
+
+}
+
+#endif
+#endif
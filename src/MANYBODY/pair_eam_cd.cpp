@@ -38,6 +38,7 @@ PairEAMCD::PairEAMCD(LAMMPS *lmp, int _cdeamVersion)
   : PairEAM(lmp), PairEAMAlloy(lmp), cdeamVersion(_cdeamVersion)
 {
   single_enable = 0;
+  local_energy_enable = 0;
   restartinfo = 0;
 
   rhoB = NULL;
@@ -0,0 +1,418 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "pair_eam_fast.h"
+#include <cmath>
+#include <cstring>
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define NRHOTAB 4
+#define NFORCETAB 16
+#define NFRHOTAB 8
+#define TABALIGN 64
+
+/* ---------------------------------------------------------------------- */
+
+PairEAMFast::PairEAMFast(LAMMPS *lmp) : PairEAM(lmp)
+{
+  // forces are only computed on owned atoms from a full neighbor list,
+  //   so the virial is tallied per pair
+
+  no_virial_fdotr_compute = 1;
+
+  single_flag = 0;
+  ntab = 0;
+  rhotab_mem = forcetab_mem = frhotab_mem = NULL;
+  rhotab_d = forcetab_d = frhotab_d = NULL;
+  rhotab_f = forcetab_f = frhotab_f = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairEAMFast::~PairEAMFast()
+{
+  destroy_tables();
+}
+
+/* ----------------------------------------------------------------------
+   global settings
+------------------------------------------------------------------------- */
+
+void PairEAMFast::settings(int narg, char **arg)
+{
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"mode") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal pair_style command");
+      if (strcmp(arg[iarg+1],"double") == 0) single_flag = 0;
+      else if (strcmp(arg[iarg+1],"single") == 0) single_flag = 1;
+      else error->all(FLERR,"Illegal pair_style command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairEAMFast::init_style()
+{
+  // convert read-in file(s) to arrays and spline them
+
+  file2array();
+  array2spline();
+
+  // need a full neighbor list
+  // requestor is cast back to Pair by neighbor, so pass the
+  //   Pair part of this class, which differs with virtual inheritance
+
+  int irequest = neighbor->request((Pair *) this,instance_me);
+  neighbor->requests[irequest]->half = 0;
+  neighbor->requests[irequest]->full = 1;
+  embedstep = -1;
+}
+
+/* ----------------------------------------------------------------------
+   spline read-in values, then copy coefficients into per type pair tables
+------------------------------------------------------------------------- */
+
+void PairEAMFast::array2spline()
+{
+  PairEAM::array2spline();
+
+  destroy_tables();
+  if (single_flag) pack_tables(rhotab_f,forcetab_f,frhotab_f);
+  else pack_tables(rhotab_d,forcetab_d,frhotab_d);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairEAMFast::destroy_tables()
+{
+  memory->sfree_shared(rhotab_mem);
+  memory->sfree_shared(forcetab_mem);
+  memory->sfree_shared(frhotab_mem);
+  rhotab_mem = forcetab_mem = frhotab_mem = NULL;
+  rhotab_d = forcetab_d = frhotab_d = NULL;
+  rhotab_f = forcetab_f = frhotab_f = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   allocate tables aligned to TABALIGN bytes and fill them
+   tables are shared by all procs on a node and filled by one of them,
+     shared memory is page aligned so all procs use the same offset
+   for type pair I,J and knot M, with I = type of atom whose neighbors
+     are looped over:
+   rhotab[(I*(ntypes+1)+J)*ntab+M] = 4 coeffs of rho of J at I
+   forcetab[(I*(ntypes+1)+J)*ntab+M] = 3 coeffs of rho' of I at J,
+     3 of rho' of J at I, 3 of (phi*r)', 4 of phi*r, 3 padding
+   frhotab[I*(nrho+1)+M] = 7 coeffs of embedding function of I, 1 padding
+------------------------------------------------------------------------- */
+
+template <class flt_t>
+void PairEAMFast::pack_tables(flt_t *&rhotab, flt_t *&forcetab,
+                              flt_t *&frhotab)
+{
+  const int ntypes = atom->ntypes;
+  const int npair = (ntypes+1)*(ntypes+1);
+  ntab = nr+1;
+
+  bigint nbytes = (bigint) npair*ntab*NRHOTAB*sizeof(flt_t) + TABALIGN;
+  rhotab_mem = memory->smalloc_shared(nbytes,"pair:rhotab");
+  nbytes = (bigint) npair*ntab*NFORCETAB*sizeof(flt_t) + TABALIGN;
+  forcetab_mem = memory->smalloc_shared(nbytes,"pair:forcetab");
+  nbytes = (bigint) (ntypes+1)*(nrho+1)*NFRHOTAB*sizeof(flt_t) + TABALIGN;
+  frhotab_mem = memory->smalloc_shared(nbytes,"pair:frhotab");
+
+  rhotab = (flt_t *) (((uintptr_t) rhotab_mem + TABALIGN-1) &
+                      ~((uintptr_t) TABALIGN-1));
+  forcetab = (flt_t *) (((uintptr_t) forcetab_mem + TABALIGN-1) &
+                        ~((uintptr_t) TABALIGN-1));
+  frhotab = (flt_t *) (((uintptr_t) frhotab_mem + TABALIGN-1) &
+                       ~((uintptr_t) TABALIGN-1));
+
+  if (!memory->shared_writer()) {
+    memory->shared_sync();
+    return;
+  }
+
+  memset(rhotab,0,(size_t) npair*ntab*NRHOTAB*sizeof(flt_t));
+  memset(forcetab,0,(size_t) npair*ntab*NFORCETAB*sizeof(flt_t));
+  memset(frhotab,0,(size_t) (ntypes+1)*(nrho+1)*NFRHOTAB*sizeof(flt_t));
+
+  for (int itype = 1; itype <= ntypes; itype++)
+    for (int jtype = 1; jtype <= ntypes; jtype++) {
+      const int ij = itype*(ntypes+1) + jtype;
+      const int irhoj = type2rhor[jtype][itype];
+      const int jrhoi = type2rhor[itype][jtype];
+      const int iz2r = type2z2r[itype][jtype];
+
+      for (int m = 1; m <= nr; m++) {
+        flt_t *rt = rhotab + ((bigint) ij*ntab + m)*NRHOTAB;
+        flt_t *ft = forcetab + ((bigint) ij*ntab + m)*NFORCETAB;
+        if (irhoj >= 0) {
+          const double *coeff = rhor_spline[irhoj][m];
+          for (int k = 0; k < 4; k++) rt[k] = coeff[3+k];
+          for (int k = 0; k < 3; k++) ft[3+k] = coeff[k];
+        }
+        if (jrhoi >= 0) {
+          const double *coeff = rhor_spline[jrhoi][m];
+          for (int k = 0; k < 3; k++) ft[k] = coeff[k];
+        }
+        if (iz2r >= 0) {
+          const double *coeff = z2r_spline[iz2r][m];
+          for (int k = 0; k < 3; k++) ft[6+k] = coeff[k];
+          for (int k = 0; k < 4; k++) ft[9+k] = coeff[3+k];
+        }
+      }
+    }
+
+  for (int itype = 1; itype <= ntypes; itype++) {
+    const int ifrho = type2frho[itype];
+    if (ifrho < 0) continue;
+    for (int m = 1; m <= nrho; m++) {
+      flt_t *et = frhotab + ((bigint) itype*(nrho+1) + m)*NFRHOTAB;
+      const double *coeff = frho_spline[ifrho][m];
+      for (int k = 0; k < 7; k++) et[k] = coeff[k];
+    }
+  }
+
+  memory->shared_sync();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairEAMFast::compute(int eflag, int vflag)
+{
+  ev_init(eflag,vflag);
+
+  if (single_flag) {
+    if (evflag) {
+      if (eflag) eval<float,1,1>(rhotab_f,forcetab_f,frhotab_f);
+      else eval<float,1,0>(rhotab_f,forcetab_f,frhotab_f);
+    } else eval<float,0,0>(rhotab_f,forcetab_f,frhotab_f);
+  } else {
+    if (evflag) {
+      if (eflag) eval<double,1,1>(rhotab_d,forcetab_d,frhotab_d);
+      else eval<double,1,0>(rhotab_d,forcetab_d,frhotab_d);
+    } else eval<double,0,0>(rhotab_d,forcetab_d,frhotab_d);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   density and embedding term of each owned atom are computed in one
+     pass over its full neighbor list, so no reverse comm is needed
+   forces are then computed only on owned atoms, each pair twice
+   table coefficients may be float, all sums are accumulated in double
+------------------------------------------------------------------------- */
+
+template <class flt_t, int EVFLAG, int EFLAG>
+void PairEAMFast::eval(const flt_t * _noalias const rhotab,
+                       const flt_t * _noalias const forcetab,
+                       const flt_t * _noalias const frhotab)
+{
+  int i,j,ii,jj,m,jnum,itype,jtype;
+  double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
+  double rsq,r,p,rhoi,rhoip,rhojp,z2,z2p,recip,phip,psip,phi;
+  double fxtmp,fytmp,fztmp;
+  int *jlist;
+
+  evdwl = 0.0;
+
+  // grow energy and fp arrays if necessary
+  // need to be atom->nmax in length
+
+  if (atom->nmax > nmax) {
+    memory->destroy(rho);
+    memory->destroy(fp);
+    memory->destroy(numforce);
+    nmax = atom->nmax;
+    memory->create(rho,nmax,"pair:rho");
+    memory->create(fp,nmax,"pair:fp");
+    memory->create(numforce,nmax,"pair:numforce");
+  }
+
+  double **x = atom->x;
+  double **f = atom->f;
+  int *type = atom->type;
+  const int ntypes1 = atom->ntypes + 1;
+  const int inum = list->inum;
+  const int * const ilist = list->ilist;
+  const int * const numneigh = list->numneigh;
+  int ** const firstneigh = list->firstneigh;
+  const int nrm1 = nr-1;
+  const int nrhom1 = nrho-1;
+
+  // rho = density at each owned atom from its full neighbor list
+  // fp = derivative of embedding energy at each atom
+  // phi = embedding energy at each atom
+  // if rho > rhomax (e.g. due to close approach of two atoms),
+  //   will exceed table, so add linear term to conserve energy
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    const flt_t * const rhotab_i = rhotab + (bigint) itype*ntypes1*ntab*NRHOTAB;
+
+    rhoi = 0.0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+
+      if (rsq < cutforcesq) {
+        jtype = type[j];
+        p = sqrt(rsq)*rdr + 1.0;
+        m = static_cast<int> (p);
+        m = MIN(m,nrm1);
+        p -= m;
+        p = MIN(p,1.0);
+        const flt_t pf = p;
+        const flt_t * const c = rhotab_i + (jtype*ntab + m)*NRHOTAB;
+        rhoi += ((c[0]*pf + c[1])*pf + c[2])*pf + c[3];
+      }
+    }
+    rho[i] = rhoi;
+
+    p = rhoi*rdrho + 1.0;
+    m = static_cast<int> (p);
+    m = MAX(1,MIN(m,nrhom1));
+    p -= m;
+    p = MIN(p,1.0);
+    const flt_t * const c = frhotab + ((bigint) itype*(nrho+1) + m)*NFRHOTAB;
+    fp[i] = (c[0]*p + c[1])*p + c[2];
+    if (EFLAG) {
+      phi = ((c[3]*p + c[4])*p + c[5])*p + c[6];
+      if (rhoi > rhomax) phi += fp[i] * (rhoi-rhomax);
+      phi *= scale[itype][itype];
+      if (eflag_global) eng_vdwl += phi;
+      if (eflag_atom) eatom[i] += phi;
+    }
+  }
+
+  // communicate derivative of embedding function
+
+  comm->forward_comm_pair(this);
+  embedstep = update->ntimestep;
+
+  // compute forces on each owned atom
+  // loop over full neighbor list of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    const flt_t * const forcetab_i =
+      forcetab + (bigint) itype*ntypes1*ntab*NFORCETAB;
+    const double fpi = fp[i];
+    const double * const scale_i = scale[itype];
+
+    fxtmp = fytmp = fztmp = 0.0;
+    numforce[i] = 0;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+
+      if (rsq < cutforcesq) {
+        ++numforce[i];
+        jtype = type[j];
+        r = sqrt(rsq);
+        p = r*rdr + 1.0;
+        m = static_cast<int> (p);
+        m = MIN(m,nrm1);
+        p -= m;
+        p = MIN(p,1.0);
+        const flt_t pf = p;
+        const flt_t * const c = forcetab_i + (jtype*ntab + m)*NFORCETAB;
+        rhoip = (c[0]*pf + c[1])*pf + c[2];
+        rhojp = (c[3]*pf + c[4])*pf + c[5];
+        z2p = (c[6]*pf + c[7])*pf + c[8];
+        z2 = ((c[9]*pf + c[10])*pf + c[11])*pf + c[12];
+
+        // rhoip = derivative of (density at atom j due to atom i)
+        // rhojp = derivative of (density at atom i due to atom j)
+        // phi = pair potential energy
+        // phip = phi'
+        // z2 = phi * r
+        // z2p = (phi * r)' = (phi' r) + phi
+        // psip needs both fp[i] and fp[j] terms since r_ij appears in two
+        //   terms of embed eng: Fi(sum rho_ij) and Fj(sum rho_ji)
+        //   hence embed' = Fi(sum rho_ij) rhojp + Fj(sum rho_ji) rhoip
+        // scale factor can be applied by thermodynamic integration
+
+        recip = 1.0/r;
+        phi = z2*recip;
+        phip = z2p*recip - phi*recip;
+        psip = fpi*rhojp + fp[j]*rhoip + phip;
+        fpair = -scale_i[jtype]*psip*recip;
+
+        fxtmp += delx*fpair;
+        fytmp += dely*fpair;
+        fztmp += delz*fpair;
+
+        if (EFLAG) evdwl = scale_i[jtype]*phi;
+        if (EVFLAG) ev_tally_full(i,evdwl,0.0,fpair,delx,dely,delz);
+      }
+    }
+
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairEAMFast::memory_usage()
+{
+  double bytes = PairEAM::memory_usage();
+  if (!memory->shared_writer()) return bytes;
+
+  // tables are only counted on the proc that owns their shared memory
+
+  const int npair = (atom->ntypes+1)*(atom->ntypes+1);
+  const int nflt = single_flag ? sizeof(float) : sizeof(double);
+  bytes += (double) npair*ntab*(NRHOTAB+NFORCETAB)*nflt;
+  bytes += (double) (atom->ntypes+1)*(nrho+1)*NFRHOTAB*nflt;
+  return bytes;
+}
@@ -0,0 +1,72 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(eam/fast,PairEAMFast)
+
+#else
+
+#ifndef LMP_PAIR_EAM_FAST_H
+#define LMP_PAIR_EAM_FAST_H
+
+#include "pair_eam.h"
+
+namespace LAMMPS_NS {
+
+// use virtual public since this class is parent in multiple inheritance
+
+class PairEAMFast : virtual public PairEAM {
+ public:
+  PairEAMFast(class LAMMPS *);
+  virtual ~PairEAMFast();
+  virtual void compute(int, int);
+  void settings(int, char **);
+  void init_style();
+  double memory_usage();
+
+ protected:
+  int single_flag;              // 1 if tables are stored as float
+
+  // spline coefficients of each type pair stored contiguously
+  // rhotab = rho of J at I, NRHOTAB per knot
+  // forcetab = rho' of I at J, rho' of J at I, (phi*r)', phi*r,
+  //   NFORCETAB per knot
+  // frhotab = embedding function of each type, NFRHOTAB per knot
+
+  int ntab;                     // # of knots per type pair
+  void *rhotab_mem,*forcetab_mem,*frhotab_mem;
+  double *rhotab_d,*forcetab_d,*frhotab_d;
+  float *rhotab_f,*forcetab_f,*frhotab_f;
+
+  void array2spline();
+  void destroy_tables();
+  template <class flt_t> void pack_tables(flt_t *&, flt_t *&, flt_t *&);
+  template <class flt_t, int EVFLAG, int EFLAG>
+    void eval(const flt_t *, const flt_t *, const flt_t *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+*/
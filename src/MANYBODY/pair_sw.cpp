@@ -34,6 +34,10 @@ using namespace LAMMPS_NS;
 #define MAXLINE 1024
 #define DELTA 4
 
+// rows of cached per-neighbor terms of the short neighbor list
+
+enum{DELX,DELY,DELZ,RIJ,RINVSQ,GSRAINVSQ,EXPGSRAINV,FX,FY,FZ,NCACHE};
+
 /* ---------------------------------------------------------------------- */
 
 PairSW::PairSW(LAMMPS *lmp) : Pair(lmp)
@@ -42,6 +46,7 @@ PairSW::PairSW(LAMMPS *lmp) : Pair(lmp)
   restartinfo = 0;
   one_coeff = 1;
   manybody_flag = 1;
+  local_energy_enable = 1;
 
   nelements = 0;
   elements = NULL;
@@ -52,6 +57,10 @@ PairSW::PairSW(LAMMPS *lmp) : Pair(lmp)
 
   maxshort = 10;
   neighshort = NULL;
+
+  maxcache = 0;
+  elemshort = NULL;
+  cacheshort = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -74,6 +83,9 @@ PairSW::~PairSW()
     memory->destroy(neighshort);
     delete [] map;
   }
+
+  memory->destroy(elemshort);
+  memory->destroy(cacheshort);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -81,10 +93,10 @@ PairSW::~PairSW()
 void PairSW::compute(int eflag, int vflag)
 {
   int i,j,k,ii,jj,kk,inum,jnum,jnumm1;
-  int itype,jtype,ktype,ijparam,ikparam,ijkparam;
+  int itype,jtype,ijparam;
   tagint itag,jtag;
   double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
-  double rsq,rsq1,rsq2;
+  double rsq,r,rainv,gsrainv;
   double delr1[3],delr2[3],fj[3],fk[3];
   int *ilist,*jlist,*numneigh,**firstneigh;
 
@@ -116,10 +128,25 @@ void PairSW::compute(int eflag, int vflag)
     ztmp = x[i][2];
     fxtmp = fytmp = fztmp = 0.0;
 
-    // two-body interactions, skip half of them
-
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (jnum > maxcache) grow_cache(jnum);
+
+    double * const cdelx = cacheshort[DELX];
+    double * const cdely = cacheshort[DELY];
+    double * const cdelz = cacheshort[DELZ];
+    double * const crij = cacheshort[RIJ];
+    double * const crinvsq = cacheshort[RINVSQ];
+    double * const cgsrainvsq = cacheshort[GSRAINVSQ];
+    double * const cexpgsrainv = cacheshort[EXPGSRAINV];
+    double * const cfx = cacheshort[FX];
+    double * const cfy = cacheshort[FY];
+    double * const cfz = cacheshort[FZ];
+
+    // two-body interactions, skip half of them
+    // store neighbors within I-J cutoff in short list, together with
+    //   their radial terms of the three-body interaction
+
     int numshort = 0;
 
     for (jj = 0; jj < jnum; jj++) {
@@ -133,15 +160,22 @@ void PairSW::compute(int eflag, int vflag)
 
       jtype = map[type[j]];
       ijparam = elem2param[itype][jtype][jtype];
-      if (rsq >= params[ijparam].cutsq) {
-        continue;
-      } else {
-        neighshort[numshort++] = j;
-        if (numshort >= maxshort) {
-          maxshort += maxshort/2;
-          memory->grow(neighshort,maxshort,"pair:neighshort");
-        }
-      }
+      if (rsq >= params[ijparam].cutsq) continue;
+
+      r = sqrt(rsq);
+      rainv = 1.0/(r - params[ijparam].cut);
+      gsrainv = params[ijparam].sigma_gamma * rainv;
+      neighshort[numshort] = j;
+      elemshort[numshort] = jtype;
+      cdelx[numshort] = -delx;
+      cdely[numshort] = -dely;
+      cdelz[numshort] = -delz;
+      crij[numshort] = r;
+      crinvsq[numshort] = 1.0/rsq;
+      cgsrainvsq[numshort] = gsrainv*rainv/r;
+      cexpgsrainv[numshort] = exp(gsrainv);
+      cfx[numshort] = cfy[numshort] = cfz[numshort] = 0.0;
+      numshort++;
 
       jtag = tag[j];
       if (itag > jtag) {
@@ -167,50 +201,87 @@ void PairSW::compute(int eflag, int vflag)
                            evdwl,0.0,fpair,delx,dely,delz);
     }
 
+    // three-body interactions
+    // same as threebody() with cached radial terms
+    // forces on K are accumulated in the cache, so the loop over K
+    //   only reads and writes contiguous arrays
+
     jnumm1 = numshort - 1;
 
     for (jj = 0; jj < jnumm1; jj++) {
-      j = neighshort[jj];
-      jtype = map[type[j]];
-      ijparam = elem2param[itype][jtype][jtype];
-      delr1[0] = x[j][0] - xtmp;
-      delr1[1] = x[j][1] - ytmp;
-      delr1[2] = x[j][2] - ztmp;
-      rsq1 = delr1[0]*delr1[0] + delr1[1]*delr1[1] + delr1[2]*delr1[2];
+      jtype = elemshort[jj];
+      const int * const elem2param_ij = elem2param[itype][jtype];
+      const double delx1 = cdelx[jj];
+      const double dely1 = cdely[jj];
+      const double delz1 = cdelz[jj];
+      const double r1 = crij[jj];
+      const double rinvsq1 = crinvsq[jj];
+      const double gsrainvsq1 = cgsrainvsq[jj];
+      const double expgsrainv1 = cexpgsrainv[jj];
 
       double fjxtmp,fjytmp,fjztmp;
       fjxtmp = fjytmp = fjztmp = 0.0;
 
       for (kk = jj+1; kk < numshort; kk++) {
-        k = neighshort[kk];
-        ktype = map[type[k]];
-        ikparam = elem2param[itype][ktype][ktype];
-        ijkparam = elem2param[itype][jtype][ktype];
-
-        delr2[0] = x[k][0] - xtmp;
-        delr2[1] = x[k][1] - ytmp;
-        delr2[2] = x[k][2] - ztmp;
-        rsq2 = delr2[0]*delr2[0] + delr2[1]*delr2[1] + delr2[2]*delr2[2];
-
-        threebody(&params[ijparam],&params[ikparam],&params[ijkparam],
-                  rsq1,rsq2,delr1,delr2,fj,fk,eflag,evdwl);
-
-        fxtmp -= fj[0] + fk[0];
-        fytmp -= fj[1] + fk[1];
-        fztmp -= fj[2] + fk[2];
-        fjxtmp += fj[0];
-        fjytmp += fj[1];
-        fjztmp += fj[2];
-        f[k][0] += fk[0];
-        f[k][1] += fk[1];
-        f[k][2] += fk[2];
-
-        if (evflag) ev_tally3(i,j,k,evdwl,0.0,fj,fk,delr1,delr2);
+        const Param * const paramijk = &params[elem2param_ij[elemshort[kk]]];
+        const double delx2 = cdelx[kk];
+        const double dely2 = cdely[kk];
+        const double delz2 = cdelz[kk];
+
+        const double rinv12 = 1.0/(r1*crij[kk]);
+        const double cs = (delx1*delx2 + dely1*dely2 + delz1*delz2) * rinv12;
+        const double delcs = cs - paramijk->costheta;
+        const double facexp = expgsrainv1*cexpgsrainv[kk];
+        const double facrad = paramijk->lambda_epsilon * facexp*delcs*delcs;
+        const double frad1 = facrad*gsrainvsq1;
+        const double frad2 = facrad*cgsrainvsq[kk];
+        const double facang = paramijk->lambda_epsilon2 * facexp*delcs;
+        const double facang12 = rinv12*facang;
+        const double csfacang = cs*facang;
+        const double csfac1 = rinvsq1*csfacang;
+        const double csfac2 = crinvsq[kk]*csfacang;
+
+        const double fjx = delx1*(frad1+csfac1)-delx2*facang12;
+        const double fjy = dely1*(frad1+csfac1)-dely2*facang12;
+        const double fjz = delz1*(frad1+csfac1)-delz2*facang12;
+        const double fkx = delx2*(frad2+csfac2)-delx1*facang12;
+        const double fky = dely2*(frad2+csfac2)-dely1*facang12;
+        const double fkz = delz2*(frad2+csfac2)-delz1*facang12;
+
+        fxtmp -= fjx + fkx;
+        fytmp -= fjy + fky;
+        fztmp -= fjz + fkz;
+        fjxtmp += fjx;
+        fjytmp += fjy;
+        fjztmp += fjz;
+        cfx[kk] += fkx;
+        cfy[kk] += fky;
+        cfz[kk] += fkz;
+
+        if (evflag) {
+          fj[0] = fjx; fj[1] = fjy; fj[2] = fjz;
+          fk[0] = fkx; fk[1] = fky; fk[2] = fkz;
+          delr1[0] = delx1; delr1[1] = dely1; delr1[2] = delz1;
+          delr2[0] = delx2; delr2[1] = dely2; delr2[2] = delz2;
+          if (eflag) evdwl = facrad;
+          ev_tally3(i,neighshort[jj],neighshort[kk],evdwl,0.0,
+                    fj,fk,delr1,delr2);
+        }
       }
-      f[j][0] += fjxtmp;
-      f[j][1] += fjytmp;
-      f[j][2] += fjztmp;
+      cfx[jj] += fjxtmp;
+      cfy[jj] += fjytmp;
+      cfz[jj] += fjztmp;
+    }
+
+    // apply forces accumulated on short neighbors
+
+    for (kk = 0; kk < numshort; kk++) {
+      k = neighshort[kk];
+      f[k][0] += cfx[kk];
+      f[k][1] += cfy[kk];
+      f[k][2] += cfz[kk];
     }
+
     f[i][0] += fxtmp;
     f[i][1] += fytmp;
     f[i][2] += fztmp;
@@ -219,6 +290,94 @@ void PairSW::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   grow cached short neighbor terms to hold N neighbors
+------------------------------------------------------------------------- */
+
+void PairSW::grow_cache(int n)
+{
+  maxcache = n + n/2;
+  memory->destroy(elemshort);
+  memory->destroy(cacheshort);
+  memory->create(elemshort,maxcache,"pair:elemshort");
+  memory->create(cacheshort,NCACHE,maxcache,"pair:cacheshort");
+  if (maxcache > maxshort) {
+    maxshort = maxcache;
+    memory->grow(neighshort,maxshort,"pair:neighshort");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   energy of atom I from its full list of neighbors
+   two-body terms are split evenly between both atoms,
+   three-body terms belong to the central atom I
+------------------------------------------------------------------------- */
+
+double PairSW::energy_local(int i, int jnum, int *jlist)
+{
+  int j,k,jj,kk,itype,jtype,ktype,ijparam,ikparam,ijkparam;
+  double rsq1,rsq2,fpair,evdwl;
+  double delr1[3],delr2[3],fj[3],fk[3];
+
+  double **x = atom->x;
+  int *type = atom->type;
+
+  itype = map[type[i]];
+  if (itype < 0) return 0.0;
+
+  double energy = 0.0;
+  int numshort = 0;
+
+  for (jj = 0; jj < jnum; jj++) {
+    j = jlist[jj];
+    delr1[0] = x[j][0] - x[i][0];
+    delr1[1] = x[j][1] - x[i][1];
+    delr1[2] = x[j][2] - x[i][2];
+    rsq1 = delr1[0]*delr1[0] + delr1[1]*delr1[1] + delr1[2]*delr1[2];
+
+    jtype = map[type[j]];
+    ijparam = elem2param[itype][jtype][jtype];
+    if (rsq1 >= params[ijparam].cutsq) continue;
+
+    neighshort[numshort++] = j;
+    if (numshort >= maxshort) {
+      maxshort += maxshort/2;
+      memory->grow(neighshort,maxshort,"pair:neighshort");
+    }
+
+    twobody(&params[ijparam],rsq1,fpair,1,evdwl);
+    energy += 0.5*evdwl;
+  }
+
+  for (jj = 0; jj < numshort-1; jj++) {
+    j = neighshort[jj];
+    jtype = map[type[j]];
+    ijparam = elem2param[itype][jtype][jtype];
+    delr1[0] = x[j][0] - x[i][0];
+    delr1[1] = x[j][1] - x[i][1];
+    delr1[2] = x[j][2] - x[i][2];
+    rsq1 = delr1[0]*delr1[0] + delr1[1]*delr1[1] + delr1[2]*delr1[2];
+
+    for (kk = jj+1; kk < numshort; kk++) {
+      k = neighshort[kk];
+      ktype = map[type[k]];
+      ikparam = elem2param[itype][ktype][ktype];
+      ijkparam = elem2param[itype][jtype][ktype];
+
+      delr2[0] = x[k][0] - x[i][0];
+      delr2[1] = x[k][1] - x[i][1];
+      delr2[2] = x[k][2] - x[i][2];
+      rsq2 = delr2[0]*delr2[0] + delr2[1]*delr2[1] + delr2[2]*delr2[2];
+
+      threebody(&params[ijparam],&params[ikparam],&params[ijkparam],
+                rsq1,rsq2,delr1,delr2,fj,fk,1,evdwl);
+      energy += evdwl;
+    }
+  }
+
+  return energy;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void PairSW::allocate()
@@ -33,6 +33,7 @@ class PairSW : public Pair {
   virtual void coeff(int, char **);
   virtual double init_one(int, int);
   virtual void init_style();
+  virtual double energy_local(int, int, int *);
 
   struct Param {
     double epsilon,sigma;
@@ -58,7 +59,12 @@ class PairSW : public Pair {
   int maxshort;                 // size of short neighbor list array
   int *neighshort;              // short neighbor list array
 
+  int maxcache;                 // size of cached short neighbor terms
+  int *elemshort;               // element of each short neighbor
+  double **cacheshort;          // per-neighbor terms of short list
+
   virtual void allocate();
+  void grow_cache(int);
   void read_file(char *);
   virtual void setup_params();
   void twobody(Param *, double, double &, int, double &);
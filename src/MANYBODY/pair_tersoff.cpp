@@ -39,6 +39,11 @@ using namespace MathSpecial;
 #define MAXLINE 1024
 #define DELTA 4
 
+// per-neighbor terms cached in cacheshort
+
+enum{DELX,DELY,DELZ,RSQ,RIJ,HATX,HATY,HATZ,FC,DFC,
+     COSTHETA,GIJK,EXDELR,FX,FY,FZ,NCACHE};
+
 /* ---------------------------------------------------------------------- */
 
 PairTersoff::PairTersoff(LAMMPS *lmp) : Pair(lmp)
@@ -47,6 +52,7 @@ PairTersoff::PairTersoff(LAMMPS *lmp) : Pair(lmp)
   restartinfo = 0;
   one_coeff = 1;
   manybody_flag = 1;
+  local_energy_enable = 1;
 
   nelements = 0;
   elements = NULL;
@@ -57,6 +63,12 @@ PairTersoff::PairTersoff(LAMMPS *lmp) : Pair(lmp)
 
   maxshort = 10;
   neighshort = NULL;
+
+  cache_enable = 1;
+  cacheflag = 0;
+  maxcache = 0;
+  elemshort = NULL;
+  cacheshort = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -79,6 +91,9 @@ PairTersoff::~PairTersoff()
     memory->destroy(neighshort);
     delete [] map;
   }
+
+  memory->destroy(elemshort);
+  memory->destroy(cacheshort);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -97,6 +112,15 @@ void PairTersoff::compute(int eflag, int vflag)
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
+  // use per-neighbor terms cached once per atom, if possible
+
+  if (cacheflag) {
+    if (evflag) eval_cached<1>(eflag);
+    else eval_cached<0>(eflag);
+    if (vflag_fdotr) virial_fdotr_compute();
+    return;
+  }
+
   double **x = atom->x;
   double **f = atom->f;
   tagint *tag = atom->tag;
@@ -264,6 +288,361 @@ void PairTersoff::compute(int eflag, int vflag)
   if (vflag_fdotr) virial_fdotr_compute();
 }
 
+/* ----------------------------------------------------------------------
+   compute with per-neighbor terms of atom I computed once
+   short list holds neighbors within the I-J cutoff along with
+     distance, unit vector, and cutoff function and its derivative
+   angular and radial terms of each triplet computed in the zeta loop
+     are reused in the force loop
+   inner loops over K only read cached arrays and accumulate forces
+     on K in the cache, so they can be vectorized
+------------------------------------------------------------------------- */
+
+template <int EVFLAG>
+void PairTersoff::eval_cached(int eflag)
+{
+  int i,j,k,ii,jj,kk,inum,jnum,numshort;
+  int itype,jtype,iparam_ij;
+  tagint itag,jtag;
+  double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
+  double rsq,r,rinv,zeta_ij,prefactor;
+  double fxtmp,fytmp,fztmp,fjxtmp,fjytmp,fjztmp;
+  double delr1[3],delr2[3],fj[3],fk[3];
+  int *ilist,*jlist,*numneigh,**firstneigh;
+
+  evdwl = 0.0;
+
+  double **x = atom->x;
+  double **f = atom->f;
+  tagint *tag = atom->tag;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over full neighbor list of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    itag = tag[i];
+    itype = map[type[i]];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    fxtmp = fytmp = fztmp = 0.0;
+
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (jnum > maxcache) grow_cache(jnum);
+
+    double * const cdelx = cacheshort[DELX];
+    double * const cdely = cacheshort[DELY];
+    double * const cdelz = cacheshort[DELZ];
+    double * const crsq = cacheshort[RSQ];
+    double * const crij = cacheshort[RIJ];
+    double * const chatx = cacheshort[HATX];
+    double * const chaty = cacheshort[HATY];
+    double * const chatz = cacheshort[HATZ];
+    double * const cfc = cacheshort[FC];
+    double * const cdfc = cacheshort[DFC];
+    double * const ccos = cacheshort[COSTHETA];
+    double * const cgijk = cacheshort[GIJK];
+    double * const cexdelr = cacheshort[EXDELR];
+    double * const cfx = cacheshort[FX];
+    double * const cfy = cacheshort[FY];
+    double * const cfz = cacheshort[FZ];
+
+    // two-body interactions, skip half of them
+    // store neighbors within I-J cutoff and their terms in short list
+
+    numshort = 0;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+
+      jtype = map[type[j]];
+      iparam_ij = elem2param[itype][jtype][jtype];
+      if (rsq >= params[iparam_ij].cutsq) continue;
+
+      r = sqrt(rsq);
+      rinv = 1.0/r;
+      neighshort[numshort] = j;
+      elemshort[numshort] = jtype;
+      cdelx[numshort] = -delx;
+      cdely[numshort] = -dely;
+      cdelz[numshort] = -delz;
+      crsq[numshort] = rsq;
+      crij[numshort] = r;
+      chatx[numshort] = -delx*rinv;
+      chaty[numshort] = -dely*rinv;
+      chatz[numshort] = -delz*rinv;
+      cfc[numshort] = ters_fc(r,&params[iparam_ij]);
+      cdfc[numshort] = ters_fc_d(r,&params[iparam_ij]);
+      cfx[numshort] = cfy[numshort] = cfz[numshort] = 0.0;
+      numshort++;
+
+      jtag = tag[j];
+      if (itag > jtag) {
+        if ((itag+jtag) % 2 == 0) continue;
+      } else if (itag < jtag) {
+        if ((itag+jtag) % 2 == 1) continue;
+      } else {
+        if (x[j][2] < ztmp) continue;
+        if (x[j][2] == ztmp && x[j][1] < ytmp) continue;
+        if (x[j][2] == ztmp && x[j][1] == ytmp && x[j][0] < xtmp) continue;
+      }
+
+      repulsive(&params[iparam_ij],rsq,fpair,eflag,evdwl);
+
+      fxtmp += delx*fpair;
+      fytmp += dely*fpair;
+      fztmp += delz*fpair;
+      f[j][0] -= delx*fpair;
+      f[j][1] -= dely*fpair;
+      f[j][2] -= delz*fpair;
+
+      if (EVFLAG) ev_tally(i,j,nlocal,newton_pair,
+                           evdwl,0.0,fpair,delx,dely,delz);
+    }
+
+    // three-body interactions
+
+    for (jj = 0; jj < numshort; jj++) {
+      j = neighshort[jj];
+      jtype = elemshort[jj];
+      iparam_ij = elem2param[itype][jtype][jtype];
+      const int * const elem2param_ij = elem2param[itype][jtype];
+      const double rij = crij[jj];
+      const double hjx = chatx[jj];
+      const double hjy = chaty[jj];
+      const double hjz = chatz[jj];
+
+      // accumulate bondorder zeta for each i-j interaction via loop over k
+
+      zeta_ij = 0.0;
+
+      for (kk = 0; kk < numshort; kk++) {
+        if (jj == kk) continue;
+        const Param * const param = &params[elem2param_ij[elemshort[kk]]];
+        const double costheta = hjx*chatx[kk] + hjy*chaty[kk] + hjz*chatz[kk];
+        double arg = param->lam3 * (rij-crij[kk]);
+        if (param->powermint == 3) arg = cube(arg);
+
+        double ex_delr;
+        if (arg > 69.0776) ex_delr = 1.e30;
+        else if (arg < -69.0776) ex_delr = 0.0;
+        else ex_delr = exp(arg);
+
+        const double gijk = ters_gijk(costheta,param);
+        ccos[kk] = costheta;
+        cgijk[kk] = gijk;
+        cexdelr[kk] = ex_delr;
+        zeta_ij += cfc[kk] * gijk * ex_delr;
+      }
+
+      // pairwise force due to zeta
+
+      force_zeta(&params[iparam_ij],crsq[jj],zeta_ij,fpair,prefactor,
+                 eflag,evdwl);
+
+      delr1[0] = cdelx[jj];
+      delr1[1] = cdely[jj];
+      delr1[2] = cdelz[jj];
+
+      fxtmp += delr1[0]*fpair;
+      fytmp += delr1[1]*fpair;
+      fztmp += delr1[2]*fpair;
+      fjxtmp = -delr1[0]*fpair;
+      fjytmp = -delr1[1]*fpair;
+      fjztmp = -delr1[2]*fpair;
+
+      if (EVFLAG) ev_tally(i,j,nlocal,newton_pair,
+                           evdwl,0.0,-fpair,-delr1[0],-delr1[1],-delr1[2]);
+
+      // attractive term via loop over k
+      // same as ters_zetaterm_d() with cached terms
+
+      const double rijinv = 1.0/rij;
+
+      for (kk = 0; kk < numshort; kk++) {
+        if (jj == kk) continue;
+        const Param * const param = &params[elem2param_ij[elemshort[kk]]];
+        const double rik = crij[kk];
+        const double hkx = chatx[kk];
+        const double hky = chaty[kk];
+        const double hkz = chatz[kk];
+        const double costheta = ccos[kk];
+        const double gijk = cgijk[kk];
+        const double gijk_d = ters_gijk_d(costheta,param);
+        const double ex_delr = cexdelr[kk];
+        double ex_delr_d;
+        if (param->powermint == 3)
+          ex_delr_d = 3.0*cube(param->lam3) * square(rij-rik)*ex_delr;
+        else ex_delr_d = param->lam3 * ex_delr;
+
+        const double fc = cfc[kk];
+        const double rikinv = 1.0/rik;
+        const double dfc_gex = prefactor * cdfc[kk]*gijk*ex_delr;
+        const double fc_gdex = prefactor * fc*gijk_d*ex_delr;
+        const double fc_gexd = prefactor * fc*gijk*ex_delr_d;
+
+        // derivatives of cos(theta) wrt Rj and Rk, that wrt Ri is -(sum)
+
+        const double dcosjx = (hkx - costheta*hjx) * rijinv;
+        const double dcosjy = (hky - costheta*hjy) * rijinv;
+        const double dcosjz = (hkz - costheta*hjz) * rijinv;
+        const double dcoskx = (hjx - costheta*hkx) * rikinv;
+        const double dcosky = (hjy - costheta*hky) * rikinv;
+        const double dcoskz = (hjz - costheta*hkz) * rikinv;
+
+        const double fjx = fc_gdex*dcosjx + fc_gexd*hjx;
+        const double fjy = fc_gdex*dcosjy + fc_gexd*hjy;
+        const double fjz = fc_gdex*dcosjz + fc_gexd*hjz;
+        const double fkx = (dfc_gex - fc_gexd)*hkx + fc_gdex*dcoskx;
+        const double fky = (dfc_gex - fc_gexd)*hky + fc_gdex*dcosky;
+        const double fkz = (dfc_gex - fc_gexd)*hkz + fc_gdex*dcoskz;
+
+        fxtmp -= fjx + fkx;
+        fytmp -= fjy + fky;
+        fztmp -= fjz + fkz;
+        fjxtmp += fjx;
+        fjytmp += fjy;
+        fjztmp += fjz;
+        cfx[kk] += fkx;
+        cfy[kk] += fky;
+        cfz[kk] += fkz;
+
+        if (EVFLAG && vflag_atom) {
+          fj[0] = fjx; fj[1] = fjy; fj[2] = fjz;
+          fk[0] = fkx; fk[1] = fky; fk[2] = fkz;
+          delr2[0] = cdelx[kk];
+          delr2[1] = cdely[kk];
+          delr2[2] = cdelz[kk];
+          v_tally3(i,j,neighshort[kk],fj,fk,delr1,delr2);
+        }
+      }
+
+      cfx[jj] += fjxtmp;
+      cfy[jj] += fjytmp;
+      cfz[jj] += fjztmp;
+    }
+
+    // apply forces accumulated on short neighbors
+
+    for (kk = 0; kk < numshort; kk++) {
+      k = neighshort[kk];
+      f[k][0] += cfx[kk];
+      f[k][1] += cfy[kk];
+      f[k][2] += cfz[kk];
+    }
+
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   grow cached short neighbor terms to hold N neighbors
+------------------------------------------------------------------------- */
+
+void PairTersoff::grow_cache(int n)
+{
+  maxcache = n + n/2;
+  memory->destroy(elemshort);
+  memory->destroy(cacheshort);
+  memory->create(elemshort,maxcache,"pair:elemshort");
+  memory->create(cacheshort,NCACHE,maxcache,"pair:cacheshort");
+  if (maxcache > maxshort) {
+    maxshort = maxcache;
+    memory->grow(neighshort,maxshort,"pair:neighshort");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   energy of atom I from its full list of neighbors
+   repulsive terms are split evenly between both atoms,
+   bond-order terms belong to atom I
+------------------------------------------------------------------------- */
+
+double PairTersoff::energy_local(int i, int jnum, int *jlist)
+{
+  int j,k,jj,kk,itype,jtype,ktype,iparam_ij,iparam_ijk;
+  double rsq1,rsq2,zeta_ij,fpair,prefactor,evdwl;
+  double delr1[3],delr2[3];
+
+  double **x = atom->x;
+  int *type = atom->type;
+  const double cutshortsq = cutmax*cutmax;
+
+  itype = map[type[i]];
+  if (itype < 0) return 0.0;
+
+  int numshort = 0;
+  for (jj = 0; jj < jnum; jj++) {
+    j = jlist[jj];
+    delr1[0] = x[j][0] - x[i][0];
+    delr1[1] = x[j][1] - x[i][1];
+    delr1[2] = x[j][2] - x[i][2];
+    rsq1 = delr1[0]*delr1[0] + delr1[1]*delr1[1] + delr1[2]*delr1[2];
+    if (rsq1 < cutshortsq) {
+      neighshort[numshort++] = j;
+      if (numshort >= maxshort) {
+        maxshort += maxshort/2;
+        memory->grow(neighshort,maxshort,"pair:neighshort");
+      }
+    }
+  }
+
+  double energy = 0.0;
+
+  for (jj = 0; jj < numshort; jj++) {
+    j = neighshort[jj];
+    jtype = map[type[j]];
+    iparam_ij = elem2param[itype][jtype][jtype];
+
+    delr1[0] = x[j][0] - x[i][0];
+    delr1[1] = x[j][1] - x[i][1];
+    delr1[2] = x[j][2] - x[i][2];
+    rsq1 = delr1[0]*delr1[0] + delr1[1]*delr1[1] + delr1[2]*delr1[2];
+    if (rsq1 >= params[iparam_ij].cutsq) continue;
+
+    repulsive(&params[iparam_ij],rsq1,fpair,1,evdwl);
+    energy += 0.5*evdwl;
+
+    zeta_ij = 0.0;
+    for (kk = 0; kk < numshort; kk++) {
+      if (jj == kk) continue;
+      k = neighshort[kk];
+      ktype = map[type[k]];
+      iparam_ijk = elem2param[itype][jtype][ktype];
+
+      delr2[0] = x[k][0] - x[i][0];
+      delr2[1] = x[k][1] - x[i][1];
+      delr2[2] = x[k][2] - x[i][2];
+      rsq2 = delr2[0]*delr2[0] + delr2[1]*delr2[1] + delr2[2]*delr2[2];
+      if (rsq2 >= params[iparam_ijk].cutsq) continue;
+
+      zeta_ij += zeta(&params[iparam_ijk],rsq1,rsq2,delr1,delr2);
+    }
+
+    force_zeta(&params[iparam_ij],rsq1,zeta_ij,fpair,prefactor,1,evdwl);
+    energy += evdwl;
+  }
+
+  return energy;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void PairTersoff::allocate()
@@ -577,6 +956,19 @@ void PairTersoff::setup_params()
   cutmax = 0.0;
   for (m = 0; m < nparams; m++)
     if (params[m].cut > cutmax) cutmax = params[m].cut;
+
+  // cached terms of neighbor K of atom I can be used for any J
+  //   if the I-J-K cutoff is the same as the I-K-K cutoff
+
+  cacheflag = cache_enable;
+  for (i = 0; i < nelements; i++)
+    for (j = 0; j < nelements; j++)
+      for (k = 0; k < nelements; k++) {
+        Param *pijk = &params[elem2param[i][j][k]];
+        Param *pikk = &params[elem2param[i][k][k]];
+        if (pijk->bigr != pikk->bigr || pijk->bigd != pikk->bigd)
+          cacheflag = 0;
+      }
 }
 
 /* ---------------------------------------------------------------------- */
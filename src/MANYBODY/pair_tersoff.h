@@ -33,6 +33,7 @@ class PairTersoff : public Pair {
   void coeff(int, char **);
   virtual void init_style();
   double init_one(int, int);
+  virtual double energy_local(int, int, int *);
 
  protected:
   struct Param {
@@ -63,6 +64,12 @@ class PairTersoff : public Pair {
   int maxshort;                 // size of short neighbor list array
   int *neighshort;              // short neighbor list array
 
+  int cache_enable;             // 1 if this style supports cached terms
+  int cacheflag;                // 1 if compute() uses cached terms
+  int maxcache;                 // size of cached short neighbor terms
+  int *elemshort;               // element of each short neighbor
+  double **cacheshort;          // per-neighbor terms of short list
+
   virtual void allocate();
   virtual void read_file(char *);
   virtual void setup_params();
@@ -85,6 +92,9 @@ class PairTersoff : public Pair {
   void costheta_d(double *, double, double *, double,
                   double *, double *, double *);
 
+  template <int EVFLAG> void eval_cached(int);
+  void grow_cache(int);
+
   // inlined functions for efficiency
 
   inline double ters_gijk(const double costheta,
@@ -38,7 +38,13 @@ using namespace MathSpecial;
 
 /* ---------------------------------------------------------------------- */
 
-PairTersoffMOD::PairTersoffMOD(LAMMPS *lmp) : PairTersoff(lmp) {}
+PairTersoffMOD::PairTersoffMOD(LAMMPS *lmp) : PairTersoff(lmp)
+{
+  // zeta() and cutoff function differ from Tersoff,
+  //   so always use the generic compute()
+
+  cache_enable = 0;
+}
 
 /* ---------------------------------------------------------------------- */
 
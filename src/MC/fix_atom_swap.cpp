@@ -42,6 +42,7 @@
 #include "memory.h"
 #include "error.h"
 #include "neighbor.h"
+#include "local_energy.h"
 
 using namespace LAMMPS_NS;
 using namespace FixConst;
@@ -53,7 +54,7 @@ FixAtomSwap::FixAtomSwap(LAMMPS *lmp, int narg, char **arg) :
   idregion(NULL), type_list(NULL), mu(NULL), qtype(NULL),
   sqrt_mass_ratio(NULL), local_swap_iatom_list(NULL),
   local_swap_jatom_list(NULL), local_swap_atom_list(NULL),
-  random_equal(NULL), random_unequal(NULL), c_pe(NULL)
+  random_equal(NULL), random_unequal(NULL), c_pe(NULL), local(NULL)
 {
   if (narg < 10) error->all(FLERR,"Illegal fix atom/swap command");
 
@@ -127,6 +128,9 @@ void FixAtomSwap::options(int narg, char **arg)
   regionflag = 0;
   conserve_ke_flag = 1;
   semi_grand_flag = 0;
+  kspace_incr_flag = 1;
+  full_flag = false;
+  kspace_mc_flag = 0;
   nswaptypes = 0;
   nmutypes = 0;
   iregion = -1;
@@ -155,6 +159,15 @@ void FixAtomSwap::options(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"yes") == 0) semi_grand_flag = 1;
       else error->all(FLERR,"Illegal fix atom/swap command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"kspace_incremental") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix atom/swap command");
+      if (strcmp(arg[iarg+1],"no") == 0) kspace_incr_flag = 0;
+      else if (strcmp(arg[iarg+1],"yes") == 0) kspace_incr_flag = 1;
+      else error->all(FLERR,"Illegal fix atom/swap command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"full_energy") == 0) {
+      full_flag = true;
+      iarg += 1;
     } else if (strcmp(arg[iarg],"types") == 0) {
       if (iarg+3 > narg) error->all(FLERR,"Illegal fix atom/swap command");
       iarg++;
@@ -190,6 +203,7 @@ FixAtomSwap::~FixAtomSwap()
   if (regionflag) delete [] idregion;
   delete random_equal;
   delete random_unequal;
+  delete local;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -258,6 +272,45 @@ void FixAtomSwap::init()
     }
   }
 
+  // kspace energy of swaps via update of cached structure factors
+  // instead of a full kspace evaluation, if supported by kspace style
+
+  kspace_mc_flag = 0;
+  if (kspace_incr_flag && force->kspace && force->kspace->mcflag &&
+      atom->q_flag) kspace_mc_flag = 1;
+
+  // decide whether to use local energies around swapped atoms
+  // requires a pair style with single() or a local energy routine,
+  //   no bonded topology or fix energies, and incremental kspace energies
+  // many-body styles also need ghost atoms within 2x the pair cutoff
+
+  local_flag = 0;
+  if (!full_flag) {
+    Pair *pair = force->pair;
+    int flag = 1;
+    if (pair == NULL || force->pair_match("^hybrid",0) ||
+        pair->tail_flag || atom->molecular || !atom->tag_enable) flag = 0;
+    else if (pair->manybody_flag && !pair->local_energy_enable) flag = 0;
+    else if (!pair->manybody_flag && !pair->single_enable) flag = 0;
+    else if (force->kspace && !kspace_mc_flag) flag = 0;
+    for (int ifix = 0; ifix < modify->nfix; ifix++)
+      if (modify->fix[ifix]->thermo_energy) flag = 0;
+
+    if (flag) {
+      if (local == NULL) local = new LocalEnergy(lmp);
+      local->init(0.0);
+      double cutghost = MAX(pair->cutforce + neighbor->skin,
+                            comm->cutghostuser);
+      if (pair->manybody_flag && cutghost < local->cutghost_min()) {
+        flag = 0;
+        if (comm->me == 0)
+          error->warning(FLERR,"Fix atom/swap local energies need a larger "
+                         "ghost cutoff, see comm_modify cutoff");
+      }
+    }
+    local_flag = flag;
+  }
+
   memory->create(sqrt_mass_ratio,atom->ntypes+1,atom->ntypes+1,"atom/swap:sqrt_mass_ratio");
   for (int itype = 1; itype <= atom->ntypes; itype++)
     for (int jtype = 1; jtype <= atom->ntypes; jtype++)
@@ -311,21 +364,33 @@ void FixAtomSwap::pre_exchange()
   if (modify->n_pre_neighbor) modify->pre_neighbor();
   neighbor->build(1);
 
-  energy_stored = energy_full();
+  if (kspace_mc_flag) force->kspace->mc_setup();
 
   int nsuccess = 0;
-  if (semi_grand_flag) {
-    update_semi_grand_atoms_list();
-    for (int i = 0; i < ncycles; i++) nsuccess += attempt_semi_grand();
+  if (local_flag) {
+    local->setup();
+    if (semi_grand_flag) {
+      update_semi_grand_atoms_list();
+      for (int i = 0; i < ncycles; i++) nsuccess += attempt_semi_grand_local();
+    } else {
+      update_swap_atoms_list();
+      for (int i = 0; i < ncycles; i++) nsuccess += attempt_swap_local();
+    }
   } else {
-    update_swap_atoms_list();
-    for (int i = 0; i < ncycles; i++) nsuccess += attempt_swap();
+    energy_stored = energy_full();
+    if (semi_grand_flag) {
+      update_semi_grand_atoms_list();
+      for (int i = 0; i < ncycles; i++) nsuccess += attempt_semi_grand();
+    } else {
+      update_swap_atoms_list();
+      for (int i = 0; i < ncycles; i++) nsuccess += attempt_swap();
+    }
+    energy_full();
   }
 
   nswap_attempts += ncycles;
   nswap_successes += nsuccess;
 
-  energy_full();
   next_reneighbor = update->ntimestep + nevery;
 }
 
@@ -379,6 +444,7 @@ int FixAtomSwap::attempt_semi_grand()
   if (success_all) {
     update_semi_grand_atoms_list();
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
     if (conserve_ke_flag) {
       if (i >= 0) {
         atom->v[i][0] *= sqrt_mass_ratio[itype][jtype];
@@ -392,6 +458,7 @@ int FixAtomSwap::attempt_semi_grand()
       atom->type[i] = itype;
     }
     if (force->kspace) force->kspace->qsum_qsq();
+    if (kspace_mc_flag) force->kspace->mc_reject();
     energy_stored = energy_before;
 
     if (unequal_cutoffs) {
@@ -427,10 +494,18 @@ int FixAtomSwap::attempt_swap()
   if (i >= 0) {
     atom->type[i] = jtype;
     if (atom->q_flag) atom->q[i] = qtype[1];
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(qtype[0],atom->x[i]);
+      force->kspace->mc_add(qtype[1],atom->x[i]);
+    }
   }
   if (j >= 0) {
     atom->type[j] = itype;
     if (atom->q_flag) atom->q[j] = qtype[0];
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(qtype[1],atom->x[j]);
+      force->kspace->mc_add(qtype[0],atom->x[j]);
+    }
   }
 
   if (unequal_cutoffs) {
@@ -451,6 +526,7 @@ int FixAtomSwap::attempt_swap()
       exp(beta*(energy_before - energy_after))) {
     update_swap_atoms_list();
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
     if (conserve_ke_flag) {
       if (i >= 0) {
         atom->v[i][0] *= sqrt_mass_ratio[itype][jtype];
@@ -465,6 +541,7 @@ int FixAtomSwap::attempt_swap()
     }
     return 1;
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     if (i >= 0) {
       atom->type[i] =  type_list[0];
       if (atom->q_flag) atom->q[i] = qtype[0];
@@ -490,6 +567,163 @@ int FixAtomSwap::attempt_swap()
   return 0;
 }
 
+/* ----------------------------------------------------------------------
+   semi-grand move using local energy change of the retyped atom
+   atom charges are not changed by semi-grand moves
+------------------------------------------------------------------------- */
+
+int FixAtomSwap::attempt_semi_grand_local()
+{
+  if (nswap == 0) return 0;
+
+  int itype,jtype,jswaptype;
+  int i = pick_semi_grand_atom();
+  int success = 0;
+  if (i >= 0) {
+    jswaptype = static_cast<int> (nswaptypes*random_unequal->uniform());
+    jtype = type_list[jswaptype];
+    itype = atom->type[i];
+    while (itype == jtype) {
+      jswaptype = static_cast<int> (nswaptypes*random_unequal->uniform());
+      jtype = type_list[jswaptype];
+    }
+
+    double qi = atom->q_flag ? atom->q[i] : 0.0;
+    double xi[3];
+    xi[0] = atom->x[i][0];
+    xi[1] = atom->x[i][1];
+    xi[2] = atom->x[i][2];
+    double energy_change = local->energy(i,jtype,qi,xi) -
+      local->energy(i,itype,qi,xi);
+
+    if (random_unequal->uniform() <
+        exp(beta*(mu[jtype] - mu[itype] - energy_change))) success = 1;
+  }
+
+  int success_all = 0;
+  MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
+  if (!success_all) return 0;
+
+  if (i >= 0) {
+    atom->type[i] = jtype;
+    if (conserve_ke_flag) {
+      atom->v[i][0] *= sqrt_mass_ratio[itype][jtype];
+      atom->v[i][1] *= sqrt_mass_ratio[itype][jtype];
+      atom->v[i][2] *= sqrt_mass_ratio[itype][jtype];
+    }
+  }
+
+  local_comm();
+  update_semi_grand_atoms_list();
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   swap move using local energy changes of the two swapped atoms
+   energy change of J is evaluated after I has been retyped
+------------------------------------------------------------------------- */
+
+int FixAtomSwap::attempt_swap_local()
+{
+  if ((niswap == 0) || (njswap == 0)) return 0;
+
+  int i = pick_i_swap_atom();
+  int j = pick_j_swap_atom();
+  int itype = type_list[0];
+  int jtype = type_list[1];
+  double qi = atom->q_flag ? qtype[0] : 0.0;
+  double qj = atom->q_flag ? qtype[1] : 0.0;
+  double xtmp[3];
+
+  double energy_change = 0.0;
+  if (i >= 0) {
+    xtmp[0] = atom->x[i][0];
+    xtmp[1] = atom->x[i][1];
+    xtmp[2] = atom->x[i][2];
+    energy_change += local->energy(i,jtype,qj,xtmp) -
+      local->energy(i,itype,qi,xtmp);
+    atom->type[i] = jtype;
+    if (atom->q_flag) atom->q[i] = qj;
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(qi,atom->x[i]);
+      force->kspace->mc_add(qj,atom->x[i]);
+    }
+  }
+
+  local_comm();
+
+  if (j >= 0) {
+    xtmp[0] = atom->x[j][0];
+    xtmp[1] = atom->x[j][1];
+    xtmp[2] = atom->x[j][2];
+    energy_change += local->energy(j,itype,qi,xtmp) -
+      local->energy(j,jtype,qj,xtmp);
+    atom->type[j] = itype;
+    if (atom->q_flag) atom->q[j] = qi;
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(qj,atom->x[j]);
+      force->kspace->mc_add(qi,atom->x[j]);
+    }
+  }
+
+  double energy_change_all;
+  MPI_Allreduce(&energy_change,&energy_change_all,1,MPI_DOUBLE,MPI_SUM,world);
+  if (kspace_mc_flag) energy_change_all += force->kspace->mc_energy_change();
+
+  int success = 0;
+  if (random_equal->uniform() < exp(-beta*energy_change_all)) success = 1;
+
+  if (success) {
+    if (kspace_mc_flag) force->kspace->mc_accept();
+    if (conserve_ke_flag) {
+      if (i >= 0) {
+        atom->v[i][0] *= sqrt_mass_ratio[itype][jtype];
+        atom->v[i][1] *= sqrt_mass_ratio[itype][jtype];
+        atom->v[i][2] *= sqrt_mass_ratio[itype][jtype];
+      }
+      if (j >= 0) {
+        atom->v[j][0] *= sqrt_mass_ratio[jtype][itype];
+        atom->v[j][1] *= sqrt_mass_ratio[jtype][itype];
+        atom->v[j][2] *= sqrt_mass_ratio[jtype][itype];
+      }
+    }
+  } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
+    if (i >= 0) {
+      atom->type[i] = itype;
+      if (atom->q_flag) atom->q[i] = qi;
+    }
+    if (j >= 0) {
+      atom->type[j] = jtype;
+      if (atom->q_flag) atom->q[j] = qj;
+    }
+  }
+
+  local_comm();
+  if (success) update_swap_atoms_list();
+  return success;
+}
+
+/* ----------------------------------------------------------------------
+   update ghost atoms after atom types changed, rebuild local energy bins
+     if ghost atoms were recreated
+------------------------------------------------------------------------- */
+
+void FixAtomSwap::local_comm()
+{
+  if (unequal_cutoffs) {
+    if (domain->triclinic) domain->x2lamda(atom->nlocal);
+    domain->pbc();
+    comm->exchange();
+    comm->borders();
+    if (domain->triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
+    if (modify->n_pre_neighbor) modify->pre_neighbor();
+    local->setup();
+  } else {
+    comm->forward_comm_fix(this);
+  }
+}
+
 /* ----------------------------------------------------------------------
    compute system potential energy
 ------------------------------------------------------------------------- */
@@ -511,7 +745,8 @@ double FixAtomSwap::energy_full()
     if (force->improper) force->improper->compute(eflag,vflag);
   }
 
-  if (force->kspace) force->kspace->compute(eflag,vflag);
+  if (kspace_mc_flag) force->kspace->mc_energy_change();
+  else if (force->kspace) force->kspace->compute(eflag,vflag);
 
   if (modify->n_post_force) modify->post_force(vflag);
   if (modify->n_end_of_step) modify->end_of_step();
@@ -33,6 +33,8 @@ class FixAtomSwap : public Fix {
   void pre_exchange();
   int attempt_semi_grand();
   int attempt_swap();
+  int attempt_semi_grand_local();
+  int attempt_swap_local();
   double energy_full();
   int pick_semi_grand_atom();
   int pick_i_swap_atom();
@@ -50,6 +52,10 @@ class FixAtomSwap : public Fix {
   int nevery,seed;
   int conserve_ke_flag;                   // yes = conserve ke, no = do not conserve ke
   int semi_grand_flag;                    // yes = semi-grand canonical, no = constant composition
+  int kspace_incr_flag;                   // yes = allow incremental kspace energies
+  int kspace_mc_flag;                     // 1 if kspace energy of swaps is incremental
+  bool full_flag;                         // true if full_energy option used
+  int local_flag;                         // 1 if energy changes are local
   int ncycles;
   int niswap,njswap;                      // # of i,j swap atoms on all procs
   int niswap_local,njswap_local;          // # of swap atoms on this proc
@@ -83,8 +89,10 @@ class FixAtomSwap : public Fix {
   class RanPark *random_unequal;
 
   class Compute *c_pe;
+  class LocalEnergy *local;
 
   void options(int, char **);
+  void local_comm();
 };
 
 }
@@ -136,6 +144,11 @@ E: All atoms of a swapped type must have same charge.
 
 Self-explanatory.
 
+W: Fix atom/swap local energies need a larger ghost cutoff, see comm_modify cutoff
+
+Local energies of many-body pair styles need ghost atoms within twice
+the pair cutoff.  The full_energy option is used instead.
+
 E: Cannot do atom/swap on atoms in atom_modify first group
 
 This is a restriction due to the way atoms are organized in a list to
@@ -43,6 +43,7 @@
 #include "memory.h"
 #include "error.h"
 #include "neighbor.h"
+#include "local_energy.h"
 
 using namespace LAMMPS_NS;
 using namespace FixConst;
@@ -68,7 +69,7 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
   Fix(lmp, narg, arg),
   idregion(NULL), full_flag(0), ngroups(0), groupstrings(NULL), ngrouptypes(0), grouptypestrings(NULL),
   grouptypebits(NULL), grouptypes(NULL), local_gas_list(NULL), molcoords(NULL), molq(NULL), molimage(NULL),
-  random_equal(NULL), random_unequal(NULL),
+  random_equal(NULL), random_unequal(NULL), random_parallel(NULL), local(NULL),
   fixrigid(NULL), fixshake(NULL), idrigid(NULL), idshake(NULL)
 {
   if (narg < 11) error->all(FLERR,"Illegal fix gcmc command");
@@ -116,6 +117,10 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
 
   random_unequal = new RanPark(lmp,seed);
 
+  // random number generator for concurrent moves, different on each proc
+
+  random_parallel = new RanPark(lmp,seed + comm->me);
+
   // error checks on region and its extent being inside simulation box
 
   region_xlo = region_xhi = region_ylo = region_yhi =
@@ -220,6 +225,11 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
 
   gcmc_nmax = 0;
   local_gas_list = NULL;
+
+  maxtrial = 0;
+  trial_list = NULL;
+  trial_deferred = NULL;
+  trial_all = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -256,6 +266,12 @@ void FixGCMC::options(int narg, char **arg)
   charge = 0.0;
   charge_flag = false;
   full_flag = false;
+  kspace_incr_flag = true;
+  kspace_mc_flag = 0;
+  local_flag = 0;
+  parallel_flag = true;
+  parallel_mc_flag = 0;
+  cutinterior = 0.0;
   ngroups = 0;
   int ngroupsmax = 0;
   groupstrings = NULL;
@@ -344,6 +360,18 @@ void FixGCMC::options(int narg, char **arg)
     } else if (strcmp(arg[iarg],"full_energy") == 0) {
       full_flag = true;
       iarg += 1;
+    } else if (strcmp(arg[iarg],"kspace_incremental") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix gcmc command");
+      if (strcmp(arg[iarg+1],"no") == 0) kspace_incr_flag = false;
+      else if (strcmp(arg[iarg+1],"yes") == 0) kspace_incr_flag = true;
+      else error->all(FLERR,"Illegal fix gcmc command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"parallel_moves") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix gcmc command");
+      if (strcmp(arg[iarg+1],"no") == 0) parallel_flag = false;
+      else if (strcmp(arg[iarg+1],"yes") == 0) parallel_flag = true;
+      else error->all(FLERR,"Illegal fix gcmc command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"group") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix gcmc command");
       if (ngroups >= ngroupsmax) {
@@ -408,8 +436,13 @@ FixGCMC::~FixGCMC()
   if (regionflag) delete [] idregion;
   delete random_equal;
   delete random_unequal;
+  delete random_parallel;
+  delete local;
 
   memory->destroy(local_gas_list);
+  memory->destroy(trial_list);
+  memory->destroy(trial_deferred);
+  memory->destroy(trial_all);
   memory->destroy(molcoords);
   memory->destroy(molq);
   memory->destroy(molimage);
@@ -477,9 +510,56 @@ void FixGCMC::init()
     pmolrotate /= pmctot;
   }
 
-  // decide whether to switch to the full_energy option
+  // decide whether to use local energies around moved atoms
+  // requires atom moves and exchanges, a pair style with single()
+  //   or a local energy routine, and incremental kspace energies
+  // many-body styles also need ghost atoms within 2x the pair cutoff
+  //   plus the displacement
 
+  local_flag = 0;
   if (!full_flag) {
+    Pair *pair = force->pair;
+    int flag = 1;
+    if (exchmode != EXCHATOM || movemode != MOVEATOM) flag = 0;
+    else if (pair == NULL || force->pair_match("^hybrid",0) ||
+             pair->tail_flag || !atom->tag_enable) flag = 0;
+    else if (pair->manybody_flag && !pair->local_energy_enable) flag = 0;
+    else if (!pair->manybody_flag && !pair->single_enable) flag = 0;
+    else if (force->kspace && (!kspace_incr_flag || !force->kspace->mcflag ||
+                               !atom->q_flag)) flag = 0;
+
+    if (flag) {
+      if (local == NULL) local = new LocalEnergy(lmp);
+      local->init(overlap_flag ? overlap_cutoffsq : 0.0);
+      double cutghost = MAX(pair->cutforce + neighbor->skin,
+                            comm->cutghostuser);
+      if (pair->manybody_flag &&
+          cutghost < local->cutghost_min() + displace) {
+        flag = 0;
+        if (comm->me == 0)
+          error->warning(FLERR,"Fix gcmc local energies need a larger "
+                         "ghost cutoff, see comm_modify cutoff");
+      }
+    }
+    local_flag = flag;
+  }
+
+  // translations are done concurrently on all procs,
+  //   if there is no kspace coupling of all atoms
+  // moves stay cutinterior away from sub-domain faces,
+  //   so energies of concurrent moves are independent
+
+  parallel_mc_flag = 0;
+  if (local_flag && parallel_flag && !force->kspace && !triclinic &&
+      comm->style == 0) {
+    parallel_mc_flag = 1;
+    if (force->pair->manybody_flag) cutinterior = force->pair->cutforce;
+    else cutinterior = 0.5*force->pair->cutforce;
+  }
+
+  // decide whether to switch to the full_energy option
+
+  if (!full_flag && !local_flag) {
     if ((force->kspace) ||
         (force->pair == NULL) ||
         (force->pair->single_enable == 0) ||
@@ -499,6 +579,13 @@ void FixGCMC::init()
     c_pe = modify->compute[ipe];
   }
 
+  // kspace energy of trial moves via update of cached structure factors
+  // instead of a full kspace evaluation, if supported by kspace style
+
+  kspace_mc_flag = 0;
+  if ((full_flag || local_flag) && kspace_incr_flag && force->kspace &&
+      force->kspace->mcflag && atom->q_flag) kspace_mc_flag = 1;
+
   int *type = atom->type;
 
   if (exchmode == EXCHATOM) {
@@ -767,6 +854,7 @@ void FixGCMC::pre_exchange()
   update_gas_atoms_list();
 
   if (full_flag) {
+    if (kspace_mc_flag) force->kspace->mc_setup();
     energy_stored = energy_full();
     if (overlap_flag && energy_stored > MAXENERGYTEST)
         error->warning(FLERR,"Energy of old configuration in "
@@ -797,6 +885,31 @@ void FixGCMC::pre_exchange()
     comm->borders();
     if (triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
 
+  } else if (local_flag) {
+    local->setup();
+    if (kspace_mc_flag) force->kspace->mc_setup();
+
+    // consecutive translations are batched for concurrent moves
+
+    int ntranslations = 0;
+    for (int i = 0; i < ncycles; i++) {
+      int ixm = static_cast<int>(random_equal->uniform()*ncycles) + 1;
+      if (ixm <= nmcmoves) {
+        random_equal->uniform();
+        if (parallel_mc_flag) ntranslations++;
+        else attempt_atomic_translation_local();
+      } else {
+        if (ntranslations) {
+          attempt_atomic_translation_parallel(ntranslations);
+          ntranslations = 0;
+        }
+        double xgcmc = random_equal->uniform();
+        if (xgcmc < 0.5) attempt_atomic_deletion_local();
+        else attempt_atomic_insertion_local();
+      }
+    }
+    if (ntranslations) attempt_atomic_translation_parallel(ntranslations);
+
   } else {
 
     for (int i = 0; i < ncycles; i++) {
@@ -1048,6 +1161,413 @@ void FixGCMC::attempt_atomic_insertion()
   }
 }
 
+/* ----------------------------------------------------------------------
+   translation of one gas atom with local energies
+------------------------------------------------------------------------- */
+
+void FixGCMC::attempt_atomic_translation_local()
+{
+  ntranslation_attempts += 1.0;
+
+  if (ngas == 0) return;
+
+  int i = pick_random_gas_atom();
+
+  double coord[3];
+  if (i >= 0) trial_displacement(i,coord,random_unequal);
+  translate_local(i,coord);
+}
+
+/* ----------------------------------------------------------------------
+   ntrials translations done concurrently by all procs
+   each proc moves its own picks whose old and new positions are
+     cutinterior away from its sub-domain faces, so that no energy
+     depends on moves of two procs
+   other trials are deferred and done one at a time afterwards
+------------------------------------------------------------------------- */
+
+void FixGCMC::attempt_atomic_translation_parallel(int ntrials)
+{
+  ntranslation_attempts += ntrials;
+
+  if (ngas == 0) return;
+
+  if (ntrials > maxtrial) {
+    maxtrial = ntrials;
+    memory->destroy(trial_list);
+    memory->destroy(trial_deferred);
+    memory->create(trial_list,maxtrial,"gcmc:trial_list");
+    memory->create(trial_deferred,4*maxtrial,"gcmc:trial_deferred");
+  }
+
+  // pick gas atoms of all trials up front, same as for serial trials
+
+  int ntrial = 0;
+  for (int k = 0; k < ntrials; k++) {
+    int i = pick_random_gas_atom();
+    if (i >= 0) trial_list[ntrial++] = i;
+  }
+
+  double coord[3],xold[3];
+  int ndeferred = 0;
+  int nsuccess = 0;
+
+  for (int k = 0; k < ntrial; k++) {
+    int i = trial_list[k];
+    double **x = atom->x;
+    trial_displacement(i,coord,random_parallel);
+
+    if (!interior(x[i]) || !interior(coord)) {
+      double *deferred = &trial_deferred[4*ndeferred++];
+      deferred[0] = atom->tag[i];
+      deferred[1] = coord[0] - x[i][0];
+      deferred[2] = coord[1] - x[i][1];
+      deferred[3] = coord[2] - x[i][2];
+      continue;
+    }
+
+    xold[0] = x[i][0];
+    xold[1] = x[i][1];
+    xold[2] = x[i][2];
+    int itype = atom->type[i];
+    double qi = atom->q_flag ? atom->q[i] : 0.0;
+    double energy_before = local->energy(i,itype,qi,xold);
+    double energy_after = local->energy(i,itype,qi,coord);
+    if (local->overlap) continue;
+
+    if (random_parallel->uniform() <
+        exp(beta*(energy_before - energy_after))) {
+      local->move(i,coord);
+      nsuccess++;
+    }
+  }
+
+  int nsuccess_all;
+  MPI_Allreduce(&nsuccess,&nsuccess_all,1,MPI_INT,MPI_SUM,world);
+
+  if (nsuccess_all) {
+    domain->pbc();
+    comm->exchange();
+    atom->nghost = 0;
+    comm->borders();
+    update_gas_atoms_list();
+    local->setup();
+    ntranslation_successes += nsuccess_all;
+  }
+
+  // deferred trials of all procs, one at a time
+  // owner of each atom may have changed, so identify it by tag
+
+  int nprocs = comm->nprocs;
+  int *recvcounts = new int[nprocs];
+  int *displs = new int[nprocs];
+
+  int nsend = 4*ndeferred;
+  MPI_Allgather(&nsend,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  int ntotal = 0;
+  for (int iproc = 0; iproc < nprocs; iproc++) {
+    displs[iproc] = ntotal;
+    ntotal += recvcounts[iproc];
+  }
+  memory->grow(trial_all,MAX(ntotal,1),"gcmc:trial_all");
+  MPI_Allgatherv(trial_deferred,nsend,MPI_DOUBLE,
+                 trial_all,recvcounts,displs,MPI_DOUBLE,world);
+
+  delete [] recvcounts;
+  delete [] displs;
+
+  for (int m = 0; m < ntotal; m += 4) {
+    tagint itag = static_cast<tagint> (trial_all[m]);
+    int i = -1;
+    for (int k = 0; k < ngas_local; k++)
+      if (atom->tag[local_gas_list[k]] == itag) {
+        i = local_gas_list[k];
+        break;
+      }
+
+    if (i >= 0) {
+      double **x = atom->x;
+      coord[0] = x[i][0] + trial_all[m+1];
+      coord[1] = x[i][1] + trial_all[m+2];
+      coord[2] = x[i][2] + trial_all[m+3];
+      if (regionflag &&
+          domain->regions[iregion]->match(coord[0],coord[1],coord[2]) == 0)
+        i = -1;
+      else if (!domain->inside_nonperiodic(coord))
+        error->one(FLERR,"Fix gcmc put atom outside box");
+    }
+    translate_local(i,coord);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   deletion of one gas atom with local energies
+------------------------------------------------------------------------- */
+
+void FixGCMC::attempt_atomic_deletion_local()
+{
+  ndeletion_attempts += 1.0;
+
+  if (ngas == 0 || ngas <= min_ngas) return;
+
+  int i = pick_random_gas_atom();
+
+  double energy_change = 0.0;
+  if (i >= 0) {
+    double xold[3];
+    xold[0] = atom->x[i][0];
+    xold[1] = atom->x[i][1];
+    xold[2] = atom->x[i][2];
+    double qi = atom->q_flag ? atom->q[i] : 0.0;
+    energy_change = -local->energy(i,atom->type[i],qi,xold);
+    if (local->overlap) energy_change = -MAXENERGYSIGNAL;
+    if (kspace_mc_flag) force->kspace->mc_remove(qi,xold);
+  }
+  if (kspace_mc_flag) energy_change += force->kspace->mc_energy_change();
+
+  int success = 0;
+  if (i >= 0) {
+    if (random_unequal->uniform() <
+        ngas*exp(-beta*energy_change)/(zz*volume)) {
+      atom->avec->copy(atom->nlocal-1,i,1);
+      atom->nlocal--;
+      success = 1;
+    }
+  }
+
+  int success_all = 0;
+  MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
+
+  if (success_all) {
+    atom->natoms--;
+    if (atom->tag_enable) {
+      if (atom->map_style) atom->map_init();
+    }
+    atom->nghost = 0;
+    if (triclinic) domain->x2lamda(atom->nlocal);
+    comm->borders();
+    if (triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
+    update_gas_atoms_list();
+    local->setup();
+    ndeletion_successes += 1.0;
+    if (kspace_mc_flag) force->kspace->mc_accept();
+  } else if (kspace_mc_flag) force->kspace->mc_reject();
+}
+
+/* ----------------------------------------------------------------------
+   insertion of one gas atom with local energies
+------------------------------------------------------------------------- */
+
+void FixGCMC::attempt_atomic_insertion_local()
+{
+  double lamda[3];
+
+  ninsertion_attempts += 1.0;
+
+  if (ngas >= max_ngas) return;
+
+  // pick coordinates for insertion point
+
+  double coord[3];
+  if (regionflag) {
+    int region_attempt = 0;
+    coord[0] = region_xlo + random_equal->uniform() * (region_xhi-region_xlo);
+    coord[1] = region_ylo + random_equal->uniform() * (region_yhi-region_ylo);
+    coord[2] = region_zlo + random_equal->uniform() * (region_zhi-region_zlo);
+    while (domain->regions[iregion]->match(coord[0],coord[1],coord[2]) == 0) {
+      coord[0] = region_xlo + random_equal->uniform() * (region_xhi-region_xlo);
+      coord[1] = region_ylo + random_equal->uniform() * (region_yhi-region_ylo);
+      coord[2] = region_zlo + random_equal->uniform() * (region_zhi-region_zlo);
+      region_attempt++;
+      if (region_attempt >= max_region_attempts) return;
+    }
+    if (triclinic) domain->x2lamda(coord,lamda);
+  } else {
+    if (triclinic == 0) {
+      coord[0] = xlo + random_equal->uniform() * (xhi-xlo);
+      coord[1] = ylo + random_equal->uniform() * (yhi-ylo);
+      coord[2] = zlo + random_equal->uniform() * (zhi-zlo);
+    } else {
+      lamda[0] = random_equal->uniform();
+      lamda[1] = random_equal->uniform();
+      lamda[2] = random_equal->uniform();
+
+      // wasteful, but necessary
+
+      if (lamda[0] == 1.0) lamda[0] = 0.0;
+      if (lamda[1] == 1.0) lamda[1] = 0.0;
+      if (lamda[2] == 1.0) lamda[2] = 0.0;
+
+      domain->lamda2x(lamda,coord);
+    }
+  }
+
+  int proc_flag = 0;
+  if (triclinic == 0) {
+    domain->remap(coord);
+    if (!domain->inside(coord))
+      error->one(FLERR,"Fix gcmc put atom outside box");
+    if (coord[0] >= sublo[0] && coord[0] < subhi[0] &&
+        coord[1] >= sublo[1] && coord[1] < subhi[1] &&
+        coord[2] >= sublo[2] && coord[2] < subhi[2]) proc_flag = 1;
+  } else {
+    if (lamda[0] >= sublo[0] && lamda[0] < subhi[0] &&
+        lamda[1] >= sublo[1] && lamda[1] < subhi[1] &&
+        lamda[2] >= sublo[2] && lamda[2] < subhi[2]) proc_flag = 1;
+  }
+
+  double qi = charge_flag ? charge : 0.0;
+  double insertion_energy = 0.0;
+  if (proc_flag) {
+    insertion_energy = local->energy(-1,ngcmc_type,qi,coord);
+    if (local->overlap) insertion_energy = MAXENERGYSIGNAL;
+    if (kspace_mc_flag) force->kspace->mc_add(qi,coord);
+  }
+  if (kspace_mc_flag) insertion_energy += force->kspace->mc_energy_change();
+
+  int success = 0;
+  if (proc_flag) {
+    if (insertion_energy < MAXENERGYTEST &&
+        random_unequal->uniform() <
+        zz*volume*exp(-beta*insertion_energy)/(ngas+1)) {
+      atom->avec->create_atom(ngcmc_type,coord);
+      int m = atom->nlocal - 1;
+
+      // add to groups
+      // optionally add to type-based groups
+
+      atom->mask[m] = groupbitall;
+      for (int igroup = 0; igroup < ngrouptypes; igroup++) {
+        if (ngcmc_type == grouptypes[igroup])
+          atom->mask[m] |= grouptypebits[igroup];
+      }
+
+      atom->v[m][0] = random_unequal->gaussian()*sigma;
+      atom->v[m][1] = random_unequal->gaussian()*sigma;
+      atom->v[m][2] = random_unequal->gaussian()*sigma;
+      if (charge_flag) atom->q[m] = charge;
+      modify->create_attribute(m);
+
+      success = 1;
+    }
+  }
+
+  int success_all = 0;
+  MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
+
+  if (success_all) {
+    atom->natoms++;
+    if (atom->tag_enable) {
+      atom->tag_extend();
+      if (atom->map_style) atom->map_init();
+    }
+    atom->nghost = 0;
+    if (triclinic) domain->x2lamda(atom->nlocal);
+    comm->borders();
+    if (triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
+    update_gas_atoms_list();
+    local->setup();
+    ninsertion_successes += 1.0;
+    if (kspace_mc_flag) force->kspace->mc_accept();
+  } else if (kspace_mc_flag) force->kspace->mc_reject();
+}
+
+/* ----------------------------------------------------------------------
+   trial position coord of gas atom i, displaced within a sphere
+------------------------------------------------------------------------- */
+
+void FixGCMC::trial_displacement(int i, double *coord, RanPark *random)
+{
+  double **x = atom->x;
+  double rsq,rx,ry,rz;
+
+  do {
+    rsq = 1.1;
+    while (rsq > 1.0) {
+      rx = 2*random->uniform() - 1.0;
+      ry = 2*random->uniform() - 1.0;
+      rz = 2*random->uniform() - 1.0;
+      rsq = rx*rx + ry*ry + rz*rz;
+    }
+    coord[0] = x[i][0] + displace*rx;
+    coord[1] = x[i][1] + displace*ry;
+    coord[2] = x[i][2] + displace*rz;
+  } while (regionflag &&
+           domain->regions[iregion]->match(coord[0],coord[1],coord[2]) == 0);
+
+  if (!domain->inside_nonperiodic(coord))
+    error->one(FLERR,"Fix gcmc put atom outside box");
+}
+
+/* ----------------------------------------------------------------------
+   translate gas atom i to coord with local energies
+   i = -1 on procs that do not own the atom, called by all procs
+------------------------------------------------------------------------- */
+
+void FixGCMC::translate_local(int i, double *coord)
+{
+  double energy_change = 0.0;
+  double energy_after = 0.0;
+
+  if (i >= 0) {
+    double xold[3];
+    xold[0] = atom->x[i][0];
+    xold[1] = atom->x[i][1];
+    xold[2] = atom->x[i][2];
+    int itype = atom->type[i];
+    double qi = atom->q_flag ? atom->q[i] : 0.0;
+    double energy_before = local->energy(i,itype,qi,xold);
+    energy_after = local->energy(i,itype,qi,coord);
+    if (local->overlap) energy_after = MAXENERGYSIGNAL;
+    energy_change = energy_after - energy_before;
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(qi,xold);
+      force->kspace->mc_add(qi,coord);
+    }
+  }
+  if (kspace_mc_flag) energy_change += force->kspace->mc_energy_change();
+
+  int success = 0;
+  if (i >= 0) {
+    if (energy_after < MAXENERGYTEST &&
+        random_unequal->uniform() < exp(-beta*energy_change)) {
+      double **x = atom->x;
+      x[i][0] = coord[0];
+      x[i][1] = coord[1];
+      x[i][2] = coord[2];
+      success = 1;
+    }
+  }
+
+  int success_all = 0;
+  MPI_Allreduce(&success,&success_all,1,MPI_INT,MPI_MAX,world);
+
+  if (success_all) {
+    if (triclinic) domain->x2lamda(atom->nlocal);
+    domain->pbc();
+    comm->exchange();
+    atom->nghost = 0;
+    comm->borders();
+    if (triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
+    update_gas_atoms_list();
+    local->setup();
+    ntranslation_successes += 1.0;
+    if (kspace_mc_flag) force->kspace->mc_accept();
+  } else if (kspace_mc_flag) force->kspace->mc_reject();
+}
+
+/* ----------------------------------------------------------------------
+   1 if point is at least cutinterior inside my sub-domain
+------------------------------------------------------------------------- */
+
+int FixGCMC::interior(double *xi)
+{
+  for (int k = 0; k < 3; k++)
+    if (xi[k] < sublo[k] + cutinterior || xi[k] > subhi[k] - cutinterior)
+      return 0;
+  return 1;
+}
+
 /* ----------------------------------------------------------------------
 ------------------------------------------------------------------------- */
 
@@ -1540,6 +2060,10 @@ void FixGCMC::attempt_atomic_translation_full()
     xtmp[0] = x[i][0];
     xtmp[1] = x[i][1];
     xtmp[2] = x[i][2];
+    if (kspace_mc_flag) {
+      force->kspace->mc_remove(atom->q[i],x[i]);
+      force->kspace->mc_add(atom->q[i],coord);
+    }
     x[i][0] = coord[0];
     x[i][1] = coord[1];
     x[i][2] = coord[2];
@@ -1554,7 +2078,9 @@ void FixGCMC::attempt_atomic_translation_full()
       exp(beta*(energy_before - energy_after))) {
     energy_stored = energy_after;
     ntranslation_successes += 1.0;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
 
     tagint tmptag_all;
     MPI_Allreduce(&tmptag,&tmptag_all,1,MPI_LMP_TAGINT,MPI_MAX,world);
@@ -1596,6 +2122,7 @@ void FixGCMC::attempt_atomic_deletion_full()
     atom->mask[i] = exclusion_group_bit;
     if (q_flag) {
       q_tmp = atom->q[i];
+      if (kspace_mc_flag) force->kspace->mc_remove(q_tmp,atom->x[i]);
       atom->q[i] = 0.0;
     }
   }
@@ -1613,7 +2140,9 @@ void FixGCMC::attempt_atomic_deletion_full()
     if (atom->map_style) atom->map_init();
     ndeletion_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     if (i >= 0) {
       atom->mask[i] = tmpmask;
       if (q_flag) atom->q[i] = q_tmp;
@@ -1703,6 +2232,7 @@ void FixGCMC::attempt_atomic_insertion_full()
     atom->v[m][2] = random_unequal->gaussian()*sigma;
     if (charge_flag) atom->q[m] = charge;
     modify->create_attribute(m);
+    if (kspace_mc_flag) force->kspace->mc_add(atom->q[m],atom->x[m]);
   }
 
   atom->natoms++;
@@ -1724,7 +2254,9 @@ void FixGCMC::attempt_atomic_insertion_full()
 
     ninsertion_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     atom->natoms--;
     if (proc_flag) atom->nlocal--;
     if (force->kspace) force->kspace->qsum_qsq();
@@ -1796,11 +2328,13 @@ void FixGCMC::attempt_molecule_translation_full()
 
   for (int i = 0; i < atom->nlocal; i++) {
     if (atom->molecule[i] == translation_molecule) {
+      if (kspace_mc_flag) force->kspace->mc_remove(atom->q[i],x[i]);
       x[i][0] += com_displace[0];
       x[i][1] += com_displace[1];
       x[i][2] += com_displace[2];
       if (!domain->inside_nonperiodic(x[i]))
         error->one(FLERR,"Fix gcmc put atom outside box");
+      if (kspace_mc_flag) force->kspace->mc_add(atom->q[i],x[i]);
     }
   }
 
@@ -1811,7 +2345,9 @@ void FixGCMC::attempt_molecule_translation_full()
       exp(beta*(energy_before - energy_after))) {
     ntranslation_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     energy_stored = energy_before;
     for (int i = 0; i < atom->nlocal; i++) {
       if (atom->molecule[i] == translation_molecule) {
@@ -1883,6 +2419,7 @@ void FixGCMC::attempt_molecule_rotation_full()
       molcoords[n][1] = x[i][1];
       molcoords[n][2] = x[i][2];
       molimage[n] = image[i];
+      if (kspace_mc_flag) force->kspace->mc_remove(atom->q[i],x[i]);
       double xtmp[3];
       domain->unmap(x[i],image[i],xtmp);
       xtmp[0] -= com[0];
@@ -1896,6 +2433,7 @@ void FixGCMC::attempt_molecule_rotation_full()
       domain->remap(x[i],image[i]);
       if (!domain->inside(x[i]))
         error->one(FLERR,"Fix gcmc put atom outside box");
+      if (kspace_mc_flag) force->kspace->mc_add(atom->q[i],x[i]);
       n++;
     }
   }
@@ -1907,7 +2445,9 @@ void FixGCMC::attempt_molecule_rotation_full()
       exp(beta*(energy_before - energy_after))) {
     nrotation_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     energy_stored = energy_before;
     int n = 0;
     for (int i = 0; i < atom->nlocal; i++) {
@@ -1961,6 +2501,7 @@ void FixGCMC::attempt_molecule_deletion_full()
       if (atom->q_flag) {
         molq[m] = atom->q[i];
         m++;
+        if (kspace_mc_flag) force->kspace->mc_remove(atom->q[i],atom->x[i]);
         atom->q[i] = 0.0;
       }
     }
@@ -1985,7 +2526,9 @@ void FixGCMC::attempt_molecule_deletion_full()
     if (atom->map_style) atom->map_init();
     ndeletion_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
   } else {
+    if (kspace_mc_flag) force->kspace->mc_reject();
     energy_stored = energy_before;
     int m = 0;
     for (int i = 0; i < atom->nlocal; i++) {
@@ -2147,6 +2690,7 @@ void FixGCMC::attempt_molecule_insertion_full()
 
       atom->add_molecule_atom(onemols[imol],i,m,maxtag_all);
       modify->create_attribute(m);
+      if (kspace_mc_flag) force->kspace->mc_add(atom->q[m],atom->x[m]);
     }
   }
 
@@ -2185,9 +2729,11 @@ void FixGCMC::attempt_molecule_insertion_full()
 
     ninsertion_successes += 1.0;
     energy_stored = energy_after;
+    if (kspace_mc_flag) force->kspace->mc_accept();
 
   } else {
 
+    if (kspace_mc_flag) force->kspace->mc_reject();
     atom->nbonds -= onemols[imol]->nbonds;
     atom->nangles -= onemols[imol]->nangles;
     atom->ndihedrals -= onemols[imol]->ndihedrals;
@@ -2293,6 +2839,11 @@ double FixGCMC::energy_full()
   int eflag = 1;
   int vflag = 0;
 
+  // kspace energy of trial move from cached structure factors
+  // collective, so done before a possible return due to overlap
+
+  if (kspace_mc_flag) force->kspace->mc_energy_change();
+
   // if overlap check requested, if overlap,
   // return signal value for energy
 
@@ -2344,7 +2895,7 @@ double FixGCMC::energy_full()
     if (force->improper) force->improper->compute(eflag,vflag);
   }
 
-  if (force->kspace) force->kspace->compute(eflag,vflag);
+  if (force->kspace && !kspace_mc_flag) force->kspace->compute(eflag,vflag);
 
   // unlike Verlet, not performing a reverse_comm() or forces here
   // b/c GCMC does not care about forces
@@ -2535,6 +3086,8 @@ double FixGCMC::compute_vector(int n)
 double FixGCMC::memory_usage()
 {
   double bytes = gcmc_nmax * sizeof(int);
+  bytes += maxtrial * (sizeof(int) + 4*sizeof(double));
+  if (local) bytes += local->memory_usage();
   return bytes;
 }
 
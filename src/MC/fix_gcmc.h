@@ -45,6 +45,10 @@ class FixGCMC : public Fix {
   void attempt_molecule_rotation_full();
   void attempt_molecule_deletion_full();
   void attempt_molecule_insertion_full();
+  void attempt_atomic_translation_local();
+  void attempt_atomic_translation_parallel(int);
+  void attempt_atomic_deletion_local();
+  void attempt_atomic_insertion_local();
   double energy(int, int, tagint, double *);
   double molecule_energy(tagint);
   double energy_full();
@@ -76,6 +80,12 @@ class FixGCMC : public Fix {
   bool pressure_flag;       // true if user specified reservoir pressure
   bool charge_flag;         // true if user specified atomic charge
   bool full_flag;           // true if doing full system energy calculations
+  bool kspace_incr_flag;    // true if user allows incremental kspace energies
+  int kspace_mc_flag;       // 1 if kspace energy of moves is incremental
+  int local_flag;           // 1 if energies are local around moved atoms
+  bool parallel_flag;       // true if user allows concurrent translations
+  int parallel_mc_flag;     // 1 if translations run concurrently on procs
+  double cutinterior;       // distance to sub-domain faces of concurrent moves
 
   int natoms_per_molecule;  // number of atoms in each inserted molecule
   int nmaxmolatoms;         // number of atoms allocated for molecule arrays
@@ -112,6 +122,10 @@ class FixGCMC : public Fix {
   double energy_stored;  // full energy of old/current configuration
   double *sublo,*subhi;
   int *local_gas_list;
+  int maxtrial;             // size of per-proc lists of translation trials
+  int *trial_list;          // gas atoms picked for concurrent translation
+  double *trial_deferred;   // tag and displacement of deferred trials
+  double *trial_all;        // deferred trials of all procs
   double **cutsq;
   double **molcoords;
   double *molq;
@@ -128,6 +142,9 @@ class FixGCMC : public Fix {
 
   class RanPark *random_equal;
   class RanPark *random_unequal;
+  class RanPark *random_parallel;
+
+  class LocalEnergy *local;
 
   class Atom *model_atom;
 
@@ -141,6 +158,9 @@ class FixGCMC : public Fix {
   class Compute *c_pe;
 
   void options(int, char **);
+  void trial_displacement(int, double *, class RanPark *);
+  void translate_local(int, double *);
+  int interior(double *);
 };
 
 }
@@ -0,0 +1,467 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "local_energy.h"
+#include "atom.h"
+#include "atom_vec.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "neighbor.h"
+#include "pair.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define DELTA 64
+
+/* ---------------------------------------------------------------------- */
+
+LocalEnergy::LocalEnergy(LAMMPS *lmp) : Pointers(lmp)
+{
+  overlap = 0;
+  cut = cutsq = 0.0;
+  overlap_cutsq = 0.0;
+  manybody = 0;
+  dedup = 0;
+
+  nbinx = nbiny = nbinz = 1;
+  maxbin = 0;
+  binhead = NULL;
+  maxatom = 0;
+  binnext = atom2bin = NULL;
+
+  nimage = 0;
+  maxneigh = maxlist = 0;
+  neigh = list = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+LocalEnergy::~LocalEnergy()
+{
+  memory->destroy(binhead);
+  memory->destroy(binnext);
+  memory->destroy(atom2bin);
+  memory->destroy(neigh);
+  memory->destroy(list);
+}
+
+/* ----------------------------------------------------------------------
+   set cutoff and energy model from current pair style
+   overlap = squared distance at which a trial atom overlaps, 0 if none
+------------------------------------------------------------------------- */
+
+void LocalEnergy::init(double overlap_cutsq_caller)
+{
+  Pair *pair = force->pair;
+  if (pair == NULL) error->all(FLERR,"Local energies require a pair style");
+
+  manybody = pair->manybody_flag;
+  if (manybody && !pair->local_energy_enable)
+    error->all(FLERR,"Pair style does not support local energies");
+  if (!manybody && !pair->single_enable)
+    error->all(FLERR,"Pair style does not support local energies");
+
+  cut = pair->cutforce;
+  cutsq = cut*cut;
+  overlap_cutsq = overlap_cutsq_caller;
+}
+
+/* ----------------------------------------------------------------------
+   ghost cutoff needed to evaluate the energy of an atom on this proc
+   many-body: energies of neighbors of the trial atom need their neighbors
+------------------------------------------------------------------------- */
+
+double LocalEnergy::cutghost_min()
+{
+  if (manybody) return 2.0*cut;
+  return cut;
+}
+
+/* ----------------------------------------------------------------------
+   bin owned + ghost atoms, must be called after each borders()
+------------------------------------------------------------------------- */
+
+void LocalEnergy::setup()
+{
+  double **x = atom->x;
+  int nall = atom->nlocal + atom->nghost;
+
+  if (nall > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(binnext);
+    memory->destroy(atom2bin);
+    memory->create(binnext,maxatom,"local_energy:binnext");
+    memory->create(atom2bin,maxatom,"local_energy:atom2bin");
+  }
+
+  // bounding box of my atoms
+
+  if (nall) {
+    bboxlo[0] = bboxhi[0] = x[0][0];
+    bboxlo[1] = bboxhi[1] = x[0][1];
+    bboxlo[2] = bboxhi[2] = x[0][2];
+  } else bboxlo[0] = bboxhi[0] = bboxlo[1] = bboxhi[1] =
+           bboxlo[2] = bboxhi[2] = 0.0;
+
+  for (int i = 1; i < nall; i++)
+    for (int k = 0; k < 3; k++) {
+      if (x[i][k] < bboxlo[k]) bboxlo[k] = x[i][k];
+      if (x[i][k] > bboxhi[k]) bboxhi[k] = x[i][k];
+    }
+
+  // bins are at least cut wide, so only adjacent bins need to be searched
+  // limit # of bins for large sparse boxes
+
+  int nbin[3];
+  for (int k = 0; k < 3; k++) {
+    nbin[k] = static_cast<int> ((bboxhi[k]-bboxlo[k])/cut);
+    if (nbin[k] < 1) nbin[k] = 1;
+  }
+  while ((bigint) nbin[0]*nbin[1]*nbin[2] > 8*(bigint) nall + DELTA) {
+    int kmax = 0;
+    if (nbin[1] > nbin[kmax]) kmax = 1;
+    if (nbin[2] > nbin[kmax]) kmax = 2;
+    nbin[kmax] = (nbin[kmax]+1)/2;
+  }
+  nbinx = nbin[0];
+  nbiny = nbin[1];
+  nbinz = nbin[2];
+
+  for (int k = 0; k < 3; k++) {
+    if (bboxhi[k] > bboxlo[k]) bininv[k] = nbin[k]/(bboxhi[k]-bboxlo[k]);
+    else bininv[k] = 0.0;
+  }
+
+  int nbins = nbinx*nbiny*nbinz;
+  if (nbins > maxbin) {
+    maxbin = nbins;
+    memory->destroy(binhead);
+    memory->create(binhead,maxbin,"local_energy:binhead");
+  }
+  for (int m = 0; m < nbins; m++) binhead[m] = -1;
+
+  // insert in reverse order so lists are ordered by index
+
+  for (int i = nall-1; i >= 0; i--) {
+    int ibin = coord2bin(x[i]);
+    atom2bin[i] = ibin;
+    binnext[i] = binhead[ibin];
+    binhead[ibin] = i;
+  }
+
+  // with short periodic lengths, the same atom can be within cut twice
+
+  dedup = 0;
+  double *prd = domain->prd;
+  for (int k = 0; k < 3; k++)
+    if (domain->periodicity[k] && prd[k] < 2.0*cut) dedup = 1;
+  if (domain->triclinic) dedup = 1;
+}
+
+/* ----------------------------------------------------------------------
+   energy of a trial atom of type itype and charge qi at coord
+   relative to the system without it
+   i = existing atom whose copies are ignored, -1 for a new atom
+   only atoms within cut of the trial atom, or of those atoms
+   for many-body pair styles, enter the calculation
+------------------------------------------------------------------------- */
+
+double LocalEnergy::energy(int i, int itype, double qi, double *coord)
+{
+  Pair *pair = force->pair;
+  int nall = atom->nlocal + atom->nghost;
+  tagint itag = (i >= 0) ? atom->tag[i] : 0;
+
+  overlap = 0;
+
+  // store periodic images of trial atom as temporary atoms past nall
+
+  images(coord);
+  while (nall + nimage > atom->nmax) atom->avec->grow(0);
+
+  double **x = atom->x;
+  int *type = atom->type;
+  tagint *tag = atom->tag;
+
+  for (int k = 0; k < nimage; k++) {
+    int m = nall + k;
+    x[m][0] = image[k][0];
+    x[m][1] = image[k][1];
+    x[m][2] = image[k][2];
+    type[m] = itype;
+    tag[m] = 0;
+    if (atom->q_flag) atom->q[m] = qi;
+  }
+
+  int itrial = nall;
+  int jj,j,jtype,n,n0;
+  double delx,dely,delz,rsq,fpair;
+  double energy = 0.0;
+
+  n = gather(itrial,itag,n0);
+
+  if (overlap_cutsq > 0.0) {
+    for (jj = 0; jj < n; jj++) {
+      j = neigh[jj];
+      delx = coord[0] - x[j][0];
+      dely = coord[1] - x[j][1];
+      delz = coord[2] - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      if (rsq < overlap_cutsq) {
+        overlap = 1;
+        return 0.0;
+      }
+    }
+  }
+
+  // pairwise: sum of pair energies with trial atom,
+  //   half of those with its own periodic images
+
+  if (!manybody) {
+    double **cutsq_pair = pair->cutsq;
+    for (jj = 0; jj < n; jj++) {
+      j = neigh[jj];
+      delx = coord[0] - x[j][0];
+      dely = coord[1] - x[j][1];
+      delz = coord[2] - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      jtype = type[j];
+      if (rsq < cutsq_pair[itype][jtype]) {
+        double eng = pair->single(itrial,j,itype,jtype,rsq,1.0,1.0,fpair);
+        if (jj < n0) energy += eng;
+        else energy += 0.5*eng;
+      }
+    }
+    return energy;
+  }
+
+  // many-body: local energy of trial atom plus change of local energy
+  //   of each atom within cut of it, counting each atom once
+
+  energy = pair->energy_local(itrial,n,neigh);
+
+  if (n0 > maxlist) {
+    maxlist = n0 + DELTA;
+    memory->destroy(list);
+    memory->create(list,maxlist,"local_energy:list");
+  }
+
+  int nlist = 0;
+  for (jj = 0; jj < n0; jj++) {
+    j = neigh[jj];
+    if (dedup) {
+      int kk;
+      for (kk = 0; kk < nlist; kk++)
+        if (tag[list[kk]] == tag[j]) break;
+      if (kk < nlist) continue;
+    }
+    list[nlist++] = j;
+  }
+
+  for (jj = 0; jj < nlist; jj++) {
+    j = list[jj];
+    n = gather(j,itag,n0);
+    if (n == n0) continue;
+    energy += pair->energy_local(j,n,neigh) - pair->energy_local(j,n0,neigh);
+  }
+
+  return energy;
+}
+
+/* ----------------------------------------------------------------------
+   move existing atom i and its periodic copies on this proc to coord
+------------------------------------------------------------------------- */
+
+void LocalEnergy::move(int i, double *coord)
+{
+  double **x = atom->x;
+  tagint *tag = atom->tag;
+  double tolsq = 1.0e-12*cutsq;
+
+  double delta[3];
+  delta[0] = coord[0] - x[i][0];
+  delta[1] = coord[1] - x[i][1];
+  delta[2] = coord[2] - x[i][2];
+
+  // find copies near the periodic images of the old position
+
+  images(x[i]);
+  int ncopy = 0;
+  int copies[27];
+
+  for (int k = 0; k < nimage; k++) {
+    int ibin = coord2bin(image[k]);
+    for (int j = binhead[ibin]; j >= 0; j = binnext[j]) {
+      if (tag[j] != tag[i]) continue;
+      double delx = x[j][0] - image[k][0];
+      double dely = x[j][1] - image[k][1];
+      double delz = x[j][2] - image[k][2];
+      if (delx*delx + dely*dely + delz*delz > tolsq) continue;
+      int m;
+      for (m = 0; m < ncopy; m++)
+        if (copies[m] == j) break;
+      if (m == ncopy && ncopy < 27) copies[ncopy++] = j;
+    }
+  }
+
+  // unlink each copy from its bin, shift it, and rebin it
+
+  for (int m = 0; m < ncopy; m++) {
+    int j = copies[m];
+    int ibin = atom2bin[j];
+    if (binhead[ibin] == j) binhead[ibin] = binnext[j];
+    else {
+      int prev = binhead[ibin];
+      while (binnext[prev] != j) prev = binnext[prev];
+      binnext[prev] = binnext[j];
+    }
+
+    x[j][0] += delta[0];
+    x[j][1] += delta[1];
+    x[j][2] += delta[2];
+
+    ibin = coord2bin(x[j]);
+    atom2bin[j] = ibin;
+    binnext[j] = binhead[ibin];
+    binhead[ibin] = j;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   bin index of a point, points outside bounding box go to edge bins
+------------------------------------------------------------------------- */
+
+int LocalEnergy::coord2bin(double *xi)
+{
+  int ix = static_cast<int> ((xi[0]-bboxlo[0])*bininv[0]);
+  int iy = static_cast<int> ((xi[1]-bboxlo[1])*bininv[1]);
+  int iz = static_cast<int> ((xi[2]-bboxlo[2])*bininv[2]);
+  ix = MAX(0,MIN(ix,nbinx-1));
+  iy = MAX(0,MIN(iy,nbiny-1));
+  iz = MAX(0,MIN(iz,nbinz-1));
+  return (iz*nbiny + iy)*nbinx + ix;
+}
+
+/* ----------------------------------------------------------------------
+   periodic images of xi within cut of the bounding box of my atoms
+   image 0 is xi itself
+------------------------------------------------------------------------- */
+
+void LocalEnergy::images(double *xi)
+{
+  int *periodicity = domain->periodicity;
+  double *prd = domain->prd;
+  double xy = domain->xy;
+  double xz = domain->xz;
+  double yz = domain->yz;
+
+  image[0][0] = xi[0];
+  image[0][1] = xi[1];
+  image[0][2] = xi[2];
+  nimage = 1;
+
+  int xmax = periodicity[0] ? 1 : 0;
+  int ymax = periodicity[1] ? 1 : 0;
+  int zmax = periodicity[2] ? 1 : 0;
+
+  double p[3];
+  for (int kz = -zmax; kz <= zmax; kz++)
+    for (int ky = -ymax; ky <= ymax; ky++)
+      for (int kx = -xmax; kx <= xmax; kx++) {
+        if (kx == 0 && ky == 0 && kz == 0) continue;
+        p[0] = xi[0] + kx*prd[0] + ky*xy + kz*xz;
+        p[1] = xi[1] + ky*prd[1] + kz*yz;
+        p[2] = xi[2] + kz*prd[2];
+        if (p[0] < bboxlo[0]-cut || p[0] > bboxhi[0]+cut ||
+            p[1] < bboxlo[1]-cut || p[1] > bboxhi[1]+cut ||
+            p[2] < bboxlo[2]-cut || p[2] > bboxhi[2]+cut) continue;
+        image[nimage][0] = p[0];
+        image[nimage][1] = p[1];
+        image[nimage][2] = p[2];
+        nimage++;
+      }
+}
+
+/* ----------------------------------------------------------------------
+   neighbors of atom i within cut, returned in neigh
+   first n0 are owned + ghost atoms, excluding copies of atom skiptag,
+   remainder are images of the trial atom
+------------------------------------------------------------------------- */
+
+int LocalEnergy::gather(int i, tagint skiptag, int &n0)
+{
+  double **x = atom->x;
+  tagint *tag = atom->tag;
+  int nall = atom->nlocal + atom->nghost;
+  double xtmp = x[i][0];
+  double ytmp = x[i][1];
+  double ztmp = x[i][2];
+  double delx,dely,delz;
+
+  int ix = static_cast<int> ((xtmp-bboxlo[0])*bininv[0]);
+  int iy = static_cast<int> ((ytmp-bboxlo[1])*bininv[1]);
+  int iz = static_cast<int> ((ztmp-bboxlo[2])*bininv[2]);
+  ix = MAX(0,MIN(ix,nbinx-1));
+  iy = MAX(0,MIN(iy,nbiny-1));
+  iz = MAX(0,MIN(iz,nbinz-1));
+
+  int n = 0;
+  for (int jz = MAX(iz-1,0); jz <= MIN(iz+1,nbinz-1); jz++)
+    for (int jy = MAX(iy-1,0); jy <= MIN(iy+1,nbiny-1); jy++)
+      for (int jx = MAX(ix-1,0); jx <= MIN(ix+1,nbinx-1); jx++) {
+        int ibin = (jz*nbiny + jy)*nbinx + jx;
+        for (int j = binhead[ibin]; j >= 0; j = binnext[j]) {
+          if (j == i || tag[j] == skiptag) continue;
+          delx = xtmp - x[j][0];
+          dely = ytmp - x[j][1];
+          delz = ztmp - x[j][2];
+          if (delx*delx + dely*dely + delz*delz >= cutsq) continue;
+          if (n == maxneigh) grow_neigh();
+          neigh[n++] = j;
+        }
+      }
+
+  n0 = n;
+  for (int j = nall; j < nall+nimage; j++) {
+    if (j == i) continue;
+    delx = xtmp - x[j][0];
+    dely = ytmp - x[j][1];
+    delz = ztmp - x[j][2];
+    if (delx*delx + dely*dely + delz*delz >= cutsq) continue;
+    if (n == maxneigh) grow_neigh();
+    neigh[n++] = j;
+  }
+
+  return n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void LocalEnergy::grow_neigh()
+{
+  maxneigh += DELTA;
+  memory->grow(neigh,maxneigh,"local_energy:neigh");
+}
+
+/* ---------------------------------------------------------------------- */
+
+double LocalEnergy::memory_usage()
+{
+  double bytes = maxbin * sizeof(int);
+  bytes += 2*maxatom * sizeof(int);
+  bytes += (maxneigh + maxlist) * sizeof(int);
+  return bytes;
+}
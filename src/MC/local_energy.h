@@ -0,0 +1,76 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_LOCAL_ENERGY_H
+#define LMP_LOCAL_ENERGY_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class LocalEnergy : protected Pointers {
+ public:
+  int overlap;                  // 1 if last energy() found an overlap
+
+  LocalEnergy(class LAMMPS *);
+  ~LocalEnergy();
+  void init(double);
+  double cutghost_min();
+  void setup();
+  double energy(int, int, double, double *);
+  void move(int, double *);
+  double memory_usage();
+
+ private:
+  double cut,cutsq;             // largest pair cutoff
+  double overlap_cutsq;         // overlap distance squared, 0 if none
+  int manybody;                 // 1 if pair needs per-atom local energies
+  int dedup;                    // 1 if an atom can be seen twice within cut
+
+  // bins of owned + ghost atoms, each bin at least cut wide
+
+  int nbinx,nbiny,nbinz,maxbin;
+  double bboxlo[3],bboxhi[3],bininv[3];
+  int *binhead,*binnext,*atom2bin;
+  int maxatom;
+
+  // periodic images of the trial atom, stored past owned + ghost atoms
+
+  int nimage;
+  double image[27][3];
+
+  int maxneigh,*neigh;          // neighbors of one atom
+  int maxlist,*list;            // atoms whose energy depends on trial atom
+
+  int coord2bin(double *);
+  void images(double *);
+  int gather(int, tagint, int &);
+  void grow_neigh();
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Local energies require a pair style
+
+Self-explanatory.
+
+E: Pair style does not support local energies
+
+Many-body pair styles must provide a local energy routine to
+evaluate energy changes of individual atoms.
+
+*/
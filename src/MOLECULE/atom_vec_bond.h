@@ -49,6 +49,7 @@ class AtomVecBond : public AtomVec {
   int unpack_restart(double *);
   void create_atom(int, double *);
   void data_atom(double *, imageint, char **);
+  void data_atom_binary(double *, imageint, double *);
   int data_atom_hybrid(int, char **);
   void pack_data(double **);
   int pack_data_hybrid(int, double *);
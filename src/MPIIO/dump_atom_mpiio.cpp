@@ -37,7 +37,10 @@ using namespace LAMMPS_NS;
 /* ---------------------------------------------------------------------- */
 
 DumpAtomMPIIO::DumpAtomMPIIO(LAMMPS *lmp, int narg, char **arg) :
-  DumpAtom(lmp, narg, arg) {}
+  DumpAtom(lmp, narg, arg)
+{
+  async_allow = 0;
+}
 
 /* ---------------------------------------------------------------------- */
 
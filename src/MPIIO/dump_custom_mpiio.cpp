@@ -19,6 +19,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include "domain.h"
 #include "input.h"
 #include "variable.h"
@@ -52,13 +53,26 @@ enum{LT,LE,GT,GE,EQ,NEQ};
 /* ---------------------------------------------------------------------- */
 
 DumpCustomMPIIO::DumpCustomMPIIO(LAMMPS *lmp, int narg, char **arg) :
-  DumpCustom(lmp, narg, arg) {}
+  DumpCustom(lmp, narg, arg)
+{
+  async_allow = 0;
+
+  order_flag = 0;
+  ordered = 0;
+  order_warn = 0;
+  order = NULL;
+  maxorder = 0;
+  obuf = NULL;
+  maxobuf = 0;
+}
 
 /* ---------------------------------------------------------------------- */
 
 DumpCustomMPIIO::~DumpCustomMPIIO()
 {
   if (multifile == 0) MPI_File_close(&mpifh);
+  memory->destroy(order);
+  memory->sfree(obuf);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -202,7 +216,32 @@ void DumpCustomMPIIO::write()
 
   if (sort_flag && sortcol == 0) pack(ids);
   else pack(NULL);
-  if (sort_flag) sort();
+
+  // with ordered output, each atom is written at an offset set by its ID
+  // only requires a local sort, else sort across procs
+
+  ordered = 0;
+  if (order_flag) {
+    ordered = ordered_ids();
+    if (!ordered && !order_warn) {
+      if (me == 0)
+        error->warning(FLERR,"Dump custom/mpiio cannot write snapshot "
+                       "at atom ID offsets, sorting instead");
+      order_warn = 1;
+    }
+  }
+
+  if (ordered) {
+    if (nme > maxorder) {
+      maxorder = nme;
+      memory->destroy(order);
+      memory->create(order,maxorder,"dump:order");
+    }
+    for (int i = 0; i < nme; i++) order[i] = i;
+    tagint *myids = ids;
+    std::sort(order,order+nme,
+              [myids](int i, int j) { return myids[i] < myids[j]; });
+  } else if (sort_flag) sort();
 
   // determine how much data needs to be written for setting the file size and prepocess it prior to writing
   performEstimate = 1;
@@ -288,6 +327,9 @@ void DumpCustomMPIIO::init_style()
   if (binary) write_choice = &DumpCustomMPIIO::write_binary;
   else write_choice = &DumpCustomMPIIO::write_string;
 
+  if (order_flag && (!sort_flag || sortcol != 0))
+    error->all(FLERR,"Dump_modify ordered requires sort by atom ID");
+
   // find current ptr for each compute,fix,variable
   // check that fix frequency is acceptable
 
@@ -373,7 +415,10 @@ void DumpCustomMPIIO::header_binary(bigint ndump)
     memcpy(&((char*)headerBuffer)[headerSize],&size_one,sizeof(int));
     headerSize += sizeof(int);
 
-    memcpy(&((char*)headerBuffer)[headerSize],&nprocs,sizeof(int));
+    // an ordered snapshot is a single chunk of per-atom values
+
+    int nchunk = ordered ? 1 : nprocs;
+    memcpy(&((char*)headerBuffer)[headerSize],&nchunk,sizeof(int));
     headerSize += sizeof(int);
   }
   else { // write data
@@ -435,7 +480,10 @@ void DumpCustomMPIIO::header_binary_triclinic(bigint ndump)
     memcpy(&((char*)headerBuffer)[headerSize],&size_one,sizeof(int));
     headerSize += sizeof(int);
 
-    memcpy(&((char*)headerBuffer)[headerSize],&nprocs,sizeof(int));
+    // an ordered snapshot is a single chunk of per-atom values
+
+    int nchunk = ordered ? 1 : nprocs;
+    memcpy(&((char*)headerBuffer)[headerSize],&nchunk,sizeof(int));
     headerSize += sizeof(int);
 
   }
@@ -508,7 +556,10 @@ void DumpCustomMPIIO::header_item_triclinic(bigint ndump)
 
 void DumpCustomMPIIO::write_data(int n, double *mybuf)
 {
-  (this->*write_choice)(n,mybuf);
+  if (ordered) {
+    if (binary) write_binary_ordered(n,mybuf);
+    else write_string_ordered(n,mybuf);
+  } else (this->*write_choice)(n,mybuf);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -569,6 +620,201 @@ void DumpCustomMPIIO::write_string(int n, double *mybuf)
   }
 }
 
+/* ----------------------------------------------------------------------
+   check if snapshot can be written with each atom at an offset set by its ID
+   requires IDs of dumped atoms to be 1 to ntotal, so there are no gaps
+   a binary snapshot is one chunk, so its size must fit in an int
+------------------------------------------------------------------------- */
+
+int DumpCustomMPIIO::ordered_ids()
+{
+  tagint maxid = 0;
+  for (int i = 0; i < nme; i++) maxid = MAX(maxid,ids[i]);
+  tagint maxall;
+  MPI_Allreduce(&maxid,&maxall,1,MPI_LMP_TAGINT,MPI_MAX,world);
+
+  if (maxall != ntotal) return 0;
+  if (binary && ntotal*size_one > MAXSMALLINT) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   binary snapshot as one chunk with a record of size_one doubles per atom
+   record of atom with ID = N is at offset (N-1)*recordSize in the chunk
+------------------------------------------------------------------------- */
+
+void DumpCustomMPIIO::write_binary_ordered(int n, double *mybuf)
+{
+  if (performEstimate) {
+    recordSize = size_one*sizeof(double);
+    sumFileSize = sizeof(int) + ntotal*recordSize;
+
+    bigint nbytes = (bigint) n*recordSize;
+    if (nbytes > MAXSMALLINT)
+      error->one(FLERR,"Too much per-proc info for dump");
+
+    if (nbytes > maxobuf) {
+      maxobuf = nbytes;
+      obuf = (char *) memory->srealloc(obuf,maxobuf,"dump:obuf");
+    }
+    for (int i = 0; i < n; i++)
+      memcpy(&obuf[(bigint) i*recordSize],&mybuf[(bigint) order[i]*size_one],
+             recordSize);
+  }
+  else {
+    if (me == 0) {
+      int nvalues = ntotal*size_one;
+      MPI_File_write_at(mpifh,mpifo,&nvalues,sizeof(int),MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+    }
+    mpifo += sizeof(int);
+    write_ordered(n);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   text snapshot with every line padded with blanks to the longest line
+   line of atom with ID = N is at offset (N-1)*recordSize in the snapshot
+------------------------------------------------------------------------- */
+
+void DumpCustomMPIIO::write_string_ordered(int n, double *mybuf)
+{
+  if (performEstimate) {
+
+#if defined(_OPENMP)
+    int nthreads = omp_get_max_threads();
+    if ((nthreads > 1) && !(lmp->kokkos))
+      nsme = convert_string_omp(n,mybuf); // not (yet) compatible with Kokkos
+    else
+      nsme = convert_string(n,mybuf);
+#else
+
+    nsme = convert_string(n,mybuf);
+#endif
+
+    // find start of each line, lines are in same order as in mybuf
+    // store them in obuf temporarily, until the records are built
+
+    bigint nbytes = (n+1)*sizeof(int);
+    if (nbytes > maxobuf) {
+      maxobuf = nbytes;
+      obuf = (char *) memory->srealloc(obuf,maxobuf,"dump:obuf");
+    }
+    int *start = (int *) obuf;
+    int maxlen = 0;
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      start[i] = m;
+      while (sbuf[m] != '\n') m++;
+      m++;
+      maxlen = MAX(maxlen,m-start[i]);
+    }
+    start[n] = m;
+
+    int maxall;
+    MPI_Allreduce(&maxlen,&maxall,1,MPI_INT,MPI_MAX,world);
+    recordSize = maxall;
+    sumFileSize = ntotal*recordSize;
+
+    nbytes = (bigint) n*recordSize;
+    if (nbytes > MAXSMALLINT)
+      error->one(FLERR,"Too much per-proc info for dump");
+
+    // copy start offsets so obuf can be reused for the records
+
+    int *mystart;
+    memory->create(mystart,n+1,"dump:mystart");
+    memcpy(mystart,start,(n+1)*sizeof(int));
+
+    if (nbytes > maxobuf) {
+      maxobuf = nbytes;
+      obuf = (char *) memory->srealloc(obuf,maxobuf,"dump:obuf");
+    }
+    for (int i = 0; i < n; i++) {
+      int j = order[i];
+      int len = mystart[j+1] - mystart[j] - 1;
+      char *record = &obuf[(bigint) i*recordSize];
+      memcpy(record,&sbuf[mystart[j]],len);
+      memset(&record[len],' ',recordSize-1-len);
+      record[recordSize-1] = '\n';
+    }
+    memory->destroy(mystart);
+  }
+  else write_ordered(n);
+}
+
+/* ----------------------------------------------------------------------
+   write records of my n atoms at offsets set by their IDs
+   runs of consecutive IDs are written as one block of a file view
+   n*recordSize was checked to fit in an int, so each block length does
+------------------------------------------------------------------------- */
+
+void DumpCustomMPIIO::write_ordered(int n)
+{
+  int nrun = 0;
+  int *blocklen;
+  MPI_Aint *disp;
+  memory->create(blocklen,MAX(n,1),"dump:blocklen");
+  memory->create(disp,MAX(n,1),"dump:disp");
+
+  for (int i = 0; i < n; i++) {
+    if (i && ids[order[i]] == ids[order[i-1]]+1)
+      blocklen[nrun-1] += recordSize;
+    else {
+      blocklen[nrun] = recordSize;
+      disp[nrun] = (MPI_Aint) (ids[order[i]]-1) * recordSize;
+      nrun++;
+    }
+  }
+
+  MPI_Datatype filetype;
+  MPI_Type_create_hindexed(nrun,blocklen,disp,MPI_BYTE,&filetype);
+  MPI_Type_commit(&filetype);
+
+  MPI_File_set_view(mpifh,mpifo,MPI_BYTE,filetype,(char *) "native",
+                    MPI_INFO_NULL);
+  int nbytes = (bigint) n*recordSize;
+  MPI_File_write_at_all(mpifh,0,obuf,nbytes,MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+  MPI_File_set_view(mpifh,0,MPI_BYTE,MPI_BYTE,(char *) "native",
+                    MPI_INFO_NULL);
+
+  MPI_Type_free(&filetype);
+  memory->destroy(blocklen);
+  memory->destroy(disp);
+
+  if (flush_flag)
+    MPI_File_sync(mpifh);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpCustomMPIIO::modify_param(int narg, char **arg)
+{
+  int n = DumpCustom::modify_param(narg,arg);
+  if (n) return n;
+
+  if (strcmp(arg[0],"ordered") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"yes") == 0) order_flag = 1;
+    else if (strcmp(arg[1],"no") == 0) order_flag = 0;
+    else error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+bigint DumpCustomMPIIO::memory_usage()
+{
+  bigint bytes = DumpCustom::memory_usage();
+  bytes += memory->usage(order,maxorder);
+  bytes += maxobuf;
+  return bytes;
+}
+
 #if defined(_OPENMP)
 
 /* ----------------------------------------------------------------------
@@ -28,6 +28,7 @@ class DumpCustomMPIIO : public DumpCustom {
  public:
   DumpCustomMPIIO(class LAMMPS *, int, char **);
   virtual ~DumpCustomMPIIO();
+  virtual bigint memory_usage();
 
  protected:
 
@@ -39,6 +40,15 @@ class DumpCustomMPIIO : public DumpCustom {
   int performEstimate; // switch for write_data and write_header methods to use for gathering data and detemining filesize for preallocation vs actually writing the data
   char *filecurrent;  // name of file for this round (with % and * replaced)
 
+  int order_flag;      // 1 if sort by ID writes records at ID offsets
+  int ordered;         // 1 if current snapshot is written at ID offsets
+  int order_warn;      // 1 if fallback to sort() has been warned about
+  int *order;          // local indices of dump lines in ascending ID order
+  int maxorder;
+  char *obuf;          // fixed-size records of my atoms in ID order
+  bigint maxobuf;
+  bigint recordSize;   // bytes per atom record in ordered snapshot
+
 #if defined(_OPENMP)
   int convert_string_omp(int, double *);  // multithreaded version of convert_string
 #endif
@@ -49,6 +59,8 @@ class DumpCustomMPIIO : public DumpCustom {
   virtual void write_data(int, double *);
 
   virtual void init_style();
+  virtual int modify_param(int, char **);
+
   typedef void (DumpCustomMPIIO::*FnPtrHeader)(bigint);
   FnPtrHeader header_choice;           // ptr to write header functions
   void header_binary(bigint);
@@ -60,6 +72,11 @@ class DumpCustomMPIIO : public DumpCustom {
   FnPtrData write_choice;              // ptr to write data functions
   void write_binary(int, double *);
   void write_string(int, double *);
+
+  int ordered_ids();
+  void write_binary_ordered(int, double *);
+  void write_string_ordered(int, double *);
+  void write_ordered(int);
 };
 
 }
@@ -79,6 +96,22 @@ E: Too much per-proc info for dump
 Number of local atoms times number of columns must fit in a 32-bit
 integer for dump.
 
+E: Dump_modify ordered requires sort by atom ID
+
+Use dump_modify sort id together with dump_modify ordered yes.
+
+W: Dump custom/mpiio cannot write snapshot at atom ID offsets, sorting instead
+
+Ordered output requires the atom IDs of the dumped atoms to be 1 to
+N, where N is the number of atoms in the snapshot.  The snapshot is
+sorted by atom ID via communication instead.
+
+E: Illegal dump_modify command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
 E: Dump_modify format line is too short
 
 UNDOCUMENTED
@@ -27,6 +27,7 @@
 #include "force.h"
 #include "memory.h"
 #include "error.h"
+#include "qeq_extrapolate.h"
 
 using namespace LAMMPS_NS;
 using namespace FixConst;
@@ -65,7 +66,28 @@ FixQEq::FixQEq(LAMMPS *lmp, int narg, char **arg) :
   pack_flag = 0;
   s = NULL;
   t = NULL;
-  nprev = 5;
+
+  // optional extrapolation keywords
+  // all other optional keywords take one value and are
+  //   parsed by the derived classes
+
+  extrap = new QEqExtrapolate(lmp,style);
+
+  int iarg = 8;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq command");
+    extrap->modify_param(narg-iarg,&arg[iarg]);
+    iarg += 2;
+  }
+
+  // history of previous solutions
+
+  nprev = extrap->setup(5);
+
+  vector_flag = 1;
+  size_vector = 3;
+  global_freq = 1;
+  extvector = 0;
 
   Hdia_inv = NULL;
   b_s = NULL;
@@ -125,6 +147,7 @@ FixQEq::~FixQEq()
 
   memory->destroy(s_hist);
   memory->destroy(t_hist);
+  delete extrap;
 
   deallocate_storage();
   deallocate_matrix();
@@ -448,7 +471,7 @@ void FixQEq::calculate_Q()
     if (atom->mask[i] & groupbit) {
       q[i] = s[i] - u * t[i];
 
-      for( k = 4; k > 0; --k ) {
+      for( k = nprev-1; k > 0; --k ) {
         s_hist[i][k] = s_hist[i][k-1];
         t_hist[i][k] = t_hist[i][k-1];
       }
@@ -461,6 +484,43 @@ void FixQEq::calculate_Q()
   comm->forward_comm_fix( this ); //Dist_vector( atom->q );
 }
 
+/* ----------------------------------------------------------------------
+   initial guess for s and t from previous solutions
+------------------------------------------------------------------------- */
+
+void FixQEq::extrapolate()
+{
+  int i, ii, k, inum, *ilist;
+
+  inum = list->inum;
+  ilist = list->ilist;
+
+  extrap->coeffs(inum,ilist,groupbit,s_hist,t_hist);
+
+  for( ii = 0; ii < inum; ++ii ) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      if (extrap->nextrap) {
+        s[i] = t[i] = 0.0;
+        for( k = 0; k < extrap->nextrap; k++ ) {
+          s[i] += extrap->cs[k] * s_hist[i][k];
+          t[i] += extrap->ct[k] * t_hist[i][k];
+        }
+      } else {
+        t[i] = t_hist[i][2] + 3 * ( t_hist[i][0] - t_hist[i][1] );
+        s[i] = 4*(s_hist[i][0]+s_hist[i][2])-(6*s_hist[i][1]+s_hist[i][3]);
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixQEq::compute_vector(int n)
+{
+  return extrap->compute_vector(n);
+}
+
 /* ---------------------------------------------------------------------- */
 
 int FixQEq::pack_forward_comm(int n, int *list, double *buf,
@@ -49,6 +49,7 @@ class FixQEq : public Fix {
   int pack_exchange(int, double *);
   int unpack_exchange(int, double *);
   double memory_usage();
+  double compute_vector(int);
 
  protected:
   int nevery;
@@ -80,6 +81,8 @@ class FixQEq : public Fix {
   double **s_hist, **t_hist;
   int nprev;
 
+  class QEqExtrapolate *extrap;  // initial guess from previous solutions
+
   typedef struct{
     int n, m;
     int *firstnbr;
@@ -105,6 +108,7 @@ class FixQEq : public Fix {
   double *qv;
 
   void calculate_Q();
+  void extrapolate();
 
   double parallel_norm(double*, int);
   double parallel_dot(double*, double*, int);
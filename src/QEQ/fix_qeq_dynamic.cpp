@@ -55,6 +55,10 @@ FixQEqDynamic::FixQEqDynamic(LAMMPS *lmp, int narg, char **arg) :
       iarg += 2;
     } else error->all(FLERR,"Illegal fix qeq/dynamic command");
   }
+
+  // damped dynamics does not use CG or extrapolation
+
+  vector_flag = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -66,6 +66,10 @@ FixQEqFire::FixQEqFire(LAMMPS *lmp, int narg, char **arg) :
     } else error->all(FLERR,"Illegal fix qeq/fire command");
   }
 
+  // damped dynamics does not use CG or extrapolation
+
+  vector_flag = 0;
+
   comb = NULL;
   comb3 = NULL;
 }
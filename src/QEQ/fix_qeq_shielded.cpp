@@ -31,6 +31,7 @@
 #include "respa.h"
 #include "memory.h"
 #include "error.h"
+#include "qeq_extrapolate.h"
 
 using namespace LAMMPS_NS;
 
@@ -141,6 +142,7 @@ void FixQEqShielded::pre_force(int /*vflag*/)
   init_matvec();
   matvecs = CG(b_s, s);         // CG on s - parallel
   matvecs += CG(b_t, t);        // CG on t - parallel
+  extrap->count_matvecs(matvecs);
   calculate_Q();
 
   if (force->kspace) force->kspace->qsum_qsq();
@@ -164,11 +166,11 @@ void FixQEqShielded::init_matvec()
       Hdia_inv[i] = 1. / eta[ atom->type[i] ];
       b_s[i]      = -( chi[atom->type[i]] + chizj[i] );
       b_t[i]      = -1.0;
-      t[i] = t_hist[i][2] + 3 * ( t_hist[i][0] - t_hist[i][1] );
-      s[i] = 4*(s_hist[i][0]+s_hist[i][2])-(6*s_hist[i][1]+s_hist[i][3]);
     }
   }
 
+  extrapolate();
+
   pack_flag = 2;
   comm->forward_comm_fix(this); //Dist_vector( s );
   pack_flag = 3;
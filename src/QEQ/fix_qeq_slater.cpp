@@ -32,6 +32,7 @@
 #include "respa.h"
 #include "math_const.h"
 #include "error.h"
+#include "qeq_extrapolate.h"
 
 using namespace LAMMPS_NS;
 using namespace MathConst;
@@ -51,6 +52,9 @@ FixQEqSlater::FixQEqSlater(LAMMPS *lmp, int narg, char **arg) :
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq/slater command");
       alpha = atof(arg[iarg+1]);
       iarg += 2;
+    } else if ((strcmp(arg[iarg],"extrapolate") == 0) ||
+               (strcmp(arg[iarg],"history") == 0)) {
+      iarg += 2;    // parsed by FixQEq
     } else error->all(FLERR,"Illegal fix qeq/slater command");
   }
 
@@ -119,6 +123,7 @@ void FixQEqSlater::pre_force(int /*vflag*/)
   init_matvec();
   matvecs = CG(b_s, s);         // CG on s - parallel
   matvecs += CG(b_t, t);        // CG on t - parallel
+  extrap->count_matvecs(matvecs);
   calculate_Q();
 
   if (force->kspace) force->kspace->qsum_qsq();
@@ -142,11 +147,11 @@ void FixQEqSlater::init_matvec()
       Hdia_inv[i] = 1. / eta[ atom->type[i] ];
       b_s[i]      = -( chi[atom->type[i]] + chizj[i] );
       b_t[i]      = -1.0;
-      t[i] = t_hist[i][2] + 3 * ( t_hist[i][0] - t_hist[i][1] );
-      s[i] = 4*(s_hist[i][0]+s_hist[i][2])-(6*s_hist[i][1]+s_hist[i][3]);
     }
   }
 
+  extrapolate();
+
   pack_flag = 2;
   comm->forward_comm_fix(this); //Dist_vector( s );
   pack_flag = 3;
@@ -131,6 +131,11 @@ SNA::SNA(LAMMPS* lmp, double rfac0_in,
   idxb = NULL;
   ulist_r_ij = NULL;
   ulist_i_ij = NULL;
+  a_r_ij = NULL;
+  a_i_ij = NULL;
+  b_r_ij = NULL;
+  b_i_ij = NULL;
+  sfac_ij = NULL;
 
   build_indexlist();
   create_twojmax_arrays();
@@ -153,6 +158,11 @@ SNA::~SNA()
   memory->destroy(rcutij);
   memory->destroy(ulist_r_ij);
   memory->destroy(ulist_i_ij);
+  memory->destroy(a_r_ij);
+  memory->destroy(a_i_ij);
+  memory->destroy(b_r_ij);
+  memory->destroy(b_i_ij);
+  memory->destroy(sfac_ij);
   delete[] idxz;
   delete[] idxb;
   destroy_twojmax_arrays();
@@ -301,12 +311,22 @@ void SNA::grow_rij(int newnmax)
   memory->destroy(rcutij);
   memory->destroy(ulist_r_ij);
   memory->destroy(ulist_i_ij);
+  memory->destroy(a_r_ij);
+  memory->destroy(a_i_ij);
+  memory->destroy(b_r_ij);
+  memory->destroy(b_i_ij);
+  memory->destroy(sfac_ij);
   memory->create(rij, nmax, 3, "pair:rij");
   memory->create(inside, nmax, "pair:inside");
   memory->create(wj, nmax, "pair:wj");
   memory->create(rcutij, nmax, "pair:rcutij");
-  memory->create(ulist_r_ij, nmax, idxu_max, "sna:ulist_ij");
-  memory->create(ulist_i_ij, nmax, idxu_max, "sna:ulist_ij");
+  memory->create(ulist_r_ij, idxu_max, nmax, "sna:ulist_ij");
+  memory->create(ulist_i_ij, idxu_max, nmax, "sna:ulist_ij");
+  memory->create(a_r_ij, nmax, "sna:a_ij");
+  memory->create(a_i_ij, nmax, "sna:a_ij");
+  memory->create(b_r_ij, nmax, "sna:b_ij");
+  memory->create(b_i_ij, nmax, "sna:b_ij");
+  memory->create(sfac_ij, nmax, "sna:sfac_ij");
 }
 
 /* ----------------------------------------------------------------------
@@ -315,13 +335,15 @@ void SNA::grow_rij(int newnmax)
 
 void SNA::compute_ui(int jnum)
 {
-  double rsq, r, x, y, z, z0, theta0;
+  double rsq, r, x, y, z, z0, theta0, r0inv;
 
   // utot(j,ma,mb) = 0 for all j,ma,ma
   // utot(j,ma,ma) = 1 for all j,ma
   // for j in neighbors of i:
   //   compute r0 = (x,y,z,z0)
   //   utot(j,ma,mb) += u(r0;j,ma,mb) for all j,ma,mb
+  // Cayley-Klein parameters of all neighbors are computed first,
+  //   so u(r0;j,ma,mb) is computed for all neighbors at once
 
   zero_uarraytot();
   addself_uarraytot(wself);
@@ -337,10 +359,16 @@ void SNA::compute_ui(int jnum)
     //    theta0 = (r - rmin0) * rscale0;
     z0 = r / tan(theta0);
 
-    compute_uarray(x, y, z, z0, r, j);
-    add_uarraytot(r, wj[j], rcutij[j], j);
+    r0inv = 1.0 / sqrt(r * r + z0 * z0);
+    a_r_ij[j] = r0inv * z0;
+    a_i_ij[j] = -r0inv * z;
+    b_r_ij[j] = r0inv * y;
+    b_i_ij[j] = -r0inv * x;
+    sfac_ij[j] = wj[j] * compute_sfac(r, rcutij[j]);
   }
 
+  compute_uarray(jnum);
+  add_uarraytot(jnum);
 }
 
 /* ----------------------------------------------------------------------
@@ -842,7 +870,7 @@ void SNA::zero_uarraytot()
 {
   for (int j = 0; j <= twojmax; j++) {
     int jju = idxu_block[j];
-    for (int mb = 0; mb <= j; mb++)
+    for (int mb = 0; 2*mb <= j; mb++)
       for (int ma = 0; ma <= j; ma++) {
         ulisttot_r[jju] = 0.0;
         ulisttot_i[jju] = 0.0;
@@ -866,60 +894,70 @@ void SNA::addself_uarraytot(double wself_in)
 }
 
 /* ----------------------------------------------------------------------
-   add Wigner U-functions for one neighbor to the total
+   add Wigner U-functions of all neighbors to the total
+   only the left side of each matrix layer is summed, the right side
+     follows from inversion symmetry VMK 4.4(2)
 ------------------------------------------------------------------------- */
 
-void SNA::add_uarraytot(double r, double wj, double rcut, int jj)
+void SNA::add_uarraytot(int jnum)
 {
-  double sfac;
-
-  sfac = compute_sfac(r, rcut);
-
-  sfac *= wj;
-
-  double* ulist_r = ulist_r_ij[jj];
-  double* ulist_i = ulist_i_ij[jj];
-
   for (int j = 0; j <= twojmax; j++) {
     int jju = idxu_block[j];
-    for (int mb = 0; mb <= j; mb++)
+    for (int mb = 0; 2*mb <= j; mb++)
+      for (int ma = 0; ma <= j; ma++) {
+        const double* ulist_r = ulist_r_ij[jju];
+        const double* ulist_i = ulist_i_ij[jju];
+        double sum_r = ulisttot_r[jju];
+        double sum_i = ulisttot_i[jju];
+        for (int jj = 0; jj < jnum; jj++) {
+          sum_r += sfac_ij[jj] * ulist_r[jj];
+          sum_i += sfac_ij[jj] * ulist_i[jj];
+        }
+        ulisttot_r[jju] = sum_r;
+        ulisttot_i[jju] = sum_i;
+        jju++;
+      }
+
+    // copy left side to right side with inversion symmetry VMK 4.4(2)
+    // u[ma-j][mb-j] = (-1)^(ma-mb)*Conj([u[ma][mb])
+
+    jju = idxu_block[j];
+    int jjup = jju+(j+1)*(j+1)-1;
+    int mbpar = 1;
+    for (int mb = 0; 2*mb <= j; mb++) {
+      int mapar = mbpar;
       for (int ma = 0; ma <= j; ma++) {
-        ulisttot_r[jju] +=
-          sfac * ulist_r[jju];
-        ulisttot_i[jju] +=
-          sfac * ulist_i[jju];
+        if (mapar == 1) {
+          ulisttot_r[jjup] = ulisttot_r[jju];
+          ulisttot_i[jjup] = -ulisttot_i[jju];
+        } else {
+          ulisttot_r[jjup] = -ulisttot_r[jju];
+          ulisttot_i[jjup] = ulisttot_i[jju];
+        }
+        mapar = -mapar;
         jju++;
+        jjup--;
       }
+      mbpar = -mbpar;
+    }
   }
 }
 
 /* ----------------------------------------------------------------------
-   compute Wigner U-functions for one neighbor
+   compute Wigner U-functions for all neighbors
+   neighbor index is innermost, so each recursion step is vectorizable
 ------------------------------------------------------------------------- */
 
-void SNA::compute_uarray(double x, double y, double z,
-                         double z0, double r, int jj)
+void SNA::compute_uarray(int jnum)
 {
-  double r0inv;
-  double a_r, b_r, a_i, b_i;
   double rootpq;
 
-  // compute Cayley-Klein parameters for unit quaternion
-
-  r0inv = 1.0 / sqrt(r * r + z0 * z0);
-  a_r = r0inv * z0;
-  a_i = -r0inv * z;
-  b_r = r0inv * y;
-  b_i = -r0inv * x;
-
   // VMK Section 4.8.2
 
-
-  double* ulist_r = ulist_r_ij[jj];
-  double* ulist_i = ulist_i_ij[jj];
-
-  ulist_r[0] = 1.0;
-  ulist_i[0] = 0.0;
+  for (int jj = 0; jj < jnum; jj++) {
+    ulist_r_ij[0][jj] = 1.0;
+    ulist_i_ij[0][jj] = 0.0;
+  }
 
   for (int j = 1; j <= twojmax; j++) {
     int jju = idxu_block[j];
@@ -928,29 +966,34 @@ void SNA::compute_uarray(double x, double y, double z,
     // fill in left side of matrix layer from previous layer
 
     for (int mb = 0; 2*mb <= j; mb++) {
-      ulist_r[jju] = 0.0;
-      ulist_i[jju] = 0.0;
+      for (int jj = 0; jj < jnum; jj++) {
+        ulist_r_ij[jju][jj] = 0.0;
+        ulist_i_ij[jju][jj] = 0.0;
+      }
 
       for (int ma = 0; ma < j; ma++) {
+        const double* up_r = ulist_r_ij[jjup];
+        const double* up_i = ulist_i_ij[jjup];
+        double* u_r = ulist_r_ij[jju];
+        double* u_i = ulist_i_ij[jju];
+        double* u1_r = ulist_r_ij[jju+1];
+        double* u1_i = ulist_i_ij[jju+1];
+
         rootpq = rootpqarray[j - ma][j - mb];
-        ulist_r[jju] +=
-          rootpq *
-          (a_r * ulist_r[jjup] +
-           a_i * ulist_i[jjup]);
-        ulist_i[jju] +=
-          rootpq *
-          (a_r * ulist_i[jjup] -
-           a_i * ulist_r[jjup]);
+        for (int jj = 0; jj < jnum; jj++) {
+          u_r[jj] += rootpq *
+            (a_r_ij[jj] * up_r[jj] + a_i_ij[jj] * up_i[jj]);
+          u_i[jj] += rootpq *
+            (a_r_ij[jj] * up_i[jj] - a_i_ij[jj] * up_r[jj]);
+        }
 
         rootpq = rootpqarray[ma + 1][j - mb];
-        ulist_r[jju+1] =
-          -rootpq *
-          (b_r * ulist_r[jjup] +
-           b_i * ulist_i[jjup]);
-        ulist_i[jju+1] =
-          -rootpq *
-          (b_r * ulist_i[jjup] -
-           b_i * ulist_r[jjup]);
+        for (int jj = 0; jj < jnum; jj++) {
+          u1_r[jj] = -rootpq *
+            (b_r_ij[jj] * up_r[jj] + b_i_ij[jj] * up_i[jj]);
+          u1_i[jj] = -rootpq *
+            (b_r_ij[jj] * up_i[jj] - b_i_ij[jj] * up_r[jj]);
+        }
         jju++;
         jjup++;
       }
@@ -959,25 +1002,34 @@ void SNA::compute_uarray(double x, double y, double z,
 
     // copy left side to right side with inversion symmetry VMK 4.4(2)
     // u[ma-j][mb-j] = (-1)^(ma-mb)*Conj([u[ma][mb])
+    // only the left side is used, except for the first row
+    //   of the right side of odd j, which is needed by layer j+1
 
-    jju = idxu_block[j];
-    jjup = jju+(j+1)*(j+1)-1;
-    int mbpar = 1;
-    for (int mb = 0; 2*mb <= j; mb++) {
-      int mapar = mbpar;
+    if (j%2 == 1) {
+      int mb = j/2;
+      jju = idxu_block[j] + (j+1)*mb;
+      jjup = idxu_block[j] + (j+1)*(j-mb) + j;
+      int mapar = (mb%2 == 0) ? 1 : -1;
       for (int ma = 0; ma <= j; ma++) {
+        const double* u_r = ulist_r_ij[jju];
+        const double* u_i = ulist_i_ij[jju];
+        double* um_r = ulist_r_ij[jjup];
+        double* um_i = ulist_i_ij[jjup];
         if (mapar == 1) {
-          ulist_r[jjup] = ulist_r[jju];
-          ulist_i[jjup] = -ulist_i[jju];
+          for (int jj = 0; jj < jnum; jj++) {
+            um_r[jj] = u_r[jj];
+            um_i[jj] = -u_i[jj];
+          }
         } else {
-          ulist_r[jjup] = -ulist_r[jju];
-          ulist_i[jjup] = ulist_i[jju];
+          for (int jj = 0; jj < jnum; jj++) {
+            um_r[jj] = -u_r[jj];
+            um_i[jj] = u_i[jj];
+          }
         }
         mapar = -mapar;
         jju++;
         jjup--;
       }
-      mbpar = -mbpar;
     }
   }
 }
@@ -1033,9 +1085,6 @@ void SNA::compute_duarray(double x, double y, double z,
   db_i[0] += -r0inv;
   db_r[1] += r0inv;
 
-  double* ulist_r = ulist_r_ij[jj];
-  double* ulist_i = ulist_i_ij[jj];
-
   dulist_r[0][0] = 0.0;
   dulist_r[0][1] = 0.0;
   dulist_r[0][2] = 0.0;
@@ -1058,13 +1107,13 @@ void SNA::compute_duarray(double x, double y, double z,
         rootpq = rootpqarray[j - ma][j - mb];
         for (int k = 0; k < 3; k++) {
           dulist_r[jju][k] +=
-            rootpq * (da_r[k] * ulist_r[jjup] +
-                      da_i[k] * ulist_i[jjup] +
+            rootpq * (da_r[k] * ulist_r_ij[jjup][jj] +
+                      da_i[k] * ulist_i_ij[jjup][jj] +
                       a_r * dulist_r[jjup][k] +
                       a_i * dulist_i[jjup][k]);
           dulist_i[jju][k] +=
-            rootpq * (da_r[k] * ulist_i[jjup] -
-                      da_i[k] * ulist_r[jjup] +
+            rootpq * (da_r[k] * ulist_i_ij[jjup][jj] -
+                      da_i[k] * ulist_r_ij[jjup][jj] +
                       a_r * dulist_i[jjup][k] -
                       a_i * dulist_r[jjup][k]);
         }
@@ -1072,13 +1121,13 @@ void SNA::compute_duarray(double x, double y, double z,
         rootpq = rootpqarray[ma + 1][j - mb];
         for (int k = 0; k < 3; k++) {
           dulist_r[jju+1][k] =
-            -rootpq * (db_r[k] * ulist_r[jjup] +
-                       db_i[k] * ulist_i[jjup] +
+            -rootpq * (db_r[k] * ulist_r_ij[jjup][jj] +
+                       db_i[k] * ulist_i_ij[jjup][jj] +
                        b_r * dulist_r[jjup][k] +
                        b_i * dulist_i[jjup][k]);
           dulist_i[jju+1][k] =
-            -rootpq * (db_r[k] * ulist_i[jjup] -
-                       db_i[k] * ulist_r[jjup] +
+            -rootpq * (db_r[k] * ulist_i_ij[jjup][jj] -
+                       db_i[k] * ulist_r_ij[jjup][jj] +
                        b_r * dulist_i[jjup][k] -
                        b_i * dulist_r[jjup][k]);
         }
@@ -1090,12 +1139,13 @@ void SNA::compute_duarray(double x, double y, double z,
 
     // copy left side to right side with inversion symmetry VMK 4.4(2)
     // u[ma-j][mb-j] = (-1)^(ma-mb)*Conj([u[ma][mb])
+    // only needed for the first row of the right side of odd j
 
-    jju = idxu_block[j];
-    jjup = jju+(j+1)*(j+1)-1;
-    int mbpar = 1;
-    for (int mb = 0; 2*mb <= j; mb++) {
-      int mapar = mbpar;
+    if (j%2 == 1) {
+      int mb = j/2;
+      jju = idxu_block[j] + (j+1)*mb;
+      jjup = idxu_block[j] + (j+1)*(j-mb) + j;
+      int mapar = (mb%2 == 0) ? 1 : -1;
       for (int ma = 0; ma <= j; ma++) {
         if (mapar == 1) {
           for (int k = 0; k < 3; k++) {
@@ -1112,7 +1162,6 @@ void SNA::compute_duarray(double x, double y, double z,
         jju++;
         jjup--;
       }
-      mbpar = -mbpar;
     }
   }
 
@@ -1125,17 +1174,17 @@ void SNA::compute_duarray(double x, double y, double z,
     int jju = idxu_block[j];
     for (int mb = 0; 2*mb <= j; mb++)
       for (int ma = 0; ma <= j; ma++) {
-        dulist_r[jju][0] = dsfac * ulist_r[jju] * ux +
+        dulist_r[jju][0] = dsfac * ulist_r_ij[jju][jj] * ux +
                                   sfac * dulist_r[jju][0];
-        dulist_i[jju][0] = dsfac * ulist_i[jju] * ux +
+        dulist_i[jju][0] = dsfac * ulist_i_ij[jju][jj] * ux +
                                   sfac * dulist_i[jju][0];
-        dulist_r[jju][1] = dsfac * ulist_r[jju] * uy +
+        dulist_r[jju][1] = dsfac * ulist_r_ij[jju][jj] * uy +
                                   sfac * dulist_r[jju][1];
-        dulist_i[jju][1] = dsfac * ulist_i[jju] * uy +
+        dulist_i[jju][1] = dsfac * ulist_i_ij[jju][jj] * uy +
                                   sfac * dulist_i[jju][1];
-        dulist_r[jju][2] = dsfac * ulist_r[jju] * uz +
+        dulist_r[jju][2] = dsfac * ulist_r_ij[jju][jj] * uz +
                                   sfac * dulist_r[jju][2];
-        dulist_i[jju][2] = dsfac * ulist_i[jju] * uz +
+        dulist_i[jju][2] = dsfac * ulist_i_ij[jju][jj] * uz +
                                   sfac * dulist_i[jju][2];
         jju++;
       }
@@ -1180,6 +1229,7 @@ double SNA::memory_usage()
   bytes += nmax * sizeof(int);                           // inside
   bytes += nmax * sizeof(double);                        // wj
   bytes += nmax * sizeof(double);                        // rcutij
+  bytes += nmax * 5 * sizeof(double);                    // a_ij,b_ij,sfac_ij
 
   return bytes;
 }
@@ -85,7 +85,10 @@ private:
   int*** idxcg_block;
 
   double* ulisttot_r, * ulisttot_i;
-  double** ulist_r_ij, ** ulist_i_ij;
+  double** ulist_r_ij, ** ulist_i_ij;   // U of each neighbor, [jju][jj]
+  double* a_r_ij, * a_i_ij;             // Cayley-Klein parameters
+  double* b_r_ij, * b_i_ij;             //   of each neighbor
+  double* sfac_ij;                      // weighted switching function
   int* idxu_block;
 
   double* zlist_r, * zlist_i;
@@ -107,9 +110,8 @@ private:
   void init_rootpqarray();
   void zero_uarraytot();
   void addself_uarraytot(double);
-  void add_uarraytot(double, double, double, int);
-  void compute_uarray(double, double, double,
-                      double, double, int);
+  void add_uarraytot(int);
+  void compute_uarray(int);
   double deltacg(int, int, int);
   int compute_ncoeff();
   void compute_duarray(double, double, double,
@@ -57,6 +57,7 @@ public:
 DumpAtomADIOS::DumpAtomADIOS(LAMMPS *lmp, int narg, char **arg)
 : DumpAtom(lmp, narg, arg)
 {
+    async_allow = 0;
     internal = new DumpAtomADIOSInternal();
     try {
         internal->ad =
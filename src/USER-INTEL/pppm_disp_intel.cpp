@@ -47,7 +47,9 @@ enum{FORWARD_IK, FORWARD_AD, FORWARD_IK_PERATOM, FORWARD_AD_PERATOM,
      FORWARD_IK_G, FORWARD_AD_G, FORWARD_IK_PERATOM_G, FORWARD_AD_PERATOM_G,
      FORWARD_IK_A, FORWARD_AD_A, FORWARD_IK_PERATOM_A, FORWARD_AD_PERATOM_A,
      FORWARD_IK_NONE, FORWARD_AD_NONE, FORWARD_IK_PERATOM_NONE,
-     FORWARD_AD_PERATOM_NONE};
+     FORWARD_AD_PERATOM_NONE, FORWARD_IK_ALL, FORWARD_AD_ALL,
+     FORWARD_IK_ALL_G, FORWARD_AD_ALL_G, FORWARD_IK_ALL_A, FORWARD_AD_ALL_A,
+     FORWARD_IK_ALL_NONE, FORWARD_AD_ALL_NONE};
 
 #ifdef FFT_SINGLE
 #define ZEROF 0.0f
@@ -310,7 +312,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                  energy_1, greensfn, virial_1, vg,vg2, u_brick, v0_brick,
                  v1_brick, v2_brick, v3_brick, v4_brick, v5_brick);
 
-      cg->forward_comm(this,FORWARD_AD);
+      if (vflag_atom) cg_peratom->forward_comm(this,FORWARD_AD_ALL);
+      else cg->forward_comm(this,FORWARD_AD);
 
       if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
         fieldforce_c_ad<float,double>(fix->get_mixed_buffers());
@@ -319,9 +322,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
       } else {
         fieldforce_c_ad<float,float>(fix->get_single_buffers());
       }
-
-      if (vflag_atom) cg_peratom->forward_comm(this, FORWARD_AD_PERATOM);
-
     } else {
       poisson_ik(work1, work2, density_fft, fft1, fft2,
                  nx_pppm, ny_pppm, nz_pppm, nfft,
@@ -332,7 +332,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                  u_brick, v0_brick, v1_brick, v2_brick, v3_brick, v4_brick,
                  v5_brick);
 
-      cg->forward_comm(this, FORWARD_IK);
+      if (evflag_atom) cg_peratom->forward_comm(this,FORWARD_IK_ALL);
+      else cg->forward_comm(this,FORWARD_IK);
 
       if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
         fieldforce_c_ik<float,double>(fix->get_mixed_buffers());
@@ -341,8 +342,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
       } else {
         fieldforce_c_ik<float,float>(fix->get_single_buffers());
       }
-
-      if (evflag_atom) cg_peratom->forward_comm(this, FORWARD_IK_PERATOM);
     }
     if (evflag_atom) fieldforce_c_peratom();
   }
@@ -389,7 +388,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                  virial_6, vg_6, vg2_6, u_brick_g, v0_brick_g, v1_brick_g,
                  v2_brick_g, v3_brick_g, v4_brick_g, v5_brick_g);
 
-      cg_6->forward_comm(this,FORWARD_AD_G);
+      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_G);
+      else cg_6->forward_comm(this,FORWARD_AD_G);
 
     if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
       fieldforce_g_ad<float,double>(fix->get_mixed_buffers());
@@ -398,9 +398,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
     } else {
       fieldforce_g_ad<float,float>(fix->get_single_buffers());
     }
-
-      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_PERATOM_G);
-
     } else {
       poisson_ik(work1_6, work2_6, density_fft_g, fft1_6, fft2_6,
                  nx_pppm_6, ny_pppm_6, nz_pppm_6, nfft_6, nxlo_fft_6,
@@ -411,7 +408,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                  vdz_brick_g, virial_6, vg_6, vg2_6, u_brick_g, v0_brick_g,
                  v1_brick_g, v2_brick_g, v3_brick_g, v4_brick_g, v5_brick_g);
 
-      cg_6->forward_comm(this,FORWARD_IK_G);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_G);
+      else cg_6->forward_comm(this,FORWARD_IK_G);
 
     if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
       fieldforce_g_ik<float,double>(fix->get_mixed_buffers());
@@ -420,9 +418,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
     } else {
       fieldforce_g_ik<float,float>(fix->get_single_buffers());
     }
-
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_G);
     }
     if (evflag_atom) fieldforce_g_peratom();
   }
@@ -479,7 +474,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                     v5_brick_a2, u_brick_a4, v0_brick_a4, v1_brick_a4,
                     v2_brick_a4, v3_brick_a4, v4_brick_a4, v5_brick_a4);
 
-      cg_6->forward_comm(this, FORWARD_AD_A);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_A);
+      else cg_6->forward_comm(this,FORWARD_AD_A);
 
     if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
       fieldforce_a_ad<float,double>(fix->get_mixed_buffers());
@@ -488,9 +484,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
     } else {
       fieldforce_a_ad<float,float>(fix->get_single_buffers());
     }
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_AD_PERATOM_A);
-
     }  else {
 
       poisson_ik(work1_6, work2_6, density_fft_a3, fft1_6, fft2_6,
@@ -520,7 +513,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
                     u_brick_a4, v0_brick_a4, v1_brick_a4, v2_brick_a4,
                     v3_brick_a4, v4_brick_a4, v5_brick_a4);
 
-      cg_6->forward_comm(this, FORWARD_IK_A);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_A);
+      else cg_6->forward_comm(this,FORWARD_IK_A);
 
       if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
         fieldforce_a_ik<float,double>(fix->get_mixed_buffers());
@@ -529,8 +523,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
       } else {
         fieldforce_a_ik<float,float>(fix->get_single_buffers());
       }
-
-      if (evflag_atom) cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_A);
     }
     if (evflag_atom) fieldforce_a_peratom();
   }
@@ -576,7 +568,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
         n += 2;
       }
 
-      cg_6->forward_comm(this,FORWARD_AD_NONE);
+      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_ALL_NONE);
+      else cg_6->forward_comm(this,FORWARD_AD_NONE);
 
     if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
       fieldforce_none_ad<float,double>(fix->get_mixed_buffers());
@@ -585,9 +578,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
     } else {
       fieldforce_none_ad<float,float>(fix->get_single_buffers());
     }
-
-      if (vflag_atom) cg_peratom_6->forward_comm(this,FORWARD_AD_PERATOM_NONE);
-
     } else {
       int n = 0;
       for (int k = 0; k<nsplit_alloc/2; k++) {
@@ -602,7 +592,8 @@ void PPPMDispIntel::compute(int eflag, int vflag)
         n += 2;
       }
 
-      cg_6->forward_comm(this,FORWARD_IK_NONE);
+      if (evflag_atom) cg_peratom_6->forward_comm(this,FORWARD_IK_ALL_NONE);
+      else cg_6->forward_comm(this,FORWARD_IK_NONE);
 
     if (fix->precision() == FixIntel::PREC_MODE_MIXED) {
       fieldforce_none_ik<float,double>(fix->get_mixed_buffers());
@@ -612,8 +603,6 @@ void PPPMDispIntel::compute(int eflag, int vflag)
       fieldforce_none_ik<float,float>(fix->get_single_buffers());
     }
 
-      if (evflag_atom)
-        cg_peratom_6->forward_comm(this, FORWARD_IK_PERATOM_NONE);
     }
     if (evflag_atom) fieldforce_none_peratom();
   }
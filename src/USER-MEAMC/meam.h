@@ -103,7 +103,10 @@ private:
   double dr, rdrar;
 
 public:
-  int nmax;
+  // rho0, arho1-3, arho2b, arho3b, t_ave and tsq_ave are accumulated
+  // over pairs and hold nthreads copies of nmax rows each, one per thread
+
+  int nmax, nthreads;
   double *rho, *rho0, *rho1, *rho2, *rho3, *frhop;
   double *gamma, *dgamma1, *dgamma2, *dgamma3, *arho2b;
   double **arho1, **arho2, **arho3, **arho3b, **t_ave, **tsq_ave;
@@ -209,7 +212,7 @@ protected:
   void getscreen(int i, double* scrfcn, double* dscrfcn, double* fcpair, double** x, int numneigh,
                  int* firstneigh, int numneigh_full, int* firstneigh_full, int ntype, int* type, int* fmap);
   void calc_rho1(int i, int ntype, int* type, int* fmap, double** x, int numneigh, int* firstneigh,
-                 double* scrfcn, double* fcpair);
+                 double* scrfcn, double* fcpair, int thr_offset);
 
   void alloyparams();
   void compute_pair_meam();
@@ -263,10 +266,10 @@ public:
                          int* ibar);
   void meam_setup_param(int which, double value, int nindex, int* index /*index(3)*/, int* errorflag);
   void meam_setup_done(double* cutmax);
-  void meam_dens_setup(int atom_nmax, int nall, int n_neigh);
+  void meam_dens_setup(int atom_nmax, int nall, int n_neigh, int nthr);
   void meam_dens_init(int i, int ntype, int* type, int* fmap, double** x, int numneigh, int* firstneigh,
-                      int numneigh_full, int* firstneigh_full, int fnoffset);
-  void meam_dens_final(int nlocal, int eflag_either, int eflag_global, int eflag_atom, double* eng_vdwl,
+                      int numneigh_full, int* firstneigh_full, int fnoffset, int thr_offset);
+  void meam_dens_final(int ifrom, int ito, int eflag_either, int eflag_global, int eflag_atom, double* eng_vdwl,
                        double* eatom, int ntype, int* type, int* fmap, double** scale, int& errorflag);
   void meam_force(int i, int eflag_either, int eflag_global, int eflag_atom, int vflag_atom, double* eng_vdwl,
                   double* eatom, int ntype, int* type, int* fmap, double** scale, double** x, int numneigh, int* firstneigh,
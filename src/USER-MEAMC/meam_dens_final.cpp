@@ -3,7 +3,7 @@
 using namespace LAMMPS_NS;
 
 void
-MEAM::meam_dens_final(int nlocal, int eflag_either, int eflag_global, int eflag_atom, double* eng_vdwl,
+MEAM::meam_dens_final(int ifrom, int ito, int eflag_either, int eflag_global, int eflag_atom, double* eng_vdwl,
                       double* eatom, int /*ntype*/, int* type, int* fmap, double** scale, int& errorflag)
 {
   int i, elti;
@@ -12,9 +12,9 @@ MEAM::meam_dens_final(int nlocal, int eflag_either, int eflag_global, int eflag_
   double denom, rho_bkgd, Fl;
   double scaleii;
 
-  //     Complete the calculation of density
+  //     Complete the calculation of density for local atoms ifrom to ito-1
 
-  for (i = 0; i < nlocal; i++) {
+  for (i = ifrom; i < ito; i++) {
     elti = fmap[type[i]];
     if (elti >= 0) {
       scaleii = scale[type[i]][type[i]];
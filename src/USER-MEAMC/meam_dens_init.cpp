@@ -6,13 +6,14 @@
 using namespace LAMMPS_NS;
 
 void
-MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh)
+MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh, int nthr)
 {
   int i, j;
 
   // grow local arrays if necessary
+  // accumulated densities are stored once per thread
 
-  if (atom_nmax > nmax) {
+  if (atom_nmax > nmax || nthr != nthreads) {
     memory->destroy(rho);
     memory->destroy(rho0);
     memory->destroy(rho1);
@@ -32,9 +33,10 @@ MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh)
     memory->destroy(tsq_ave);
 
     nmax = atom_nmax;
+    nthreads = nthr;
 
     memory->create(rho, nmax, "pair:rho");
-    memory->create(rho0, nmax, "pair:rho0");
+    memory->create(rho0, nthreads * nmax, "pair:rho0");
     memory->create(rho1, nmax, "pair:rho1");
     memory->create(rho2, nmax, "pair:rho2");
     memory->create(rho3, nmax, "pair:rho3");
@@ -43,13 +45,13 @@ MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh)
     memory->create(dgamma1, nmax, "pair:dgamma1");
     memory->create(dgamma2, nmax, "pair:dgamma2");
     memory->create(dgamma3, nmax, "pair:dgamma3");
-    memory->create(arho2b, nmax, "pair:arho2b");
-    memory->create(arho1, nmax, 3, "pair:arho1");
-    memory->create(arho2, nmax, 6, "pair:arho2");
-    memory->create(arho3, nmax, 10, "pair:arho3");
-    memory->create(arho3b, nmax, 3, "pair:arho3b");
-    memory->create(t_ave, nmax, 3, "pair:t_ave");
-    memory->create(tsq_ave, nmax, 3, "pair:tsq_ave");
+    memory->create(arho2b, nthreads * nmax, "pair:arho2b");
+    memory->create(arho1, nthreads * nmax, 3, "pair:arho1");
+    memory->create(arho2, nthreads * nmax, 6, "pair:arho2");
+    memory->create(arho3, nthreads * nmax, 10, "pair:arho3");
+    memory->create(arho3b, nthreads * nmax, 3, "pair:arho3b");
+    memory->create(t_ave, nthreads * nmax, 3, "pair:t_ave");
+    memory->create(tsq_ave, nthreads * nmax, 3, "pair:tsq_ave");
   }
 
   if (n_neigh > maxneigh) {
@@ -63,6 +65,7 @@ MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh)
   }
 
   // zero out local arrays
+  // only the first copy, additional threads clear their own copy
 
   for (i = 0; i < nall; i++) {
     rho0[i] = 0.0;
@@ -81,14 +84,15 @@ MEAM::meam_dens_setup(int atom_nmax, int nall, int n_neigh)
 void
 MEAM::meam_dens_init(int i, int ntype, int* type, int* fmap, double** x,
                      int numneigh, int* firstneigh,
-                     int numneigh_full, int* firstneigh_full, int fnoffset)
+                     int numneigh_full, int* firstneigh_full, int fnoffset, int thr_offset)
 {
   //     Compute screening function and derivatives
   getscreen(i, &scrfcn[fnoffset], &dscrfcn[fnoffset], &fcpair[fnoffset], x, numneigh, firstneigh,
             numneigh_full, firstneigh_full, ntype, type, fmap);
 
   //     Calculate intermediate density terms to be communicated
-  calc_rho1(i, ntype, type, fmap, x, numneigh, firstneigh, &scrfcn[fnoffset], &fcpair[fnoffset]);
+  //     into the copy of the accumulated densities starting at row thr_offset
+  calc_rho1(i, ntype, type, fmap, x, numneigh, firstneigh, &scrfcn[fnoffset], &fcpair[fnoffset], thr_offset);
 }
 
 // ccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc
@@ -258,7 +262,7 @@ MEAM::getscreen(int i, double* scrfcn, double* dscrfcn, double* fcpair, double**
 
 void
 MEAM::calc_rho1(int i, int /*ntype*/, int* type, int* fmap, double** x, int numneigh, int* firstneigh,
-                double* scrfcn, double* fcpair)
+                double* scrfcn, double* fcpair, int thr_offset)
 {
   int jn, j, m, n, p, elti, eltj;
   int nv2, nv3;
@@ -268,6 +272,15 @@ MEAM::calc_rho1(int i, int /*ntype*/, int* type, int* fmap, double** x, int numn
   double ro0i, ro0j;
   double rhoa0i, rhoa1i, rhoa2i, rhoa3i, A1i, A2i, A3i;
 
+  double* const rho0 = this->rho0 + thr_offset;
+  double* const arho2b = this->arho2b + thr_offset;
+  double** const arho1 = this->arho1 + thr_offset;
+  double** const arho2 = this->arho2 + thr_offset;
+  double** const arho3 = this->arho3 + thr_offset;
+  double** const arho3b = this->arho3b + thr_offset;
+  double** const t_ave = this->t_ave + thr_offset;
+  double** const tsq_ave = this->tsq_ave + thr_offset;
+
   elti = fmap[type[i]];
   xtmp = x[i][0];
   ytmp = x[i][1];
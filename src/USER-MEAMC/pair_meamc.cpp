@@ -120,7 +120,7 @@ void PairMEAMC::compute(int eflag, int vflag)
   n = 0;
   for (ii = 0; ii < inum_half; ii++) n += numneigh_half[ilist_half[ii]];
 
-  meam_inst->meam_dens_setup(atom->nmax, nall, n);
+  meam_inst->meam_dens_setup(atom->nmax, nall, n, 1);
 
   double **x = atom->x;
   double **f = atom->f;
@@ -138,13 +138,13 @@ void PairMEAMC::compute(int eflag, int vflag)
     meam_inst->meam_dens_init(i,ntype,type,map,x,
                     numneigh_half[i],firstneigh_half[i],
                     numneigh_full[i],firstneigh_full[i],
-                    offset);
+                    offset,0);
     offset += numneigh_half[i];
   }
 
   comm->reverse_comm_pair(this);
 
-  meam_inst->meam_dens_final(nlocal,eflag_either,eflag_global,eflag_atom,
+  meam_inst->meam_dens_final(0,nlocal,eflag_either,eflag_global,eflag_atom,
                    &eng_vdwl,eatom,ntype,type,map,scale,errorflag);
   if (errorflag) {
     char str[128];
@@ -759,8 +759,9 @@ void PairMEAMC::unpack_reverse_comm(int n, int *list, double *buf)
 
 double PairMEAMC::memory_usage()
 {
-  double bytes = 11 * meam_inst->nmax * sizeof(double);
-  bytes += (3 + 6 + 10 + 3 + 3 + 3) * meam_inst->nmax * sizeof(double);
+  double bytes = 9 * meam_inst->nmax * sizeof(double);
+  bytes += (2 + 3 + 6 + 10 + 3 + 3 + 3) * meam_inst->nthreads *
+    meam_inst->nmax * sizeof(double);
   bytes += 3 * meam_inst->maxneigh * sizeof(double);
   return bytes;
 }
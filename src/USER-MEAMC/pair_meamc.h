@@ -29,7 +29,7 @@ class PairMEAMC : public Pair {
  public:
   PairMEAMC(class LAMMPS *);
   ~PairMEAMC();
-  void compute(int, int);
+  virtual void compute(int, int);
   void settings(int, char **);
   void coeff(int, char **);
   void init_style();
@@ -43,7 +43,7 @@ class PairMEAMC : public Pair {
   void unpack_reverse_comm(int, int *, double *);
   double memory_usage();
 
- private:
+ protected:
   class MEAM *meam_inst;
   double cutmax;                // max cutoff for all elements
   int nelements;                // # of unique elements
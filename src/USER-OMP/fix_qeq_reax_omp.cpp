@@ -41,6 +41,7 @@
 #include "update.h"
 #include "memory.h"
 #include "error.h"
+#include "qeq_extrapolate.h"
 #include "reaxc_defs.h"
 #include "reaxc_types.h"
 
@@ -63,17 +64,9 @@ using namespace FixConst;
 FixQEqReaxOMP::FixQEqReaxOMP(LAMMPS *lmp, int narg, char **arg) :
   FixQEqReax(lmp, narg, arg)
 {
-  if (narg<8 || narg>9) error->all(FLERR,"Illegal fix qeq/reax/omp command");
+  if (narg < 8) error->all(FLERR,"Illegal fix qeq/reax/omp command");
 
   b_temp = NULL;
-
-  // ASPC: Kolafa, J. Comp. Chem., 25(3), 335 (2003)
-  do_aspc = 0;
-  aspc_order = 1;
-  // Must be consistent with nprev to store history: nprev = aspc_order + 2
-  aspc_order_max = nprev - 2;
-  aspc_omega = 0.0;
-  aspc_b = NULL;
 }
 
 FixQEqReaxOMP::~FixQEqReaxOMP()
@@ -86,6 +79,9 @@ FixQEqReaxOMP::~FixQEqReaxOMP()
 void FixQEqReaxOMP::post_constructor()
 {
   pertype_parameters(pertype_option);
+  if (pipeline_flag || icflag)
+    error->all(FLERR,"Fix qeq/reax/omp does not support keywords "
+               "pipeline or precond ic");
 }
 
 /* ---------------------------------------------------------------------- */
@@ -111,41 +107,6 @@ void FixQEqReaxOMP::deallocate_storage()
 
 /* ---------------------------------------------------------------------- */
 
-void FixQEqReaxOMP::init()
-{
-  FixQEqReax::init();
-
-  // APSC setup
-  if (do_aspc) {
-    memory->create(aspc_b, aspc_order_max+2, "qeq/reax/aspc_b");
-
-    // Calculate damping factor
-    double o = double(aspc_order);
-    aspc_omega = (o+2.0) / (2*o+3.0);
-
-    // Calculate B coefficients
-    double c = (4.0 * o + 6.0) / (o + 3.0);
-    aspc_b[0] = c;
-
-    double n =  1.0;
-    double d =  4.0;
-    double s = -1.0;
-    double f =  2.0;
-
-    for (int i=1; i<aspc_order_max+2; i++) {
-      c*= (o + n) / (o + d);
-      aspc_b[i] = s * f * c;
-
-      s *= -1.0;
-      f += 1.0;
-      n -= 1.0;
-      d += 1.0;
-    }
-  }
-}
-
-/* ---------------------------------------------------------------------- */
-
 void FixQEqReaxOMP::compute_H()
 {
   int inum, *ilist, *numneigh, **firstneigh;
@@ -329,8 +290,11 @@ void FixQEqReaxOMP::pre_force(int /* vflag */)
     startTimeBase = endTimeBase;
 #endif
 
+    matvecs = matvecs_s + matvecs_t;
   } // if (dual_enabled)
 
+  extrap->count_matvecs(matvecs);
+
 #ifdef OMP_TIMING
   startTimeBase = MPI_Wtime();
 #endif
@@ -376,10 +340,10 @@ void FixQEqReaxOMP::init_matvec()
     ilist = list->ilist;
   }
 
-  // Should really be more careful with initialization and first (aspc_order+2) MD steps
-  if (do_aspc) {
+  extrap->coeffs(nn,ilist,groupbit,s_hist,t_hist);
+
+  if (extrap->nextrap) {
 
-    double m_aspc_omega = 1.0 - aspc_omega;
 #if defined(_OPENMP)
 #pragma omp parallel for schedule(dynamic,50) private(i)
 #endif
@@ -392,17 +356,15 @@ void FixQEqReaxOMP::init_matvec()
         b_s[i]      = -chi[ atom->type[i] ];
         b_t[i]      = -1.0;
 
-        // Predictor Step
+        /* ASPC or least-squares extrapolation from previous solutions */
         double tp = 0.0;
         double sp = 0.0;
-        for (int j=0; j<aspc_order+2; j++) {
-          tp+= aspc_b[j] * t_hist[i][j];
-          sp+= aspc_b[j] * s_hist[i][j];
+        for (int j=0; j<extrap->nextrap; j++) {
+          tp+= extrap->ct[j] * t_hist[i][j];
+          sp+= extrap->cs[j] * s_hist[i][j];
         }
-
-        // Corrector Step
-        t[i] = aspc_omega * t_hist[i][0] + m_aspc_omega * tp;
-        s[i] = aspc_omega * s_hist[i][0] + m_aspc_omega * sp;
+        t[i] = tp;
+        s[i] = sp;
       }
     }
 
@@ -29,7 +29,6 @@ class FixQEqReaxOMP : public FixQEqReax {
  public:
   FixQEqReaxOMP(class LAMMPS *, int, char **);
   ~FixQEqReaxOMP();
-  virtual void init();
   virtual void init_storage();
   virtual void pre_force(int);
   virtual void post_constructor();
@@ -37,11 +36,6 @@ class FixQEqReaxOMP : public FixQEqReax {
  protected:
   double **b_temp;
 
-  int do_aspc;
-  int aspc_order, aspc_order_max;
-  double aspc_omega;
-  double * aspc_b;
-
   virtual void allocate_storage();
   virtual void deallocate_storage();
   virtual void init_matvec();
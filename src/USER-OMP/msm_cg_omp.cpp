@@ -188,11 +188,12 @@ void MSMCGOMP::compute(int eflag, int vflag)
 
   // forward communicate charge density values to fill ghost grid points
   // compute direct sum interaction and then restrict to coarser grid
+  // ghost comm is skipped on levels without ghost grid values
 
   for (int n=0; n<=levels-2; n++) {
     if (!active_flag[n]) continue;
     current_level = n;
-    cg[n]->forward_comm(this,FORWARD_RHO);
+    if (ghost_flag[n]) cg[n]->forward_comm(this,FORWARD_RHO);
 
     direct(n);
     restriction(n);
@@ -205,10 +206,10 @@ void MSMCGOMP::compute(int eflag, int vflag)
   if (active_flag[levels-1]) {
     if (domain->nonperiodic) {
       current_level = levels-1;
-      cg[levels-1]->forward_comm(this,FORWARD_RHO);
+      if (ghost_flag[levels-1]) cg[levels-1]->forward_comm(this,FORWARD_RHO);
       direct_top(levels-1);
-      cg[levels-1]->reverse_comm(this,REVERSE_AD);
-      if (vflag_atom)
+      if (ghost_flag[levels-1]) cg[levels-1]->reverse_comm(this,REVERSE_AD);
+      if (vflag_atom && ghost_flag[levels-1])
         cg_peratom[levels-1]->reverse_comm(this,REVERSE_AD_PERATOM);
     } else {
       // Here using MPI_Allreduce is cheaper than using commgrid
@@ -216,7 +217,7 @@ void MSMCGOMP::compute(int eflag, int vflag)
       direct(levels-1);
       grid_swap_reverse(levels-1,egrid[levels-1]);
       current_level = levels-1;
-      if (vflag_atom)
+      if (vflag_atom && ghost_flag[levels-1])
         cg_peratom[levels-1]->reverse_comm(this,REVERSE_AD_PERATOM);
     }
   }
@@ -229,11 +230,11 @@ void MSMCGOMP::compute(int eflag, int vflag)
     prolongation(n);
 
     current_level = n;
-    cg[n]->reverse_comm(this,REVERSE_AD);
+    if (ghost_flag[n]) cg[n]->reverse_comm(this,REVERSE_AD);
 
     // extra per-atom virial communication
 
-    if (vflag_atom)
+    if (vflag_atom && ghost_flag[n])
       cg_peratom[n]->reverse_comm(this,REVERSE_AD_PERATOM);
   }
 
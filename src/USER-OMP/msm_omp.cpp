@@ -71,6 +71,29 @@ void MSMOMP::compute(int eflag, int vflag)
 ------------------------------------------------------------------------- */
 
 void MSMOMP::direct(int n)
+{
+  direct_omp(n,0);
+}
+
+/* ----------------------------------------------------------------------
+   MSM direct sum procedure for top grid level (nonperiodic systems only)
+------------------------------------------------------------------------- */
+
+void MSMOMP::direct_top(int n)
+{
+  direct_omp(n,1);
+}
+
+/* ----------------------------------------------------------------------
+   threaded direct sum on grid level n, top = 1 for the top grid level
+   of a non-periodic system, which interacts with all grid points
+   the hemisphere is evaluated twice without write conflicts: as a
+   gather of the potential at each owned grid point from its upper
+   half-stencil (direct_eval), and as a gather of the lower half-stencil
+   contributions to each owned or ghost grid point (direct_scatter)
+------------------------------------------------------------------------- */
+
+void MSMOMP::direct_omp(int n, int top)
 {
   // zero out electric potential
 
@@ -90,77 +113,147 @@ void MSMOMP::direct(int n)
   if (eflag_global) {
     if (vflag_global) {
       if (vflag_atom)
-        direct_eval<1,1,1>(n);
+        direct_eval<1,1,1>(n,top);
       else
-        direct_eval<1,1,0>(n);
+        direct_eval<1,1,0>(n,top);
     } else {
       if (vflag_atom)
-        direct_eval<1,0,1>(n);
+        direct_eval<1,0,1>(n,top);
       else
-        direct_eval<1,0,0>(n);
+        direct_eval<1,0,0>(n,top);
     }
   } else { // !eflag_global
     if (vflag_global) {
       if (vflag_atom)
-        direct_eval<0,1,1>(n);
+        direct_eval<0,1,1>(n,top);
       else
-        direct_eval<0,1,0>(n);
+        direct_eval<0,1,0>(n,top);
     } else {
       if (vflag_atom)
-        direct_eval<0,0,1>(n);
+        direct_eval<0,0,1>(n,top);
       else
-        direct_eval<0,0,0>(n);
+        direct_eval<0,0,0>(n,top);
     }
   }
 
   if (vflag_atom)
-    direct_peratom<1>(n);
+    direct_scatter<1>(n,top);
   else
-    direct_peratom<0>(n);
+    direct_scatter<0>(n,top);
 }
 
+/* ----------------------------------------------------------------------
+   set direct sum kernels and their extent for grid level n
+   c = offset of the kernel center, nx,ny = kernel strides
+   dlo,dhi = range of stencil offsets in x,y, dzhi = upper range in z
+------------------------------------------------------------------------- */
+
+void MSMOMP::direct_stencil(int n, int top, double **kernel, int *c,
+                            int &nx, int &ny, int *dlo, int *dhi, int &dzhi)
+{
+  if (top) {
+    kernel[0] = g_direct_top;
+    kernel[1] = v0_direct_top;
+    kernel[2] = v1_direct_top;
+    kernel[3] = v2_direct_top;
+    kernel[4] = v3_direct_top;
+    kernel[5] = v4_direct_top;
+    kernel[6] = v5_direct_top;
+
+    c[0] = betax[n] - alpha[n];
+    c[1] = betay[n] - alpha[n];
+    c[2] = betaz[n] - alpha[n];
+
+    // periodic dims interact with one image of each grid point
+
+    dlo[0] = domain->xperiodic ? 0 : -c[0];
+    dhi[0] = domain->xperiodic ? nx_msm[n]-1 : c[0];
+    dlo[1] = domain->yperiodic ? 0 : -c[1];
+    dhi[1] = domain->yperiodic ? ny_msm[n]-1 : c[1];
+    dzhi = domain->zperiodic ? nz_msm[n]-1 : c[2];
+  } else {
+    kernel[0] = g_direct[n];
+    kernel[1] = v0_direct[n];
+    kernel[2] = v1_direct[n];
+    kernel[3] = v2_direct[n];
+    kernel[4] = v3_direct[n];
+    kernel[5] = v4_direct[n];
+    kernel[6] = v5_direct[n];
+
+    c[0] = nxhi_direct;
+    c[1] = nyhi_direct;
+    c[2] = nzhi_direct;
+
+    dlo[0] = nxlo_direct;
+    dhi[0] = nxhi_direct;
+    dlo[1] = nylo_direct;
+    dhi[1] = nyhi_direct;
+    dzhi = nzhi_direct;
+  }
+
+  nx = 2*c[0] + 1;
+  ny = 2*c[1] + 1;
+}
+
+/* ----------------------------------------------------------------------
+   gather potential and virial at each owned grid point
+   from the upper hemisphere of its stencil
+------------------------------------------------------------------------- */
+
 template <int EFLAG_GLOBAL, int VFLAG_GLOBAL, int VFLAG_ATOM>
-void MSMOMP::direct_eval(const int nn)
+void MSMOMP::direct_eval(int nn, int top)
 {
-  const double * _noalias const * _noalias const * _noalias const qgridn = qgrid[nn];
-  const double * _noalias const g_directn = g_direct[nn];
-  const double * _noalias const v0_directn = v0_direct[nn];
-  const double * _noalias const v1_directn = v1_direct[nn];
-  const double * _noalias const v2_directn = v2_direct[nn];
-  const double * _noalias const v3_directn = v3_direct[nn];
-  const double * _noalias const v4_directn = v4_direct[nn];
-  const double * _noalias const v5_directn = v5_direct[nn];
+  double *kernel[7];
+  int c[3],dlo[2],dhi[2];
+  int nx,ny,dzhi;
+
+  direct_stencil(nn,top,kernel,c,nx,ny,dlo,dhi,dzhi);
+
+  double ***qgridn = qgrid[nn];
+  double ***egridn = egrid[nn];
+  double ***v0gridn = v0grid[nn];
+  double ***v1gridn = v1grid[nn];
+  double ***v2gridn = v2grid[nn];
+  double ***v3gridn = v3grid[nn];
+  double ***v4gridn = v4grid[nn];
+  double ***v5gridn = v5grid[nn];
 
   double v0,v1,v2,v3,v4,v5,emsm;
   v0 = v1 = v2 = v3 = v4 = v5 = emsm = 0.0;
-  const int alphan = alpha[nn];
-  const int betaxn = betax[nn];
-  const int betayn = betay[nn];
-  const int betazn = betaz[nn];
-
-  const int nx = nxhi_direct - nxlo_direct + 1;
-  const int ny = nyhi_direct - nylo_direct + 1;
 
   // merge three outer loops into one for better threading
 
-  const int nzlo_inn = nzlo_in[nn];
-  const int nylo_inn = nylo_in[nn];
-  const int nxlo_inn = nxlo_in[nn];
-  const int numz = nzhi_in[nn] - nzlo_inn + 1;
-  const int numy = nyhi_in[nn] - nylo_inn + 1;
-  const int numx = nxhi_in[nn] - nxlo_inn + 1;
-  const int inum = numz*numy*numx;
-
-  const int zper = domain->zperiodic;
-  const int yper = domain->yperiodic;
-  const int xper = domain->xperiodic;
-
-  const int n=nn;
+  int numz = nzhi_in[nn] - nzlo_in[nn] + 1;
+  int numy = nyhi_in[nn] - nylo_in[nn] + 1;
+  int numx = nxhi_in[nn] - nxlo_in[nn] + 1;
+  int inum = numz*numy*numx;
 
 #if defined(_OPENMP)
-#pragma omp parallel default(none) reduction(+:v0,v1,v2,v3,v4,v5,emsm)
+#pragma omp parallel default(none) \
+  shared(nn,kernel,c,dlo,dhi,nx,ny,dzhi,qgridn,egridn,v0gridn,v1gridn, \
+         v2gridn,v3gridn,v4gridn,v5gridn,numz,numy,numx,inum) \
+  reduction(+:v0,v1,v2,v3,v4,v5,emsm)
 #endif
   {
+    const double * _noalias const g_directn = kernel[0];
+    const double * _noalias const v0_directn = kernel[1];
+    const double * _noalias const v1_directn = kernel[2];
+    const double * _noalias const v2_directn = kernel[3];
+    const double * _noalias const v3_directn = kernel[4];
+    const double * _noalias const v4_directn = kernel[5];
+    const double * _noalias const v5_directn = kernel[6];
+
+    const int cx = c[0];
+    const int cy = c[1];
+    const int cz = c[2];
+    const int alphan = alpha[nn];
+    const int betaxn = betax[nn];
+    const int betayn = betay[nn];
+    const int betazn = betaz[nn];
+    const int xper = domain->xperiodic;
+    const int yper = domain->yperiodic;
+    const int zper = domain->zperiodic;
+
     double esum,v0sum,v1sum,v2sum,v3sum,v4sum,v5sum;
     int i,ifrom,ito,tid,icx,icy,icz,ix,iy,iz,k;
 
@@ -175,15 +268,15 @@ void MSMOMP::direct_eval(const int nn)
       icz = i/(numy*numx);
       icy = (i - icz*numy*numx) / numx;
       icx = i - icz*numy*numx - icy*numx;
-      icz += nzlo_inn;
-      icy += nylo_inn;
-      icx += nxlo_inn;
+      icz += nzlo_in[nn];
+      icy += nylo_in[nn];
+      icx += nxlo_in[nn];
 
-      const int kmax = zper ? nzhi_direct : MIN(nzhi_direct,betazn - icz);
-      const int jmin = yper ? nylo_direct : MAX(nylo_direct,alphan - icy);
-      const int jmax = yper ? nyhi_direct : MIN(nyhi_direct,betayn - icy);
-      const int imin = xper ? nxlo_direct : MAX(nxlo_direct,alphan - icx);
-      const int imax = xper ? nxhi_direct : MIN(nxhi_direct,betaxn - icx);
+      const int kmax = zper ? dzhi : MIN(dzhi,betazn - icz);
+      const int jmin = yper ? dlo[1] : MAX(dlo[1],alphan - icy);
+      const int jmax = yper ? dhi[1] : MIN(dhi[1],betayn - icy);
+      const int imin = xper ? dlo[0] : MAX(dlo[0],alphan - icx);
+      const int imax = xper ? dhi[0] : MIN(dhi[0],betaxn - icx);
 
       esum = 0.0;
       if (VFLAG_GLOBAL || VFLAG_ATOM)
@@ -194,14 +287,14 @@ void MSMOMP::direct_eval(const int nn)
 
       for (iz = 1; iz <= kmax; iz++) {
         const int kk = icz+iz;
-        const int zk = (iz + nzhi_direct)*ny;
+        const int zk = (iz + cz)*ny;
         for (iy = jmin; iy <= jmax; iy++) {
           const int jj = icy+iy;
-          const int zyk = (zk + iy + nyhi_direct)*nx;
+          const int zyk = (zk + iy + cy)*nx;
           const double * _noalias const qgridnkj = &qgridn[kk][jj][icx];
           for (ix = imin; ix <= imax; ix++) {
             const double qtmp2 = qgridnkj[ix];
-            k = zyk + ix + nxhi_direct;
+            k = zyk + ix + cx;
             const double gtmp = g_directn[k];
             esum += gtmp * qtmp2;
 
@@ -219,14 +312,14 @@ void MSMOMP::direct_eval(const int nn)
 
       // iz=0
 
-      const int zk = nzhi_direct*ny;
+      const int zk = cz*ny;
       for (iy = 1; iy <= jmax; iy++) {
         const int jj = icy+iy;
-        const int zyk = (zk + iy + nyhi_direct)*nx;
+        const int zyk = (zk + iy + cy)*nx;
         const double * _noalias const qgridnkj = &qgridn[icz][jj][icx];
         for (ix = imin; ix <= imax; ix++) {
           const double qtmp2 = qgridnkj[ix];
-          k = zyk + ix + nxhi_direct;
+          k = zyk + ix + cx;
           const double gtmp = g_directn[k];
           esum += gtmp * qtmp2;
 
@@ -243,11 +336,11 @@ void MSMOMP::direct_eval(const int nn)
 
       // iz=0, iy=0
 
-      const int zyk = (zk + nyhi_direct)*nx;
+      const int zyk = (zk + cy)*nx;
       const double * _noalias const qgridnkj = &qgridn[icz][icy][icx];
       for (ix = 1; ix <= imax; ix++) {
         const double qtmp2 = qgridnkj[ix];
-        k = zyk + ix + nxhi_direct;
+        k = zyk + ix + cx;
         const double gtmp = g_directn[k];
         esum += gtmp * qtmp2;
 
@@ -264,7 +357,7 @@ void MSMOMP::direct_eval(const int nn)
       // iz=0, iy=0, ix=0
 
       const double qtmp2 = qgridnkj[0];
-      k = zyk + nxhi_direct;
+      k = zyk + cx;
       const double gtmp = g_directn[k];
       esum += 0.5 * gtmp * qtmp2;
 
@@ -272,15 +365,15 @@ void MSMOMP::direct_eval(const int nn)
 
       // accumulate per-atom energy/virial
 
-      egrid[n][icz][icy][icx] = esum;
+      egridn[icz][icy][icx] = esum;
 
       if (VFLAG_ATOM) {
-        v0grid[n][icz][icy][icx] = v0sum;
-        v1grid[n][icz][icy][icx] = v1sum;
-        v2grid[n][icz][icy][icx] = v2sum;
-        v3grid[n][icz][icy][icx] = v3sum;
-        v4grid[n][icz][icy][icx] = v4sum;
-        v5grid[n][icz][icy][icx] = v5sum;
+        v0gridn[icz][icy][icx] = v0sum;
+        v1gridn[icz][icy][icx] = v1sum;
+        v2gridn[icz][icy][icx] = v2sum;
+        v3gridn[icz][icy][icx] = v3sum;
+        v4gridn[icz][icy][icx] = v4sum;
+        v5gridn[icz][icy][icx] = v5sum;
       }
 
       if (EFLAG_GLOBAL || VFLAG_GLOBAL) {
@@ -312,153 +405,482 @@ void MSMOMP::direct_eval(const int nn)
   }
 }
 
+/* ----------------------------------------------------------------------
+   add the contributions of the upper hemisphere stencils of all owned
+   grid points to the owned and ghost grid points they reach
+   written as a gather over target grid points t, so threads never
+   write to the same grid point: owned sources are s = t - d with d in
+   the upper hemisphere, summed in the same order as a serial scatter
+------------------------------------------------------------------------- */
+
 template <int VFLAG_ATOM>
-void MSMOMP::direct_peratom(const int nn)
+void MSMOMP::direct_scatter(int nn, int top)
 {
-  double * _noalias const * _noalias const * _noalias const egridn  = egrid[nn];
-  double * _noalias const * _noalias const * _noalias const v0gridn  = v0grid[nn];
-  double * _noalias const * _noalias const * _noalias const v1gridn  = v1grid[nn];
-  double * _noalias const * _noalias const * _noalias const v2gridn  = v2grid[nn];
-  double * _noalias const * _noalias const * _noalias const v3gridn  = v3grid[nn];
-  double * _noalias const * _noalias const * _noalias const v4gridn  = v4grid[nn];
-  double * _noalias const * _noalias const * _noalias const v5gridn  = v5grid[nn];
-  const double * _noalias const * _noalias const * _noalias const qgridn = qgrid[nn];
-  const double * _noalias const g_directn = g_direct[nn];
-  const double * _noalias const v0_directn = v0_direct[nn];
-  const double * _noalias const v1_directn = v1_direct[nn];
-  const double * _noalias const v2_directn = v2_direct[nn];
-  const double * _noalias const v3_directn = v3_direct[nn];
-  const double * _noalias const v4_directn = v4_direct[nn];
-  const double * _noalias const v5_directn = v5_direct[nn];
-
-
-  const int alphan = alpha[nn];
-  const int betaxn = betax[nn];
-  const int betayn = betay[nn];
-  const int betazn = betaz[nn];
-
-  const int nx = nxhi_direct - nxlo_direct + 1;
-  const int ny = nyhi_direct - nylo_direct + 1;
-
-  // merge three outer loops into one
-
-  const int nzlo_inn = nzlo_in[nn];
-  const int nylo_inn = nylo_in[nn];
-  const int nxlo_inn = nxlo_in[nn];
-  const int numz = nzhi_in[nn] - nzlo_inn + 1;
-  const int numy = nyhi_in[nn] - nylo_inn + 1;
-  const int numx = nxhi_in[nn] - nxlo_inn + 1;
-  const int inum = numz*numy*numx;
-
-  const int zper = domain->zperiodic;
-  const int yper = domain->yperiodic;
-  const int xper = domain->xperiodic;
-
-  int i,icx,icy,icz,ix,iy,iz,k;
-
-
-  for (i = 0; i < inum; ++i) {
-
-    // infer outer loop indices icx, icy, icz from master loop index i
-
-    icz = i/(numy*numx);
-    icy = (i - icz*numy*numx) / numx;
-    icx = i - icz*numy*numx - icy*numx;
-    icz += nzlo_inn;
-    icy += nylo_inn;
-    icx += nxlo_inn;
-
-    const int kmax = zper ? nzhi_direct : MIN(nzhi_direct,betazn - icz);
-    const int jmin = yper ? nylo_direct : MAX(nylo_direct,alphan - icy);
-    const int jmax = yper ? nyhi_direct : MIN(nyhi_direct,betayn - icy);
-    const int imin = xper ? nxlo_direct : MAX(nxlo_direct,alphan - icx);
-    const int imax = xper ? nxhi_direct : MIN(nxhi_direct,betaxn - icx);
-
-    const double qtmp = qgridn[icz][icy][icx]; // charge on center grid point
-
-
-    // use hemisphere to avoid double computation of pair-wise
-    //   interactions in direct sum (no computations in -z direction)
-
-    for (iz = 1; iz <= kmax; iz++) {
-      const int kk = icz+iz;
-      const int zk = (iz + nzhi_direct)*ny;
-      for (iy = jmin; iy <= jmax; iy++) {
-        const int jj = icy+iy;
-        const int zyk = (zk + iy + nyhi_direct)*nx;
-        double * _noalias const egridnkj = &egridn[kk][jj][icx];
-        for (ix = imin; ix <= imax; ix++) {
-          k = zyk + ix + nxhi_direct;
-          const int ii = icx+ix;
-          const double gtmp = g_directn[k];
+  double *kernel[7];
+  int c[3],dlo[2],dhi[2];
+  int nx,ny,dzhi;
+
+  direct_stencil(nn,top,kernel,c,nx,ny,dlo,dhi,dzhi);
+
+  double ***qgridn = qgrid[nn];
+  double ***egridn = egrid[nn];
+  double ***v0gridn = v0grid[nn];
+  double ***v1gridn = v1grid[nn];
+  double ***v2gridn = v2grid[nn];
+  double ***v3gridn = v3grid[nn];
+  double ***v4gridn = v4grid[nn];
+  double ***v5gridn = v5grid[nn];
 
-          egridnkj[ix] += gtmp * qtmp;
+  // merge three outer loops over owned and ghost grid points into one
 
-          if (VFLAG_ATOM) {
-            v0gridn[kk][jj][ii] += v0_directn[k] * qtmp;
-            v1gridn[kk][jj][ii] += v1_directn[k] * qtmp;
-            v2gridn[kk][jj][ii] += v2_directn[k] * qtmp;
-            v3gridn[kk][jj][ii] += v3_directn[k] * qtmp;
-            v4gridn[kk][jj][ii] += v4_directn[k] * qtmp;
-            v5gridn[kk][jj][ii] += v5_directn[k] * qtmp;
+  int numz = nzhi_out[nn] - nzlo_out[nn] + 1;
+  int numy = nyhi_out[nn] - nylo_out[nn] + 1;
+  int numx = nxhi_out[nn] - nxlo_out[nn] + 1;
+  int inum = numz*numy*numx;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(none) \
+  shared(nn,kernel,c,dlo,dhi,nx,ny,dzhi,qgridn,egridn,v0gridn,v1gridn, \
+         v2gridn,v3gridn,v4gridn,v5gridn,numz,numy,numx,inum)
+#endif
+  {
+    const double * _noalias const g_directn = kernel[0];
+    const double * _noalias const v0_directn = kernel[1];
+    const double * _noalias const v1_directn = kernel[2];
+    const double * _noalias const v2_directn = kernel[3];
+    const double * _noalias const v3_directn = kernel[4];
+    const double * _noalias const v4_directn = kernel[5];
+    const double * _noalias const v5_directn = kernel[6];
+
+    const int cx = c[0];
+    const int cy = c[1];
+    const int cz = c[2];
+
+    double esum,v0sum,v1sum,v2sum,v3sum,v4sum,v5sum;
+    int i,ifrom,ito,tid,itx,ity,itz,ix,iy,iz,k;
+
+    loop_setup_thr(ifrom, ito, tid, inum, comm->nthreads);
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+
+    for (i = ifrom; i < ito; ++i) {
+
+      // infer target grid point itx, ity, itz from master loop index i
+
+      itz = i/(numy*numx);
+      ity = (i - itz*numy*numx) / numx;
+      itx = i - itz*numy*numx - ity*numx;
+      itz += nzlo_out[nn];
+      ity += nylo_out[nn];
+      itx += nxlo_out[nn];
+
+      // range of stencil offsets whose source grid point is owned
+      // non-periodic bounds are met since ghost grid points are clipped
+
+      const int kmin = MAX(0,itz - nzhi_in[nn]);
+      const int kmax = MIN(dzhi,itz - nzlo_in[nn]);
+      const int jmin = MAX(dlo[1],ity - nyhi_in[nn]);
+      const int jmax = MIN(dhi[1],ity - nylo_in[nn]);
+      const int imin = MAX(dlo[0],itx - nxhi_in[nn]);
+      const int imax = MIN(dhi[0],itx - nxlo_in[nn]);
+
+      if (kmin > kmax || jmin > jmax || imin > imax) continue;
+
+      esum = egridn[itz][ity][itx];
+      if (VFLAG_ATOM) {
+        v0sum = v0gridn[itz][ity][itx];
+        v1sum = v1gridn[itz][ity][itx];
+        v2sum = v2gridn[itz][ity][itx];
+        v3sum = v3gridn[itz][ity][itx];
+        v4sum = v4gridn[itz][ity][itx];
+        v5sum = v5gridn[itz][ity][itx];
+      }
+
+      // offsets in +z direction
+
+      for (iz = kmax; iz >= MAX(1,kmin); iz--) {
+        const int kk = itz-iz;
+        const int zk = (iz + cz)*ny;
+        for (iy = jmax; iy >= jmin; iy--) {
+          const int jj = ity-iy;
+          const int zyk = (zk + iy + cy)*nx;
+          const double * _noalias const qgridnkj = &qgridn[kk][jj][itx];
+          for (ix = imax; ix >= imin; ix--) {
+            const double qtmp = qgridnkj[-ix];
+            k = zyk + ix + cx;
+            esum += g_directn[k] * qtmp;
+
+            if (VFLAG_ATOM) {
+              v0sum += v0_directn[k] * qtmp;
+              v1sum += v1_directn[k] * qtmp;
+              v2sum += v2_directn[k] * qtmp;
+              v3sum += v3_directn[k] * qtmp;
+              v4sum += v4_directn[k] * qtmp;
+              v5sum += v5_directn[k] * qtmp;
+            }
+          }
+        }
+      }
+
+      if (kmin == 0) {
+
+        // iz=0
+
+        const int zk = cz*ny;
+        for (iy = jmax; iy >= MAX(1,jmin); iy--) {
+          const int jj = ity-iy;
+          const int zyk = (zk + iy + cy)*nx;
+          const double * _noalias const qgridnkj = &qgridn[itz][jj][itx];
+          for (ix = imax; ix >= imin; ix--) {
+            const double qtmp = qgridnkj[-ix];
+            k = zyk + ix + cx;
+            esum += g_directn[k] * qtmp;
+
+            if (VFLAG_ATOM) {
+              v0sum += v0_directn[k] * qtmp;
+              v1sum += v1_directn[k] * qtmp;
+              v2sum += v2_directn[k] * qtmp;
+              v3sum += v3_directn[k] * qtmp;
+              v4sum += v4_directn[k] * qtmp;
+              v5sum += v5_directn[k] * qtmp;
+            }
+          }
+        }
+
+        if (jmin <= 0 && jmax >= 0) {
+
+          // iz=0, iy=0
+
+          const int zyk = (zk + cy)*nx;
+          const double * _noalias const qgridnkj = &qgridn[itz][ity][itx];
+          for (ix = imax; ix >= MAX(1,imin); ix--) {
+            const double qtmp = qgridnkj[-ix];
+            k = zyk + ix + cx;
+            esum += g_directn[k] * qtmp;
+
+            if (VFLAG_ATOM) {
+              v0sum += v0_directn[k] * qtmp;
+              v1sum += v1_directn[k] * qtmp;
+              v2sum += v2_directn[k] * qtmp;
+              v3sum += v3_directn[k] * qtmp;
+              v4sum += v4_directn[k] * qtmp;
+              v5sum += v5_directn[k] * qtmp;
+            }
           }
+
+          // iz=0, iy=0, ix=0 for owned grid points
+
+          if (imin <= 0 && imax >= 0)
+            esum += 0.5 * g_directn[zyk + cx] * qgridnkj[0];
+
+          // virial is zero for iz=0, iy=0, ix=0
         }
       }
+
+      egridn[itz][ity][itx] = esum;
+      if (VFLAG_ATOM) {
+        v0gridn[itz][ity][itx] = v0sum;
+        v1gridn[itz][ity][itx] = v1sum;
+        v2gridn[itz][ity][itx] = v2sum;
+        v3gridn[itz][ity][itx] = v3sum;
+        v4gridn[itz][ity][itx] = v4sum;
+        v5gridn[itz][ity][itx] = v5sum;
+      }
     }
+    thr->timer(Timer::KSPACE);
+  } // end of omp parallel region
+}
 
-    // iz=0
+/* ----------------------------------------------------------------------
+   MSM restriction procedure for intermediate grid levels, interpolate
+   charges from finer grid to coarser grid
+   each coarse grid point only reads from the finer grid
+------------------------------------------------------------------------- */
 
-    const int zk = nzhi_direct*ny;
-    for (iy = 1; iy <= jmax; iy++) {
-      const int jj = icy+iy;
-      const int zyk = (zk + iy + nyhi_direct)*nx;
-      double * _noalias const egridnkj = &egridn[icz][jj][icx];
-      for (ix = imin; ix <= imax; ix++) {
-        k = zyk + ix + nxhi_direct;
-        const int ii = icx+ix;
-        const double gtmp = g_directn[k];
+void MSMOMP::restriction(int n)
+{
+  int p = order-1;
 
-        egridnkj[ix] += gtmp * qtmp;
+  double ***qgrid1 = qgrid[n];
+  double ***qgrid2 = qgrid[n+1];
+
+  int *index = new int[p+2];
+  transfer_weights(n,index);
+
+  // zero out charge on coarser grid
+
+  memset(&(qgrid2[nzlo_out[n+1]][nylo_out[n+1]][nxlo_out[n+1]]),0,
+         ngrid[n+1]*sizeof(double));
+
+  // merge three outer loops over owned coarse grid points into one
+
+  int numz = nzhi_in[n+1] - nzlo_in[n+1] + 1;
+  int numy = nyhi_in[n+1] - nylo_in[n+1] + 1;
+  int numx = nxhi_in[n+1] - nxlo_in[n+1] + 1;
+  int inum = MAX(0,numz)*MAX(0,numy)*MAX(0,numx);
+
+#if defined(_OPENMP)
+#pragma omp parallel default(none) \
+  shared(n,p,qgrid1,qgrid2,index,numz,numy,numx,inum)
+#endif
+  {
+    const int rx = static_cast<int> (delxinv[n]/delxinv[n+1]);
+    const int ry = static_cast<int> (delyinv[n]/delyinv[n+1]);
+    const int rz = static_cast<int> (delzinv[n]/delzinv[n+1]);
+    const int xper = domain->xperiodic;
+    const int yper = domain->yperiodic;
+    const int zper = domain->zperiodic;
 
-        if (VFLAG_ATOM) {
-          v0gridn[icz][jj][ii] += v0_directn[k] * qtmp;
-          v1gridn[icz][jj][ii] += v1_directn[k] * qtmp;
-          v2gridn[icz][jj][ii] += v2_directn[k] * qtmp;
-          v3gridn[icz][jj][ii] += v3_directn[k] * qtmp;
-          v4gridn[icz][jj][ii] += v4_directn[k] * qtmp;
-          v5gridn[icz][jj][ii] += v5_directn[k] * qtmp;
+    int i,j,k,m,ifrom,ito,tid,ip,jp,kp,ic,jc,kc,ii,jj,kk;
+    double phiz,phizy,q2sum;
+
+    loop_setup_thr(ifrom, ito, tid, inum, comm->nthreads);
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+
+    for (m = ifrom; m < ito; ++m) {
+
+      kp = m/(numy*numx);
+      jp = (m - kp*numy*numx) / numx;
+      ip = m - kp*numy*numx - jp*numx;
+      kp += nzlo_in[n+1];
+      jp += nylo_in[n+1];
+      ip += nxlo_in[n+1];
+
+      ic = ip * rx;
+      jc = jp * ry;
+      kc = kp * rz;
+
+      q2sum = 0.0;
+
+      for (k=0; k<=p+1; k++) {
+        kk = kc+index[k];
+        if (!zper) {
+          if (kk < alpha[n]) continue;
+          if (kk > betaz[n]) break;
+        }
+        phiz = phi1d[2][k];
+        for (j=0; j<=p+1; j++) {
+          jj = jc+index[j];
+          if (!yper) {
+            if (jj < alpha[n]) continue;
+            if (jj > betay[n]) break;
+          }
+          phizy = phi1d[1][j]*phiz;
+          for (i=0; i<=p+1; i++) {
+            ii = ic+index[i];
+            if (!xper) {
+              if (ii < alpha[n]) continue;
+              if (ii > betax[n]) break;
+            }
+            q2sum += qgrid1[kk][jj][ii] *
+              phi1d[0][i]*phizy;
+          }
         }
       }
+      qgrid2[kp][jp][ip] += q2sum;
     }
+    thr->timer(Timer::KSPACE);
+  } // end of omp parallel region
 
-    // iz=0, iy=0
+  delete[] index;
+}
 
-    const int zyk = (zk + nyhi_direct)*nx;
-    double * _noalias const egridnkj = &egridn[icz][icy][icx];
-    for (ix = 1; ix <= imax; ix++) {
-      k = zyk + ix + nxhi_direct;
-      const int ii = icx+ix;
-      const double gtmp = g_directn[k];
+/* ----------------------------------------------------------------------
+   MSM prolongation procedure for intermediate grid levels, interpolate
+   per-atom energy/virial from coarser grid to finer grid
+   written as a gather over finer owned and ghost grid points, using
+   1d lists of the coarse grid points that reach them in each dim
+------------------------------------------------------------------------- */
 
-      egridnkj[ix] += gtmp * qtmp;
+void MSMOMP::prolongation(int n)
+{
+  int p = order-1;
+
+  int *index = new int[p+2];
+  transfer_weights(n,index);
+
+  // 1d stencil lists for each dim
+
+  int numx = nxhi_out[n] - nxlo_out[n] + 1;
+  int numy = nyhi_out[n] - nylo_out[n] + 1;
+  int numz = nzhi_out[n] - nzlo_out[n] + 1;
+  int inum = numz*numy*numx;
+
+  int maxx = MAX(0,nxhi_in[n+1]-nxlo_in[n+1]+1) * (p+2);
+  int maxy = MAX(0,nyhi_in[n+1]-nylo_in[n+1]+1) * (p+2);
+  int maxz = MAX(0,nzhi_in[n+1]-nzlo_in[n+1]+1) * (p+2);
+
+  int *xfirst = new int[numx+1];
+  int *yfirst = new int[numy+1];
+  int *zfirst = new int[numz+1];
+  int *xlist = new int[maxx+1];
+  int *ylist = new int[maxy+1];
+  int *zlist = new int[maxz+1];
+  double *xphi = new double[maxx+1];
+  double *yphi = new double[maxy+1];
+  double *zphi = new double[maxz+1];
+
+  prolongation_stencil(nxlo_out[n],nxhi_out[n],nxlo_in[n+1],nxhi_in[n+1],
+                       static_cast<int> (delxinv[n]/delxinv[n+1]),
+                       domain->xperiodic,betax[n],phi1d[0],index,
+                       xfirst,xlist,xphi);
+  prolongation_stencil(nylo_out[n],nyhi_out[n],nylo_in[n+1],nyhi_in[n+1],
+                       static_cast<int> (delyinv[n]/delyinv[n+1]),
+                       domain->yperiodic,betay[n],phi1d[1],index,
+                       yfirst,ylist,yphi);
+  prolongation_stencil(nzlo_out[n],nzhi_out[n],nzlo_in[n+1],nzhi_in[n+1],
+                       static_cast<int> (delzinv[n]/delzinv[n+1]),
+                       domain->zperiodic,betaz[n],phi1d[2],index,
+                       zfirst,zlist,zphi);
+
+  double ***egrid1 = egrid[n];
+  double ***egrid2 = egrid[n+1];
+  double ***v0grid1 = v0grid[n];
+  double ***v0grid2 = v0grid[n+1];
+  double ***v1grid1 = v1grid[n];
+  double ***v1grid2 = v1grid[n+1];
+  double ***v2grid1 = v2grid[n];
+  double ***v2grid2 = v2grid[n+1];
+  double ***v3grid1 = v3grid[n];
+  double ***v3grid2 = v3grid[n+1];
+  double ***v4grid1 = v4grid[n];
+  double ***v4grid2 = v4grid[n+1];
+  double ***v5grid1 = v5grid[n];
+  double ***v5grid2 = v5grid[n+1];
 
-      if (VFLAG_ATOM) {
-        v0gridn[icz][icy][ii] += v0_directn[k] * qtmp;
-        v1gridn[icz][icy][ii] += v1_directn[k] * qtmp;
-        v2gridn[icz][icy][ii] += v2_directn[k] * qtmp;
-        v3gridn[icz][icy][ii] += v3_directn[k] * qtmp;
-        v4gridn[icz][icy][ii] += v4_directn[k] * qtmp;
-        v5gridn[icz][icy][ii] += v5_directn[k] * qtmp;
+#if defined(_OPENMP)
+#pragma omp parallel default(none) \
+  shared(n,numz,numy,numx,inum,xfirst,yfirst,zfirst,xlist,ylist,zlist, \
+         xphi,yphi,zphi,egrid1,egrid2,v0grid1,v0grid2,v1grid1,v1grid2, \
+         v2grid1,v2grid2,v3grid1,v3grid2,v4grid1,v4grid2,v5grid1,v5grid2)
+#endif
+  {
+    int i,ifrom,ito,tid,ii,jj,kk,a,b,m,ip,jp,kp;
+    double phiz,phizy,phi3d;
+    double etmp;
+    double v0tmp,v1tmp,v2tmp,v3tmp,v4tmp,v5tmp;
+    v0tmp = v1tmp = v2tmp = v3tmp = v4tmp = v5tmp = 0.0;
+
+    loop_setup_thr(ifrom, ito, tid, inum, comm->nthreads);
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+
+    for (i = ifrom; i < ito; ++i) {
+
+      // infer finer grid point ii, jj, kk from master loop index i
+
+      kk = i/(numy*numx);
+      jj = (i - kk*numy*numx) / numx;
+      ii = i - kk*numy*numx - jj*numx;
+
+      if (zfirst[kk] == zfirst[kk+1] || yfirst[jj] == yfirst[jj+1] ||
+          xfirst[ii] == xfirst[ii+1]) continue;
+
+      // coarse grid points are visited in the order of a serial scatter
+
+      etmp = egrid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+      if (vflag_atom) {
+        v0tmp = v0grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+        v1tmp = v1grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+        v2tmp = v2grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+        v3tmp = v3grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+        v4tmp = v4grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+        v5tmp = v5grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]];
+      }
+
+      for (a = zfirst[kk]; a < zfirst[kk+1]; a++) {
+        kp = zlist[a];
+        phiz = zphi[a];
+        for (b = yfirst[jj]; b < yfirst[jj+1]; b++) {
+          jp = ylist[b];
+          phizy = yphi[b]*phiz;
+          for (m = xfirst[ii]; m < xfirst[ii+1]; m++) {
+            ip = xlist[m];
+            phi3d = xphi[m]*phizy;
+
+            etmp += egrid2[kp][jp][ip] * phi3d;
+
+            if (vflag_atom) {
+              v0tmp += v0grid2[kp][jp][ip] * phi3d;
+              v1tmp += v1grid2[kp][jp][ip] * phi3d;
+              v2tmp += v2grid2[kp][jp][ip] * phi3d;
+              v3tmp += v3grid2[kp][jp][ip] * phi3d;
+              v4tmp += v4grid2[kp][jp][ip] * phi3d;
+              v5tmp += v5grid2[kp][jp][ip] * phi3d;
+            }
+          }
+        }
       }
+
+      egrid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = etmp;
+      if (vflag_atom) {
+        v0grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v0tmp;
+        v1grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v1tmp;
+        v2grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v2tmp;
+        v3grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v3tmp;
+        v4grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v4tmp;
+        v5grid1[kk+nzlo_out[n]][jj+nylo_out[n]][ii+nxlo_out[n]] = v5tmp;
+      }
+    }
+    thr->timer(Timer::KSPACE);
+  } // end of omp parallel region
+
+  delete [] index;
+  delete [] xfirst;
+  delete [] yfirst;
+  delete [] zfirst;
+  delete [] xlist;
+  delete [] ylist;
+  delete [] zlist;
+  delete [] xphi;
+  delete [] yphi;
+  delete [] zphi;
+}
+
+/* ----------------------------------------------------------------------
+   list the owned coarse grid points clo:chi whose prolongation stencil
+   reaches each finer grid point flo:fhi in one dim
+   coarse point c reaches c*ratio + index[k] with weight phi[k]
+   non-periodic: finer grid points above hi are skipped, as are ones
+     below alpha, which are outside flo:fhi
+   list of finer grid point f is first[f-flo] to first[f-flo+1]-1,
+     ordered by ascending coarse grid point
+------------------------------------------------------------------------- */
+
+void MSMOMP::prolongation_stencil(int flo, int fhi, int clo, int chi,
+                                  int ratio, int periodic, int hi,
+                                  double *phi, int *index,
+                                  int *first, int *list, double *wt)
+{
+  const int p = order-1;
+  const int nf = fhi - flo + 1;
+  int c,f,k,m;
+
+  for (m = 0; m <= nf; m++) first[m] = 0;
+
+  for (c = clo; c <= chi; c++)
+    for (k = 0; k <= p+1; k++) {
+      f = c*ratio + index[k];
+      if (!periodic && f > hi) break;
+      if (f < flo || f > fhi) continue;
+      first[f-flo+1]++;
     }
 
-    // iz=0, iy=0, ix=0
+  for (m = 0; m < nf; m++) first[m+1] += first[m];
 
-    k = zyk + nxhi_direct;
-    const double gtmp = g_directn[k];
-    egridnkj[0] += 0.5 * gtmp * qtmp;
+  int *next = new int[nf];
+  for (m = 0; m < nf; m++) next[m] = first[m];
 
-    // virial is zero for iz=0, iy=0, ix=0
+  for (c = clo; c <= chi; c++)
+    for (k = 0; k <= p+1; k++) {
+      f = c*ratio + index[k];
+      if (!periodic && f > hi) break;
+      if (f < flo || f > fhi) continue;
+      m = next[f-flo]++;
+      list[m] = c;
+      wt[m] = phi[k];
+    }
 
-  }
+  delete [] next;
 }
@@ -32,11 +32,19 @@ namespace LAMMPS_NS {
 
  protected:
   virtual void direct(int);
+  virtual void direct_top(int);
+  virtual void restriction(int);
+  virtual void prolongation(int);
   virtual void compute(int,int);
 
  private:
-  template <int, int, int> void direct_eval(int);
-  template <int> void direct_peratom(int);
+  void direct_omp(int, int);
+  void direct_stencil(int, int, double **, int *, int &, int &,
+                      int *, int *, int &);
+  template <int, int, int> void direct_eval(int, int);
+  template <int> void direct_scatter(int, int);
+  void prolongation_stencil(int, int, int, int, int, int, int,
+                            double *, int *, int *, int *, double *);
 
 };
 
@@ -0,0 +1,196 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "pair_meamc_omp.h"
+#include <cstdio>
+#include <cstring>
+#include "meam.h"
+#include "atom.h"
+#include "comm.h"
+#include "error.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+
+#include "suffix.h"
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairMEAMCOMP::PairMEAMCOMP(LAMMPS *lmp) :
+  PairMEAMC(lmp), ThrOMP(lmp, THR_PAIR)
+{
+  suffix_flag |= Suffix::OMP;
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairMEAMCOMP::compute(int eflag, int vflag)
+{
+  ev_init(eflag,vflag);
+
+  const int nlocal = atom->nlocal;
+  const int nall = nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+
+  const int inum_half = listhalf->inum;
+  int * const ilist_half = listhalf->ilist;
+  int * const numneigh_half = listhalf->numneigh;
+  int ** const firstneigh_half = listhalf->firstneigh;
+  int * const numneigh_full = listfull->numneigh;
+  int ** const firstneigh_full = listfull->firstneigh;
+
+  // strip neighbor lists of any special bond flags before using with MEAM
+
+  if (neighbor->ago == 0) {
+    neigh_strip(inum_half,ilist_half,numneigh_half,firstneigh_half);
+    neigh_strip(inum_half,ilist_half,numneigh_full,firstneigh_full);
+  }
+
+  // size of scrfcn based on half neighbor list
+  // accumulated densities get one copy per thread
+
+  int n = 0;
+  for (int ii = 0; ii < inum_half; ii++) n += numneigh_half[ilist_half[ii]];
+
+  meam_inst->meam_dens_setup(atom->nmax, nall, n, nthreads);
+
+  int errorflag = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(none) shared(eflag,vflag,errorflag)
+#endif
+  {
+    int ifrom, ito, tid, i, ii;
+
+    loop_setup_thr(ifrom, ito, tid, inum_half, nthreads);
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+    ev_setup_thr(eflag, vflag, nall, eatom, vatom, NULL, thr);
+
+    double **x = atom->x;
+    double **f = thr->get_f();
+    int *type = atom->type;
+    const int ntype = atom->ntypes;
+    MEAM * const meam = meam_inst;
+
+    // offset of the first atom of this thread into the screening arrays
+    // screening factors are stored there for reuse by meam_force()
+
+    int offset = 0;
+    for (ii = 0; ii < ifrom; ii++) offset += numneigh_half[ilist_half[ii]];
+    const int offset_start = offset;
+
+    // clear this thread's copy of the accumulated densities
+    // first copy was already cleared by meam_dens_setup()
+
+    const int thr_offset = tid*nall;
+    if (tid > 0) {
+      memset(meam->rho0 + thr_offset, 0, nall*sizeof(double));
+      memset(meam->arho2b + thr_offset, 0, nall*sizeof(double));
+      memset(meam->arho1[thr_offset], 0, 3*nall*sizeof(double));
+      memset(meam->arho2[thr_offset], 0, 6*nall*sizeof(double));
+      memset(meam->arho3[thr_offset], 0, 10*nall*sizeof(double));
+      memset(meam->arho3b[thr_offset], 0, 3*nall*sizeof(double));
+      memset(meam->t_ave[thr_offset], 0, 3*nall*sizeof(double));
+      memset(meam->tsq_ave[thr_offset], 0, 3*nall*sizeof(double));
+    }
+
+    sync_threads();
+
+    for (ii = ifrom; ii < ito; ii++) {
+      i = ilist_half[ii];
+      meam->meam_dens_init(i,ntype,type,map,x,
+                           numneigh_half[i],firstneigh_half[i],
+                           numneigh_full[i],firstneigh_full[i],
+                           offset,thr_offset);
+      offset += numneigh_half[i];
+    }
+
+    // sum per-thread densities into the first copy
+
+    data_reduce_thr(meam->rho0, nall, nthreads, 1, tid);
+    data_reduce_thr(meam->arho2b, nall, nthreads, 1, tid);
+    data_reduce_thr(&(meam->arho1[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(&(meam->arho2[0][0]), nall, nthreads, 6, tid);
+    data_reduce_thr(&(meam->arho3[0][0]), nall, nthreads, 10, tid);
+    data_reduce_thr(&(meam->arho3b[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(&(meam->t_ave[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(&(meam->tsq_ave[0][0]), nall, nthreads, 3, tid);
+
+    // wait until reduction is complete before communicating
+
+    sync_threads();
+
+#if defined(_OPENMP)
+#pragma omp master
+#endif
+    { comm->reverse_comm_pair(this); }
+
+    sync_threads();
+
+    // per-atom completion of the densities over a block of local atoms
+
+    int lfrom, lto, thr_error = 0;
+    loop_setup_thr(lfrom, lto, tid, nlocal, nthreads);
+    meam->meam_dens_final(lfrom,lto,eflag_either,eflag_global,eflag_atom,
+                          thr->get_eng_vdwl(),thr->get_eatom_pair(),ntype,type,map,
+                          scale,thr_error);
+    if (thr_error) {
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      errorflag = thr_error;
+    }
+
+    sync_threads();
+
+#if defined(_OPENMP)
+#pragma omp master
+#endif
+    {
+      if (errorflag) {
+        char str[128];
+        sprintf(str,"MEAM library error %d",errorflag);
+        error->one(FLERR,str);
+      }
+      comm->forward_comm_pair(this);
+    }
+
+    sync_threads();
+
+    double **vptr = vflag_atom ? thr->get_vatom_pair() : NULL;
+
+    offset = offset_start;
+    for (ii = ifrom; ii < ito; ii++) {
+      i = ilist_half[ii];
+      meam->meam_force(i,eflag_either,eflag_global,eflag_atom,
+                       vflag_atom,thr->get_eng_vdwl(),thr->get_eatom_pair(),
+                       ntype,type,map,scale,x,
+                       numneigh_half[i],firstneigh_half[i],
+                       numneigh_full[i],firstneigh_full[i],
+                       offset,f,vptr);
+      offset += numneigh_half[i];
+    }
+
+    thr->timer(Timer::PAIR);
+    reduce_thr(this, eflag, vflag, thr);
+  } // end of omp parallel region
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairMEAMCOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairMEAMC::memory_usage();
+
+  return bytes;
+}
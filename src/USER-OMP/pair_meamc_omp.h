@@ -0,0 +1,46 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(meam/c/omp,PairMEAMCOMP)
+PairStyle(meam/omp,PairMEAMCOMP)
+
+#else
+
+#ifndef LMP_PAIR_MEAMC_OMP_H
+#define LMP_PAIR_MEAMC_OMP_H
+
+#include "pair_meamc.h"
+#include "thr_omp.h"
+
+namespace LAMMPS_NS {
+
+class PairMEAMCOMP : public PairMEAMC, public ThrOMP {
+
+ public:
+  PairMEAMCOMP(class LAMMPS *);
+
+  virtual void compute(int, int);
+  virtual double memory_usage();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: MEAM library error %d
+
+A call to the MEAM Fortran library returned an error.
+
+*/
@@ -0,0 +1,308 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "pair_snap_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "memory.h"
+#include "neigh_list.h"
+#include "sna.h"
+
+#include "suffix.h"
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSNAPOMP::PairSNAPOMP(LAMMPS *lmp) :
+  PairSNAP(lmp), ThrOMP(lmp, THR_PAIR)
+{
+  suffix_flag |= Suffix::OMP;
+  respa_enable = 0;
+
+  nsna = 0;
+  sna_thr = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairSNAPOMP::~PairSNAPOMP()
+{
+  for (int tid = 1; tid < nsna; tid++) delete sna_thr[tid];
+  delete [] sna_thr;
+}
+
+/* ----------------------------------------------------------------------
+   create one SNA workspace per thread, thread 0 uses the one of PairSNAP
+------------------------------------------------------------------------- */
+
+void PairSNAPOMP::init_style()
+{
+  PairSNAP::init_style();
+
+  for (int tid = 1; tid < nsna; tid++) delete sna_thr[tid];
+  delete [] sna_thr;
+
+  nsna = comm->nthreads;
+  sna_thr = new SNA*[nsna];
+  sna_thr[0] = snaptr;
+  for (int tid = 1; tid < nsna; tid++) {
+    sna_thr[tid] = new SNA(Pair::lmp,rfac0,twojmax,rmin0,switchflag,bzeroflag);
+    sna_thr[tid]->init();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSNAPOMP::compute(int eflag, int vflag)
+{
+  ev_init(eflag,vflag);
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  if (beta_max < inum) {
+    memory->grow(beta,inum,ncoeff,"PairSNAP:beta");
+    memory->grow(bispectrum,inum,ncoeff,"PairSNAP:bispectrum");
+    beta_max = inum;
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel default(none) shared(eflag,vflag)
+#endif
+  {
+    int ifrom, ito, tid;
+
+    loop_setup_thr(ifrom, ito, tid, inum, nthreads);
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+    ev_setup_thr(eflag, vflag, nall, eatom, vatom, NULL, thr);
+
+    // each thread handles its own atoms with its own SNA workspace
+    // beta and bispectrum of an atom only depend on its own neighbors
+
+    SNA *sna = sna_thr[tid];
+    if (quadraticflag || eflag) compute_bispectrum_thr(ifrom, ito, sna);
+    compute_beta_thr(ifrom, ito);
+    eval(ifrom, ito, thr, sna);
+
+    thr->timer(Timer::PAIR);
+    reduce_thr(this, eflag, vflag, thr);
+  } // end of omp parallel region
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSNAPOMP::eval(int iifrom, int iito, ThrData * const thr, SNA *sna)
+{
+  int i,j,jnum,ninside;
+  double delx,dely,delz,evdwl,rsq;
+  double fij[3];
+  int *jlist;
+
+  const double * const * const x = atom->x;
+  double * const * const f = thr->get_f();
+  const int * const type = atom->type;
+  const int nlocal = atom->nlocal;
+
+  for (int ii = iifrom; ii < iito; ii++) {
+    i = list->ilist[ii];
+
+    const double xtmp = x[i][0];
+    const double ytmp = x[i][1];
+    const double ztmp = x[i][2];
+    const int itype = type[i];
+    const int ielem = map[itype];
+    const double radi = radelem[ielem];
+
+    jlist = list->firstneigh[i];
+    jnum = list->numneigh[i];
+
+    sna->grow_rij(jnum);
+
+    ninside = 0;
+    for (int jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+      delx = x[j][0] - xtmp;
+      dely = x[j][1] - ytmp;
+      delz = x[j][2] - ztmp;
+      rsq = delx*delx + dely*dely + delz*delz;
+      int jtype = type[j];
+      int jelem = map[jtype];
+
+      if (rsq < cutsq[itype][jtype]&&rsq>1e-20) {
+        sna->rij[ninside][0] = delx;
+        sna->rij[ninside][1] = dely;
+        sna->rij[ninside][2] = delz;
+        sna->inside[ninside] = j;
+        sna->wj[ninside] = wjelem[jelem];
+        sna->rcutij[ninside] = (radi + radelem[jelem])*rcutfac;
+        ninside++;
+      }
+    }
+
+    // compute Ui, Yi for atom I
+
+    sna->compute_ui(ninside);
+    sna->compute_yi(beta[ii]);
+
+    // for neighbors of I within cutoff:
+    // compute Fij = dEi/dRj = -dEi/dRi
+    // add to Fi, subtract from Fj in per-thread force array
+
+    for (int jj = 0; jj < ninside; jj++) {
+      j = sna->inside[jj];
+      sna->compute_duidrj(sna->rij[jj],sna->wj[jj],sna->rcutij[jj],jj);
+      sna->compute_deidrj(fij);
+
+      f[i][0] += fij[0];
+      f[i][1] += fij[1];
+      f[i][2] += fij[2];
+      f[j][0] -= fij[0];
+      f[j][1] -= fij[1];
+      f[j][2] -= fij[2];
+
+      if (vflag_either)
+        ev_tally_xyz_thr(this,i,j,nlocal,1,0.0,0.0,
+                         fij[0],fij[1],fij[2],
+                         -sna->rij[jj][0],-sna->rij[jj][1],
+                         -sna->rij[jj][2],thr);
+    }
+
+    // tally energy contribution of atom I
+
+    if (eflag_either) {
+      double* coeffi = coeffelem[ielem];
+      evdwl = coeffi[0];
+
+      for (int icoeff = 0; icoeff < ncoeff; icoeff++)
+        evdwl += coeffi[icoeff+1]*bispectrum[ii][icoeff];
+
+      if (quadraticflag) {
+        int k = ncoeff+1;
+        for (int icoeff = 0; icoeff < ncoeff; icoeff++) {
+          double bveci = bispectrum[ii][icoeff];
+          evdwl += 0.5*coeffi[k++]*bveci*bveci;
+          for (int jcoeff = icoeff+1; jcoeff < ncoeff; jcoeff++) {
+            double bvecj = bispectrum[ii][jcoeff];
+            evdwl += coeffi[k++]*bveci*bvecj;
+          }
+        }
+      }
+      e_tally_thr(this,i,i,nlocal,1,evdwl,0.0,thr);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   compute beta for atoms IIFROM to IITO-1 in list
+------------------------------------------------------------------------- */
+
+void PairSNAPOMP::compute_beta_thr(int iifrom, int iito)
+{
+  const int * const type = atom->type;
+
+  for (int ii = iifrom; ii < iito; ii++) {
+    const int i = list->ilist[ii];
+    const int ielem = map[type[i]];
+    double* coeffi = coeffelem[ielem];
+
+    for (int icoeff = 0; icoeff < ncoeff; icoeff++)
+      beta[ii][icoeff] = coeffi[icoeff+1];
+
+    if (quadraticflag) {
+      int k = ncoeff+1;
+      for (int icoeff = 0; icoeff < ncoeff; icoeff++) {
+        double bveci = bispectrum[ii][icoeff];
+        beta[ii][icoeff] += coeffi[k]*bveci;
+        k++;
+        for (int jcoeff = icoeff+1; jcoeff < ncoeff; jcoeff++) {
+          double bvecj = bispectrum[ii][jcoeff];
+          beta[ii][icoeff] += coeffi[k]*bvecj;
+          beta[ii][jcoeff] += coeffi[k]*bveci;
+          k++;
+        }
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   compute bispectrum for atoms IIFROM to IITO-1 in list
+------------------------------------------------------------------------- */
+
+void PairSNAPOMP::compute_bispectrum_thr(int iifrom, int iito, SNA *sna)
+{
+  int i,j,jnum,ninside;
+  double delx,dely,delz,rsq;
+  int *jlist;
+
+  const double * const * const x = atom->x;
+  const int * const type = atom->type;
+
+  for (int ii = iifrom; ii < iito; ii++) {
+    i = list->ilist[ii];
+
+    const double xtmp = x[i][0];
+    const double ytmp = x[i][1];
+    const double ztmp = x[i][2];
+    const int itype = type[i];
+    const int ielem = map[itype];
+    const double radi = radelem[ielem];
+
+    jlist = list->firstneigh[i];
+    jnum = list->numneigh[i];
+
+    sna->grow_rij(jnum);
+
+    ninside = 0;
+    for (int jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+      delx = x[j][0] - xtmp;
+      dely = x[j][1] - ytmp;
+      delz = x[j][2] - ztmp;
+      rsq = delx*delx + dely*dely + delz*delz;
+      int jtype = type[j];
+      int jelem = map[jtype];
+
+      if (rsq < cutsq[itype][jtype]&&rsq>1e-20) {
+        sna->rij[ninside][0] = delx;
+        sna->rij[ninside][1] = dely;
+        sna->rij[ninside][2] = delz;
+        sna->inside[ninside] = j;
+        sna->wj[ninside] = wjelem[jelem];
+        sna->rcutij[ninside] = (radi + radelem[jelem])*rcutfac;
+        ninside++;
+      }
+    }
+
+    sna->compute_ui(ninside);
+    sna->compute_zi();
+    sna->compute_bi();
+
+    for (int icoeff = 0; icoeff < ncoeff; icoeff++)
+      bispectrum[ii][icoeff] = sna->blist[icoeff];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSNAPOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSNAP::memory_usage();
+  for (int tid = 1; tid < nsna; tid++)
+    bytes += sna_thr[tid]->memory_usage();
+
+  return bytes;
+}
@@ -0,0 +1,50 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(snap/omp,PairSNAPOMP)
+
+#else
+
+#ifndef LMP_PAIR_SNAP_OMP_H
+#define LMP_PAIR_SNAP_OMP_H
+
+#include "pair_snap.h"
+#include "thr_omp.h"
+
+namespace LAMMPS_NS {
+
+class PairSNAPOMP : public PairSNAP, public ThrOMP {
+
+ public:
+  PairSNAPOMP(class LAMMPS *);
+  virtual ~PairSNAPOMP();
+
+  virtual void compute(int, int);
+  virtual void init_style();
+  virtual double memory_usage();
+
+ private:
+  int nsna;                     // # of per-thread SNA workspaces
+  class SNA **sna_thr;          // SNA workspace of each thread, 0 = snaptr
+
+  void compute_bispectrum_thr(int, int, class SNA *);
+  void compute_beta_thr(int, int);
+  void eval(int, int, ThrData * const, class SNA *);
+};
+
+}
+
+#endif
+#endif
@@ -50,6 +50,12 @@ class ThrData {
   double *get_de() const { return _de; };
   double *get_drho() const { return _drho; };
 
+  // give access to per-thread pair energy accumulators
+  // for styles that tally into them directly
+  double *get_eng_vdwl() { return &eng_vdwl; };
+  double *get_eatom_pair() const { return eatom_pair; };
+  double **get_vatom_pair() const { return vatom_pair; };
+
   // setup and erase per atom arrays
   void init_adp(int, double *, double **, double **); // ADP (+ EAM)
   void init_cdeam(int, double *, double *, double *); // CDEAM (+ EAM)
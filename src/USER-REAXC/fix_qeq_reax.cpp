@@ -36,6 +36,7 @@
 #include "memory.h"
 #include "citeme.h"
 #include "error.h"
+#include "qeq_extrapolate.h"
 #include "reaxc_defs.h"
 #include "reaxc_types.h"
 
@@ -67,7 +68,7 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
 {
   if (lmp->citeme) lmp->citeme->add(cite_fix_qeq_reax);
 
-  if (narg<8 || narg>9) error->all(FLERR,"Illegal fix qeq/reax command");
+  if (narg < 8) error->all(FLERR,"Illegal fix qeq/reax command");
 
   nevery = force->inumeric(FLERR,arg[3]);
   if (nevery <= 0) error->all(FLERR,"Illegal fix qeq/reax command");
@@ -79,13 +80,43 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   pertype_option = new char[len];
   strcpy(pertype_option,arg[7]);
 
-  // dual CG support only available for USER-OMP variant
-  // check for compatibility is in Fix::post_constructor()
+  // optional solver keywords
+  // support by accelerated variants is checked in post_constructor()
+
   dual_enabled = 0;
-  if (narg == 9) {
-    if (strcmp(arg[8],"dual") == 0) dual_enabled = 1;
-    else error->all(FLERR,"Illegal fix qeq/reax command");
+  pipeline_flag = 0;
+  icflag = 0;
+  droptol = 0.1;
+  extrap = new QEqExtrapolate(lmp,style);
+
+  int iarg = 8;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"dual") == 0) {
+      dual_enabled = 1;
+      iarg++;
+    } else if (strcmp(arg[iarg],"pipeline") == 0) {
+      pipeline_flag = 1;
+      iarg++;
+    } else if (strcmp(arg[iarg],"precond") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq/reax command");
+      if (strcmp(arg[iarg+1],"diag") == 0) icflag = 0;
+      else if (strcmp(arg[iarg+1],"ic") == 0) icflag = 1;
+      else error->all(FLERR,"Illegal fix qeq/reax command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"droptol") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq/reax command");
+      droptol = force->numeric(FLERR,arg[iarg+1]);
+      if (droptol < 0.0) error->all(FLERR,"Illegal fix qeq/reax command");
+      iarg += 2;
+    } else if ((strcmp(arg[iarg],"extrapolate") == 0) ||
+               (strcmp(arg[iarg],"history") == 0)) {
+      iarg += extrap->modify_param(narg-iarg,&arg[iarg]);
+    } else error->all(FLERR,"Illegal fix qeq/reax command");
   }
+
+  if (dual_enabled && pipeline_flag)
+    error->all(FLERR,"Fix qeq/reax keywords dual and pipeline "
+               "cannot be used together");
   shld = NULL;
 
   n = n_cap = 0;
@@ -94,7 +125,15 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   pack_flag = 0;
   s = NULL;
   t = NULL;
-  nprev = 4;
+
+  // history of previous solutions
+
+  nprev = extrap->setup(4);
+
+  vector_flag = 1;
+  size_vector = 3;
+  global_freq = 1;
+  extvector = 0;
 
   Hdia_inv = NULL;
   b_s = NULL;
@@ -108,6 +147,14 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   r = NULL;
   d = NULL;
 
+  // pipelined CG
+  pcg_w = pcg_z = pcg_q = pcg_s = pcg_p = NULL;
+
+  // IC preconditioner
+  ic_nmax = ic_mmax = 0;
+  ic_first = ic_num = ic_col = NULL;
+  ic_val = ic_dinv = NULL;
+
   // H matrix
   H.firstnbr = NULL;
   H.numnbrs = NULL;
@@ -151,6 +198,14 @@ FixQEqReax::~FixQEqReax()
   deallocate_storage();
   deallocate_matrix();
 
+  memory->destroy(ic_first);
+  memory->destroy(ic_num);
+  memory->destroy(ic_col);
+  memory->destroy(ic_val);
+  memory->destroy(ic_dinv);
+
+  delete extrap;
+
   memory->destroy(shld);
 
   if (!reaxflag) {
@@ -165,8 +220,10 @@ FixQEqReax::~FixQEqReax()
 void FixQEqReax::post_constructor()
 {
   pertype_parameters(pertype_option);
-  if (dual_enabled)
-    error->all(FLERR,"Dual keyword only supported with fix qeq/reax/omp");
+  if (kokkosable && (dual_enabled || pipeline_flag || icflag ||
+                     extrap->style != QEqExtrapolate::FIXED))
+    error->all(FLERR,"Fix qeq/reax/kk does not support keywords "
+               "dual, pipeline, precond ic or extrapolate");
 }
 
 /* ---------------------------------------------------------------------- */
@@ -256,6 +313,14 @@ void FixQEqReax::allocate_storage()
   memory->create(q,size,"qeq:q");
   memory->create(r,size,"qeq:r");
   memory->create(d,size,"qeq:d");
+
+  if (pipeline_flag) {
+    memory->create(pcg_w,nmax,"qeq:pcg_w");
+    memory->create(pcg_z,nmax,"qeq:pcg_z");
+    memory->create(pcg_q,nmax,"qeq:pcg_q");
+    memory->create(pcg_s,nmax,"qeq:pcg_s");
+    memory->create(pcg_p,nmax,"qeq:pcg_p");
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -275,6 +340,12 @@ void FixQEqReax::deallocate_storage()
   memory->destroy( q );
   memory->destroy( r );
   memory->destroy( d );
+
+  memory->destroy( pcg_w );
+  memory->destroy( pcg_z );
+  memory->destroy( pcg_q );
+  memory->destroy( pcg_s );
+  memory->destroy( pcg_p );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -503,10 +574,19 @@ void FixQEqReax::pre_force(int /*vflag*/)
 
   init_matvec();
 
-  matvecs_s = CG(b_s, s);       // CG on s - parallel
-  matvecs_t = CG(b_t, t);       // CG on t - parallel
-  matvecs = matvecs_s + matvecs_t;
+  if (dual_enabled) {
+    matvecs = dual_CG(b_s, b_t, s, t);  // CG on s and t together
+  } else if (pipeline_flag) {
+    matvecs_s = pipelined_CG(b_s, s);
+    matvecs_t = pipelined_CG(b_t, t);
+    matvecs = matvecs_s + matvecs_t;
+  } else {
+    matvecs_s = CG(b_s, s);       // CG on s - parallel
+    matvecs_t = CG(b_t, t);       // CG on t - parallel
+    matvecs = matvecs_s + matvecs_t;
+  }
 
+  extrap->count_matvecs(matvecs);
   calculate_Q();
 
   if (comm->me == 0) {
@@ -536,7 +616,7 @@ void FixQEqReax::init_matvec()
   /* fill-in H matrix */
   compute_H();
 
-  int nn, ii, i;
+  int nn, ii, i, k;
   int *ilist;
 
   if (reaxc) {
@@ -547,6 +627,8 @@ void FixQEqReax::init_matvec()
     ilist = list->ilist;
   }
 
+  extrap->coeffs(nn,ilist,groupbit,s_hist,t_hist);
+
   for (ii = 0; ii < nn; ++ii) {
     i = ilist[ii];
     if (atom->mask[i] & groupbit) {
@@ -556,6 +638,17 @@ void FixQEqReax::init_matvec()
       b_s[i]      = -chi[ atom->type[i] ];
       b_t[i]      = -1.0;
 
+      if (extrap->nextrap) {
+
+        /* ASPC or least-squares extrapolation from previous solutions */
+        s[i] = t[i] = 0.0;
+        for (k = 0; k < extrap->nextrap; k++) {
+          s[i] += extrap->cs[k] * s_hist[i][k];
+          t[i] += extrap->ct[k] * t_hist[i][k];
+        }
+        continue;
+      }
+
       /* quadratic extrapolation for s & t from previous solutions */
       t[i] = t_hist[i][2] + 3 * ( t_hist[i][0] - t_hist[i][1]);
 
@@ -568,6 +661,8 @@ void FixQEqReax::init_matvec()
   comm->forward_comm_fix(this); //Dist_vector( s );
   pack_flag = 3;
   comm->forward_comm_fix(this); //Dist_vector( t );
+
+  if (icflag) build_precond();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -694,11 +789,7 @@ int FixQEqReax::CG( double *b, double *x)
 
   vector_sum( r , 1.,  b, -1., q, nn);
 
-  for (jj = 0; jj < nn; ++jj) {
-    j = ilist[jj];
-    if (atom->mask[j] & groupbit)
-      d[j] = r[j] * Hdia_inv[j]; //pre-condition
-  }
+  apply_precond( r, d ); //pre-condition
 
   b_norm = parallel_norm( b, nn);
   sig_new = parallel_dot( r, d, nn);
@@ -715,11 +806,7 @@ int FixQEqReax::CG( double *b, double *x)
     vector_add( r, -alpha, q, nn );
 
     // pre-conditioning
-    for (jj = 0; jj < nn; ++jj) {
-      j = ilist[jj];
-      if (atom->mask[j] & groupbit)
-        p[j] = r[j] * Hdia_inv[j];
-    }
+    apply_precond( r, p );
 
     sig_old = sig_new;
     sig_new = parallel_dot( r, p, nn);
@@ -738,6 +825,532 @@ int FixQEqReax::CG( double *b, double *x)
   return i;
 }
 
+/* ----------------------------------------------------------------------
+   pipelined preconditioned CG (Ghysels and Vanroose)
+   the two dot products of an iteration are combined into one
+   non-blocking reduction that overlaps with the preconditioner
+   application and the matrix-vector product
+------------------------------------------------------------------------- */
+
+int FixQEqReax::pipelined_CG( double *b, double *x)
+{
+  int  i, j, jj, imax;
+  double alpha, alpha_old, beta, b_norm;
+  double gamma, gamma_old, delta;
+  double my_buf[2], buf[2];
+
+  int *mask = atom->mask;
+  int nn;
+  int *ilist;
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    ilist = list->ilist;
+  }
+
+  imax = 200;
+
+  // r = b - A x, u = M r, w = A u
+  // u is stored in p, M w in d and A M w in q, so that the
+  // forward and reverse communication of CG() (pack_flag 1) applies
+
+  pack_flag = 1;
+  sparse_matvec( &H, x, q);
+  comm->reverse_comm_fix(this); //Coll_Vector( q );
+
+  vector_sum( r , 1.,  b, -1., q, nn);
+  apply_precond( r, p );
+
+  for (jj = 0; jj < nn; ++jj) {
+    j = ilist[jj];
+    if (mask[j] & groupbit) {
+      d[j] = p[j];
+      pcg_z[j] = pcg_q[j] = pcg_s[j] = pcg_p[j] = 0.0;
+    }
+  }
+
+  comm->forward_comm_fix(this); //Dist_vector( d );
+  sparse_matvec( &H, d, q );
+  comm->reverse_comm_fix(this); //Coll_vector( q );
+
+  for (jj = 0; jj < nn; ++jj) {
+    j = ilist[jj];
+    if (mask[j] & groupbit) pcg_w[j] = q[j];
+  }
+
+  b_norm = parallel_norm( b, nn);
+  alpha = gamma = 0.0;
+
+  for (i = 1; i < imax; ++i) {
+    my_buf[0] = my_buf[1] = 0.0;
+    for (jj = 0; jj < nn; ++jj) {
+      j = ilist[jj];
+      if (mask[j] & groupbit) {
+        my_buf[0] += r[j] * p[j];
+        my_buf[1] += pcg_w[j] * p[j];
+      }
+    }
+
+#if defined(MPI_VERSION) && (MPI_VERSION > 2)
+    MPI_Request request;
+    MPI_Iallreduce(my_buf,buf,2,MPI_DOUBLE,MPI_SUM,world,&request);
+#else
+    MPI_Allreduce(my_buf,buf,2,MPI_DOUBLE,MPI_SUM,world);
+#endif
+
+    // m = M w and n = A m while the reduction is in flight
+
+    apply_precond( pcg_w, d );
+    comm->forward_comm_fix(this); //Dist_vector( d );
+    sparse_matvec( &H, d, q );
+    comm->reverse_comm_fix(this); //Coll_vector( q );
+
+#if defined(MPI_VERSION) && (MPI_VERSION > 2)
+    MPI_Wait(&request,MPI_STATUS_IGNORE);
+#endif
+
+    gamma_old = gamma;
+    gamma = buf[0];
+    delta = buf[1];
+    if (sqrt(gamma) / b_norm <= tolerance) break;
+
+    alpha_old = alpha;
+    if (i > 1) {
+      beta = gamma / gamma_old;
+      alpha = gamma / (delta - beta * gamma / alpha_old);
+    } else {
+      beta = 0.0;
+      alpha = gamma / delta;
+    }
+
+    for (jj = 0; jj < nn; ++jj) {
+      j = ilist[jj];
+      if (mask[j] & groupbit) {
+        pcg_z[j] = q[j] + beta * pcg_z[j];
+        pcg_q[j] = d[j] + beta * pcg_q[j];
+        pcg_s[j] = pcg_w[j] + beta * pcg_s[j];
+        pcg_p[j] = p[j] + beta * pcg_p[j];
+
+        x[j] += alpha * pcg_p[j];
+        r[j] -= alpha * pcg_s[j];
+        p[j] -= alpha * pcg_q[j];
+        pcg_w[j] -= alpha * pcg_z[j];
+      }
+    }
+  }
+
+  if (i >= imax && comm->me == 0) {
+    char str[128];
+    sprintf(str,"Fix qeq/reax CG convergence failed after %d iterations "
+            "at " BIGINT_FORMAT " step",i,update->ntimestep);
+    error->warning(FLERR,str);
+  }
+
+  return i;
+}
+
+/* ----------------------------------------------------------------------
+   CG on the s and t systems together, one reduction for both
+   r, d, p, q hold the two systems interleaved
+------------------------------------------------------------------------- */
+
+int FixQEqReax::dual_CG( double *b1, double *b2, double *x1, double *x2)
+{
+  int i, ii, jj, indxI, imax;
+  double alpha_s, alpha_t, beta_s, beta_t, b_norm_s, b_norm_t;
+  double sig_old_s, sig_old_t, sig_new_s, sig_new_t;
+  double my_buf[4], buf[4];
+
+  int *mask = atom->mask;
+  int nn;
+  int *ilist;
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    ilist = list->ilist;
+  }
+
+  imax = 200;
+
+  pack_flag = 5; // forward 2x d and reverse 2x q
+  dual_sparse_matvec( &H, x1, x2, q );
+  comm->reverse_comm_fix(this); //Coll_Vector( q );
+
+  for (jj = 0; jj < nn; ++jj) {
+    ii = ilist[jj];
+    if (mask[ii] & groupbit) {
+      indxI = 2 * ii;
+      r[indxI  ] = b1[ii] - q[indxI  ];
+      r[indxI+1] = b2[ii] - q[indxI+1];
+    }
+  }
+
+  dual_apply_precond( r, d ); //pre-condition
+
+  my_buf[0] = my_buf[1] = my_buf[2] = my_buf[3] = 0.0;
+  for (jj = 0; jj < nn; ++jj) {
+    ii = ilist[jj];
+    if (mask[ii] & groupbit) {
+      indxI = 2 * ii;
+      my_buf[0] += b1[ii] * b1[ii];
+      my_buf[1] += b2[ii] * b2[ii];
+      my_buf[2] += r[indxI  ] * d[indxI  ];
+      my_buf[3] += r[indxI+1] * d[indxI+1];
+    }
+  }
+
+  MPI_Allreduce(my_buf,buf,4,MPI_DOUBLE,MPI_SUM,world);
+
+  b_norm_s = sqrt(buf[0]);
+  b_norm_t = sqrt(buf[1]);
+  sig_new_s = buf[2];
+  sig_new_t = buf[3];
+
+  for (i = 1; i < imax; ++i) {
+    comm->forward_comm_fix(this); //Dist_vector( d );
+    dual_sparse_matvec( &H, d, q );
+    comm->reverse_comm_fix(this); //Coll_vector( q );
+
+    my_buf[0] = my_buf[1] = 0.0;
+    for (jj = 0; jj < nn; ++jj) {
+      ii = ilist[jj];
+      if (mask[ii] & groupbit) {
+        indxI = 2 * ii;
+        my_buf[0] += d[indxI  ] * q[indxI  ];
+        my_buf[1] += d[indxI+1] * q[indxI+1];
+      }
+    }
+
+    MPI_Allreduce(my_buf,buf,2,MPI_DOUBLE,MPI_SUM,world);
+
+    alpha_s = sig_new_s / buf[0];
+    alpha_t = sig_new_t / buf[1];
+
+    for (jj = 0; jj < nn; ++jj) {
+      ii = ilist[jj];
+      if (mask[ii] & groupbit) {
+        indxI = 2 * ii;
+        x1[ii] += alpha_s * d[indxI  ];
+        x2[ii] += alpha_t * d[indxI+1];
+        r[indxI  ] -= alpha_s * q[indxI  ];
+        r[indxI+1] -= alpha_t * q[indxI+1];
+      }
+    }
+
+    // pre-conditioning
+    dual_apply_precond( r, p );
+
+    my_buf[0] = my_buf[1] = 0.0;
+    for (jj = 0; jj < nn; ++jj) {
+      ii = ilist[jj];
+      if (mask[ii] & groupbit) {
+        indxI = 2 * ii;
+        my_buf[0] += r[indxI  ] * p[indxI  ];
+        my_buf[1] += r[indxI+1] * p[indxI+1];
+      }
+    }
+
+    sig_old_s = sig_new_s;
+    sig_old_t = sig_new_t;
+
+    MPI_Allreduce(my_buf,buf,2,MPI_DOUBLE,MPI_SUM,world);
+
+    sig_new_s = buf[0];
+    sig_new_t = buf[1];
+
+    if (sqrt(sig_new_s)/b_norm_s <= tolerance
+        || sqrt(sig_new_t)/b_norm_t <= tolerance) break;
+
+    beta_s = sig_new_s / sig_old_s;
+    beta_t = sig_new_t / sig_old_t;
+
+    for (jj = 0; jj < nn; ++jj) {
+      ii = ilist[jj];
+      if (mask[ii] & groupbit) {
+        indxI = 2 * ii;
+        d[indxI  ] = p[indxI  ] + beta_s * d[indxI  ];
+        d[indxI+1] = p[indxI+1] + beta_t * d[indxI+1];
+      }
+    }
+  }
+
+  i++;
+  matvecs_s = matvecs_t = i; // plus one is consistent with count from CG()
+
+  // if necessary, converge the other system
+
+  if (sqrt(sig_new_s)/b_norm_s > tolerance) {
+    pack_flag = 2;
+    comm->forward_comm_fix(this); // x1 => s
+
+    i += CG(b1, x1);
+    matvecs_s = i;
+  } else if (sqrt(sig_new_t)/b_norm_t > tolerance) {
+    pack_flag = 3;
+    comm->forward_comm_fix(this); // x2 => t
+
+    i += CG(b2, x2);
+    matvecs_t = i;
+  }
+
+  if (i >= imax && comm->me == 0) {
+    char str[128];
+    sprintf(str,"Fix qeq/reax CG convergence failed after %d iterations "
+            "at " BIGINT_FORMAT " step",i,update->ntimestep);
+    error->warning(FLERR,str);
+  }
+
+  return i;
+}
+
+/* ----------------------------------------------------------------------
+   incomplete Cholesky factor with zero fill-in of the block of H
+   coupling owned atoms, H = L L^T
+   off-diagonal elements smaller than droptol relative to the geometric
+   mean of the two diagonal elements are dropped before factorization
+   L is stored by rows without the diagonal, the inverse diagonal of L
+   is stored separately
+------------------------------------------------------------------------- */
+
+void FixQEqReax::build_precond()
+{
+  int i, j, k, ii, jj, kk, m, row, col, itr_j;
+  int *ilist;
+  int nn;
+
+  int *type = atom->type;
+  int *mask = atom->mask;
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    ilist = list->ilist;
+  }
+
+  if (n > ic_nmax) {
+    ic_nmax = atom->nmax;
+    memory->destroy(ic_first);
+    memory->destroy(ic_num);
+    memory->destroy(ic_dinv);
+    memory->create(ic_first,ic_nmax,"qeq:ic_first");
+    memory->create(ic_num,ic_nmax,"qeq:ic_num");
+    memory->create(ic_dinv,ic_nmax,"qeq:ic_dinv");
+  }
+
+  // count retained elements of each row of the lower triangle
+
+  for (i = 0; i < n; i++) ic_num[i] = 0;
+
+  for (ii = 0; ii < nn; ii++) {
+    i = ilist[ii];
+    if (!(mask[i] & groupbit)) continue;
+    for (itr_j=H.firstnbr[i]; itr_j<H.firstnbr[i]+H.numnbrs[i]; itr_j++) {
+      j = H.jlist[itr_j];
+      if (j >= n || !(mask[j] & groupbit)) continue;
+      if (fabs(H.val[itr_j]) < droptol*sqrt(eta[type[i]]*eta[type[j]]))
+        continue;
+      ic_num[MAX(i,j)]++;
+    }
+  }
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    ic_first[i] = m;
+    m += ic_num[i];
+    ic_num[i] = 0;
+  }
+
+  if (m > ic_mmax) {
+    ic_mmax = static_cast<int> (1.2*m) + 1;
+    memory->destroy(ic_col);
+    memory->destroy(ic_val);
+    memory->create(ic_col,ic_mmax,"qeq:ic_col");
+    memory->create(ic_val,ic_mmax,"qeq:ic_val");
+  }
+
+  // fill rows, then sort each row by column and merge duplicates
+
+  for (ii = 0; ii < nn; ii++) {
+    i = ilist[ii];
+    if (!(mask[i] & groupbit)) continue;
+    for (itr_j=H.firstnbr[i]; itr_j<H.firstnbr[i]+H.numnbrs[i]; itr_j++) {
+      j = H.jlist[itr_j];
+      if (j >= n || !(mask[j] & groupbit)) continue;
+      if (fabs(H.val[itr_j]) < droptol*sqrt(eta[type[i]]*eta[type[j]]))
+        continue;
+      row = MAX(i,j);
+      col = MIN(i,j);
+      k = ic_first[row] + ic_num[row]++;
+      ic_col[k] = col;
+      ic_val[k] = H.val[itr_j];
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    int *cols = ic_col + ic_first[i];
+    double *vals = ic_val + ic_first[i];
+    int num = ic_num[i];
+    for (k = 1; k < num; k++) {
+      col = cols[k];
+      double val = vals[k];
+      for (kk = k-1; kk >= 0 && cols[kk] > col; kk--) {
+        cols[kk+1] = cols[kk];
+        vals[kk+1] = vals[kk];
+      }
+      cols[kk+1] = col;
+      vals[kk+1] = val;
+    }
+    m = 0;
+    for (k = 0; k < num; k++) {
+      if (m > 0 && cols[m-1] == cols[k]) vals[m-1] += vals[k];
+      else {
+        cols[m] = cols[k];
+        vals[m++] = vals[k];
+      }
+    }
+    ic_num[i] = m;
+  }
+
+  // IC(0) factorization row by row
+  // L_ik = (H_ik - sum_{m<k} L_im L_km) / L_kk
+  // L_ii = sqrt(H_ii - sum_{k<i} L_ik^2)
+  // fall back to the unfactored diagonal if a pivot becomes too small
+
+  for (i = 0; i < n; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    int *cols = ic_col + ic_first[i];
+    double *vals = ic_val + ic_first[i];
+    int num = ic_num[i];
+    double diag = eta[type[i]];
+
+    for (k = 0; k < num; k++) {
+      col = cols[k];
+      int *kcols = ic_col + ic_first[col];
+      double *kvals = ic_val + ic_first[col];
+      int knum = ic_num[col];
+      double sum = vals[k];
+      for (jj = 0, kk = 0; jj < k && kk < knum; ) {
+        if (cols[jj] == kcols[kk]) sum -= vals[jj++] * kvals[kk++];
+        else if (cols[jj] < kcols[kk]) jj++;
+        else kk++;
+      }
+      vals[k] = sum * ic_dinv[col];
+      diag -= vals[k]*vals[k];
+    }
+
+    if (diag <= 1.0e-3*eta[type[i]]) diag = eta[type[i]];
+    ic_dinv[i] = 1.0/sqrt(diag);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   z = M^-1 r for owned atoms, M = diag(H) or L L^T
+------------------------------------------------------------------------- */
+
+void FixQEqReax::apply_precond( double *r, double *z)
+{
+  int i, k, ii;
+  int *mask = atom->mask;
+
+  if (!icflag) {
+    int nn;
+    int *ilist;
+    if (reaxc) {
+      nn = reaxc->list->inum;
+      ilist = reaxc->list->ilist;
+    } else {
+      nn = list->inum;
+      ilist = list->ilist;
+    }
+
+    for (ii = 0; ii < nn; ++ii) {
+      i = ilist[ii];
+      if (mask[i] & groupbit)
+        z[i] = r[i] * Hdia_inv[i];
+    }
+    return;
+  }
+
+  // forward substitution L y = r
+
+  for (i = 0; i < n; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    double sum = r[i];
+    for (k = ic_first[i]; k < ic_first[i]+ic_num[i]; k++)
+      sum -= ic_val[k] * z[ic_col[k]];
+    z[i] = sum * ic_dinv[i];
+  }
+
+  // backward substitution L^T z = y by columns of L^T
+
+  for (i = n-1; i >= 0; i--) {
+    if (!(mask[i] & groupbit)) continue;
+    z[i] *= ic_dinv[i];
+    for (k = ic_first[i]; k < ic_first[i]+ic_num[i]; k++)
+      z[ic_col[k]] -= ic_val[k] * z[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   same as apply_precond() for two interleaved vectors
+------------------------------------------------------------------------- */
+
+void FixQEqReax::dual_apply_precond( double *r, double *z)
+{
+  int i, j, k, ii;
+  int *mask = atom->mask;
+
+  if (!icflag) {
+    int nn;
+    int *ilist;
+    if (reaxc) {
+      nn = reaxc->list->inum;
+      ilist = reaxc->list->ilist;
+    } else {
+      nn = list->inum;
+      ilist = list->ilist;
+    }
+
+    for (ii = 0; ii < nn; ++ii) {
+      i = ilist[ii];
+      if (mask[i] & groupbit) {
+        z[2*i  ] = r[2*i  ] * Hdia_inv[i];
+        z[2*i+1] = r[2*i+1] * Hdia_inv[i];
+      }
+    }
+    return;
+  }
+
+  for (i = 0; i < n; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    double sum1 = r[2*i];
+    double sum2 = r[2*i+1];
+    for (k = ic_first[i]; k < ic_first[i]+ic_num[i]; k++) {
+      j = ic_col[k];
+      sum1 -= ic_val[k] * z[2*j];
+      sum2 -= ic_val[k] * z[2*j+1];
+    }
+    z[2*i  ] = sum1 * ic_dinv[i];
+    z[2*i+1] = sum2 * ic_dinv[i];
+  }
+
+  for (i = n-1; i >= 0; i--) {
+    if (!(mask[i] & groupbit)) continue;
+    z[2*i  ] *= ic_dinv[i];
+    z[2*i+1] *= ic_dinv[i];
+    for (k = ic_first[i]; k < ic_first[i]+ic_num[i]; k++) {
+      j = ic_col[k];
+      z[2*j  ] -= ic_val[k] * z[2*i  ];
+      z[2*j+1] -= ic_val[k] * z[2*i+1];
+    }
+  }
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -782,6 +1395,103 @@ void FixQEqReax::sparse_matvec( sparse_matrix *A, double *x, double *b)
 
 }
 
+/* ----------------------------------------------------------------------
+   b = A [x1 x2], result interleaved
+------------------------------------------------------------------------- */
+
+void FixQEqReax::dual_sparse_matvec( sparse_matrix *A, double *x1,
+                                     double *x2, double *b)
+{
+  int i, j, itr_j;
+  int nn, NN, ii;
+  int *ilist;
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    NN = reaxc->list->inum + reaxc->list->gnum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    NN = list->inum + list->gnum;
+    ilist = list->ilist;
+  }
+
+  for (ii = 0; ii < nn; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      b[2*i  ] = eta[ atom->type[i] ] * x1[i];
+      b[2*i+1] = eta[ atom->type[i] ] * x2[i];
+    }
+  }
+
+  for (ii = nn; ii < NN; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit)
+      b[2*i] = b[2*i+1] = 0;
+  }
+
+  for (ii = 0; ii < nn; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      for (itr_j=A->firstnbr[i]; itr_j<A->firstnbr[i]+A->numnbrs[i]; itr_j++) {
+        j = A->jlist[itr_j];
+        b[2*i  ] += A->val[itr_j] * x1[j];
+        b[2*i+1] += A->val[itr_j] * x2[j];
+        b[2*j  ] += A->val[itr_j] * x1[i];
+        b[2*j+1] += A->val[itr_j] * x2[i];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   b = A x, x and b interleaved
+------------------------------------------------------------------------- */
+
+void FixQEqReax::dual_sparse_matvec( sparse_matrix *A, double *x, double *b)
+{
+  int i, j, itr_j;
+  int nn, NN, ii;
+  int *ilist;
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    NN = reaxc->list->inum + reaxc->list->gnum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    NN = list->inum + list->gnum;
+    ilist = list->ilist;
+  }
+
+  for (ii = 0; ii < nn; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      b[2*i  ] = eta[ atom->type[i] ] * x[2*i  ];
+      b[2*i+1] = eta[ atom->type[i] ] * x[2*i+1];
+    }
+  }
+
+  for (ii = nn; ii < NN; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit)
+      b[2*i] = b[2*i+1] = 0;
+  }
+
+  for (ii = 0; ii < nn; ++ii) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      for (itr_j=A->firstnbr[i]; itr_j<A->firstnbr[i]+A->numnbrs[i]; itr_j++) {
+        j = A->jlist[itr_j];
+        b[2*i  ] += A->val[itr_j] * x[2*j  ];
+        b[2*i+1] += A->val[itr_j] * x[2*j+1];
+        b[2*j  ] += A->val[itr_j] * x[2*i  ];
+        b[2*j+1] += A->val[itr_j] * x[2*i+1];
+      }
+    }
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixQEqReax::calculate_Q()
@@ -826,6 +1536,13 @@ void FixQEqReax::calculate_Q()
 
 /* ---------------------------------------------------------------------- */
 
+double FixQEqReax::compute_vector(int n)
+{
+  return extrap->compute_vector(n);
+}
+
+/* ---------------------------------------------------------------------- */
+
 int FixQEqReax::pack_forward_comm(int n, int *list, double *buf,
                                   int /*pbc_flag*/, int * /*pbc*/)
 {
@@ -928,6 +1645,10 @@ double FixQEqReax::memory_usage()
 
   if (dual_enabled)
     bytes += atom->nmax*4 * sizeof(double); // double size for q, d, r, and p
+  if (pipeline_flag)
+    bytes += atom->nmax*5 * sizeof(double); // pipelined CG vectors
+  bytes += ic_nmax*2 * sizeof(int) + ic_nmax * sizeof(double);
+  bytes += ic_mmax * (sizeof(int) + sizeof(double));
 
   return bytes;
 }
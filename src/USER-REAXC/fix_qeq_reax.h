@@ -52,6 +52,8 @@ class FixQEqReax : public Fix {
   void min_setup_pre_force(int);
   void min_pre_force(int);
 
+  double compute_vector(int);
+
   int matvecs;
   double qeq_time;
 
@@ -95,6 +97,17 @@ class FixQEqReax : public Fix {
   //CG storage
   double *p, *q, *r, *d;
 
+  // pipelined CG storage
+  int pipeline_flag;        // 1 if pipelined CG with a single reduction
+  double *pcg_w, *pcg_z, *pcg_q, *pcg_s, *pcg_p;
+
+  // incomplete Cholesky factor of the local block of H
+  int icflag;               // 1 if IC instead of diagonal preconditioner
+  double droptol;           // relative size of dropped matrix elements
+  int ic_nmax, ic_mmax;
+  int *ic_first, *ic_num, *ic_col;
+  double *ic_val, *ic_dinv;
+
   //GMRES storage
   //double *g,*y;
   //double **v;
@@ -119,9 +132,14 @@ class FixQEqReax : public Fix {
   virtual void calculate_Q();
 
   virtual int CG(double*,double*);
+  int pipelined_CG(double*,double*);
   //int GMRES(double*,double*);
   virtual void sparse_matvec(sparse_matrix*,double*,double*);
 
+  void build_precond();
+  void apply_precond(double*,double*);
+  void dual_apply_precond(double*,double*);
+
   virtual int pack_forward_comm(int, int *, double *, int, int *);
   virtual void unpack_forward_comm(int, int, double *);
   virtual int pack_reverse_comm(int, int, double *);
@@ -142,6 +160,11 @@ class FixQEqReax : public Fix {
   // dual CG support
   int dual_enabled;  // 0: Original, separate s & t optimization; 1: dual optimization
   int matvecs_s, matvecs_t; // Iteration count for each system
+  virtual int dual_CG(double*,double*,double*,double*);
+  virtual void dual_sparse_matvec(sparse_matrix*,double*,double*,double*);
+  virtual void dual_sparse_matvec(sparse_matrix*,double*,double*);
+
+  class QEqExtrapolate *extrap;  // initial guess from previous solutions
 };
 
 }
@@ -247,6 +247,7 @@ void PairReaxC::settings(int narg, char **arg)
   system->mincap = MIN_CAP;
   system->safezone = SAFE_ZONE;
   system->saferzone = SAFER_ZONE;
+  system->adaptive = 1;
 
   // process optional keywords
 
@@ -284,9 +285,21 @@ void PairReaxC::settings(int narg, char **arg)
       if (system->mincap < 0)
         error->all(FLERR,"Illegal pair_style reax/c mincap command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"lists") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal pair_style reax/c command");
+      if (strcmp(arg[iarg+1],"adaptive") == 0) system->adaptive = 1;
+      else if (strcmp(arg[iarg+1],"static") == 0) system->adaptive = 0;
+      else error->all(FLERR,"Illegal pair_style reax/c command");
+      if (system->adaptive && system->omp_active)
+        error->all(FLERR,"Pair style reax/c/omp requires lists static");
+      iarg += 2;
     } else error->all(FLERR,"Illegal pair_style reax/c command");
   }
 
+  // the OpenMP version sizes its lists with the static scheme
+
+  if (system->omp_active) system->adaptive = 0;
+
   // LAMMPS is responsible for generating nbrs
 
   control->reneighbor = 1;
@@ -712,6 +725,8 @@ int PairReaxC::estimate_reax_lists()
 
   free( marked );
 
+  if (system->adaptive)
+    return static_cast<int> (MAX( num_nbrs*ADAPT_GROW, MIN_NBRS ));
   return static_cast<int> (MAX( num_nbrs*safezone, mincap*MIN_NBRS ));
 }
 
@@ -758,6 +773,13 @@ int PairReaxC::write_reax_lists()
       get_distance( x[j], x[i], &d_sqr, &dvec );
 
       if (d_sqr <= (cutoff_sqr)) {
+
+        // grow the list instead of writing past its end
+
+        if (num_nbrs == far_nbrs->num_intrs) {
+          Grow_List( static_cast<int> (num_nbrs*ADAPT_GROW) + 1, far_nbrs );
+          far_list = far_nbrs->select.far_nbr_list;
+        }
         dist[j] = sqrt( d_sqr );
         set_far_nbr( &far_list[num_nbrs], j, dist[j], dvec );
         ++num_nbrs;
@@ -829,13 +851,21 @@ double PairReaxC::memory_usage()
   bytes += 3.0 * system->total_cap * sizeof(int);
 
   // From reaxc_lists
-  bytes += 2.0 * lists->n * sizeof(int);
-  bytes += lists->num_intrs * sizeof(three_body_interaction_data);
-  bytes += lists->num_intrs * sizeof(bond_data);
-  bytes += lists->num_intrs * sizeof(dbond_data);
-  bytes += lists->num_intrs * sizeof(dDelta_data);
-  bytes += lists->num_intrs * sizeof(far_neighbor_data);
-  bytes += lists->num_intrs * sizeof(hbond_data);
+  // lists never shrink, so their sizes are the high-water marks
+
+  for (int i = 0; i < LIST_N; i++) {
+    reax_list *l = lists + i;
+    if (!l->allocated) continue;
+    bytes += 2.0 * l->n * sizeof(int);
+    if (l->type == TYP_THREE_BODY)
+      bytes += 1.0 * l->num_intrs * sizeof(three_body_interaction_data);
+    else if (l->type == TYP_BOND)
+      bytes += 1.0 * l->num_intrs * sizeof(bond_data);
+    else if (l->type == TYP_FAR_NEIGHBOR)
+      bytes += 1.0 * l->num_intrs * sizeof(far_neighbor_data);
+    else if (l->type == TYP_HBOND)
+      bytes += 1.0 * l->num_intrs * sizeof(hbond_data);
+  }
 
   if(fixspecies_flag)
     bytes += 2 * nmax * MAXSPECBOND * sizeof(double);
@@ -102,4 +102,9 @@ Number of ghost atoms has increased too much during simulation and has exceeded
 the size of reax/c arrays.  Increase safe_zone and min_cap in pair_style reax/c
 command
 
+E: Pair style reax/c/omp requires lists static
+
+The OpenMP version of the ReaxFF pair style does not support adaptive
+lists.
+
 */
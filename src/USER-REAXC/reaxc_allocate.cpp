@@ -443,6 +443,27 @@ void ReAllocate( reax_system *system, control_params *control,
   }
 
 
+  /* adaptive lists grow while they are filled, here only their
+     per-atom indexes must follow the atom capacities */
+  if (system->adaptive) {
+    if (Nflag) {
+      far_nbrs = *lists + FAR_NBRS;
+      Make_List( system->total_cap, far_nbrs->num_intrs,
+                 TYP_FAR_NEIGHBOR, far_nbrs );
+      Make_List( system->total_cap, (*lists)[BONDS].num_intrs,
+                 TYP_BOND, (*lists)+BONDS );
+    }
+    if (control->hbond_cut > 0 && system->numH >= DANGER_ZONE * system->Hcap) {
+      system->Hcap = int(MAX( system->numH * saferzone, mincap ));
+      Make_List( system->Hcap, (*lists)[HBONDS].num_intrs,
+                 TYP_HBOND, (*lists)+HBONDS );
+    }
+    realloc->num_far = 0;
+    realloc->hbonds = realloc->bonds = 0;
+    realloc->num_3body = -1;
+    return;
+  }
+
   renbr = (data->step - data->prev_steps) % control->reneighbor == 0;
   /* far neighbors */
   if (renbr) {
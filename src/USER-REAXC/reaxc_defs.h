@@ -99,6 +99,8 @@
 #define SAFER_ZONE     1.4
 #define DANGER_ZONE    0.90
 #define LOOSE_ZONE     0.75
+#define ADAPT_GROW     1.25  // growth factor of adaptive lists
+#define ADAPT_SLACK    2     // spare per-atom slots of adaptive lists
 #define MAX_3BODY_PARAM     5
 #define MAX_4BODY_PARAM     5
 
@@ -34,6 +34,8 @@
 #include "reaxc_list.h"
 #include "reaxc_multi_body.h"
 #include "reaxc_nonbonded.h"
+#include "reaxc_reset_tools.h"
+#include "reaxc_tool_box.h"
 #include "reaxc_torsion_angles.h"
 #include "reaxc_valence_angles.h"
 #include "reaxc_vector.h"
@@ -128,7 +130,11 @@ void Validate_Lists( reax_system *system, storage * /*workspace*/, reax_list **l
     bonds = *lists + BONDS;
 
     for( i = 0; i < N; ++i ) {
-      system->my_atoms[i].num_bonds = MAX(Num_Entries(i,bonds)*2, MIN_BONDS);
+      if (system->adaptive)
+        system->my_atoms[i].num_bonds =
+          (int)(Num_Entries(i,bonds) * ADAPT_GROW) + ADAPT_SLACK;
+      else
+        system->my_atoms[i].num_bonds = MAX(Num_Entries(i,bonds)*2, MIN_BONDS);
 
       if (i < N-1)
         comp = Start_Index(i+1, bonds);
@@ -151,8 +157,12 @@ void Validate_Lists( reax_system *system, storage * /*workspace*/, reax_list **l
     for( i = 0; i < N; ++i ) {
       Hindex = system->my_atoms[i].Hindex;
       if (Hindex > -1) {
-        system->my_atoms[i].num_hbonds =
-          (int)(MAX( Num_Entries(Hindex, hbonds)*saferzone, MIN_HBONDS ));
+        if (system->adaptive)
+          system->my_atoms[i].num_hbonds =
+            (int)(Num_Entries(Hindex, hbonds) * ADAPT_GROW) + ADAPT_SLACK;
+        else
+          system->my_atoms[i].num_hbonds =
+            (int)(MAX( Num_Entries(Hindex, hbonds)*saferzone, MIN_HBONDS ));
 
         //if( Num_Entries(i, hbonds) >=
         //(Start_Index(i+1,hbonds)-Start_Index(i,hbonds))*0.90/*DANGER_ZONE*/){
@@ -174,15 +184,25 @@ void Validate_Lists( reax_system *system, storage * /*workspace*/, reax_list **l
 }
 
 
+/* first index past the space reserved for entry I of a list with N entries */
+
+static inline int End_Of_Space( int i, int n, reax_list *l )
+{
+  if (i < n-1) return Start_Index( i+1, l );
+  return l->num_intrs;
+}
+
+
 void Init_Forces_noQEq( reax_system *system, control_params *control,
                         simulation_data *data, storage *workspace,
-                        reax_list **lists, output_controls * /*out_control*/ ) {
+                        reax_list **lists, output_controls *out_control ) {
   int i, j, pj;
   int start_i, end_i;
   int type_i, type_j;
   int btop_i, num_bonds, num_hbonds;
   int ihb, jhb, ihb_top, jhb_top;
   int local, flag, renbr;
+  int overflow, *extra_bonds, *extra_hbonds;
   double cutoff;
   reax_list *far_nbrs, *bonds, *hbonds;
   single_body_parameters *sbp_i, *sbp_j;
@@ -205,6 +225,12 @@ void Init_Forces_noQEq( reax_system *system, control_params *control,
   btop_i = 0;
   renbr = (data->step-data->prev_steps) % control->reneighbor == 0;
 
+  // with adaptive lists, bonds that do not fit into the space of an atom
+  //   are counted in extra_bonds/extra_hbonds instead of being stored
+
+  overflow = 0;
+  extra_bonds = extra_hbonds = NULL;
+
   for( i = 0; i < system->N; ++i ) {
     atom_i = &(system->my_atoms[i]);
     type_i  = atom_i->type;
@@ -266,6 +292,19 @@ void Init_Forces_noQEq( reax_system *system, control_params *control,
               nbr_pj->d <= control->hbond_cut ) {
             // fprintf( stderr, "%d %d\n", atom1, atom2 );
             jhb = sbp_j->p_hbond;
+            if (system->adaptive && ((ihb == 1 && jhb == 2) ||
+                                     (j < system->n && ihb == 2 && jhb == 1))) {
+              int h = (ihb == 1) ? atom_i->Hindex : atom_j->Hindex;
+              int top = (ihb == 1) ? ihb_top : End_Index( h, hbonds );
+              if (top >= End_Of_Space( h, system->numH, hbonds )) {
+                if (!extra_hbonds)
+                  extra_hbonds = (int*) scalloc( system->error_ptr, system->n,
+                                                 sizeof(int), "extra_hbonds" );
+                ++extra_hbonds[(ihb == 1) ? i : j];
+                overflow = 1;
+                jhb = -1;
+              }
+            }
             if (ihb == 1 && jhb == 2) {
               hbonds->select.hbond_list[ihb_top].nbr = j;
               hbonds->select.hbond_list[ihb_top].scl = 1;
@@ -284,7 +323,16 @@ void Init_Forces_noQEq( reax_system *system, control_params *control,
           }
         }
 
-        if (//(workspace->bond_mark[i] < 3 || workspace->bond_mark[j] < 3) &&
+        if (system->adaptive && nbr_pj->d <= control->bond_cut &&
+            (btop_i >= End_Of_Space( i, system->N, bonds ) ||
+             End_Index( j, bonds ) >= End_Of_Space( j, system->N, bonds ))) {
+          if (!extra_bonds)
+            extra_bonds = (int*) scalloc( system->error_ptr, system->N,
+                                          sizeof(int), "extra_bonds" );
+          ++extra_bonds[i];
+          ++extra_bonds[j];
+          overflow = 1;
+        } else if (//(workspace->bond_mark[i] < 3 || workspace->bond_mark[j] < 3) &&
             nbr_pj->d <= control->bond_cut &&
             BOp( workspace, bonds, control->bo_cut,
                  i , btop_i, nbr_pj, sbp_i, sbp_j, twbp ) ) {
@@ -306,6 +354,33 @@ void Init_Forces_noQEq( reax_system *system, control_params *control,
   }
 
 
+  // enlarge the space of atoms that ran out of it and build the lists again
+  // the extra counts are an upper bound, so the second pass always fits
+  // BOp() accumulates total bond orders, so the workspace is reset as well
+
+  if (overflow) {
+    if (extra_bonds) {
+      for( i = 0; i < system->N; ++i )
+        if (extra_bonds[i])
+          system->my_atoms[i].num_bonds = (int)
+            ((Num_Entries(i,bonds) + extra_bonds[i]) * ADAPT_GROW) + ADAPT_SLACK;
+      sfree( system->error_ptr, extra_bonds, "extra_bonds" );
+    }
+    if (extra_hbonds) {
+      for( i = 0; i < system->n; ++i )
+        if (extra_hbonds[i]) {
+          int h = system->my_atoms[i].Hindex;
+          system->my_atoms[i].num_hbonds = (int)
+            ((Num_Entries(h,hbonds) + extra_hbonds[i]) * ADAPT_GROW) + ADAPT_SLACK;
+        }
+      sfree( system->error_ptr, extra_hbonds, "extra_hbonds" );
+    }
+    Reset_Workspace( system, workspace );
+    Reset_Neighbor_Lists( system, control, workspace, lists );
+    Init_Forces_noQEq( system, control, data, workspace, lists, out_control );
+    return;
+  }
+
   workspace->realloc.num_bonds = num_bonds;
   workspace->realloc.num_hbonds = num_hbonds;
 
@@ -422,6 +497,20 @@ void Estimate_Storages( reax_system *system, control_params *control,
   }
 
   *Htop = (int)(MAX( *Htop * safezone, mincap * MIN_HENTRIES ));
+
+  // adaptive lists size each atom from its actual count
+
+  if (system->adaptive) {
+    for( i = 0; i < system->n; ++i )
+      hb_top[i] = (int)(hb_top[i] * ADAPT_GROW) + ADAPT_SLACK;
+
+    for( i = 0; i < system->N; ++i ) {
+      *num_3body += bond_top[i] * (bond_top[i] - 1);
+      bond_top[i] = (int)(bond_top[i] * ADAPT_GROW) + ADAPT_SLACK;
+    }
+    return;
+  }
+
   for( i = 0; i < system->n; ++i )
     hb_top[i] = (int)(MAX( hb_top[i] * saferzone, MIN_HBONDS ));
 
@@ -179,7 +179,10 @@ int  Init_Lists( reax_system *system, control_params *control,
       system->my_atoms[i].num_hbonds = hb_top[i];
       total_hbonds += hb_top[i];
     }
-    total_hbonds = (int)(MAX( total_hbonds*saferzone, mincap*MIN_HBONDS ));
+    if (system->adaptive)
+      total_hbonds = MAX( total_hbonds, MIN_HBONDS );
+    else
+      total_hbonds = (int)(MAX( total_hbonds*saferzone, mincap*MIN_HBONDS ));
 
     if( !Make_List( system->Hcap, total_hbonds, TYP_HBOND,
                     *lists+HBONDS ) ) {
@@ -193,7 +196,10 @@ int  Init_Lists( reax_system *system, control_params *control,
     system->my_atoms[i].num_bonds = bond_top[i];
     total_bonds += bond_top[i];
   }
-  bond_cap = (int)(MAX( total_bonds*safezone, mincap*MIN_BONDS ));
+  if (system->adaptive)
+    bond_cap = MAX( total_bonds, MIN_BONDS );
+  else
+    bond_cap = (int)(MAX( total_bonds*safezone, mincap*MIN_BONDS ));
 
   if( !Make_List( system->total_cap, bond_cap, TYP_BOND,
                   *lists+BONDS ) ) {
@@ -202,7 +208,10 @@ int  Init_Lists( reax_system *system, control_params *control,
   (*lists+BONDS)->error_ptr = system->error_ptr;
 
   /* 3bodies list */
-  cap_3body = (int)(MAX( num_3body*safezone, MIN_3BODIES ));
+  if (system->adaptive)
+    cap_3body = MAX( num_3body, MIN_3BODIES );
+  else
+    cap_3body = (int)(MAX( num_3body*safezone, MIN_3BODIES ));
   if( !Make_List( bond_cap, cap_3body, TYP_THREE_BODY,
                   *lists+THREE_BODIES ) ){
     control->error_ptr->one(FLERR,"Problem in initializing angles list.");
@@ -25,6 +25,7 @@
   ----------------------------------------------------------------------*/
 
 #include "reaxc_list.h"
+#include <cstring>
 #include "reaxc_defs.h"
 #include "reaxc_tool_box.h"
 
@@ -98,6 +99,44 @@ int Make_List(int n, int num_intrs, int type, reax_list *l )
 }
 
 
+/************* grow list space, keep entries ******************/
+void Grow_List( int num_intrs, reax_list *l )
+{
+  size_t size;
+  void *ptr;
+
+  if (num_intrs <= l->num_intrs) return;
+
+  switch(l->type) {
+  case TYP_THREE_BODY:
+    size = sizeof(three_body_interaction_data);
+    break;
+  case TYP_BOND:
+    size = sizeof(bond_data);
+    break;
+  case TYP_FAR_NEIGHBOR:
+    size = sizeof(far_neighbor_data);
+    break;
+  case TYP_HBOND:
+    size = sizeof(hbond_data);
+    break;
+  default:
+    char errmsg[128];
+    snprintf(errmsg, 128, "Cannot grow list type %d", l->type);
+    l->error_ptr->one(FLERR,errmsg);
+    return;
+  }
+
+  ptr = smalloc(l->error_ptr, (rc_bigint) num_intrs * size, "list:grow");
+  if (l->select.v) {
+    memcpy(ptr, l->select.v, (size_t) l->num_intrs * size);
+    sfree(l->error_ptr, l->select.v, "list:grow");
+  }
+  l->select.v = ptr;
+  l->num_intrs = num_intrs;
+}
+
+
 void Delete_List( reax_list *l )
 {
   if (l->allocated == 0)
@@ -30,6 +30,7 @@
 #include "reaxc_types.h"
 
 int  Make_List( int, int, int, reax_list* );
+void Grow_List( int, reax_list* );
 void Delete_List( reax_list* );
 
 inline int  Num_Entries(int,reax_list*);
@@ -132,6 +132,22 @@ void Reset_Neighbor_Lists( reax_system *system, control_params *control,
   /* bonds list */
   if (system->N > 0) {
     bonds = (*lists) + BONDS;
+
+    /* adaptive lists grow before the indexes are set,
+       the three-body list is indexed by bond */
+    if (system->adaptive) {
+      total_bonds = 0;
+      for( i = 0; i < system->N; ++i )
+        total_bonds += system->my_atoms[i].num_bonds;
+
+      if (total_bonds > bonds->num_intrs) {
+        reax_list *thb_intrs = (*lists) + THREE_BODIES;
+        int newsize = (int)(total_bonds * ADAPT_GROW);
+        Make_List( system->total_cap, newsize, TYP_BOND, bonds );
+        Make_List( newsize, thb_intrs->num_intrs, TYP_THREE_BODY, thb_intrs );
+      }
+    }
+
     total_bonds = 0;
 
     /* reset start-end indexes */
@@ -142,7 +158,7 @@ void Reset_Neighbor_Lists( reax_system *system, control_params *control,
     }
 
     /* is reallocation needed? */
-    if (total_bonds >= bonds->num_intrs * DANGER_ZONE) {
+    if (!system->adaptive && total_bonds >= bonds->num_intrs * DANGER_ZONE) {
       workspace->realloc.bonds = 1;
       if (total_bonds >= bonds->num_intrs) {
         char errmsg[256];
@@ -155,6 +171,18 @@ void Reset_Neighbor_Lists( reax_system *system, control_params *control,
 
   if (control->hbond_cut > 0 && system->numH > 0) {
     hbonds = (*lists) + HBONDS;
+
+    if (system->adaptive) {
+      total_hbonds = 0;
+      for( i = 0; i < system->n; ++i )
+        if (system->my_atoms[i].Hindex > -1)
+          total_hbonds += system->my_atoms[i].num_hbonds;
+
+      if (total_hbonds > hbonds->num_intrs)
+        Make_List( system->Hcap, (int)(total_hbonds * ADAPT_GROW),
+                   TYP_HBOND, hbonds );
+    }
+
     total_hbonds = 0;
 
     /* reset start-end indexes */
@@ -168,7 +196,8 @@ void Reset_Neighbor_Lists( reax_system *system, control_params *control,
     }
 
     /* is reallocation needed? */
-    if (total_hbonds >= hbonds->num_intrs * 0.90/*DANGER_ZONE*/) {
+    if (!system->adaptive &&
+        total_hbonds >= hbonds->num_intrs * 0.90/*DANGER_ZONE*/) {
       workspace->realloc.hbonds = 1;
       if (total_hbonds >= hbonds->num_intrs) {
         char errmsg[256];
@@ -411,6 +411,7 @@ struct _reax_system
   int my_bonds;
   int mincap;
   double safezone, saferzone;
+  int adaptive;
 
   _LR_lookup_table **LR;
 
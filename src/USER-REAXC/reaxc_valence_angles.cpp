@@ -169,6 +169,15 @@ void Valence_Angles( reax_system *system, control_params *control,
 
     expval6 = exp( p_val6 * workspace->Delta_boc[j] );
 
+    // each bond of j adds at most one entry per other bond of j,
+    //   grow adaptive lists before they can overflow
+
+    if (system->adaptive) {
+      int max_thb = num_thb_intrs + (end_j-start_j) * (end_j-start_j-1);
+      if (max_thb > thb_intrs->num_intrs)
+        Grow_List( (int)(max_thb * ADAPT_GROW), thb_intrs );
+    }
+
     for( pi = start_j; pi < end_j; ++pi ) {
       Set_Start_Index( pi, num_thb_intrs, thb_intrs );
       pbond_ij = &(bonds->select.bond_list[pi]);
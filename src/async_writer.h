@@ -0,0 +1,120 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_ASYNC_WRITER_H
+#define LMP_ASYNC_WRITER_H
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "lmptype.h"
+#include "memory.h"
+
+namespace LAMMPS_NS {
+
+// snapshot of the blocks a filewriter proc gathered for one output file
+// the blocks are written by a background thread, while the run continues
+// the thread must not communicate or call into the rest of LAMMPS,
+//   it reports a failure via fail() and the caller raises it after wait()
+
+class AsyncWriter {
+ public:
+  char *data;                     // copy of all blocks of one snapshot
+  bigint maxdata;                 // allocated size of data in bytes
+  bigint ndata;                   // bytes of data in use
+  std::vector<int> count;         // # of values in each block
+  std::vector<int> size;          // size of one value in each block
+  std::vector<bigint> offset;     // byte offset of each block in data
+
+  AsyncWriter(Memory *mem, const char *name_caller) :
+    data(NULL), maxdata(0), ndata(0), running(0), failed(0),
+    name(name_caller), memory(mem) {}
+  ~AsyncWriter() {
+    if (writer.joinable()) writer.join();
+    memory->sfree(data);
+  }
+
+  // return location for a block of up to n bytes at end of data
+
+  char *reserve(bigint n) {
+    if (ndata + n > maxdata) {
+      maxdata = ndata + n;
+      data = (char *) memory->srealloc(data,maxdata,name);
+    }
+    return data + ndata;
+  }
+
+  // add a block of n values of nsize bytes that was put at end of data
+
+  void append(int n, int nsize) {
+    count.push_back(n);
+    size.push_back(nsize);
+    offset.push_back(ndata);
+    ndata += (bigint) n*nsize;
+  }
+
+  void clear() {
+    count.clear();
+    size.clear();
+    offset.clear();
+    ndata = 0;
+  }
+
+  // run obj->func() in the background thread
+
+  template <class T> void start(void (T::*func)(), T *obj) {
+    writer = std::thread(&AsyncWriter::run<T>,this,func,obj);
+  }
+
+  // 1 if called from the background thread
+  // the caller never writes while the thread runs, so no race
+
+  int in_thread() const { return running; }
+
+  // record failure of the background thread, first message is kept
+
+  void fail(const char *mesg) {
+    if (failed) return;
+    failed = 1;
+    errmesg = mesg;
+  }
+
+  // wait until background thread is done
+  // return its error message and reset it, empty string if none
+
+  std::string wait() {
+    if (writer.joinable()) writer.join();
+    std::string mesg;
+    if (failed) mesg = errmesg;
+    failed = 0;
+    return mesg;
+  }
+
+ private:
+  std::thread writer;
+  int running;
+  int failed;
+  std::string errmesg;
+  const char *name;
+  Memory *memory;
+
+  template <class T> void run(void (T::*func)(), T *obj) {
+    running = 1;
+    (obj->*func)();
+    running = 0;
+  }
+};
+
+}
+
+#endif
@@ -870,33 +870,14 @@ void Atom::deallocate_topology()
 }
 
 /* ----------------------------------------------------------------------
-   unpack N lines from Atom section of data file
-   call style-specific routine to parse line
+   set bounds for my proc of atoms read from data file
+   if periodic and I am lo/hi proc, adjust bounds by EPSILON
+   insures all data atoms will be owned even with round-off
+   if keepflag, bounds are those of the entire box
 ------------------------------------------------------------------------- */
 
-void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
-                      int type_offset, int shiftflag, double *shift)
+void Atom::data_bounds(double *sublo, double *subhi, int keepflag)
 {
-  int m,xptr,iptr;
-  imageint imagedata;
-  double xdata[3],lamda[3];
-  double *coord;
-  char *next;
-
-  next = strchr(buf,'\n');
-  *next = '\0';
-  int nwords = count_words(buf);
-  *next = '\n';
-
-  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3)
-    error->all(FLERR,"Incorrect atom format in data file");
-
-  char **values = new char*[nwords];
-
-  // set bounds for my proc
-  // if periodic and I am lo/hi proc, adjust bounds by EPSILON
-  // insures all data atoms will be owned even with round-off
-
   int triclinic = domain->triclinic;
 
   double epsilon[3];
@@ -907,7 +888,6 @@ void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
     epsilon[2] = domain->prd[2] * EPSILON;
   }
 
-  double sublo[3],subhi[3];
   if (triclinic == 0) {
     sublo[0] = domain->sublo[0]; subhi[0] = domain->subhi[0];
     sublo[1] = domain->sublo[1]; subhi[1] = domain->subhi[1];
@@ -918,7 +898,30 @@ void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
     sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
   }
 
-  if (comm->layout != Comm::LAYOUT_TILED) {
+  if (keepflag) {
+    if (triclinic == 0) {
+      for (int dim = 0; dim < 3; dim++) {
+        sublo[dim] = domain->boxlo[dim];
+        subhi[dim] = domain->boxhi[dim];
+      }
+    } else {
+      sublo[0] = sublo[1] = sublo[2] = 0.0;
+      subhi[0] = subhi[1] = subhi[2] = 1.0;
+    }
+    if (domain->xperiodic) {
+      sublo[0] -= epsilon[0];
+      subhi[0] += epsilon[0];
+    }
+    if (domain->yperiodic) {
+      sublo[1] -= epsilon[1];
+      subhi[1] += epsilon[1];
+    }
+    if (domain->zperiodic) {
+      sublo[2] -= epsilon[2];
+      subhi[2] += epsilon[2];
+    }
+
+  } else if (comm->layout != Comm::LAYOUT_TILED) {
     if (domain->xperiodic) {
       if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
       if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += epsilon[0];
@@ -946,6 +949,43 @@ void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
       if (comm->mysplit[2][1] == 1.0) subhi[2] += epsilon[2];
     }
   }
+}
+
+/* ----------------------------------------------------------------------
+   unpack N lines from Atom section of data file
+   call style-specific routine to parse line
+   if keepflag, keep all atoms inside the simulation box, not just my sub-box
+     caller then migrates them to their owning procs
+     lines differ between procs, so format errors are not collective
+------------------------------------------------------------------------- */
+
+void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
+                      int type_offset, int shiftflag, double *shift,
+                      int keepflag)
+{
+  int m,xptr,iptr;
+  imageint imagedata;
+  double xdata[3],lamda[3];
+  double *coord;
+  char *next;
+
+  next = strchr(buf,'\n');
+  *next = '\0';
+  int nwords = count_words(buf);
+  *next = '\n';
+
+  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3) {
+    if (keepflag) error->one(FLERR,"Incorrect atom format in data file");
+    error->all(FLERR,"Incorrect atom format in data file");
+  }
+
+  char **values = new char*[nwords];
+
+  // set bounds for my proc
+
+  int triclinic = domain->triclinic;
+  double sublo[3],subhi[3];
+  data_bounds(sublo,subhi,keepflag);
 
   // xptr = which word in line starts xyz coords
   // iptr = which word in line starts ix,iy,iz image flags
@@ -965,12 +1005,16 @@ void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
     next = strchr(buf,'\n');
 
     values[0] = strtok(buf," \t\n\r\f");
-    if (values[0] == NULL)
+    if (values[0] == NULL) {
+      if (keepflag) error->one(FLERR,"Incorrect atom format in data file");
       error->all(FLERR,"Incorrect atom format in data file");
+    }
     for (m = 1; m < nwords; m++) {
       values[m] = strtok(NULL," \t\n\r\f");
-      if (values[m] == NULL)
+      if (values[m] == NULL) {
+        if (keepflag) error->one(FLERR,"Incorrect atom format in data file");
         error->all(FLERR,"Incorrect atom format in data file");
+      }
     }
 
     if (imageflag)
@@ -1014,6 +1058,76 @@ void Atom::data_atoms(int n, char *buf, tagint id_offset, tagint mol_offset,
   delete [] values;
 }
 
+/* ----------------------------------------------------------------------
+   unpack N rows from Atoms section of binary data file
+   each row has size_data_atom values followed by 3 image flags
+   integer values are stored as 64-bit ints, others as doubles
+   keepflag has same meaning as for data_atoms()
+------------------------------------------------------------------------- */
+
+void Atom::data_atoms_binary(int n, double *buf, tagint id_offset,
+                             tagint mol_offset, int type_offset,
+                             int shiftflag, double *shift, int keepflag)
+{
+  imageint imagedata;
+  double xdata[3],lamda[3];
+  double *coord,*values;
+
+  // set bounds for my proc
+
+  int triclinic = domain->triclinic;
+  double sublo[3],subhi[3];
+  data_bounds(sublo,subhi,keepflag);
+
+  int ncol = avec->size_data_atom + 3;
+  int xptr = avec->xcol_data - 1;
+  int iptr = ncol - 3;
+
+  // loop over rows of atom data
+  // extract xyz coords and image flags
+  // remap atom into simulation box
+  // if atom is in my sub-domain, unpack its values
+
+  for (int i = 0; i < n; i++) {
+    values = &buf[(bigint) i*ncol];
+
+    imagedata =
+      ((imageint) ((int) ubuf(values[iptr]).i + IMGMAX) & IMGMASK) |
+      (((imageint) ((int) ubuf(values[iptr+1]).i + IMGMAX) & IMGMASK)
+       << IMGBITS) |
+      (((imageint) ((int) ubuf(values[iptr+2]).i + IMGMAX) & IMGMASK)
+       << IMG2BITS);
+
+    xdata[0] = values[xptr];
+    xdata[1] = values[xptr+1];
+    xdata[2] = values[xptr+2];
+    if (shiftflag) {
+      xdata[0] += shift[0];
+      xdata[1] += shift[1];
+      xdata[2] += shift[2];
+    }
+
+    domain->remap(xdata,imagedata);
+    if (triclinic) {
+      domain->x2lamda(xdata,lamda);
+      coord = lamda;
+    } else coord = xdata;
+
+    if (coord[0] >= sublo[0] && coord[0] < subhi[0] &&
+        coord[1] >= sublo[1] && coord[1] < subhi[1] &&
+        coord[2] >= sublo[2] && coord[2] < subhi[2]) {
+      avec->data_atom_binary(xdata,imagedata,values);
+      if (id_offset) tag[nlocal-1] += id_offset;
+      if (mol_offset) molecule[nlocal-1] += mol_offset;
+      if (type_offset) {
+        type[nlocal-1] += type_offset;
+        if (type[nlocal-1] > ntypes)
+          error->one(FLERR,"Invalid atom type in Atoms section of data file");
+      }
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    unpack N lines from Velocity section of data file
    check that atom IDs are > 0 and <= map_tag_max
@@ -1058,20 +1172,41 @@ void Atom::data_vels(int n, char *buf, tagint id_offset)
   delete [] values;
 }
 
+/* ----------------------------------------------------------------------
+   unpack N rows from Velocities section of binary data file
+   each row is atom ID as 64-bit int followed by size_data_vel-1 doubles
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void Atom::data_vels_binary(int n, double *buf, tagint id_offset)
+{
+  int m;
+  tagint tagdata;
+  double *values;
+
+  int ncol = avec->size_data_vel;
+
+  for (int i = 0; i < n; i++) {
+    values = &buf[(bigint) i*ncol];
+    tagdata = (tagint) ubuf(values[0]).i + id_offset;
+    if (tagdata <= 0 || tagdata > map_tag_max)
+      error->one(FLERR,"Invalid atom ID in Velocities section of data file");
+    if ((m = map(tagdata)) >= 0) avec->data_vel_binary(m,&values[1]);
+  }
+}
+
 /* ----------------------------------------------------------------------
    process N bonds read into buf from data files
    if count is non-NULL, just count bonds per atom
    else store them with atoms
-   check that atom IDs are > 0 and <= map_tag_max
 ------------------------------------------------------------------------- */
 
 void Atom::data_bonds(int n, char *buf, int *count, tagint id_offset,
                       int type_offset)
 {
-  int m,tmp,itype,rv;
+  int tmp,itype,rv;
   tagint atom1,atom2;
   char *next;
-  int newton_bond = force->newton_bond;
 
   for (int i = 0; i < n; i++) {
     next = strchr(buf,'\n');
@@ -1086,30 +1221,45 @@ void Atom::data_bonds(int n, char *buf, int *count, tagint id_offset,
     }
     itype += type_offset;
 
-    if ((atom1 <= 0) || (atom1 > map_tag_max) ||
-        (atom2 <= 0) || (atom2 > map_tag_max) || (atom1 == atom2))
-      error->one(FLERR,"Invalid atom ID in Bonds section of data file");
-    if (itype <= 0 || itype > nbondtypes)
-      error->one(FLERR,"Invalid bond type in Bonds section of data file");
-    if ((m = map(atom1)) >= 0) {
+    data_bond(itype,atom1,atom2,count);
+    buf = next + 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process one bond from data files, with any offsets already added
+   if count is non-NULL, just count bonds per atom
+   else store it with atoms
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void Atom::data_bond(int itype, tagint atom1, tagint atom2, int *count)
+{
+  int m;
+  int newton_bond = force->newton_bond;
+
+  if ((atom1 <= 0) || (atom1 > map_tag_max) ||
+      (atom2 <= 0) || (atom2 > map_tag_max) || (atom1 == atom2))
+    error->one(FLERR,"Invalid atom ID in Bonds section of data file");
+  if (itype <= 0 || itype > nbondtypes)
+    error->one(FLERR,"Invalid bond type in Bonds section of data file");
+  if ((m = map(atom1)) >= 0) {
+    if (count) count[m]++;
+    else {
+      bond_type[m][num_bond[m]] = itype;
+      bond_atom[m][num_bond[m]] = atom2;
+      num_bond[m]++;
+    }
+  }
+  if (newton_bond == 0) {
+    if ((m = map(atom2)) >= 0) {
       if (count) count[m]++;
       else {
         bond_type[m][num_bond[m]] = itype;
-        bond_atom[m][num_bond[m]] = atom2;
+        bond_atom[m][num_bond[m]] = atom1;
         num_bond[m]++;
       }
     }
-    if (newton_bond == 0) {
-      if ((m = map(atom2)) >= 0) {
-        if (count) count[m]++;
-        else {
-          bond_type[m][num_bond[m]] = itype;
-          bond_atom[m][num_bond[m]] = atom1;
-          num_bond[m]++;
-        }
-      }
-    }
-    buf = next + 1;
   }
 }
 
@@ -1117,16 +1267,14 @@ void Atom::data_bonds(int n, char *buf, int *count, tagint id_offset,
    process N angles read into buf from data files
    if count is non-NULL, just count angles per atom
    else store them with atoms
-   check that atom IDs are > 0 and <= map_tag_max
 ------------------------------------------------------------------------- */
 
 void Atom::data_angles(int n, char *buf, int *count, tagint id_offset,
                        int type_offset)
 {
-  int m,tmp,itype,rv;
+  int tmp,itype,rv;
   tagint atom1,atom2,atom3;
   char *next;
-  int newton_bond = force->newton_bond;
 
   for (int i = 0; i < n; i++) {
     next = strchr(buf,'\n');
@@ -1142,14 +1290,43 @@ void Atom::data_angles(int n, char *buf, int *count, tagint id_offset,
     }
     itype += type_offset;
 
-    if ((atom1 <= 0) || (atom1 > map_tag_max) ||
-        (atom2 <= 0) || (atom2 > map_tag_max) ||
-        (atom3 <= 0) || (atom3 > map_tag_max) ||
-        (atom1 == atom2) || (atom1 == atom3) || (atom2 == atom3))
-      error->one(FLERR,"Invalid atom ID in Angles section of data file");
-    if (itype <= 0 || itype > nangletypes)
-      error->one(FLERR,"Invalid angle type in Angles section of data file");
-    if ((m = map(atom2)) >= 0) {
+    data_angle(itype,atom1,atom2,atom3,count);
+    buf = next + 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process one angle from data files, with any offsets already added
+   if count is non-NULL, just count angles per atom
+   else store it with atoms
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void Atom::data_angle(int itype, tagint atom1, tagint atom2, tagint atom3,
+                      int *count)
+{
+  int m;
+  int newton_bond = force->newton_bond;
+
+  if ((atom1 <= 0) || (atom1 > map_tag_max) ||
+      (atom2 <= 0) || (atom2 > map_tag_max) ||
+      (atom3 <= 0) || (atom3 > map_tag_max) ||
+      (atom1 == atom2) || (atom1 == atom3) || (atom2 == atom3))
+    error->one(FLERR,"Invalid atom ID in Angles section of data file");
+  if (itype <= 0 || itype > nangletypes)
+    error->one(FLERR,"Invalid angle type in Angles section of data file");
+  if ((m = map(atom2)) >= 0) {
+    if (count) count[m]++;
+    else {
+      angle_type[m][num_angle[m]] = itype;
+      angle_atom1[m][num_angle[m]] = atom1;
+      angle_atom2[m][num_angle[m]] = atom2;
+      angle_atom3[m][num_angle[m]] = atom3;
+      num_angle[m]++;
+    }
+  }
+  if (newton_bond == 0) {
+    if ((m = map(atom1)) >= 0) {
       if (count) count[m]++;
       else {
         angle_type[m][num_angle[m]] = itype;
@@ -1159,29 +1336,16 @@ void Atom::data_angles(int n, char *buf, int *count, tagint id_offset,
         num_angle[m]++;
       }
     }
-    if (newton_bond == 0) {
-      if ((m = map(atom1)) >= 0) {
-        if (count) count[m]++;
-        else {
-          angle_type[m][num_angle[m]] = itype;
-          angle_atom1[m][num_angle[m]] = atom1;
-          angle_atom2[m][num_angle[m]] = atom2;
-          angle_atom3[m][num_angle[m]] = atom3;
-          num_angle[m]++;
-        }
-      }
-      if ((m = map(atom3)) >= 0) {
-        if (count) count[m]++;
-        else {
-          angle_type[m][num_angle[m]] = itype;
-          angle_atom1[m][num_angle[m]] = atom1;
-          angle_atom2[m][num_angle[m]] = atom2;
-          angle_atom3[m][num_angle[m]] = atom3;
-          num_angle[m]++;
-        }
+    if ((m = map(atom3)) >= 0) {
+      if (count) count[m]++;
+      else {
+        angle_type[m][num_angle[m]] = itype;
+        angle_atom1[m][num_angle[m]] = atom1;
+        angle_atom2[m][num_angle[m]] = atom2;
+        angle_atom3[m][num_angle[m]] = atom3;
+        num_angle[m]++;
       }
     }
-    buf = next + 1;
   }
 }
 
@@ -1189,16 +1353,14 @@ void Atom::data_angles(int n, char *buf, int *count, tagint id_offset,
    process N dihedrals read into buf from data files
    if count is non-NULL, just count diihedrals per atom
    else store them with atoms
-   check that atom IDs are > 0 and <= map_tag_max
 ------------------------------------------------------------------------- */
 
 void Atom::data_dihedrals(int n, char *buf, int *count, tagint id_offset,
                           int type_offset)
 {
-  int m,tmp,itype,rv;
+  int tmp,itype,rv;
   tagint atom1,atom2,atom3,atom4;
   char *next;
-  int newton_bond = force->newton_bond;
 
   for (int i = 0; i < n; i++) {
     next = strchr(buf,'\n');
@@ -1216,17 +1378,47 @@ void Atom::data_dihedrals(int n, char *buf, int *count, tagint id_offset,
     }
     itype += type_offset;
 
-    if ((atom1 <= 0) || (atom1 > map_tag_max) ||
-        (atom2 <= 0) || (atom2 > map_tag_max) ||
-        (atom3 <= 0) || (atom3 > map_tag_max) ||
-        (atom4 <= 0) || (atom4 > map_tag_max) ||
-        (atom1 == atom2) || (atom1 == atom3) || (atom1 == atom4) ||
-        (atom2 == atom3) || (atom2 == atom4) || (atom3 == atom4))
-      error->one(FLERR,"Invalid atom ID in Dihedrals section of data file");
-    if (itype <= 0 || itype > ndihedraltypes)
-      error->one(FLERR,
-                 "Invalid dihedral type in Dihedrals section of data file");
-    if ((m = map(atom2)) >= 0) {
+    data_dihedral(itype,atom1,atom2,atom3,atom4,count);
+    buf = next + 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process one dihedral from data files, with any offsets already added
+   if count is non-NULL, just count dihedrals per atom
+   else store it with atoms
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void Atom::data_dihedral(int itype, tagint atom1, tagint atom2, tagint atom3,
+                         tagint atom4, int *count)
+{
+  int m;
+  int newton_bond = force->newton_bond;
+
+  if ((atom1 <= 0) || (atom1 > map_tag_max) ||
+      (atom2 <= 0) || (atom2 > map_tag_max) ||
+      (atom3 <= 0) || (atom3 > map_tag_max) ||
+      (atom4 <= 0) || (atom4 > map_tag_max) ||
+      (atom1 == atom2) || (atom1 == atom3) || (atom1 == atom4) ||
+      (atom2 == atom3) || (atom2 == atom4) || (atom3 == atom4))
+    error->one(FLERR,"Invalid atom ID in Dihedrals section of data file");
+  if (itype <= 0 || itype > ndihedraltypes)
+    error->one(FLERR,
+               "Invalid dihedral type in Dihedrals section of data file");
+  if ((m = map(atom2)) >= 0) {
+    if (count) count[m]++;
+    else {
+      dihedral_type[m][num_dihedral[m]] = itype;
+      dihedral_atom1[m][num_dihedral[m]] = atom1;
+      dihedral_atom2[m][num_dihedral[m]] = atom2;
+      dihedral_atom3[m][num_dihedral[m]] = atom3;
+      dihedral_atom4[m][num_dihedral[m]] = atom4;
+      num_dihedral[m]++;
+    }
+  }
+  if (newton_bond == 0) {
+    if ((m = map(atom1)) >= 0) {
       if (count) count[m]++;
       else {
         dihedral_type[m][num_dihedral[m]] = itype;
@@ -1237,42 +1429,28 @@ void Atom::data_dihedrals(int n, char *buf, int *count, tagint id_offset,
         num_dihedral[m]++;
       }
     }
-    if (newton_bond == 0) {
-      if ((m = map(atom1)) >= 0) {
-        if (count) count[m]++;
-        else {
-          dihedral_type[m][num_dihedral[m]] = itype;
-          dihedral_atom1[m][num_dihedral[m]] = atom1;
-          dihedral_atom2[m][num_dihedral[m]] = atom2;
-          dihedral_atom3[m][num_dihedral[m]] = atom3;
-          dihedral_atom4[m][num_dihedral[m]] = atom4;
-          num_dihedral[m]++;
-        }
-      }
-      if ((m = map(atom3)) >= 0) {
-        if (count) count[m]++;
-        else {
-          dihedral_type[m][num_dihedral[m]] = itype;
-          dihedral_atom1[m][num_dihedral[m]] = atom1;
-          dihedral_atom2[m][num_dihedral[m]] = atom2;
-          dihedral_atom3[m][num_dihedral[m]] = atom3;
-          dihedral_atom4[m][num_dihedral[m]] = atom4;
-          num_dihedral[m]++;
-        }
+    if ((m = map(atom3)) >= 0) {
+      if (count) count[m]++;
+      else {
+        dihedral_type[m][num_dihedral[m]] = itype;
+        dihedral_atom1[m][num_dihedral[m]] = atom1;
+        dihedral_atom2[m][num_dihedral[m]] = atom2;
+        dihedral_atom3[m][num_dihedral[m]] = atom3;
+        dihedral_atom4[m][num_dihedral[m]] = atom4;
+        num_dihedral[m]++;
       }
-      if ((m = map(atom4)) >= 0) {
-        if (count) count[m]++;
-        else {
-          dihedral_type[m][num_dihedral[m]] = itype;
-          dihedral_atom1[m][num_dihedral[m]] = atom1;
-          dihedral_atom2[m][num_dihedral[m]] = atom2;
-          dihedral_atom3[m][num_dihedral[m]] = atom3;
-          dihedral_atom4[m][num_dihedral[m]] = atom4;
-          num_dihedral[m]++;
-        }
+    }
+    if ((m = map(atom4)) >= 0) {
+      if (count) count[m]++;
+      else {
+        dihedral_type[m][num_dihedral[m]] = itype;
+        dihedral_atom1[m][num_dihedral[m]] = atom1;
+        dihedral_atom2[m][num_dihedral[m]] = atom2;
+        dihedral_atom3[m][num_dihedral[m]] = atom3;
+        dihedral_atom4[m][num_dihedral[m]] = atom4;
+        num_dihedral[m]++;
       }
     }
-    buf = next + 1;
   }
 }
 
@@ -1280,16 +1458,14 @@ void Atom::data_dihedrals(int n, char *buf, int *count, tagint id_offset,
    process N impropers read into buf from data files
    if count is non-NULL, just count impropers per atom
    else store them with atoms
-   check that atom IDs are > 0 and <= map_tag_max
 ------------------------------------------------------------------------- */
 
 void Atom::data_impropers(int n, char *buf, int *count, tagint id_offset,
                           int type_offset)
 {
-  int m,tmp,itype,rv;
+  int tmp,itype,rv;
   tagint atom1,atom2,atom3,atom4;
   char *next;
-  int newton_bond = force->newton_bond;
 
   for (int i = 0; i < n; i++) {
     next = strchr(buf,'\n');
@@ -1307,17 +1483,47 @@ void Atom::data_impropers(int n, char *buf, int *count, tagint id_offset,
     }
     itype += type_offset;
 
-    if ((atom1 <= 0) || (atom1 > map_tag_max) ||
-        (atom2 <= 0) || (atom2 > map_tag_max) ||
-        (atom3 <= 0) || (atom3 > map_tag_max) ||
-        (atom4 <= 0) || (atom4 > map_tag_max) ||
-        (atom1 == atom2) || (atom1 == atom3) || (atom1 == atom4) ||
-        (atom2 == atom3) || (atom2 == atom4) || (atom3 == atom4))
-      error->one(FLERR,"Invalid atom ID in Impropers section of data file");
-    if (itype <= 0 || itype > nimpropertypes)
-      error->one(FLERR,
-                 "Invalid improper type in Impropers section of data file");
-    if ((m = map(atom2)) >= 0) {
+    data_improper(itype,atom1,atom2,atom3,atom4,count);
+    buf = next + 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process one improper from data files, with any offsets already added
+   if count is non-NULL, just count impropers per atom
+   else store it with atoms
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void Atom::data_improper(int itype, tagint atom1, tagint atom2, tagint atom3,
+                         tagint atom4, int *count)
+{
+  int m;
+  int newton_bond = force->newton_bond;
+
+  if ((atom1 <= 0) || (atom1 > map_tag_max) ||
+      (atom2 <= 0) || (atom2 > map_tag_max) ||
+      (atom3 <= 0) || (atom3 > map_tag_max) ||
+      (atom4 <= 0) || (atom4 > map_tag_max) ||
+      (atom1 == atom2) || (atom1 == atom3) || (atom1 == atom4) ||
+      (atom2 == atom3) || (atom2 == atom4) || (atom3 == atom4))
+    error->one(FLERR,"Invalid atom ID in Impropers section of data file");
+  if (itype <= 0 || itype > nimpropertypes)
+    error->one(FLERR,
+               "Invalid improper type in Impropers section of data file");
+  if ((m = map(atom2)) >= 0) {
+    if (count) count[m]++;
+    else {
+      improper_type[m][num_improper[m]] = itype;
+      improper_atom1[m][num_improper[m]] = atom1;
+      improper_atom2[m][num_improper[m]] = atom2;
+      improper_atom3[m][num_improper[m]] = atom3;
+      improper_atom4[m][num_improper[m]] = atom4;
+      num_improper[m]++;
+    }
+  }
+  if (newton_bond == 0) {
+    if ((m = map(atom1)) >= 0) {
       if (count) count[m]++;
       else {
         improper_type[m][num_improper[m]] = itype;
@@ -1328,42 +1534,28 @@ void Atom::data_impropers(int n, char *buf, int *count, tagint id_offset,
         num_improper[m]++;
       }
     }
-    if (newton_bond == 0) {
-      if ((m = map(atom1)) >= 0) {
-        if (count) count[m]++;
-        else {
-          improper_type[m][num_improper[m]] = itype;
-          improper_atom1[m][num_improper[m]] = atom1;
-          improper_atom2[m][num_improper[m]] = atom2;
-          improper_atom3[m][num_improper[m]] = atom3;
-          improper_atom4[m][num_improper[m]] = atom4;
-          num_improper[m]++;
-        }
-      }
-      if ((m = map(atom3)) >= 0) {
-        if (count) count[m]++;
-        else {
-          improper_type[m][num_improper[m]] = itype;
-          improper_atom1[m][num_improper[m]] = atom1;
-          improper_atom2[m][num_improper[m]] = atom2;
-          improper_atom3[m][num_improper[m]] = atom3;
-          improper_atom4[m][num_improper[m]] = atom4;
-          num_improper[m]++;
-        }
+    if ((m = map(atom3)) >= 0) {
+      if (count) count[m]++;
+      else {
+        improper_type[m][num_improper[m]] = itype;
+        improper_atom1[m][num_improper[m]] = atom1;
+        improper_atom2[m][num_improper[m]] = atom2;
+        improper_atom3[m][num_improper[m]] = atom3;
+        improper_atom4[m][num_improper[m]] = atom4;
+        num_improper[m]++;
       }
-      if ((m = map(atom4)) >= 0) {
-        if (count) count[m]++;
-        else {
-          improper_type[m][num_improper[m]] = itype;
-          improper_atom1[m][num_improper[m]] = atom1;
-          improper_atom2[m][num_improper[m]] = atom2;
-          improper_atom3[m][num_improper[m]] = atom3;
-          improper_atom4[m][num_improper[m]] = atom4;
-          num_improper[m]++;
-        }
+    }
+    if ((m = map(atom4)) >= 0) {
+      if (count) count[m]++;
+      else {
+        improper_type[m][num_improper[m]] = itype;
+        improper_atom1[m][num_improper[m]] = atom1;
+        improper_atom2[m][num_improper[m]] = atom2;
+        improper_atom3[m][num_improper[m]] = atom3;
+        improper_atom4[m][num_improper[m]] = atom4;
+        num_improper[m]++;
       }
     }
-    buf = next + 1;
   }
 }
 
@@ -246,12 +246,19 @@ class Atom : protected Pointers {
 
   void deallocate_topology();
 
-  void data_atoms(int, char *, tagint, tagint, int, int, double *);
+  void data_atoms(int, char *, tagint, tagint, int, int, double *, int);
+  void data_atoms_binary(int, double *, tagint, tagint, int, int, double *,
+                         int);
   void data_vels(int, char *, tagint);
+  void data_vels_binary(int, double *, tagint);
   void data_bonds(int, char *, int *, tagint, int);
+  void data_bond(int, tagint, tagint, int *);
   void data_angles(int, char *, int *, tagint, int);
+  void data_angle(int, tagint, tagint, tagint, int *);
   void data_dihedrals(int, char *, int *, tagint, int);
+  void data_dihedral(int, tagint, tagint, tagint, tagint, int *);
   void data_impropers(int, char *, int *, tagint, int);
+  void data_improper(int, tagint, tagint, tagint, tagint, int *);
   void data_bonus(int, char *, class AtomVec *, tagint);
   void data_bodies(int, char *, class AtomVecBody *, tagint);
   void data_fix_compute_variable(int, int);
@@ -350,6 +357,18 @@ class Atom : protected Pointers {
   void setup_sort_bins();
   int next_prime(int);
 
+  void data_bounds(double *, double *, int);
+
+  // union data struct for unpacking 64-bit ints from binary data files
+
+  union ubuf {
+    double d;
+    int64_t i;
+    ubuf(double arg) : d(arg) {}
+    ubuf(int64_t arg) : i(arg) {}
+    ubuf(int arg) : i(arg) {}
+  };
+
  private:
   template <typename T> static AtomVec *avec_creator(LAMMPS *);
 };
@@ -34,6 +34,7 @@ AtomVec::AtomVec(LAMMPS *lmp) : Pointers(lmp)
   bonds_allow = angles_allow = dihedrals_allow = impropers_allow = 0;
   mass_type = dipole_type = 0;
   forceclearflag = 0;
+  binary_data_allow = 0;
   size_data_bonus = 0;
   maxexchange = 0;
 
@@ -135,6 +136,18 @@ void AtomVec::data_vel(int m, char **values)
   v[m][2] = utils::numeric(FLERR,values[2],true,lmp);
 }
 
+/* ----------------------------------------------------------------------
+   unpack one row of Velocities section of binary data file
+------------------------------------------------------------------------- */
+
+void AtomVec::data_vel_binary(int m, double *values)
+{
+  double **v = atom->v;
+  v[m][0] = values[0];
+  v[m][1] = values[1];
+  v[m][2] = values[2];
+}
+
 /* ----------------------------------------------------------------------
    pack velocity info for data file
 ------------------------------------------------------------------------- */
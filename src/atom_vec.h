@@ -26,6 +26,7 @@ class AtomVec : protected Pointers {
   int mass_type;                       // 1 if per-type masses
   int dipole_type;                     // 1 if per-type dipole moments
   int forceclearflag;                  // 1 if has forceclear() method
+  int binary_data_allow;               // 1 if has data_atom_binary() method
 
   int comm_x_only;                     // 1 if only exchange x in forward comm
   int comm_f_only;                     // 1 if only exchange f in reverse comm
@@ -94,6 +95,8 @@ class AtomVec : protected Pointers {
   virtual void data_atom_bonus(int, char **) {}
   virtual int data_atom_hybrid(int, char **) {return 0;}
   virtual void data_vel(int, char **);
+  virtual void data_atom_binary(double *, imageint, double *) {}
+  virtual void data_vel_binary(int, double *);
   virtual int data_vel_hybrid(int, char **) {return 0;}
 
   virtual void pack_data(double **) = 0;
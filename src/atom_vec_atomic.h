@@ -48,6 +48,7 @@ class AtomVecAtomic : public AtomVec {
   int unpack_restart(double *);
   void create_atom(int, double *);
   void data_atom(double *, imageint, char **);
+  void data_atom_binary(double *, imageint, double *);
   void pack_data(double **);
   void write_data(FILE *, int, double **);
   bigint memory_usage();
@@ -14,6 +14,7 @@
 #include "dump.h"
 #include <mpi.h>
 #include <cstring>
+#include "async_writer.h"
 #include "atom.h"
 #include "irregular.h"
 #include "update.h"
@@ -85,6 +86,8 @@ Dump::Dump(LAMMPS *lmp, int /*narg*/, char **arg) : Pointers(lmp)
   append_flag = 0;
   buffer_allow = 0;
   buffer_flag = 0;
+  async_allow = 0;
+  async_flag = 0;
   padflag = 0;
   pbcflag = 0;
   time_flag = 0;
@@ -102,6 +105,7 @@ Dump::Dump(LAMMPS *lmp, int /*narg*/, char **arg) : Pointers(lmp)
   ids = idsort = NULL;
   index = proclist = NULL;
   irregular = NULL;
+  async = NULL;
 
   maxsbuf = 0;
   sbuf = NULL;
@@ -115,6 +119,7 @@ Dump::Dump(LAMMPS *lmp, int /*narg*/, char **arg) : Pointers(lmp)
   // if contains '*', write one file per timestep and replace * with timestep
   // check file suffixes
   //   if ends in .bin = binary file
+  //   else if ends in .bin.gz = gzipped binary file
   //   else if ends in .gz = gzipped text file
   //   else ASCII text file
 
@@ -153,12 +158,21 @@ Dump::Dump(LAMMPS *lmp, int /*narg*/, char **arg) : Pointers(lmp)
   if (suffix > filename && strcmp(suffix,".bin") == 0) binary = 1;
   suffix = filename + strlen(filename) - strlen(".gz");
   if (suffix > filename && strcmp(suffix,".gz") == 0) compressed = 1;
+  suffix = filename + strlen(filename) - strlen(".bin.gz");
+  if (suffix > filename && strcmp(suffix,".bin.gz") == 0) binary = 1;
 }
 
 /* ---------------------------------------------------------------------- */
 
 Dump::~Dump()
 {
+  // finish async output of the last snapshot
+  // styles whose write_data() uses memory freed in their own destructor
+  //   must already call wait_write() there
+
+  wait_write();
+  delete async;
+
   delete [] id;
   delete [] style;
   delete [] filename;
@@ -217,6 +231,7 @@ Dump::~Dump()
 
 void Dump::init()
 {
+  wait_write();
   init_style();
 
   if (!sort_flag) {
@@ -339,6 +354,10 @@ void Dump::write()
 
   if (delay_flag && update->ntimestep < delaystep) return;
 
+  // previous snapshot must be completely written before fp is reused
+
+  wait_write();
+
   // if file per timestep, open new file
 
   if (multifile) openfile();
@@ -461,27 +480,41 @@ void Dump::write()
   // filewriter = 1 = this proc writes to file
   // ping each proc in my cluster, receive its data, write data to file
   // else wait for ping from fileproc, send my data to fileproc
+  // for async output, filewriter copies data of all procs into a snapshot
+  //   and a background thread writes it, while the simulation continues
 
   int tmp,nlines,nchars;
   MPI_Status status;
   MPI_Request request;
 
+  if (async_flag && filewriter) async->clear();
+
   // comm and output buf of doubles
 
   if (buffer_flag == 0 || binary) {
     if (filewriter) {
       for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+        double *rbuf = buf;
+        if (async_flag)
+          rbuf = (double *)
+            async->reserve((bigint) maxbuf*size_one*sizeof(double));
         if (iproc) {
-          MPI_Irecv(buf,maxbuf*size_one,MPI_DOUBLE,me+iproc,0,world,&request);
+          MPI_Irecv(rbuf,maxbuf*size_one,MPI_DOUBLE,me+iproc,0,world,&request);
           MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
           MPI_Wait(&request,&status);
           MPI_Get_count(&status,MPI_DOUBLE,&nlines);
           nlines /= size_one;
-        } else nlines = nme;
+        } else {
+          nlines = nme;
+          if (async_flag) memcpy(rbuf,buf,(bigint) nme*size_one*sizeof(double));
+        }
 
-        write_data(nlines,buf);
+        if (async_flag)
+          async->append(nlines,size_one*sizeof(double));
+        else write_data(nlines,buf);
       }
-      if (flush_flag && fp) fflush(fp);
+      if (async_flag) async->start(&Dump::write_async,this);
+      else write_finish();
 
     } else {
       MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
@@ -493,16 +526,23 @@ void Dump::write()
   } else {
     if (filewriter) {
       for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+        char *rbuf = sbuf;
+        if (async_flag) rbuf = async->reserve(maxsbuf);
         if (iproc) {
-          MPI_Irecv(sbuf,maxsbuf,MPI_CHAR,me+iproc,0,world,&request);
+          MPI_Irecv(rbuf,maxsbuf,MPI_CHAR,me+iproc,0,world,&request);
           MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
           MPI_Wait(&request,&status);
           MPI_Get_count(&status,MPI_CHAR,&nchars);
-        } else nchars = nsme;
+        } else {
+          nchars = nsme;
+          if (async_flag) memcpy(rbuf,sbuf,nsme);
+        }
 
-        write_data(nchars,(double *) sbuf);
+        if (async_flag) async->append(nchars,sizeof(char));
+        else write_data(nchars,(double *) sbuf);
       }
-      if (flush_flag && fp) fflush(fp);
+      if (async_flag) async->start(&Dump::write_async,this);
+      else write_finish();
 
     } else {
       MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
@@ -522,17 +562,61 @@ void Dump::write()
   // currently used for incremental dump files
 
   if (refreshflag) modify->compute[irefresh]->refresh();
+}
 
-  // if file per timestep, close file if I am filewriter
+/* ----------------------------------------------------------------------
+   complete output of one snapshot on a filewriter proc
+   if file per timestep, close file, else flush it if requested
+   some derived classes override this function
+------------------------------------------------------------------------- */
 
+void Dump::write_finish()
+{
   if (multifile) {
-    if (compressed) {
-      if (filewriter && fp != NULL) pclose(fp);
-    } else {
-      if (filewriter && fp != NULL) fclose(fp);
+    if (fp != NULL) {
+      if (compressed) pclose(fp);
+      else fclose(fp);
     }
     fp = NULL;
-  }
+  } else if (flush_flag && fp) fflush(fp);
+}
+
+/* ----------------------------------------------------------------------
+   body of background thread for dump_modify async yes
+   write all blocks of the snapshot gathered by Dump::write()
+   must not communicate or call into the rest of LAMMPS
+------------------------------------------------------------------------- */
+
+void Dump::write_async()
+{
+  const int nblocks = async->count.size();
+  for (int i = 0; i < nblocks; i++)
+    write_data(async->count[i],(double *) (async->data + async->offset[i]));
+  write_finish();
+}
+
+/* ----------------------------------------------------------------------
+   report failure to write the dump file
+   in the background thread it is recorded and raised by wait_write()
+------------------------------------------------------------------------- */
+
+void Dump::write_error(const char *mesg)
+{
+  if (async && async->in_thread()) async->fail(mesg);
+  else error->one(FLERR,mesg);
+}
+
+/* ----------------------------------------------------------------------
+   wait until background thread has written the previous snapshot
+   must be called before the file or the dump settings are changed
+   a failure reported by the thread is raised here
+------------------------------------------------------------------------- */
+
+void Dump::wait_write()
+{
+  if (async == NULL) return;
+  std::string mesg = async->wait();
+  if (!mesg.empty()) error->one(FLERR,mesg.c_str());
 }
 
 /* ----------------------------------------------------------------------
@@ -918,6 +1002,8 @@ void Dump::modify_params(int narg, char **arg)
 {
   if (narg == 0) error->all(FLERR,"Illegal dump_modify command");
 
+  wait_write();
+
   int iarg = 0;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"append") == 0) {
@@ -927,6 +1013,16 @@ void Dump::modify_params(int narg, char **arg)
       else error->all(FLERR,"Illegal dump_modify command");
       iarg += 2;
 
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) async_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) async_flag = 0;
+      else error->all(FLERR,"Illegal dump_modify command");
+      if (async_flag && async_allow == 0)
+        error->all(FLERR,"Dump_modify async yes not allowed for this style");
+      if (async_flag && async == NULL) async = new AsyncWriter(memory,"dump:async");
+      iarg += 2;
+
     } else if (strcmp(arg[iarg],"buffer") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
       if (strcmp(arg[iarg+1],"yes") == 0) buffer_flag = 1;
@@ -1175,6 +1271,7 @@ bigint Dump::memory_usage()
 {
   bigint bytes = memory->usage(buf,size_one*maxbuf);
   bytes += memory->usage(sbuf,maxsbuf);
+  if (async) bytes += async->maxdata;
   if (sort_flag) {
     if (sortcol == 0) bytes += memory->usage(ids,maxids);
     bytes += memory->usage(bufsort,size_one*maxsort);
@@ -40,6 +40,7 @@ class Dump : protected Pointers {
   virtual ~Dump();
   void init();
   virtual void write();
+  void wait_write();
 
   virtual int pack_forward_comm(int, int *, double *, int, int *) {return 0;}
   virtual void unpack_forward_comm(int, int, double *) {}
@@ -69,6 +70,8 @@ class Dump : protected Pointers {
   int append_flag;           // 1 if open file in append mode, 0 if not
   int buffer_allow;          // 1 if style allows for buffer_flag, 0 if not
   int buffer_flag;           // 1 if buffer output as one big string, 0 if not
+  int async_allow;           // 1 if style allows for async_flag, 0 if not
+  int async_flag;            // 1 if file is written by background thread
   int padflag;               // timestep padding in filename
   int pbcflag;               // 1 if remap dumped atoms via PBC, 0 if not
   int singlefile_opened;     // 1 = one big file, already opened, else 0
@@ -136,6 +139,7 @@ class Dump : protected Pointers {
   int maxpbc;
 
   class Irregular *irregular;
+  class AsyncWriter *async;  // snapshot and thread for async output
 
   virtual void init_style() = 0;
   virtual void openfile();
@@ -145,6 +149,9 @@ class Dump : protected Pointers {
   virtual void pack(tagint *) = 0;
   virtual int convert_string(int, double *) {return 0;}
   virtual void write_data(int, double *) = 0;
+  virtual void write_finish();
+  void write_async();
+  void write_error(const char *);
   void pbc_allocate();
   double compute_time();
 
@@ -221,6 +228,11 @@ E: Dump_modify buffer yes not allowed for this style
 
 Self-explanatory.
 
+E: Dump_modify async yes not allowed for this style
+
+Only the atom, cfg, custom, local, and xyz dump styles (and their
+compressed variants) can write their files in a background thread.
+
 E: Cannot use dump_modify fileper without % in dump file name
 
 Self-explanatory.
@@ -33,6 +33,7 @@ DumpAtom::DumpAtom(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
   scale_flag = 1;
   image_flag = 0;
   buffer_allow = 1;
+  async_allow = 1;
   buffer_flag = 1;
   format_default = NULL;
 }
@@ -85,6 +85,7 @@ DumpCustom::DumpCustom(LAMMPS *lmp, int narg, char **arg) :
   memory->create(argindex,nfield,"dump:argindex");
 
   buffer_allow = 1;
+  async_allow = 1;
   buffer_flag = 1;
   iregion = -1;
   idregion = NULL;
@@ -189,6 +190,8 @@ DumpCustom::DumpCustom(LAMMPS *lmp, int narg, char **arg) :
 
 DumpCustom::~DumpCustom()
 {
+  wait_write();
+
   // if wildcard expansion occurred, free earg memory from expand_args()
   // could not do in constructor, b/c some derived classes process earg
 
@@ -61,6 +61,7 @@ DumpImage::DumpImage(LAMMPS *lmp, int narg, char **arg) :
   // force binary flag on to avoid corrupted output on Windows
 
   binary = 1;
+  async_allow = 0;
   multifile_override = 0;
 
   // set filetype based on filename suffix
@@ -627,7 +628,9 @@ void DumpImage::write()
   }
 
   // create image on each proc, then merge them
+  // spheres and cylinders are rendered by OpenMP threads if there are any
 
+  image->nthreads = comm->nthreads;
   image->clear();
   create_image();
   image->merge();
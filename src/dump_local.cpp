@@ -67,6 +67,7 @@ DumpLocal::DumpLocal(LAMMPS *lmp, int narg, char **arg) :
   vtype = new int[nfield];
 
   buffer_allow = 1;
+  async_allow = 1;
   buffer_flag = 1;
 
   // computes & fixes which the dump accesses
@@ -133,6 +134,8 @@ DumpLocal::DumpLocal(LAMMPS *lmp, int narg, char **arg) :
 
 DumpLocal::~DumpLocal()
 {
+  wait_write();
+
   delete [] pack_choice;
   delete [] vtype;
   delete [] field2index;
@@ -40,6 +40,8 @@ static const char *truncpath(const char *path)
    return path;
 }
 
+thread_local int Error::defer_flag = 0;
+
 /* ---------------------------------------------------------------------- */
 
 Error::Error(LAMMPS *lmp) : Pointers(lmp) {
@@ -137,6 +139,8 @@ void Error::universe_warn(const char *file, int line, const char *str)
 
 void Error::all(const char *file, int line, const char *str)
 {
+  if (defer_flag) throw ThreadError(str);
+
   MPI_Barrier(world);
 
   int me;
@@ -190,6 +194,8 @@ void Error::all(const char *file, int line, const char *str)
 
 void Error::one(const char *file, int line, const char *str)
 {
+  if (defer_flag) throw ThreadError(str);
+
   int me;
   const char *lastcmd = (const char*)"(unknown)";
   MPI_Comm_rank(world,&me);
@@ -15,6 +15,7 @@
 #define LMP_ERROR_H
 
 #include "pointers.h"
+#include <string>
 
 #ifdef LAMMPS_EXCEPTIONS
 #include "exceptions.h"
@@ -22,6 +23,14 @@
 
 namespace LAMMPS_NS {
 
+// error raised in a background thread, see Error::defer_flag
+
+class ThreadError {
+ public:
+  std::string message;
+  ThreadError(const char *str) : message(str) {}
+};
+
 class Error : protected Pointers {
  public:
   Error(class LAMMPS *);
@@ -36,6 +45,11 @@ class Error : protected Pointers {
   void message(const char *, int, const char *, int = 1);
   void done(int = 0); // 1 would be fully backwards compatible
 
+  // set by a background thread, so that all() and one() called by it
+  //   throw a ThreadError, which the thread passes to the main thread
+
+  static thread_local int defer_flag;
+
 #ifdef LAMMPS_EXCEPTIONS
   char *    get_last_error() const;
   ErrorType get_last_error_type() const;
@@ -676,7 +676,7 @@ void Force::create_kspace(const char *style, int trysuffix)
   kspace = new_kspace(style,trysuffix,sflag);
   store_style(kspace_style,style,sflag);
 
-  if (comm->style == 1 && !kspace_match("ewald",0))
+  if (comm->style == 1 && !kspace_match("ewald",0) && !kspace_match("fmm",0))
     error->all(FLERR,
                "Cannot yet use KSpace solver with grid with comm style tiled");
 }
@@ -44,11 +44,14 @@ using namespace MathConst;
 #define NCOLORS 140
 #define NELEMENTS 109
 #define EPSILON 1.0e-6
+#define PRIMSIZE 11
+#define DELTAPRIM 16384
 
 enum{NUMERIC,MINVALUE,MAXVALUE};
 enum{CONTINUOUS,DISCRETE,SEQUENTIAL};
 enum{ABSOLUTE,FRACTIONAL};
 enum{NO,YES};
+enum{SPHERE,CYLINDER};
 
 /* ---------------------------------------------------------------------- */
 
@@ -113,6 +116,14 @@ Image::Image(LAMMPS *lmp, int nmap_caller) : Pointers(lmp)
   backLightColor[2] = 0.9;
 
   random = NULL;
+
+  nthreads = 1;
+  deferred = 0;
+  nprims = maxprims = 0;
+  prims = NULL;
+  primlo = primhi = NULL;
+  tilelist = NULL;
+  maxtilelist = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -133,6 +144,11 @@ Image::~Image()
   memory->destroy(surfacecopy);
   memory->destroy(rgbcopy);
 
+  memory->destroy(prims);
+  memory->destroy(primlo);
+  memory->destroy(primhi);
+  memory->destroy(tilelist);
+
   if (random) delete random;
 }
 
@@ -266,10 +282,17 @@ void Image::view_params(double boxxlo, double boxxhi, double boxylo,
 /* ----------------------------------------------------------------------
    initialize image to background color and depth buffer
    no need to init surfaceBuffer, since will be based on depth
+   with multiple threads, spheres and cylinders are drawn in merge()
 ------------------------------------------------------------------------- */
 
 void Image::clear()
 {
+  nprims = 0;
+  deferred = 0;
+#if defined(_OPENMP)
+  if (nthreads > 1) deferred = 1;
+#endif
+
   int red = background[0];
   int green = background[1];
   int blue = background[2];
@@ -287,48 +310,129 @@ void Image::clear()
 /* ----------------------------------------------------------------------
    merge image from each processor into one composite image
    done pixel by pixel, respecting depth buffer
-   hi procs send to lo procs, cascading down logarithmically
+   binary swap: procs exchange halves of their part of the image,
+     so each of largest power-of-2 # of procs ends with 1/P of it
+   procs beyond the power of 2 first send their image to a lower proc
+   composited parts are gathered to proc 0
 ------------------------------------------------------------------------- */
 
 void Image::merge()
 {
+  // draw deferred spheres and cylinders before compositing
+
+  render_deferred();
+
   MPI_Request requests[3];
 
-  int nhalf = 1;
-  while (nhalf < nprocs) nhalf *= 2;
-  nhalf /= 2;
-
-  while (nhalf) {
-    if (me < nhalf && me+nhalf < nprocs) {
-      MPI_Irecv(rgbcopy,npixels*3,MPI_BYTE,me+nhalf,0,world,&requests[0]);
-      MPI_Irecv(depthcopy,npixels,MPI_DOUBLE,me+nhalf,0,world,&requests[1]);
-      if (ssao)
-        MPI_Irecv(surfacecopy,npixels*2,MPI_DOUBLE,
-                  me+nhalf,0,world,&requests[2]);
-      if (ssao) MPI_Waitall(3,requests,MPI_STATUS_IGNORE);
-      else MPI_Waitall(2,requests,MPI_STATUS_IGNORE);
-
-      for (int i = 0; i < npixels; i++) {
-        if (depthBuffer[i] < 0 || (depthcopy[i] >= 0 &&
-                                   depthcopy[i] < depthBuffer[i])) {
-          depthBuffer[i] = depthcopy[i];
-          imageBuffer[i*3+0] = rgbcopy[i*3+0];
-          imageBuffer[i*3+1] = rgbcopy[i*3+1];
-          imageBuffer[i*3+2] = rgbcopy[i*3+2];
-          if (ssao) {
-            surfaceBuffer[i*2+0] = surfacecopy[i*2+0];
-            surfaceBuffer[i*2+1] = surfacecopy[i*2+1];
-          }
-        }
+  int npow2 = 1;
+  while (2*npow2 <= nprocs) npow2 *= 2;
+
+  if (me >= npow2) {
+    MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-npow2,0,world);
+    MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-npow2,0,world);
+    if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-npow2,0,world);
+  } else if (me+npow2 < nprocs) {
+    MPI_Irecv(rgbcopy,npixels*3,MPI_BYTE,me+npow2,0,world,&requests[0]);
+    MPI_Irecv(depthcopy,npixels,MPI_DOUBLE,me+npow2,0,world,&requests[1]);
+    if (ssao)
+      MPI_Irecv(surfacecopy,npixels*2,MPI_DOUBLE,
+                me+npow2,0,world,&requests[2]);
+    if (ssao) MPI_Waitall(3,requests,MPI_STATUS_IGNORE);
+    else MPI_Waitall(2,requests,MPI_STATUS_IGNORE);
+    composite(0,npixels,0);
+  }
+
+  // each step keeps one half of current pixel range
+  // proc with the mask bit set keeps upper half
+  // ties in depth go to lower proc, same as a tree merge onto proc 0
+
+  int lo = 0;
+  int hi = (me < npow2) ? npixels : 0;
+
+  for (int mask = npow2/2; mask && me < npow2; mask /= 2) {
+    int partner = me ^ mask;
+    int mid = lo + (hi-lo)/2;
+    int keeplo,keephi,sendlo,sendhi;
+    if (me & mask) {
+      keeplo = mid; keephi = hi;
+      sendlo = lo; sendhi = mid;
+    } else {
+      keeplo = lo; keephi = mid;
+      sendlo = mid; sendhi = hi;
+    }
+
+    MPI_Sendrecv(&imageBuffer[3*sendlo],3*(sendhi-sendlo),MPI_BYTE,partner,0,
+                 &rgbcopy[3*keeplo],3*(keephi-keeplo),MPI_BYTE,partner,0,
+                 world,MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&depthBuffer[sendlo],sendhi-sendlo,MPI_DOUBLE,partner,0,
+                 &depthcopy[keeplo],keephi-keeplo,MPI_DOUBLE,partner,0,
+                 world,MPI_STATUS_IGNORE);
+    if (ssao)
+      MPI_Sendrecv(&surfaceBuffer[2*sendlo],2*(sendhi-sendlo),MPI_DOUBLE,
+                   partner,0,&surfacecopy[2*keeplo],2*(keephi-keeplo),
+                   MPI_DOUBLE,partner,0,world,MPI_STATUS_IGNORE);
+
+    composite(keeplo,keephi,me & mask);
+    lo = keeplo;
+    hi = keephi;
+  }
+
+  // gather parts to proc 0, ranges are replayed for every proc
+  // proc 0 holds its own part in place
+
+  if (npow2 > 1) {
+    int *pixlo = new int[nprocs];
+    int *pixcount = new int[nprocs];
+    int *counts = new int[nprocs];
+    int *displs = new int[nprocs];
+
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      int plo = 0;
+      int phi = (iproc < npow2) ? npixels : 0;
+      for (int mask = npow2/2; mask && iproc < npow2; mask /= 2) {
+        int mid = plo + (phi-plo)/2;
+        if (iproc & mask) plo = mid;
+        else phi = mid;
       }
+      pixlo[iproc] = plo;
+      pixcount[iproc] = phi - plo;
+    }
 
-    } else if (me >= nhalf && me < 2*nhalf) {
-      MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-nhalf,0,world);
-      MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-nhalf,0,world);
-      if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-nhalf,0,world);
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      counts[iproc] = 3*pixcount[iproc];
+      displs[iproc] = 3*pixlo[iproc];
+    }
+    if (me == 0)
+      MPI_Gatherv(MPI_IN_PLACE,0,MPI_BYTE,
+                  imageBuffer,counts,displs,MPI_BYTE,0,world);
+    else
+      MPI_Gatherv(&imageBuffer[3*lo],3*(hi-lo),MPI_BYTE,
+                  NULL,NULL,NULL,MPI_BYTE,0,world);
+
+    if (ssao) {
+      if (me == 0)
+        MPI_Gatherv(MPI_IN_PLACE,0,MPI_DOUBLE,
+                    depthBuffer,pixcount,pixlo,MPI_DOUBLE,0,world);
+      else
+        MPI_Gatherv(&depthBuffer[lo],hi-lo,MPI_DOUBLE,
+                    NULL,NULL,NULL,MPI_DOUBLE,0,world);
+
+      for (int iproc = 0; iproc < nprocs; iproc++) {
+        counts[iproc] = 2*pixcount[iproc];
+        displs[iproc] = 2*pixlo[iproc];
+      }
+      if (me == 0)
+        MPI_Gatherv(MPI_IN_PLACE,0,MPI_DOUBLE,
+                    surfaceBuffer,counts,displs,MPI_DOUBLE,0,world);
+      else
+        MPI_Gatherv(&surfaceBuffer[2*lo],2*(hi-lo),MPI_DOUBLE,
+                    NULL,NULL,NULL,MPI_DOUBLE,0,world);
     }
 
-    nhalf /= 2;
+    delete [] pixlo;
+    delete [] pixcount;
+    delete [] counts;
+    delete [] displs;
   }
 
   // extra SSAO enhancement
@@ -344,12 +448,48 @@ void Image::merge()
     int pixelPart = height/nprocs * width*3;
     MPI_Gather(imageBuffer+me*pixelPart,pixelPart,MPI_BYTE,
                rgbcopy,pixelPart,MPI_BYTE,0,world);
+
+    // rows left over by height/nprocs are not shaded, copy them as is
+
+    if (me == 0)
+      memcpy(rgbcopy+nprocs*pixelPart,imageBuffer+nprocs*pixelPart,
+             npixels*3 - nprocs*pixelPart);
     writeBuffer = rgbcopy;
   } else {
     writeBuffer = imageBuffer;
   }
 }
 
+/* ----------------------------------------------------------------------
+   composite pixels lo to hi-1 received from another proc into my image
+   pixel with smaller depth wins
+   ties go to my pixel, or to received one if partnerfirst is set
+------------------------------------------------------------------------- */
+
+void Image::composite(int lo, int hi, int partnerfirst)
+{
+  int take;
+
+  for (int i = lo; i < hi; i++) {
+    if (partnerfirst)
+      take = depthcopy[i] >= 0 && (depthBuffer[i] < 0 ||
+                                   depthcopy[i] <= depthBuffer[i]);
+    else
+      take = depthBuffer[i] < 0 || (depthcopy[i] >= 0 &&
+                                    depthcopy[i] < depthBuffer[i]);
+    if (!take) continue;
+
+    depthBuffer[i] = depthcopy[i];
+    imageBuffer[i*3+0] = rgbcopy[i*3+0];
+    imageBuffer[i*3+1] = rgbcopy[i*3+1];
+    imageBuffer[i*3+2] = rgbcopy[i*3+2];
+    if (ssao) {
+      surfaceBuffer[i*2+0] = surfacecopy[i*2+0];
+      surfaceBuffer[i*2+1] = surfacecopy[i*2+1];
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    draw simulation bounding box as 12 cylinders
 ------------------------------------------------------------------------- */
@@ -384,10 +524,22 @@ void Image::draw_axes(double (*axes)[3], double diameter)
 
 /* ----------------------------------------------------------------------
    draw sphere at x with surfaceColor and diameter
-   render pixel by pixel onto image plane with depth buffering
+   store it for threaded rendering if drawing is deferred
 ------------------------------------------------------------------------- */
 
 void Image::draw_sphere(double *x, double *surfaceColor, double diameter)
+{
+  if (deferred) add_prim(SPHERE,x,NULL,surfaceColor,diameter);
+  else render_sphere(x,surfaceColor,diameter,0,height);
+}
+
+/* ----------------------------------------------------------------------
+   render sphere pixel by pixel onto image plane with depth buffering
+   only pixel rows ylo to yhi-1 are drawn
+------------------------------------------------------------------------- */
+
+void Image::render_sphere(double *x, double *surfaceColor, double diameter,
+                          int ylo, int yhi)
 {
   int ix,iy;
   double projRad;
@@ -423,7 +575,7 @@ void Image::draw_sphere(double *x, double *surfaceColor, double diameter)
 
   for (iy = yc - pixelRadius; iy <= yc + pixelRadius; iy++) {
     for (ix = xc - pixelRadius; ix <= xc + pixelRadius; ix++) {
-      if (iy < 0 || iy >= height || ix < 0 || ix >= width) continue;
+      if (iy < ylo || iy >= yhi || ix < 0 || ix >= width) continue;
 
       surface[1] = ((iy - yc) - height_error) * pixelWidth;
       surface[0] = ((ix - xc) - width_error) * pixelWidth;
@@ -455,6 +607,10 @@ void Image::draw_cube(double *x, double *surfaceColor, double diameter)
   double t,tdir[3];
   double depth;
 
+  // deferred objects are drawn first to keep the order of drawing
+
+  if (nprims) render_deferred();
+
   xlocal[0] = x[0] - xctr;
   xlocal[1] = x[1] - yctr;
   xlocal[2] = x[2] - zctr;
@@ -558,15 +714,27 @@ void Image::draw_cube(double *x, double *surfaceColor, double diameter)
 
 void Image::draw_cylinder(double *x, double *y,
                           double *surfaceColor, double diameter, int sflag)
+{
+  if (sflag % 2) draw_sphere(x,surfaceColor,diameter);
+  if (sflag/2) draw_sphere(y,surfaceColor,diameter);
+
+  if (deferred) add_prim(CYLINDER,x,y,surfaceColor,diameter);
+  else render_cylinder(x,y,surfaceColor,diameter,0,height);
+}
+
+/* ----------------------------------------------------------------------
+   render cylinder pixel by pixel onto image plane with depth buffering
+   only pixel rows ylo to yhi-1 are drawn
+------------------------------------------------------------------------- */
+
+void Image::render_cylinder(double *x, double *y, double *surfaceColor,
+                            double diameter, int ylo, int yhi)
 {
   double surface[3], normal[3];
   double mid[3],xaxis[3],yaxis[3],zaxis[3];
   double camLDir[3], camLRight[3], camLUp[3];
   double zmin, zmax;
 
-  if (sflag % 2) draw_sphere(x,surfaceColor,diameter);
-  if (sflag/2) draw_sphere(y,surfaceColor,diameter);
-
   double radius = 0.5*diameter;
   double radsq = radius*radius;
 
@@ -639,7 +807,7 @@ void Image::draw_cylinder(double *x, double *y,
 
   for (int iy = yc - pixelHalfHeight; iy <= yc + pixelHalfHeight; iy ++) {
     for (int ix = xc - pixelHalfWidth; ix <= xc + pixelHalfWidth; ix ++) {
-      if (iy < 0 || iy >= height || ix < 0 || ix >= width) continue;
+      if (iy < ylo || iy >= yhi || ix < 0 || ix >= width) continue;
 
       double sy = ((iy - yc) - height_error) * pixelWidth;
       double sx = ((ix - xc) - width_error) * pixelWidth;
@@ -693,6 +861,10 @@ void Image::draw_triangle(double *x, double *y, double *z, double *surfaceColor)
   double surface[3];
   double depth;
 
+  // deferred objects are drawn first to keep the order of drawing
+
+  if (nprims) render_deferred();
+
   xlocal[0] = x[0] - xctr;
   xlocal[1] = x[1] - yctr;
   xlocal[2] = x[2] - zctr;
@@ -866,6 +1038,150 @@ void Image::draw_pixel(int ix, int iy, double depth,
   imageBuffer[2 + ix*3 + iy*width*3] = static_cast<int>(c[2] * 255.0);
 }
 
+/* ----------------------------------------------------------------------
+   store sphere or cylinder to be rendered later by threads
+   color is copied, it may be overwritten by the caller
+------------------------------------------------------------------------- */
+
+void Image::add_prim(int kind, double *x, double *y,
+                     double *surfaceColor, double diameter)
+{
+  if (nprims == maxprims) {
+    maxprims += DELTAPRIM;
+    memory->grow(prims,maxprims,PRIMSIZE,"image:prims");
+    memory->grow(primlo,maxprims,"image:primlo");
+    memory->grow(primhi,maxprims,"image:primhi");
+  }
+
+  double *prim = prims[nprims++];
+  prim[0] = kind;
+  prim[1] = x[0];
+  prim[2] = x[1];
+  prim[3] = x[2];
+  if (y) {
+    prim[4] = y[0];
+    prim[5] = y[1];
+    prim[6] = y[2];
+  }
+  prim[7] = surfaceColor[0];
+  prim[8] = surfaceColor[1];
+  prim[9] = surfaceColor[2];
+  prim[10] = diameter;
+}
+
+/* ----------------------------------------------------------------------
+   range of pixel rows covered by deferred object I
+   same projection as in render_sphere() and render_cylinder()
+   primlo > primhi if it covers no row of the image
+------------------------------------------------------------------------- */
+
+void Image::prim_rows(int i)
+{
+  double *prim = prims[i];
+  double xlocal[3];
+  int yc,halfheight;
+
+  if (static_cast<int> (prim[0]) == SPHERE) {
+    xlocal[0] = prim[1] - xctr;
+    xlocal[1] = prim[2] - yctr;
+    xlocal[2] = prim[3] - zctr;
+
+    double ymap = MathExtra::dot3(camUp,xlocal);
+    double dist = MathExtra::dot3(camPos,camDir) -
+      MathExtra::dot3(xlocal,camDir);
+    double pixelWidth = (tanPerPixel > 0) ? tanPerPixel * dist :
+      -tanPerPixel / zoom;
+    halfheight = static_cast<int> (0.5*prim[10] / pixelWidth + 0.5) + 1;
+    yc = static_cast<int> (ymap / pixelWidth) + height / 2;
+
+  } else {
+    double zaxis[3];
+    zaxis[0] = prim[4] - prim[1];
+    zaxis[1] = prim[5] - prim[2];
+    zaxis[2] = prim[6] - prim[3];
+    double rasterHeight = fabs(MathExtra::dot3(zaxis, camUp)) + prim[10];
+
+    xlocal[0] = (prim[4] + prim[1]) * 0.5 - xctr;
+    xlocal[1] = (prim[5] + prim[2]) * 0.5 - yctr;
+    xlocal[2] = (prim[6] + prim[3]) * 0.5 - zctr;
+
+    double ymap = MathExtra::dot3(camUp,xlocal);
+    double dist = MathExtra::dot3(camPos,camDir) -
+      MathExtra::dot3(xlocal,camDir);
+    double pixelWidth = (tanPerPixel > 0) ? tanPerPixel * dist :
+      -tanPerPixel / zoom;
+    halfheight = static_cast<int> ((rasterHeight * 0.5) / pixelWidth + 0.5);
+    yc = static_cast<int> (ymap / pixelWidth) + height / 2;
+  }
+
+  primlo[i] = MAX(yc - halfheight,0);
+  primhi[i] = MIN(yc + halfheight,height-1);
+}
+
+/* ----------------------------------------------------------------------
+   render deferred spheres and cylinders with nthreads threads
+   image is split into tiles of pixel rows, each rendered by one thread
+   objects of a tile are drawn in the order they were stored,
+     so the image is the same as without deferred drawing
+------------------------------------------------------------------------- */
+
+void Image::render_deferred()
+{
+  if (nprims == 0) return;
+
+  int ntiles = MIN(4*nthreads,height);
+  int tilerows = (height + ntiles - 1) / ntiles;
+  ntiles = (height + tilerows - 1) / tilerows;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) num_threads(nthreads)
+#endif
+  for (int i = 0; i < nprims; i++) prim_rows(i);
+
+  // sort objects into lists of tiles they overlap, keeping their order
+
+  int *tilefirst = new int[ntiles+1];
+  int *tilenext = new int[ntiles];
+  int i,t;
+
+  for (t = 0; t <= ntiles; t++) tilefirst[t] = 0;
+  for (i = 0; i < nprims; i++)
+    if (primlo[i] <= primhi[i])
+      for (t = primlo[i]/tilerows; t <= primhi[i]/tilerows; t++)
+        tilefirst[t+1]++;
+  for (t = 0; t < ntiles; t++) tilefirst[t+1] += tilefirst[t];
+
+  if (tilefirst[ntiles] > maxtilelist) {
+    maxtilelist = tilefirst[ntiles];
+    memory->destroy(tilelist);
+    memory->create(tilelist,maxtilelist,"image:tilelist");
+  }
+
+  for (t = 0; t < ntiles; t++) tilenext[t] = tilefirst[t];
+  for (i = 0; i < nprims; i++)
+    if (primlo[i] <= primhi[i])
+      for (t = primlo[i]/tilerows; t <= primhi[i]/tilerows; t++)
+        tilelist[tilenext[t]++] = i;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(dynamic) num_threads(nthreads)
+#endif
+  for (int itile = 0; itile < ntiles; itile++) {
+    int ylo = itile*tilerows;
+    int yhi = MIN(ylo+tilerows,height);
+    for (int k = tilefirst[itile]; k < tilefirst[itile+1]; k++) {
+      double *prim = prims[tilelist[k]];
+      if (static_cast<int> (prim[0]) == SPHERE)
+        render_sphere(&prim[1],&prim[7],prim[10],ylo,yhi);
+      else render_cylinder(&prim[1],&prim[4],&prim[7],prim[10],ylo,yhi);
+    }
+  }
+
+  delete [] tilefirst;
+  delete [] tilenext;
+  nprims = 0;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Image::compute_SSAO()
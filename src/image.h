@@ -33,6 +33,7 @@ class Image : protected Pointers {
   double ssaoint;               // strength of shading from 0 to 1
   double *boxcolor;             // color to draw box outline with
   int background[3];            // RGB values of background
+  int nthreads;                 // # of OpenMP threads rendering the image
 
   Image(class LAMMPS *, int);
   ~Image();
@@ -73,6 +74,15 @@ class Image : protected Pointers {
   double *depthcopy,*surfacecopy;
   unsigned char *imageBuffer,*rgbcopy,*writeBuffer;
 
+  // spheres and cylinders drawn later by threads, one tile of rows each
+
+  int deferred;                 // 1 if drawing is deferred, 0 if not
+  int nprims,maxprims;          // # of deferred objects and allocated
+  double **prims;               // kind, end points, color, diameter of each
+  int *primlo,*primhi;          // range of pixel rows of each object
+  int *tilelist;                // objects overlapping each tile, in order
+  int maxtilelist;
+
   // constant view params
 
   double FOV;
@@ -120,6 +130,13 @@ class Image : protected Pointers {
   void draw_pixel(int, int, double, double *, double*);
   void compute_SSAO();
 
+  void render_sphere(double *, double *, double, int, int);
+  void render_cylinder(double *, double *, double *, double, int, int);
+  void add_prim(int, double *, double *, double *, double);
+  void prim_rows(int);
+  void render_deferred();
+  void composite(int, int, int);
+
   // inline functions
 
   inline double saturate(double v) {
@@ -40,7 +40,7 @@ KSpace::KSpace(LAMMPS *lmp) : Pointers(lmp)
 
   triclinic_support = 1;
   ewaldflag = pppmflag = msmflag = dispersionflag = tip4pflag =
-    dipoleflag = spinflag = 0;
+    dipoleflag = spinflag = mcflag = 0;
   compute_flag = 1;
   group_group_enable = 0;
   stagger_flag = 0;
@@ -62,6 +62,9 @@ KSpace::KSpace(LAMMPS *lmp) : Pointers(lmp)
 
   kewaldflag = 0;
 
+  nmc_local = maxmc_local = nmc = maxmc = 0;
+  mc_local = mc_all = NULL;
+
   order_6 = 5;
   gridflag_6 = 0;
   gewaldflag_6 = 0;
@@ -77,6 +80,7 @@ KSpace::KSpace(LAMMPS *lmp) : Pointers(lmp)
   warn_nocharge = 1;
 
   accuracy_absolute = -1.0;
+  accuracy_estimate = 0.0;
   accuracy_real_6 = -1.0;
   accuracy_kspace_6 = -1.0;
 
@@ -154,6 +158,8 @@ KSpace::~KSpace()
   memory->destroy(vatom);
   memory->destroy(gcons);
   memory->destroy(dgcons);
+  memory->destroy(mc_local);
+  memory->destroy(mc_all);
 }
 
 /* ----------------------------------------------------------------------
@@ -315,6 +321,70 @@ void KSpace::qsum_qsq(int warning_flag)
   }
 }
 
+/* ----------------------------------------------------------------------
+   add charge q at x to MC trial move as removal or addition
+   called by the proc that owns the charge, zero charges are ignored
+------------------------------------------------------------------------- */
+
+void KSpace::mc_remove(double q, double *x)
+{
+  mc_list(q,-1.0,x);
+}
+
+void KSpace::mc_add(double q, double *x)
+{
+  mc_list(q,1.0,x);
+}
+
+void KSpace::mc_list(double q, double sign, double *x)
+{
+  if (q == 0.0) return;
+
+  if (nmc_local == maxmc_local) {
+    maxmc_local += 16;
+    memory->grow(mc_local,5*maxmc_local,"kspace:mc_local");
+  }
+  double *m = &mc_local[5*nmc_local++];
+  m[0] = q;
+  m[1] = sign;
+  m[2] = x[0];
+  m[3] = x[1];
+  m[4] = x[2];
+}
+
+/* ----------------------------------------------------------------------
+   gather charges of MC trial move from all procs into mc_all
+   clears the local list for the next trial move
+------------------------------------------------------------------------- */
+
+void KSpace::mc_gather()
+{
+  int nprocs = comm->nprocs;
+  int *counts = new int[nprocs];
+  int *displs = new int[nprocs];
+
+  int nsend = 5*nmc_local;
+  MPI_Allgather(&nsend,1,MPI_INT,counts,1,MPI_INT,world);
+  int ntotal = 0;
+  for (int i = 0; i < nprocs; i++) {
+    displs[i] = ntotal;
+    ntotal += counts[i];
+  }
+
+  if (ntotal > 5*maxmc) {
+    maxmc = ntotal/5;
+    memory->destroy(mc_all);
+    memory->create(mc_all,ntotal,"kspace:mc_all");
+  }
+  MPI_Allgatherv(mc_local,nsend,MPI_DOUBLE,mc_all,counts,displs,
+                 MPI_DOUBLE,world);
+  nmc = ntotal/5;
+  nmc_local = 0;
+
+  delete [] counts;
+  delete [] displs;
+}
+
 /* ----------------------------------------------------------------------
    estimate the accuracy of the short-range coulomb tables
 ------------------------------------------------------------------------- */
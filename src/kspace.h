@@ -45,6 +45,7 @@ class KSpace : protected Pointers {
   int tip4pflag;                 // 1 if a TIP4P solver
   int dipoleflag;                // 1 if a dipole solver
   int spinflag;                  // 1 if a spin solver
+  int mcflag;                    // 1 if supports incremental MC energies
   int differentiation_flag;
   int neighrequest_flag;         // used to avoid obsolete construction
                                  // of neighbor lists
@@ -65,6 +66,8 @@ class KSpace : protected Pointers {
   double accuracy_absolute;         // user-specified accuracy in force units
   double accuracy_relative;         // user-specified dimensionless accuracy
                                     // accurary = acc_rel * two_charge_force
+  double accuracy_estimate;         // estimated accuracy after init()
+                                    // (force units), 0.0 if unknown
   double accuracy_real_6;           // real space accuracy for
                                     // dispersion solver (force units)
   double accuracy_kspace_6;         // reciprocal space accuracy for
@@ -112,6 +115,20 @@ class KSpace : protected Pointers {
 
   void qsum_qsq(int warning_flag = 1);
 
+  // incremental energy of Monte Carlo trial moves of a few charges
+  // each proc lists the charges it owns that are removed or added,
+  //   a move is a removal at the old and an addition at the new position
+  // mc_setup() caches the structure factors of the current atoms
+  // mc_energy_change() returns energy change of listed charges, sets energy
+  // mc_accept() or mc_reject() then commits or discards the trial move
+
+  void mc_remove(double, double *);
+  void mc_add(double, double *);
+  virtual void mc_setup() {}
+  virtual double mc_energy_change() {return 0.0;}
+  virtual void mc_accept() {}
+  virtual void mc_reject() {}
+
   // general child-class methods
 
   virtual void settings(int, char **) {};
@@ -192,13 +209,20 @@ class KSpace : protected Pointers {
   int vflag_either,vflag_global,vflag_atom;
   int maxeatom,maxvatom;
 
+  int nmc_local,maxmc_local;        // # of my charges in MC trial move
+  double *mc_local;                 // q,+1/-1,x,y,z of each of my charges
+  int nmc,maxmc;                    // # of charges in MC trial move
+  double *mc_all;                   // same for all procs
+  void mc_list(double, double, double *);
+  void mc_gather();
+
   int kewaldflag;                   // 1 if kspace range set for Ewald sum
   int kx_ewald,ky_ewald,kz_ewald;   // kspace settings for Ewald sum
 
   void pair_check();
   void ev_init(int eflag, int vflag, int alloc = 1) {
     if (eflag||vflag) ev_setup(eflag, vflag, alloc);
-    else evflag = eflag_either = eflag_global = eflag_atom = vflag_either = vflag_global = vflag_atom = 0;
+    else evflag = evflag_atom = eflag_either = eflag_global = eflag_atom = vflag_either = vflag_global = vflag_atom = 0;
   }
   void ev_setup(int, int, int alloc = 1);
   double estimate_table_accuracy(double, double);
@@ -171,6 +171,17 @@ typedef int bigint;
 
 #endif
 
+// union data struct for packing 32-bit and 64-bit ints into double bufs
+// see atom_vec.h for documentation
+
+union ubuf {
+  double d;
+  int64_t i;
+  ubuf(double arg) : d(arg) {}
+  ubuf(int64_t arg) : i(arg) {}
+  ubuf(int arg) : i(arg) {}
+};
+
 }
 
 // preprocessor macros for compiler specific settings
@@ -13,6 +13,7 @@
 
 #include "memory.h"
 #include <cstdlib>
+#include <cstring>
 #include "error.h"
 
 #if defined(LMP_USER_INTEL) && defined(__INTEL_COMPILER)
@@ -29,11 +30,43 @@
 #define LAMMPS_MEMALIGN 64
 #endif
 
+// node shared memory windows require MPI-3
+
+#if defined(MPI_VERSION) && (MPI_VERSION > 2)
+#define LMP_SHARED_MEMORY
+#endif
+
+#define DELTA_SHARED 16
+
 using namespace LAMMPS_NS;
 
 /* ---------------------------------------------------------------------- */
 
-Memory::Memory(LAMMPS *lmp) : Pointers(lmp) {}
+Memory::Memory(LAMMPS *lmp) : Pointers(lmp)
+{
+  shared_flag = -1;
+  shared_me = 0;
+  shared_comm = MPI_COMM_NULL;
+  nshared = maxshared = 0;
+  shared_ptr = NULL;
+  shared_win = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+Memory::~Memory()
+{
+#if defined(LMP_SHARED_MEMORY)
+  MPI_Win *win = (MPI_Win *) shared_win;
+  for (int i = 0; i < nshared; i++) {
+    MPI_Win_unlock_all(win[i]);
+    MPI_Win_free(&win[i]);
+  }
+  if (shared_flag == 1) MPI_Comm_free(&shared_comm);
+#endif
+  sfree(shared_ptr);
+  sfree(shared_win);
+}
 
 /* ----------------------------------------------------------------------
    safe malloc
@@ -126,3 +159,145 @@ void Memory::fail(const char *name)
            "Cannot create/grow a vector/array of pointers for %s",name);
   error->one(FLERR,str);
 }
+
+/* ----------------------------------------------------------------------
+   create communicator of procs in world that share memory on a node
+   sharing is only used if MPI-3 is available and 2 or more procs
+     of world are on the node
+------------------------------------------------------------------------- */
+
+void Memory::setup_shared()
+{
+  shared_flag = 0;
+  shared_me = 0;
+
+#if defined(LMP_SHARED_MEMORY)
+  int me,nprocs_shared;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_split_type(world,MPI_COMM_TYPE_SHARED,me,MPI_INFO_NULL,
+                      &shared_comm);
+  MPI_Comm_size(shared_comm,&nprocs_shared);
+  if (nprocs_shared > 1) {
+    MPI_Comm_rank(shared_comm,&shared_me);
+    shared_flag = 1;
+  } else MPI_Comm_free(&shared_comm);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   allocate memory shared by all procs of world on the same node
+   first proc on the node owns the memory, others map it
+   collective over world, all procs must request the same size
+   falls back to smalloc() if memory is not shared
+------------------------------------------------------------------------- */
+
+void *Memory::smalloc_shared(bigint nbytes, const char *name)
+{
+  if (shared_flag < 0) setup_shared();
+  if (shared_flag == 0) return smalloc(nbytes,name);
+  if (nbytes == 0) return NULL;
+
+  void *ptr = NULL;
+
+#if defined(LMP_SHARED_MEMORY)
+  MPI_Win win;
+  MPI_Aint size = (shared_me == 0) ? (MPI_Aint) nbytes : 0;
+  int err = MPI_Win_allocate_shared(size,1,MPI_INFO_NULL,shared_comm,
+                                    &ptr,&win);
+  if (err == MPI_SUCCESS && shared_me) {
+    int disp;
+    err = MPI_Win_shared_query(win,0,&size,&disp,&ptr);
+  }
+  if (err != MPI_SUCCESS || ptr == NULL) {
+    char str[128];
+    snprintf(str,128,"Failed to allocate " BIGINT_FORMAT
+             " bytes of shared memory for array %s",nbytes,name);
+    error->one(FLERR,str);
+  }
+  MPI_Win_lock_all(MPI_MODE_NOCHECK,win);
+
+  if (nshared == maxshared) {
+    maxshared += DELTA_SHARED;
+    shared_ptr = (void **)
+      srealloc(shared_ptr,maxshared*sizeof(void *),"memory:shared_ptr");
+    shared_win =
+      srealloc(shared_win,maxshared*sizeof(MPI_Win),"memory:shared_win");
+  }
+  shared_ptr[nshared] = ptr;
+  ((MPI_Win *) shared_win)[nshared] = win;
+  nshared++;
+#endif
+
+  return ptr;
+}
+
+/* ----------------------------------------------------------------------
+   free memory from smalloc_shared()
+   collective over world if memory is shared
+------------------------------------------------------------------------- */
+
+void Memory::sfree_shared(void *ptr)
+{
+  if (ptr == NULL) return;
+
+#if defined(LMP_SHARED_MEMORY)
+  MPI_Win *win = (MPI_Win *) shared_win;
+  for (int i = 0; i < nshared; i++) {
+    if (shared_ptr[i] != ptr) continue;
+    MPI_Win_unlock_all(win[i]);
+    MPI_Win_free(&win[i]);
+    nshared--;
+    shared_ptr[i] = shared_ptr[nshared];
+    win[i] = win[nshared];
+    return;
+  }
+#endif
+
+  sfree(ptr);
+}
+
+/* ----------------------------------------------------------------------
+   move memory from smalloc() with identical contents on all procs
+     into memory from smalloc_shared(), and free the original
+   collective over world
+------------------------------------------------------------------------- */
+
+void *Memory::sshare(void *ptr, bigint nbytes, const char *name)
+{
+  if (shared_flag < 0) setup_shared();
+  if (shared_flag == 0 || ptr == NULL) return ptr;
+
+  void *copy = smalloc_shared(nbytes,name);
+  if (shared_me == 0) memcpy(copy,ptr,nbytes);
+  shared_sync();
+  sfree(ptr);
+  return copy;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if this proc stores values in shared memory, else 0
+   if memory is not shared, every proc stores its own values
+------------------------------------------------------------------------- */
+
+int Memory::shared_writer()
+{
+  if (shared_flag < 0) setup_shared();
+  return (shared_me == 0) ? 1 : 0;
+}
+
+/* ----------------------------------------------------------------------
+   make values stored by the writer visible to all procs on the node
+   collective over world
+------------------------------------------------------------------------- */
+
+void Memory::shared_sync()
+{
+  if (shared_flag != 1) return;
+
+#if defined(LMP_SHARED_MEMORY)
+  MPI_Win *win = (MPI_Win *) shared_win;
+  for (int i = 0; i < nshared; i++) MPI_Win_sync(win[i]);
+  MPI_Barrier(shared_comm);
+  for (int i = 0; i < nshared; i++) MPI_Win_sync(win[i]);
+#endif
+}
@@ -21,12 +21,21 @@ namespace LAMMPS_NS {
 class Memory : protected Pointers {
  public:
   Memory(class LAMMPS *);
+  ~Memory();
 
   void *smalloc(bigint n, const char *);
   void *srealloc(void *, bigint n, const char *);
   void sfree(void *);
   void fail(const char *);
 
+  // read-only tables shared by all procs on a node, see memory.cpp
+
+  void *smalloc_shared(bigint n, const char *);
+  void sfree_shared(void *);
+  void *sshare(void *, bigint n, const char *);
+  int shared_writer();
+  void shared_sync();
+
 /* ----------------------------------------------------------------------
    create/grow/destroy vecs and multidim arrays with contiguous memory blocks
    only use with primitive data types, e.g. 1d vec of ints, 2d array of doubles
@@ -612,6 +621,91 @@ class Memory : protected Pointers {
     array = NULL;
   }
 
+/* ----------------------------------------------------------------------
+   create/destroy vecs and arrays whose data is shared by all procs
+     on a node, pointers of 2d/3d arrays are still per proc
+   calls are collective over all procs in world
+   only the proc with shared_writer() = 1 may store values,
+     followed by shared_sync() before any proc reads them
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+  TYPE *create_shared(TYPE *&array, int n, const char *name)
+  {
+    bigint nbytes = ((bigint) sizeof(TYPE)) * n;
+    array = (TYPE *) smalloc_shared(nbytes,name);
+    return array;
+  }
+
+  template <typename TYPE>
+  TYPE **create_shared(TYPE **& /*array*/, int /*n*/, const char *name)
+  {fail(name); return NULL;}
+
+  template <typename TYPE>
+  TYPE ***create_shared(TYPE ***&array, int n1, int n2, int n3,
+                        const char *name)
+  {
+    bigint nbytes = ((bigint) sizeof(TYPE)) * n1*n2*n3;
+    TYPE *data = (TYPE *) smalloc_shared(nbytes,name);
+    nbytes = ((bigint) sizeof(TYPE *)) * n1*n2;
+    TYPE **plane = (TYPE **) smalloc(nbytes,name);
+    nbytes = ((bigint) sizeof(TYPE **)) * n1;
+    array = (TYPE ***) smalloc(nbytes,name);
+
+    int i,j;
+    bigint m;
+    bigint n = 0;
+    for (i = 0; i < n1; i++) {
+      m = ((bigint) i) * n2;
+      array[i] = &plane[m];
+      for (j = 0; j < n2; j++) {
+        plane[m+j] = &data[n];
+        n += n3;
+      }
+    }
+    return array;
+  }
+
+  template <typename TYPE>
+  TYPE ****create_shared(TYPE ****& /*array*/, int /*n1*/, int /*n2*/,
+                         int /*n3*/, const char *name)
+  {fail(name); return NULL;}
+
+  template <typename TYPE>
+  void destroy_shared(TYPE *&array)
+  {
+    sfree_shared(array);
+    array = NULL;
+  }
+
+  template <typename TYPE>
+  void destroy_shared(TYPE ***&array)
+  {
+    if (array == NULL) return;
+    sfree_shared(array[0][0]);
+    sfree(array[0]);
+    sfree(array);
+    array = NULL;
+  }
+
+/* ----------------------------------------------------------------------
+   move an existing 1d array, filled identically on all procs,
+     into memory shared by all procs on a node
+   calls are collective over all procs in world
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+  TYPE *share(TYPE *&array, int n, const char *name)
+  {
+    bigint nbytes = ((bigint) sizeof(TYPE)) * n;
+    array = (TYPE *) sshare(array,nbytes,name);
+    return array;
+  }
+
+  template <typename TYPE>
+  TYPE **share(TYPE **& /*array*/, int /*n*/, const char *name)
+  {fail(name); return NULL;}
+
 /* ----------------------------------------------------------------------
    memory usage of arrays, including pointers
 ------------------------------------------------------------------------- */
@@ -653,6 +747,16 @@ class Memory : protected Pointers {
     bytes += ((bigint) sizeof(TYPE ***)) * n1;
     return bytes;
   }
+
+ private:
+  int shared_flag;         // -1 = not yet setup, 0 = no sharing, 1 = sharing
+  int shared_me;           // my rank in shared_comm
+  MPI_Comm shared_comm;    // procs in world that share memory with me
+  int nshared,maxshared;   // # of shared allocations
+  void **shared_ptr;       // address of each shared allocation
+  void *shared_win;        // MPI window of each shared allocation
+
+  void setup_shared();
 };
 
 }
@@ -676,4 +780,9 @@ E: Cannot create/grow a vector/array of pointers for %s
 LAMMPS code is making an illegal call to the templated memory
 allocaters, to create a vector or array of pointers.
 
+E: Failed to allocate %ld bytes of shared memory for array %s
+
+Your LAMMPS simulation has run out of memory, or the MPI library
+could not create a shared memory window for the procs on a node.
+
 */
@@ -150,6 +150,10 @@ void Output::init()
         error->all(FLERR,"Variable for dump every is invalid style");
     }
 
+  // restart files written in the background are complete before a new run
+
+  if (restart) restart->wait_write();
+
   if (restart_flag_single && restart_every_single == 0) {
     ivar_restart_single = input->variable->find(var_restart_single);
     if (ivar_restart_single < 0)
@@ -23,6 +23,7 @@
 #include <cstring>
 #include "atom.h"
 #include "neighbor.h"
+#include "neigh_list.h"
 #include "domain.h"
 #include "comm.h"
 #include "force.h"
@@ -55,6 +56,7 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
 
   single_enable = 1;
   single_hessian_enable = 0;
+  local_energy_enable = 0;
   restartinfo = 1;
   respa_enable = 0;
   one_coeff = 0;
@@ -72,6 +74,7 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
 
   ewaldflag = pppmflag = msmflag = dispersionflag = tip4pflag = dipoleflag = spinflag = 0;
   reinitflag = 1;
+  tabulate_enable = 0;
   centroidstressflag = 4;
 
   // pair_modify settings
@@ -88,6 +91,12 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   tabinner_disp = sqrt(2.0);
   ftable = NULL;
   fdisptable = NULL;
+  ntabulate = 0;
+  tabulate_inner = 0.0;
+  tabulate_tol = 1.0e-6;
+  tab_index = NULL;
+  tab_innersq = tab_invdelta = NULL;
+  tab_data = NULL;
 
   allocated = 0;
   suffix_flag = Suffix::NONE;
@@ -125,6 +134,7 @@ Pair::~Pair()
   memory->destroy(eatom);
   memory->destroy(vatom);
   memory->destroy(cvatom);
+  free_tabulate();
 }
 
 /* ----------------------------------------------------------------------
@@ -172,6 +182,22 @@ void Pair::modify_params(int narg, char **arg)
       if (iarg+2 > narg) error->all(FLERR,"Illegal pair_modify command");
       tabinner_disp = force->numeric(FLERR,arg[iarg+1]);
       iarg += 2;
+    } else if (strcmp(arg[iarg],"tabulate") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal pair_modify command");
+      ntabulate = force->inumeric(FLERR,arg[iarg+1]);
+      if (ntabulate < 0 || ntabulate == 1)
+        error->all(FLERR,"Illegal pair_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"tabulate/inner") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal pair_modify command");
+      tabulate_inner = force->numeric(FLERR,arg[iarg+1]);
+      if (tabulate_inner < 0.0) error->all(FLERR,"Illegal pair_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"tabulate/tol") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal pair_modify command");
+      tabulate_tol = force->numeric(FLERR,arg[iarg+1]);
+      if (tabulate_tol <= 0.0) error->all(FLERR,"Illegal pair_modify command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"tail") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal pair_modify command");
       if (strcmp(arg[iarg+1],"yes") == 0) tail_flag = 1;
@@ -261,6 +287,11 @@ void Pair::init()
         }
       }
     }
+
+  // replace single() by spline tables if requested
+
+  if (ntabulate) init_tabulate(1);
+  else free_tabulate();
 }
 
 /* ----------------------------------------------------------------------
@@ -289,6 +320,263 @@ void Pair::reinit()
         }
       }
     }
+
+  if (ntabulate) init_tabulate(0);
+}
+
+/* ----------------------------------------------------------------------
+   tabulate single() of each I,J pair for pair_modify tabulate
+   tables are uniform in rsq from inner cutoff to I,J cutoff
+   each interval stores cubic spline coeffs of F/r and energy
+     contiguously, so one lookup touches a single cache line
+   spline is evaluated at interval midpoints against single()
+     and the max error is reported if report is set
+------------------------------------------------------------------------- */
+
+void Pair::init_tabulate(int report)
+{
+  int i,j,k;
+  double rsq,fexact,eexact,ftab,etab,t,ferr,eerr;
+
+  if (!tabulate_enable || suffix_flag != Suffix::NONE)
+    error->all(FLERR,"Pair style does not support pair_modify tabulate");
+
+  free_tabulate();
+
+  const int ntypes = atom->ntypes;
+  const int n = ntabulate;
+
+  memory->create(tab_index,ntypes+1,ntypes+1,"pair:tab_index");
+  memory->create(tab_innersq,ntypes+1,ntypes+1,"pair:tab_innersq");
+  memory->create(tab_invdelta,ntypes+1,ntypes+1,"pair:tab_invdelta");
+
+  int npair = 0;
+  for (i = 1; i <= ntypes; i++)
+    for (j = i; j <= ntypes; j++) {
+      if (cutsq[i][j] > 0.0) tab_index[i][j] = tab_index[j][i] = npair++;
+      else tab_index[i][j] = tab_index[j][i] = -1;
+      tab_innersq[i][j] = tab_innersq[j][i] = 0.0;
+      tab_invdelta[i][j] = tab_invdelta[j][i] = 0.0;
+    }
+
+  if (npair == 0) return;
+  memory->create(tab_data,8*npair*n,"pair:tab_data");
+
+  double *fval = new double[n+1];
+  double *eval = new double[n+1];
+  double *work = new double[2*(n+1)];
+
+  double ferrmax = 0.0;
+  double eerrmax = 0.0;
+
+  for (i = 1; i <= ntypes; i++)
+    for (j = i; j <= ntypes; j++) {
+      if (tab_index[i][j] < 0) continue;
+
+      double inner = tabulate_inner;
+      if (inner == 0.0) inner = 0.1*sqrt(cutsq[i][j]);
+      const double innersq = inner*inner;
+      if (innersq >= cutsq[i][j])
+        error->all(FLERR,"Pair_modify tabulate inner cutoff >= pair cutoff");
+
+      const double delta = (cutsq[i][j] - innersq) / n;
+      tab_innersq[i][j] = tab_innersq[j][i] = innersq;
+      tab_invdelta[i][j] = tab_invdelta[j][i] = 1.0/delta;
+
+      for (k = 0; k <= n; k++) {
+        rsq = innersq + k*delta;
+        eval[k] = single(0,0,i,j,rsq,1.0,1.0,fval[k]);
+      }
+
+      double *coeff = tab_data + 8*n*tab_index[i][j];
+      tabulate_spline(fval,n,coeff,work);
+      tabulate_spline(eval,n,coeff+4,work);
+
+      // validate at interval midpoints where the spline error is largest
+      // relative error, or absolute error for magnitudes below one
+
+      double errmax = 0.0;
+      double rerr = 0.0;
+      t = 0.5;
+      for (k = 0; k < n; k++) {
+        rsq = innersq + (k+t)*delta;
+        eexact = single(0,0,i,j,rsq,1.0,1.0,fexact);
+        const double *c = coeff + 8*k;
+        ftab = c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+        etab = c[4] + t*(c[5] + t*(c[6] + t*c[7]));
+        const double r = sqrt(rsq);
+        ferr = fabs(ftab-fexact)*r / MAX(fabs(fexact)*r,1.0);
+        eerr = fabs(etab-eexact) / MAX(fabs(eexact),1.0);
+        ferrmax = MAX(ferrmax,ferr);
+        eerrmax = MAX(eerrmax,eerr);
+        if (MAX(ferr,eerr) > errmax) {
+          errmax = MAX(ferr,eerr);
+          rerr = r;
+        }
+      }
+
+      if (report && comm->me == 0 && errmax > tabulate_tol) {
+        char str[128];
+        snprintf(str,128,"Pair_modify tabulate error %g for types %d %d "
+                 "exceeds tolerance at r = %g",errmax,i,j,rerr);
+        error->warning(FLERR,str);
+      }
+    }
+
+  delete [] fval;
+  delete [] eval;
+  delete [] work;
+
+  if (report && comm->me == 0) {
+    const char fmt[] = "Pair tabulate: %d intervals for %d type pairs, "
+      "max error energy %g force %g\n";
+    if (screen) fprintf(screen,fmt,n,npair,eerrmax,ferrmax);
+    if (logfile) fprintf(logfile,fmt,n,npair,eerrmax,ferrmax);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   cubic spline through y[0..n] at unit knot spacing
+   end slopes from one-sided 2nd order differences
+   store per interval coeffs of y(t) = c0 + t*(c1 + t*(c2 + t*c3))
+     at stride 8 in coeff
+------------------------------------------------------------------------- */
+
+void Pair::tabulate_spline(double *y, int n, double *coeff, double *work)
+{
+  int k;
+  double *m = work;
+  double *w = work + n+1;
+
+  if (n == 2) {
+    m[0] = 0.5*(-3.0*y[0] + 4.0*y[1] - y[2]);
+    m[2] = 0.5*(3.0*y[2] - 4.0*y[1] + y[0]);
+    m[1] = 0.25*(3.0*(y[2]-y[0]) - m[0] - m[2]);
+  } else {
+    m[0] = 0.5*(-3.0*y[0] + 4.0*y[1] - y[2]);
+    m[n] = 0.5*(3.0*y[n] - 4.0*y[n-1] + y[n-2]);
+
+    // m[k-1] + 4 m[k] + m[k+1] = 3 (y[k+1] - y[k-1]) for 0 < k < n
+    // Thomas algorithm with the end slopes moved to the right-hand side
+
+    w[1] = 0.25;
+    m[1] = 0.25*(3.0*(y[2]-y[0]) - m[0]);
+    for (k = 2; k < n; k++) {
+      double rhs = 3.0*(y[k+1]-y[k-1]);
+      if (k == n-1) rhs -= m[n];
+      const double denom = 1.0 / (4.0 - w[k-1]);
+      w[k] = denom;
+      m[k] = (rhs - m[k-1]) * denom;
+    }
+    for (k = n-2; k >= 1; k--) m[k] -= w[k]*m[k+1];
+  }
+
+  for (k = 0; k < n; k++) {
+    double *c = coeff + 8*k;
+    c[0] = y[k];
+    c[1] = m[k];
+    c[2] = 3.0*(y[k+1]-y[k]) - 2.0*m[k] - m[k+1];
+    c[3] = 2.0*(y[k]-y[k+1]) + m[k] + m[k+1];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Pair::free_tabulate()
+{
+  memory->destroy(tab_index);
+  memory->destroy(tab_innersq);
+  memory->destroy(tab_invdelta);
+  memory->destroy(tab_data);
+  tab_index = NULL;
+  tab_innersq = tab_invdelta = NULL;
+  tab_data = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   shared compute() kernel for styles with pair_modify tabulate
+   pair interactions inside the inner cutoff fall back to single()
+------------------------------------------------------------------------- */
+
+void Pair::compute_tabulated(int eflag, int vflag)
+{
+  int i,j,ii,jj,k,inum,jnum,itype,jtype;
+  double xtmp,ytmp,ztmp,delx,dely,delz,evdwl,fpair;
+  double rsq,s,t,factor_lj;
+  int *ilist,*jlist,*numneigh,**firstneigh;
+
+  evdwl = 0.0;
+  ev_init(eflag,vflag);
+
+  double **x = atom->x;
+  double **f = atom->f;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  double *special_lj = force->special_lj;
+  int newton_pair = force->newton_pair;
+  const int n = ntabulate;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over neighbors of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    const double *cutsqi = cutsq[itype];
+    const double *innersqi = tab_innersq[itype];
+    const double *invdeltai = tab_invdelta[itype];
+    const int *indexi = tab_index[itype];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      factor_lj = special_lj[sbmask(j)];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      jtype = type[j];
+
+      if (rsq < cutsqi[jtype]) {
+        if (rsq < innersqi[jtype]) {
+          evdwl = single(i,j,itype,jtype,rsq,1.0,factor_lj,fpair);
+        } else {
+          s = (rsq - innersqi[jtype]) * invdeltai[jtype];
+          k = static_cast<int>(s);
+          if (k > n-1) k = n-1;
+          t = s - k;
+          const double *c = tab_data + 8*(n*indexi[jtype] + k);
+          fpair = factor_lj * (c[0] + t*(c[1] + t*(c[2] + t*c[3])));
+          if (eflag) evdwl = factor_lj * (c[4] + t*(c[5] + t*(c[6] + t*c[7])));
+        }
+
+        f[i][0] += delx*fpair;
+        f[i][1] += dely*fpair;
+        f[i][2] += delz*fpair;
+        if (newton_pair || j < nlocal) {
+          f[j][0] -= delx*fpair;
+          f[j][1] -= dely*fpair;
+          f[j][2] -= delz*fpair;
+        }
+
+        if (evflag) ev_tally(i,j,nlocal,newton_pair,
+                             evdwl,0.0,fpair,delx,dely,delz);
+      }
+    }
+  }
+
+  if (vflag_fdotr) virial_fdotr_compute();
 }
 
 /* ----------------------------------------------------------------------
@@ -1802,6 +2090,13 @@ double Pair::memory_usage()
   double bytes = comm->nthreads*maxeatom * sizeof(double);
   bytes += comm->nthreads*maxvatom*6 * sizeof(double);
   bytes += comm->nthreads*maxcvatom*9 * sizeof(double);
+  if (tab_data) {
+    int npair = 0;
+    for (int i = 1; i <= atom->ntypes; i++)
+      for (int j = i; j <= atom->ntypes; j++)
+        if (tab_index[i][j] >= 0) npair++;
+    bytes += 8.0*npair*ntabulate * sizeof(double);
+  }
   return bytes;
 }
 
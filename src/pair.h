@@ -49,6 +49,7 @@ class Pair : protected Pointers {
 
   int single_enable;             // 1 if single() routine exists
   int single_hessian_enable;     // 1 if single_hessian() routine exists
+  int local_energy_enable;       // 1 if energy_local() routine exists
   int restartinfo;               // 1 if pair style writes restart info
   int respa_enable;              // 1 if inner/middle/outer rRESPA routines
   int one_coeff;                 // 1 if allows only one coeff * * call
@@ -66,6 +67,7 @@ class Pair : protected Pointers {
   int dipoleflag;                // 1 if compatible with dipole solver
   int spinflag;                  // 1 if compatible with spin solver
   int reinitflag;                // 1 if compatible with fix adapt and alike
+  int tabulate_enable;           // 1 if compute() supports pair_modify tabulate
 
   int centroidstressflag;        // compatibility with centroid atomic stress
                                  // 1 if same as two-body atomic stress
@@ -104,6 +106,7 @@ class Pair : protected Pointers {
   int allocated;                 // 0/1 = whether arrays are allocated
                                  //       public so external driver can check
   int compute_flag;              // 0 if skip compute()
+  int ntabulate;                 // # of table intervals, 0 if not tabulated
 
   enum{GEOMETRIC,ARITHMETIC,SIXTHPOWER};   // mixing options
 
@@ -156,6 +159,11 @@ class Pair : protected Pointers {
     return 0.0;
   }
 
+  // energy attributed to atom I from its full list of JNUM neighbors
+  // used by Monte Carlo fixes to evaluate energy changes locally
+
+  virtual double energy_local(int, int, int *) { return 0.0; }
+
   void hessian_twobody(double fforce, double dfac, double delr[3], double phiTensor[6]);
 
   virtual double single_hessian(int, int, int, int,
@@ -223,7 +231,19 @@ class Pair : protected Pointers {
   int offset_flag,mix_flag;            // flags for offset and mixing
   double tabinner;                     // inner cutoff for Coulomb table
   double tabinner_disp;                 // inner cutoff for dispersion table
+  double tabulate_inner;               // inner cutoff for tabulated single()
+  double tabulate_tol;                 // error tolerance of tabulated single()
+
+                                       // single() tabulated in rsq
+  int **tab_index;                     // table index of I,J, -1 if none
+  double **tab_innersq;                // inner cutoff sq of I,J table
+  double **tab_invdelta;               // inverse rsq spacing of I,J table
+  double *tab_data;                    // 4 force + 4 energy coeffs/interval
 
+  void init_tabulate(int);
+  void tabulate_spline(double *, int, double *, double *);
+  void free_tabulate();
+  void compute_tabulated(int, int);
 
  public:
   // custom data type for accessing Coulomb tables
@@ -319,6 +339,22 @@ This is likely not what you want to do.  The exclusion settings will
 eliminate neighbors in the neighbor list, which the manybody potential
 needs to calculated its terms correctly.
 
+E: Pair style does not support pair_modify tabulate
+
+Tabulation is only available for pair styles that request it in their
+compute() function and is not available for accelerated styles.
+
+E: Pair_modify tabulate inner cutoff >= pair cutoff
+
+The inner cutoff of the tabulated single() function must be smaller
+than the cutoff of every pair of atom types.
+
+W: Pair_modify tabulate error %g for types %d %d exceeds tolerance at r = %g
+
+The cubic spline through the tabulated single() function deviates from
+the analytic function by more than the tolerance at some distance.
+Increase the number of table intervals or the inner cutoff.
+
 E: All pair coeffs are not set
 
 All pair coefficients must be set in the data file or by the
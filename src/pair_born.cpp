@@ -36,6 +36,7 @@ using namespace MathConst;
 PairBorn::PairBorn(LAMMPS *lmp) : Pair(lmp)
 {
   writedata = 1;
+  tabulate_enable = 1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -70,6 +71,11 @@ void PairBorn::compute(int eflag, int vflag)
   double r,rexp;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
+  if (ntabulate) {
+    compute_tabulated(eflag,vflag);
+    return;
+  }
+
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
@@ -32,6 +32,7 @@ using namespace MathConst;
 PairBuck::PairBuck(LAMMPS *lmp) : Pair(lmp)
 {
   writedata = 1;
+  tabulate_enable = 1;
   centroidstressflag = 1;
 }
 
@@ -66,6 +67,11 @@ void PairBuck::compute(int eflag, int vflag)
   double r,rexp;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
+  if (ntabulate) {
+    compute_tabulated(eflag,vflag);
+    return;
+  }
+
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
@@ -522,6 +522,9 @@ void PairHybrid::init_style()
         for (m = 0; m < nmap[itype][jtype]; m++)
           if (map[itype][jtype][m] == istyle) used = 1;
     if (used == 0) error->all(FLERR,"Pair hybrid sub-style is not used");
+    if (styles[istyle]->ntabulate)
+      error->all(FLERR,"Pair hybrid sub-style does not support "
+                 "pair_modify tabulate");
   }
 
   // check if special_lj/special_coul overrides are compatible
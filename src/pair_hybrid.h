@@ -125,6 +125,10 @@ E: Pair hybrid sub-style is not used
 No pair_coeff command used a sub-style specified in the pair_style
 command.
 
+E: Pair hybrid sub-style does not support pair_modify tabulate
+
+Tables are only built for the top-level pair style.
+
 E: Pair_modify special setting for pair hybrid incompatible with global special_bonds setting
 
 Cannot override a setting of 0.0 or 1.0 or change a setting between
@@ -41,6 +41,7 @@ PairLJCut::PairLJCut(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
   writedata = 1;
+  tabulate_enable = 1;
   centroidstressflag = 1;
 }
 
@@ -72,6 +73,11 @@ void PairLJCut::compute(int eflag, int vflag)
   double rsq,r2inv,r6inv,forcelj,factor_lj;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
+  if (ntabulate) {
+    compute_tabulated(eflag,vflag);
+    return;
+  }
+
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
@@ -40,6 +40,7 @@ using namespace MathConst;
 PairMIECut::PairMIECut(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
+  tabulate_enable = 1;
   cut_respa = NULL;
 }
 
@@ -74,6 +75,11 @@ void PairMIECut::compute(int eflag, int vflag)
   double rsq,r2inv,rgamR,rgamA,forcemie,factor_mie;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
+  if (ntabulate) {
+    compute_tabulated(eflag,vflag);
+    return;
+  }
+
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
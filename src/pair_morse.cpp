@@ -30,6 +30,7 @@ using namespace LAMMPS_NS;
 PairMorse::PairMorse(LAMMPS *lmp) : Pair(lmp)
 {
   writedata = 1;
+  tabulate_enable = 1;
   centroidstressflag = 1;
 }
 
@@ -59,6 +60,11 @@ void PairMorse::compute(int eflag, int vflag)
   double rsq,r,dr,dexp,factor_lj;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
+  if (ntabulate) {
+    compute_tabulated(eflag,vflag);
+    return;
+  }
+
   evdwl = 0.0;
   ev_init(eflag,vflag);
 
@@ -843,6 +843,23 @@ void PairTable::compute_table(Table *tb)
       }
     }
   }
+
+  // tables are identical on all procs and read-only from here on,
+  //   so keep one copy of them per node
+
+  int ntable = tablength;
+  int ndelta = tlm1;
+  if (tabstyle == LOOKUP) ntable = tlm1;
+  if (tabstyle == BITMAP) ntable = ndelta = 1 << tablength;
+
+  memory->share(tb->rsq,ntable,"pair:rsq");
+  memory->share(tb->drsq,ntable,"pair:drsq");
+  memory->share(tb->e,ntable,"pair:e");
+  memory->share(tb->f,ntable,"pair:f");
+  memory->share(tb->de,ndelta,"pair:de");
+  memory->share(tb->df,ndelta,"pair:df");
+  memory->share(tb->e2,ntable,"pair:e2");
+  memory->share(tb->f2,ntable,"pair:f2");
 }
 
 /* ----------------------------------------------------------------------
@@ -869,14 +886,14 @@ void PairTable::free_table(Table *tb)
   memory->destroy(tb->e2file);
   memory->destroy(tb->f2file);
 
-  memory->destroy(tb->rsq);
-  memory->destroy(tb->drsq);
-  memory->destroy(tb->e);
-  memory->destroy(tb->de);
-  memory->destroy(tb->f);
-  memory->destroy(tb->df);
-  memory->destroy(tb->e2);
-  memory->destroy(tb->f2);
+  memory->destroy_shared(tb->rsq);
+  memory->destroy_shared(tb->drsq);
+  memory->destroy_shared(tb->e);
+  memory->destroy_shared(tb->de);
+  memory->destroy_shared(tb->f);
+  memory->destroy_shared(tb->df);
+  memory->destroy_shared(tb->e2);
+  memory->destroy_shared(tb->f2);
 }
 
 /* ----------------------------------------------------------------------
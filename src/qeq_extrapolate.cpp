@@ -0,0 +1,277 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "qeq_extrapolate.h"
+#include <mpi.h>
+#include <cmath>
+#include <cstring>
+#include "atom.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+QEqExtrapolate::QEqExtrapolate(LAMMPS *lmp, const char *fix_style) :
+  Pointers(lmp), cs(NULL), ct(NULL)
+{
+  int n = strlen(fix_style) + 1;
+  fixstyle = new char[n];
+  strcpy(fixstyle,fix_style);
+
+  style = FIXED;
+  nhistory = 0;
+  nextrap = nsolve = 0;
+  matvecs = matvecs_ref = 0;
+  matvecs_total = matvecs_saved = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+QEqExtrapolate::~QEqExtrapolate()
+{
+  delete [] fixstyle;
+  memory->destroy(cs);
+  memory->destroy(ct);
+}
+
+/* ----------------------------------------------------------------------
+   parse one extrapolation keyword of the fix command
+   return # of args used, 0 if keyword is not an extrapolation keyword
+------------------------------------------------------------------------- */
+
+int QEqExtrapolate::modify_param(int narg, char **arg)
+{
+  char str[128];
+  snprintf(str,128,"Illegal fix %s command",fixstyle);
+
+  if (strcmp(arg[0],"extrapolate") == 0) {
+    if (narg < 2) error->all(FLERR,str);
+    if (strcmp(arg[1],"fixed") == 0) style = FIXED;
+    else if (strcmp(arg[1],"aspc") == 0) style = ASPC;
+    else if (strcmp(arg[1],"lsq") == 0) style = LSQ;
+    else error->all(FLERR,str);
+    return 2;
+  } else if (strcmp(arg[0],"history") == 0) {
+    if (narg < 2) error->all(FLERR,str);
+    nhistory = force->inumeric(FLERR,arg[1]);
+    if (nhistory < 1) error->all(FLERR,str);
+    return 2;
+  }
+
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   check settings after all keywords are parsed
+   Nmin = # of previous solutions the fixed scheme needs
+   return # of previous solutions the fix must store
+------------------------------------------------------------------------- */
+
+int QEqExtrapolate::setup(int nmin)
+{
+  // ASPC of order K combines K+2 solutions, default K = 1
+  // LSQ fits its coefficients to one more solution than it combines
+
+  if (nhistory == 0) nhistory = (style == LSQ) ? 4 : 3;
+  if (style == ASPC && nhistory < 2) {
+    char str[128];
+    snprintf(str,128,"Fix %s extrapolate aspc requires history >= 2",
+             fixstyle);
+    error->all(FLERR,str);
+  }
+  int nprev = MAX(nmin,nhistory+1);
+
+  memory->destroy(cs);
+  memory->destroy(ct);
+  memory->create(cs,nprev,"qeq:extrap_s");
+  memory->create(ct,nprev,"qeq:extrap_t");
+  return nprev;
+}
+
+/* ----------------------------------------------------------------------
+   set coefficients that combine stored solutions into the initial guess
+   N atoms in Ilist, only those in group with Groupbit are used
+   nextrap = 0 selects the fixed-order polynomial extrapolation of the
+     fix, which is also used until enough solutions are stored
+------------------------------------------------------------------------- */
+
+void QEqExtrapolate::coeffs(int nn, int *ilist, int groupbit,
+                            double **s_hist, double **t_hist)
+{
+  int i, ii, k, l, m;
+  int *mask = atom->mask;
+
+  nextrap = 0;
+  if (style == FIXED) return;
+
+  // predictor of the always stable predictor-corrector of order K,
+  // Kolafa, J Comp Chem, 25, 335 (2004), with nhistory = K+2
+  // the corrector is replaced by the converged CG solution
+
+  if (style == ASPC) {
+    if (nsolve < nhistory) return;
+
+    double o = nhistory - 2;
+    double c = (4.0*o + 6.0) / (o + 3.0);
+    double num = 1.0;
+    double den = 4.0;
+    double sgn = -1.0;
+    double f = 2.0;
+
+    cs[0] = c;
+    for (k = 1; k < nhistory; k++) {
+      c *= (o + num) / (o + den);
+      cs[k] = sgn * f * c;
+      sgn = -sgn;
+      f += 1.0;
+      num -= 1.0;
+      den += 1.0;
+    }
+    for (k = 0; k < nhistory; k++) ct[k] = cs[k];
+    nextrap = nhistory;
+    return;
+  }
+
+  // least-squares predictor with m = nhistory-1 coefficients c_k
+  // the latest increment D_0 = h_0 - h_1 of the stored solutions h_k
+  //   is fit by sum_k c_k D_k over all atoms, k = 1..m
+  // the next increment is predicted as sum_k c_k D_(k-1)
+  // increments are used since the solutions themselves are nearly
+  //   collinear, which makes the normal equations singular
+
+  m = MIN(nhistory-1,nsolve-2);
+  if (m < 1) return;
+
+  int nsq = m*m + m;
+  double *buf = new double[4*nsq];
+  for (k = 0; k < 2*nsq; k++) buf[k] = 0.0;
+
+  double *as = buf;
+  double *at = buf + nsq;
+  for (ii = 0; ii < nn; ++ii) {
+    i = ilist[ii];
+    if (mask[i] & groupbit) {
+      double *sh = s_hist[i];
+      double *th = t_hist[i];
+      for (k = 1; k <= m; k++) {
+        double dsk = sh[k] - sh[k+1];
+        double dtk = th[k] - th[k+1];
+        for (l = 1; l <= k; l++) {
+          as[(k-1)*m+l-1] += dsk * (sh[l] - sh[l+1]);
+          at[(k-1)*m+l-1] += dtk * (th[l] - th[l+1]);
+        }
+        as[m*m+k-1] += dsk * (sh[0] - sh[1]);
+        at[m*m+k-1] += dtk * (th[0] - th[1]);
+      }
+    }
+  }
+
+  MPI_Allreduce(buf,buf+2*nsq,2*nsq,MPI_DOUBLE,MPI_SUM,world);
+
+  double *xs = buf;
+  double *xt = buf + m;
+  if (lsq_solve(buf+2*nsq,xs,m) && lsq_solve(buf+3*nsq,xt,m)) {
+    cs[0] = 1.0 + xs[0];
+    ct[0] = 1.0 + xt[0];
+    for (k = 1; k < m; k++) {
+      cs[k] = xs[k] - xs[k-1];
+      ct[k] = xt[k] - xt[k-1];
+    }
+    cs[m] = -xs[m-1];
+    ct[m] = -xt[m-1];
+    nextrap = m+1;
+  }
+
+  delete [] buf;
+}
+
+/* ----------------------------------------------------------------------
+   solve normal equations A x = b of size n by Gaussian elimination
+   lower triangle of A stored by rows in ab, followed by b
+   a small ridge term is added to the diagonal
+   return 0 if A is singular
+------------------------------------------------------------------------- */
+
+int QEqExtrapolate::lsq_solve(double *ab, double *x, int n)
+{
+  int i, j, k, ipiv;
+  double *a = ab;
+  double *b = ab + n*n;
+
+  double amax = 0.0;
+  for (i = 0; i < n; i++) {
+    for (j = i+1; j < n; j++) a[i*n+j] = a[j*n+i];
+    amax = MAX(amax,a[i*n+i]);
+  }
+  if (amax <= 0.0) return 0;
+  for (i = 0; i < n; i++) a[i*n+i] += 1.0e-12*amax;
+
+  for (k = 0; k < n; k++) {
+    ipiv = k;
+    for (i = k+1; i < n; i++)
+      if (fabs(a[i*n+k]) > fabs(a[ipiv*n+k])) ipiv = i;
+    if (fabs(a[ipiv*n+k]) <= 1.0e-14*amax) return 0;
+    if (ipiv != k) {
+      for (j = 0; j < n; j++) {
+        double tmp = a[k*n+j];
+        a[k*n+j] = a[ipiv*n+j];
+        a[ipiv*n+j] = tmp;
+      }
+      double tmp = b[k];
+      b[k] = b[ipiv];
+      b[ipiv] = tmp;
+    }
+    for (i = k+1; i < n; i++) {
+      double f = a[i*n+k] / a[k*n+k];
+      for (j = k; j < n; j++) a[i*n+j] -= f * a[k*n+j];
+      b[i] -= f * b[k];
+    }
+  }
+
+  for (i = n-1; i >= 0; i--) {
+    double sum = b[i];
+    for (j = i+1; j < n; j++) sum -= a[i*n+j] * x[j];
+    x[i] = sum / a[i*n+i];
+  }
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   accumulate CG statistics of a solve that took N matvecs
+   called once per solve, before the solution is stored in the history
+   iterations saved are relative to the first solve,
+     which starts without previous solutions
+------------------------------------------------------------------------- */
+
+void QEqExtrapolate::count_matvecs(int n)
+{
+  matvecs = n;
+  if (nsolve == 0) matvecs_ref = n;
+  matvecs_total += n;
+  matvecs_saved += matvecs_ref - n;
+  nsolve++;
+}
+
+/* ----------------------------------------------------------------------
+   global vector of the fix: matvecs of last solve, total, and saved
+------------------------------------------------------------------------- */
+
+double QEqExtrapolate::compute_vector(int n)
+{
+  if (n == 0) return matvecs;
+  if (n == 1) return matvecs_total;
+  return matvecs_saved;
+}
@@ -0,0 +1,69 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_QEQ_EXTRAPOLATE_H
+#define LMP_QEQ_EXTRAPOLATE_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// initial guess of the s and t vectors of the QEq fixes
+//   from their previous solutions, and CG statistics of the fix
+// used by the QEQ package and by fix qeq/reax
+
+class QEqExtrapolate : protected Pointers {
+ public:
+  enum{FIXED,ASPC,LSQ};
+
+  int style;                // FIXED, ASPC, or LSQ
+  int nextrap;              // # of coefficients in use, 0 for FIXED
+  double *cs, *ct;          // coefficients applied to s_hist, t_hist
+
+  QEqExtrapolate(class LAMMPS *, const char *);
+  ~QEqExtrapolate();
+  int modify_param(int, char **);
+  int setup(int);
+  void coeffs(int, int *, int, double **, double **);
+  void count_matvecs(int);
+  double compute_vector(int);
+
+ private:
+  char *fixstyle;           // style of fix for error messages
+  int nhistory;             // # of previous solutions combined by ASPC, LSQ
+  int nsolve;               // # of solutions stored in s_hist, t_hist
+  int matvecs;              // matvecs of last solve
+  int matvecs_ref;          // matvecs of first solve, without history
+  double matvecs_total, matvecs_saved;
+
+  int lsq_solve(double *, double *, int);
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix %s command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix %s extrapolate aspc requires history >= 2
+
+The always stable predictor-corrector scheme of order K combines K+2
+previous solutions, with K >= 0.
+
+*/
@@ -39,6 +39,7 @@
 #include "improper.h"
 #include "special.h"
 #include "irregular.h"
+#include "mpiio.h"
 #include "error.h"
 #include "memory.h"
 #include "utils.h"
@@ -50,6 +51,18 @@ using namespace LAMMPS_NS;
 #define CHUNK 1024
 #define DELTA 4            // must be 2 or larger
 #define MAXBODY 32         // max # of lines in one body
+#define WINDOW 4194304     // bytes of data file read at once by each proc
+#define RVOUS 1            // 0 for irregular, 1 for all2all
+#define BINCHUNK 65536     // rows of binary section read at once by each proc
+
+// binary sections of data file, also in write_data.cpp
+//   magic, endian, format revision, # of rows, # of values per row
+//   followed by rows of values as doubles or 64-bit ints
+
+#define MAGIC_BINARY "\0LMPDAT"
+#define MAGICLEN 8
+#define ENDIAN 0x0001
+#define REVISION_BINARY 1
 
                            // customize for new sections
 #define NSECTIONS 25       // change when add to header::section_keywords
@@ -69,6 +82,7 @@ const char *suffixes[] = {"/cuda","/gpu","/opt","/omp","/kk",
 ReadData::ReadData(LAMMPS *lmp) : Pointers(lmp)
 {
   MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
   line = new char[MAXLINE];
   copy = new char[MAXLINE];
   keyword = new char[MAXLINE];
@@ -78,6 +92,12 @@ ReadData::ReadData(LAMMPS *lmp) : Pointers(lmp)
   arg = NULL;
   fp = NULL;
 
+  window = NULL;
+  nbondrvous = maxbondrvous = 0;
+  bondrvous = NULL;
+  rows = NULL;
+  topocount = NULL;
+
   // customize for new sections
   // pointers to atom styles that store extra info
 
@@ -100,7 +120,10 @@ ReadData::~ReadData()
   delete [] keyword;
   delete [] style;
   delete [] buffer;
+  delete [] window;
   memory->sfree(arg);
+  memory->sfree(bondrvous);
+  memory->destroy(rows);
 
   for (int i = 0; i < nfix; i++) {
     delete [] fix_header[i];
@@ -132,6 +155,8 @@ void ReadData::command(int narg, char **arg)
     extra_dihedral_types = extra_improper_types = 0;
 
   groupbit = 0;
+  parallelflag = 0;
+  datafile = arg[0];
 
   nfix = 0;
   fix_index = NULL;
@@ -266,6 +291,12 @@ void ReadData::command(int narg, char **arg)
       int igroup = group->find_or_create(arg[iarg+1]);
       groupbit = group->bitmask[igroup];
       iarg += 2;
+    } else if (strcmp(arg[iarg],"parallel") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal read_data command");
+      if (strcmp(arg[iarg+1],"yes") == 0) parallelflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) parallelflag = 0;
+      else error->all(FLERR,"Illegal read_data command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"fix") == 0) {
       if (iarg+4 > narg)
         error->all(FLERR,"Illegal read_data command");
@@ -312,6 +343,11 @@ void ReadData::command(int narg, char **arg)
       (extra_atom_types || extra_bond_types || extra_angle_types ||
        extra_dihedral_types || extra_improper_types))
     error->all(FLERR,"Cannot use read_data extra with add flag");
+  if (parallelflag) {
+    int n = strlen(arg[0]);
+    if (n > 3 && strcmp(&arg[0][n-3],".gz") == 0)
+      error->all(FLERR,"Cannot use read_data parallel with a gzipped data file");
+  }
 
   // first time system initialization
 
@@ -1232,14 +1268,30 @@ void ReadData::atoms()
     if (logfile) fprintf(logfile,"  reading atoms ...\n");
   }
 
-  bigint nread = 0;
+  // if parallel, each proc keeps all atoms it reads, then they are migrated
+  // else each proc keeps only atoms in its sub-domain
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_atoms(nchunk,buffer,id_offset,mol_offset,toffset,shiftflag,shift);
-    nread += nchunk;
+  if (binary_section(natoms,atom->avec->size_data_atom+3)) {
+    if (!atom->avec->binary_data_allow)
+      error->all(FLERR,"Atom style does not support binary data files");
+    read_rows(natoms,ncol_binary,parallelflag,&ReadData::atom_rows);
+    if (parallelflag) migrate_new_atoms();
+
+  } else if (parallelflag) {
+    read_lines_parallel(natoms,&ReadData::atom_lines);
+    migrate_new_atoms();
+
+  } else {
+    bigint nread = 0;
+
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_atoms(nchunk,buffer,id_offset,mol_offset,toffset,
+                       shiftflag,shift,0);
+      nread += nchunk;
+    }
   }
 
   // check that all atoms were assigned correctly
@@ -1294,14 +1346,21 @@ void ReadData::velocities()
     atom->map_set();
   }
 
-  bigint nread = 0;
+  if (binary_section(natoms,atom->avec->size_data_vel)) {
+    if (!atom->avec->binary_data_allow)
+      error->all(FLERR,"Atom style does not support binary data files");
+    read_rows(natoms,ncol_binary,0,&ReadData::vel_rows);
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_vels(nchunk,buffer,id_offset);
-    nread += nchunk;
+  } else {
+    bigint nread = 0;
+
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_vels(nchunk,buffer,id_offset);
+      nread += nchunk;
+    }
   }
 
   if (mapflag) {
@@ -1343,15 +1402,29 @@ void ReadData::bonds(int firstpass)
   }
 
   // read and process bonds
-
-  bigint nread = 0;
-
-  while (nread < nbonds) {
-    nchunk = MIN(nbonds-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_bonds(nchunk,buffer,count,id_offset,boffset);
-    nread += nchunk;
+  // if parallel, bonds read by each proc are sent to owners of their atoms
+
+  if (binary_section(nbonds,3)) {
+    topocount = count;
+    nbondrvous = 0;
+    read_rows(nbonds,3,parallelflag,&ReadData::bond_rows);
+    if (parallelflag) distribute_bonds(count);
+
+  } else if (parallelflag) {
+    nbondrvous = 0;
+    read_lines_parallel(nbonds,&ReadData::bond_lines);
+    distribute_bonds(count);
+
+  } else {
+    bigint nread = 0;
+
+    while (nread < nbonds) {
+      nchunk = MIN(nbonds-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_bonds(nchunk,buffer,count,id_offset,boffset);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max bond/atom and return
@@ -1427,14 +1500,20 @@ void ReadData::angles(int firstpass)
 
   // read and process angles
 
-  bigint nread = 0;
+  if (binary_section(nangles,4)) {
+    topocount = count;
+    read_rows(nangles,4,0,&ReadData::angle_rows);
 
-  while (nread < nangles) {
-    nchunk = MIN(nangles-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_angles(nchunk,buffer,count,id_offset,aoffset);
-    nread += nchunk;
+  } else {
+    bigint nread = 0;
+
+    while (nread < nangles) {
+      nchunk = MIN(nangles-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_angles(nchunk,buffer,count,id_offset,aoffset);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max angle/atom and return
@@ -1510,14 +1589,20 @@ void ReadData::dihedrals(int firstpass)
 
   // read and process dihedrals
 
-  bigint nread = 0;
+  if (binary_section(ndihedrals,5)) {
+    topocount = count;
+    read_rows(ndihedrals,5,0,&ReadData::dihedral_rows);
 
-  while (nread < ndihedrals) {
-    nchunk = MIN(ndihedrals-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_dihedrals(nchunk,buffer,count,id_offset,doffset);
-    nread += nchunk;
+  } else {
+    bigint nread = 0;
+
+    while (nread < ndihedrals) {
+      nchunk = MIN(ndihedrals-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_dihedrals(nchunk,buffer,count,id_offset,doffset);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max dihedral/atom and return
@@ -1593,14 +1678,20 @@ void ReadData::impropers(int firstpass)
 
   // read and process impropers
 
-  bigint nread = 0;
+  if (binary_section(nimpropers,5)) {
+    topocount = count;
+    read_rows(nimpropers,5,0,&ReadData::improper_rows);
 
-  while (nread < nimpropers) {
-    nchunk = MIN(nimpropers-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_impropers(nchunk,buffer,count,id_offset,ioffset);
-    nread += nchunk;
+  } else {
+    bigint nread = 0;
+
+    while (nread < nimpropers) {
+      nchunk = MIN(nimpropers-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_impropers(nchunk,buffer,count,id_offset,ioffset);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max improper/atom and return
@@ -2111,17 +2202,668 @@ void ReadData::parse_keyword(int first)
 /* ----------------------------------------------------------------------
    proc 0 reads N lines from file
    could be skipping Natoms lines, so use bigints
+   if parallel, all procs scan large sections for their end
+   a binary section is skipped as a whole
 ------------------------------------------------------------------------- */
 
 void ReadData::skip_lines(bigint n)
 {
-  if (me) return;
   if (n <= 0) return;
+
+  if (binary_section(n,0)) {
+    read_rows(n,ncol_binary,0,NULL);
+    return;
+  }
+
+  if (parallelflag && n > CHUNK) {
+    read_lines_parallel(n,NULL);
+    return;
+  }
+
+  if (me) return;
   char *eof = NULL;
   for (bigint i = 0; i < n; i++) eof = fgets(line,MAXLINE,fp);
   if (eof == NULL) error->one(FLERR,"Unexpected end of data file");
 }
 
+/* ----------------------------------------------------------------------
+   all procs read next N lines of data file in parallel
+   proc 0 file ptr is at 1st line on entry and is set after Nth line on exit
+   file is read in rounds, each proc reads its own window of bytes per round
+   a line belongs to the proc whose window contains its first char,
+     that proc reads past end of its window to complete the line
+   lines past the Nth line in the final round are ignored
+   process = method invoked with lines assigned to this proc in each round,
+     NULL if lines are only skipped
+------------------------------------------------------------------------- */
+
+void ReadData::read_lines_parallel(bigint n,
+                                   void (ReadData::*process)(int, char *))
+{
+  if (n <= 0) return;
+
+  // each proc opens its own copy of data file at offset of 1st line
+
+  bigint start;
+  if (me == 0) start = ftell(fp);
+  MPI_Bcast(&start,1,MPI_LMP_BIGINT,0,world);
+
+  FILE *pfp = fopen(datafile,"rb");
+  if (pfp == NULL) {
+    char str[128];
+    snprintf(str,128,"Cannot open file %s",datafile);
+    error->one(FLERR,str);
+  }
+
+  if (window == NULL) window = new char[WINDOW+MAXLINE+2];
+
+  bigint offset = start;
+  bigint nread = 0;
+  bigint myend = 0;
+
+  while (nread < n) {
+
+    // read my window, plus 1 char before it to detect if it starts a line
+    // and MAXLINE chars after it to complete the last line
+
+    bigint wlo = offset + (bigint) me*WINDOW;
+    int before = (wlo > start) ? 1 : 0;
+    int nwant = before + WINDOW + MAXLINE;
+    int nbytes = 0;
+    if (fseek(pfp,wlo-before,SEEK_SET) == 0)
+      nbytes = fread(window,sizeof(char),nwant,pfp);
+
+    char *data = &window[before];
+    int navail = MAX(nbytes-before,0);
+    int nwin = MIN(navail,WINDOW);
+
+    // count lines starting in my window, first = start of 1st one
+
+    int nmine = 0;
+    int first = -1;
+    if (nwin && (before == 0 || window[0] == '\n')) {
+      nmine = 1;
+      first = 0;
+    }
+    for (int i = 0; i < nwin-1; i++)
+      if (data[i] == '\n') {
+        if (first < 0) first = i+1;
+        nmine++;
+      }
+
+    // nprevious = # of lines preceding my 1st one
+    // nuse = # of my lines that are part of the N lines
+
+    bigint nmine_big = nmine;
+    bigint nscan,nround;
+    MPI_Scan(&nmine_big,&nscan,1,MPI_LMP_BIGINT,MPI_SUM,world);
+    MPI_Allreduce(&nmine_big,&nround,1,MPI_LMP_BIGINT,MPI_SUM,world);
+    if (nround == 0) error->all(FLERR,"Unexpected end of data file");
+
+    bigint nprevious = nread + nscan - nmine;
+    int nuse = nmine;
+    if (n - nprevious < nmine) nuse = MAX(n-nprevious,0);
+
+    // find end of my last used line
+    // last line of file may lack a newline, add one
+    // proc with the Nth line stores file offset after it
+
+    if (nuse) {
+      char *ptr = &data[first];
+      for (int i = 0; i < nuse; i++) {
+        char *next = (char *) memchr(ptr,'\n',&data[navail]-ptr);
+        if (next == NULL) {
+          if (nbytes == nwant)
+            error->one(FLERR,"Line in data file is too long");
+          next = &data[navail];
+          *next = '\n';
+        }
+        ptr = next + 1;
+      }
+      *ptr = '\0';
+
+      if (nprevious + nuse == n) myend = wlo + (ptr-data);
+      if (process) (this->*process)(nuse,&data[first]);
+    }
+
+    nread += nround;
+    offset += (bigint) nprocs*WINDOW;
+  }
+
+  fclose(pfp);
+
+  // reposition proc 0 after Nth line
+
+  bigint end;
+  MPI_Allreduce(&myend,&end,1,MPI_LMP_BIGINT,MPI_MAX,world);
+  if (me == 0) fseek(fp,end,SEEK_SET);
+}
+
+/* ----------------------------------------------------------------------
+   process N lines of Atoms section read in parallel
+------------------------------------------------------------------------- */
+
+void ReadData::atom_lines(int n, char *buf)
+{
+  atom->data_atoms(n,buf,id_offset,mol_offset,toffset,shiftflag,shift,1);
+}
+
+/* ----------------------------------------------------------------------
+   move atoms read in parallel to procs that own them
+   atoms that existed before stay on their proc and keep their indices,
+     so that new atoms are still those from nlocal_previous to nlocal
+------------------------------------------------------------------------- */
+
+void ReadData::migrate_new_atoms()
+{
+  // Irregular clears and resets atom map, so it must exist
+
+  if (atom->map_style) {
+    atom->map_init();
+    atom->map_set();
+  }
+
+  // assign new atoms to procs via lamda coords for triclinic box,
+  //   but leave x unchanged to avoid round-off from converting back
+
+  int nlocal = atom->nlocal;
+  double **x = atom->x;
+
+  comm->coord2proc_setup();
+
+  int *procassign;
+  memory->create(procassign,nlocal,"read_data:procassign");
+
+  int igx,igy,igz;
+  double lamda[3],*coord;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (i < nlocal_previous) procassign[i] = me;
+    else {
+      if (domain->triclinic) {
+        domain->x2lamda(x[i],lamda);
+        coord = lamda;
+      } else coord = x[i];
+      procassign[i] = comm->coord2proc(coord,igx,igy,igz);
+    }
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+  irregular->migrate_atoms(1,1,procassign);
+  delete irregular;
+
+  memory->destroy(procassign);
+}
+
+/* ----------------------------------------------------------------------
+   parse N lines of Bonds section read in parallel
+------------------------------------------------------------------------- */
+
+void ReadData::bond_lines(int n, char *buf)
+{
+  int tmp,itype,rv;
+  tagint atom1,atom2;
+  char *next;
+
+  for (int i = 0; i < n; i++) {
+    next = strchr(buf,'\n');
+    *next = '\0';
+    rv = sscanf(buf,"%d %d " TAGINT_FORMAT " " TAGINT_FORMAT,
+                &tmp,&itype,&atom1,&atom2);
+    if (rv != 4)
+      error->one(FLERR,"Incorrect format of Bonds section in data file");
+    if (id_offset) {
+      atom1 += id_offset;
+      atom2 += id_offset;
+    }
+    itype += boffset;
+
+    bond_rvous(itype,atom1,atom2);
+    buf = next + 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   store one bond read in parallel, with any offsets already added
+   one datum for owner of 1st atom, if newton_bond off
+     also one for owner of 2nd atom
+   check that atom IDs are > 0 and <= map_tag_max
+------------------------------------------------------------------------- */
+
+void ReadData::bond_rvous(int itype, tagint atom1, tagint atom2)
+{
+  if ((atom1 <= 0) || (atom1 > atom->map_tag_max) ||
+      (atom2 <= 0) || (atom2 > atom->map_tag_max) || (atom1 == atom2))
+    error->one(FLERR,"Invalid atom ID in Bonds section of data file");
+  if (itype <= 0 || itype > atom->nbondtypes)
+    error->one(FLERR,"Invalid bond type in Bonds section of data file");
+
+  if (nbondrvous+2 > maxbondrvous) {
+    maxbondrvous += CHUNK;
+    bondrvous = (BondRvous *)
+      memory->srealloc(bondrvous,(bigint) maxbondrvous*sizeof(BondRvous),
+                       "read_data:bondrvous");
+  }
+
+  bondrvous[nbondrvous].atomID = atom1;
+  bondrvous[nbondrvous].partnerID = atom2;
+  bondrvous[nbondrvous].type = itype;
+  nbondrvous++;
+  if (force->newton_bond == 0) {
+    bondrvous[nbondrvous].atomID = atom2;
+    bondrvous[nbondrvous].partnerID = atom1;
+    bondrvous[nbondrvous].type = itype;
+    nbondrvous++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   send bonds parsed by each proc to the owners of their atoms
+   uses rendezvous comm, owner of each atom ID is known to proc ID % nprocs
+   if count is non-NULL, just count bonds per atom
+   else store them with atoms
+------------------------------------------------------------------------- */
+
+void ReadData::distribute_bonds(int *count)
+{
+  tagint *tag = atom->tag;
+  int nlocal = atom->nlocal;
+
+  // setup input buf for rendezvous comm
+  // one datum for each owned atom: datum = owning proc, atomID
+
+  int *proclist;
+  memory->create(proclist,nlocal,"read_data:proclist");
+  IDRvous *idbuf = (IDRvous *)
+    memory->smalloc((bigint) nlocal*sizeof(IDRvous),"read_data:idbuf");
+
+  for (int i = 0; i < nlocal; i++) {
+    proclist[i] = tag[i] % nprocs;
+    idbuf[i].me = me;
+    idbuf[i].atomID = tag[i];
+  }
+
+  char *buf;
+  comm->rendezvous(RVOUS,nlocal,(char *) idbuf,sizeof(IDRvous),0,proclist,
+                   rendezvous_ids,0,buf,0,(void *) this);
+
+  memory->destroy(proclist);
+  memory->sfree(idbuf);
+
+  // one datum for each parsed bond, routed via its atom ID to its owner
+
+  memory->create(proclist,nbondrvous,"read_data:proclist");
+  for (int i = 0; i < nbondrvous; i++)
+    proclist[i] = bondrvous[i].atomID % nprocs;
+
+  int nreturn = comm->rendezvous(RVOUS,nbondrvous,(char *) bondrvous,
+                                 sizeof(BondRvous),0,proclist,
+                                 rendezvous_bonds,0,buf,sizeof(BondRvous),
+                                 (void *) this);
+  BondRvous *outbuf = (BondRvous *) buf;
+
+  memory->destroy(proclist);
+  memory->destroy(procowner);
+  memory->destroy(atomIDs);
+  nbondrvous = 0;
+
+  // count or store bonds of my atoms
+  // a bond to a non-existent atom ID is not stored anywhere
+
+  int *num_bond = atom->num_bond;
+  int **bond_type = atom->bond_type;
+  tagint **bond_atom = atom->bond_atom;
+
+  int m;
+  for (int i = 0; i < nreturn; i++) {
+    if ((m = atom->map(outbuf[i].atomID)) < 0) continue;
+    if (count) count[m]++;
+    else {
+      bond_type[m][num_bond[m]] = outbuf[i].type;
+      bond_atom[m][num_bond[m]] = outbuf[i].partnerID;
+      num_bond[m]++;
+    }
+  }
+
+  memory->sfree(outbuf);
+}
+
+/* ----------------------------------------------------------------------
+   process data for atoms assigned to me in rendezvous decomposition
+   inbuf = list of N IDRvous datums
+   no outbuf
+------------------------------------------------------------------------- */
+
+int ReadData::rendezvous_ids(int n, char *inbuf,
+                             int &flag, int *& /*proclist*/,
+                             char *& /*outbuf*/, void *ptr)
+{
+  ReadData *rptr = (ReadData *) ptr;
+  Memory *memory = rptr->memory;
+
+  int *procowner;
+  tagint *atomIDs;
+
+  memory->create(procowner,n,"read_data:procowner");
+  memory->create(atomIDs,n,"read_data:atomIDs");
+
+  IDRvous *in = (IDRvous *) inbuf;
+
+  for (int i = 0; i < n; i++) {
+    procowner[i] = in[i].me;
+    atomIDs[i] = in[i].atomID;
+  }
+
+  // store rendezvous data in ReadData class
+
+  rptr->nrvous = n;
+  rptr->procowner = procowner;
+  rptr->atomIDs = atomIDs;
+
+  // flag = 0: no second comm needed in rendezvous
+
+  flag = 0;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   process data for atoms assigned to me in rendezvous decomposition
+   inbuf = list of N BondRvous datums
+   outbuf = same list of N BondRvous datums, routed to owners of atom IDs
+     datums for non-existent atom IDs are returned to me
+------------------------------------------------------------------------- */
+
+int ReadData::rendezvous_bonds(int n, char *inbuf,
+                               int &flag, int *&proclist, char *&outbuf,
+                               void *ptr)
+{
+  ReadData *rptr = (ReadData *) ptr;
+  Atom *atom = rptr->atom;
+  Memory *memory = rptr->memory;
+
+  // clear atom map so it can be used here as a hash table
+  // faster than an STL map for large atom counts
+
+  atom->map_clear();
+
+  // hash atom IDs stored in rendezvous decomposition
+
+  int nrvous = rptr->nrvous;
+  tagint *atomIDs = rptr->atomIDs;
+
+  for (int i = 0; i < nrvous; i++)
+    atom->map_one(atomIDs[i],i);
+
+  // proclist = owner of atomID in caller decomposition
+
+  BondRvous *in = (BondRvous *) inbuf;
+  int *procowner = rptr->procowner;
+  memory->create(proclist,n,"read_data:proclist");
+
+  int m;
+  for (int i = 0; i < n; i++) {
+    m = atom->map(in[i].atomID);
+    if (m < 0) proclist[i] = rptr->me;
+    else proclist[i] = procowner[m];
+  }
+
+  outbuf = inbuf;
+
+  // re-create atom map
+
+  atom->map_init(0);
+  atom->nghost = 0;
+  atom->map_set();
+
+  // flag = 1: outbuf = inbuf
+
+  flag = 1;
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   check if next section of data file is binary and has N rows
+   proc 0 peeks at 1st char, text lines never start with a NUL char
+   if so, read its header and check it against ncol, if ncol > 0
+   return 1 for binary, 0 for text
+------------------------------------------------------------------------- */
+
+int ReadData::binary_section(bigint n, int ncol)
+{
+  int flag = 0;
+  bigint info[3];
+
+  if (me == 0) {
+    int c = getc(fp);
+    if (c == '\0') flag = 1;
+    else if (c != EOF) ungetc(c,fp);
+
+    if (flag) {
+      char magic[MAGICLEN];
+      int endian,revision;
+      magic[0] = '\0';
+      if (fread(&magic[1],sizeof(char),MAGICLEN-1,fp) != MAGICLEN-1 ||
+          fread(&endian,sizeof(int),1,fp) != 1 ||
+          fread(&revision,sizeof(int),1,fp) != 1 ||
+          fread(info,sizeof(bigint),2,fp) != 2)
+        error->one(FLERR,"Unexpected end of data file");
+      if (memcmp(magic,MAGIC_BINARY,MAGICLEN) != 0)
+        error->one(FLERR,"Invalid binary section in data file");
+      if (endian != ENDIAN)
+        error->one(FLERR,"Binary section of data file has swapped "
+                   "byte ordering");
+      if (revision > REVISION_BINARY)
+        error->one(FLERR,"Binary section of data file has newer "
+                   "format revision");
+      info[2] = ftell(fp);
+    }
+  }
+
+  MPI_Bcast(&flag,1,MPI_INT,0,world);
+  if (!flag) return 0;
+
+  MPI_Bcast(info,3,MPI_LMP_BIGINT,0,world);
+  nrows_binary = info[0];
+  ncol_binary = info[1];
+  offset_binary = info[2];
+
+  if (nrows_binary != n || ncol_binary <= 0 || (ncol && ncol_binary != ncol))
+    error->all(FLERR,"Incorrect format of binary section in data file");
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   read N rows of NCOL values of a binary section, BINCHUNK rows at a time
+   proc 0 file ptr is at 1st row on entry and is set after Nth row on exit
+   if distribute, all procs read different rows in rounds,
+     with collective MPI-IO reads if the MPIIO package is installed,
+     else each proc reads its rows with its own copy of the data file
+   else proc 0 reads rows and broadcasts them
+   process = method invoked with rows read by or sent to this proc,
+     NULL if rows are only skipped
+------------------------------------------------------------------------- */
+
+void ReadData::read_rows(bigint n, int ncol, int distribute,
+                         void (ReadData::*process)(int, double *))
+{
+  if (n <= 0) return;
+
+  int eof = 0;
+  bigint nbytes = n*ncol*sizeof(double);
+  memory->grow(rows,BINCHUNK*ncol,"read_data:rows");
+
+  // skipped rows are only passed by proc 0, a pipe must be read through
+
+  if (process == NULL) {
+    if (me == 0) {
+      if (!compressed) {
+        if (fseek(fp,nbytes,SEEK_CUR)) eof = 1;
+      } else {
+        for (bigint nread = 0; nread < n; nread += BINCHUNK) {
+          int nchunk = MIN(n-nread,BINCHUNK);
+          if (fread(rows,sizeof(double),nchunk*ncol,fp) != (size_t) nchunk*ncol)
+            eof = 1;
+        }
+      }
+    }
+    MPI_Bcast(&eof,1,MPI_INT,0,world);
+    if (eof) error->all(FLERR,"Unexpected end of data file");
+    return;
+  }
+
+  if (!distribute) {
+    for (bigint nread = 0; nread < n; nread += BINCHUNK) {
+      int nchunk = MIN(n-nread,BINCHUNK);
+      if (me == 0)
+        if (fread(rows,sizeof(double),nchunk*ncol,fp) != (size_t) nchunk*ncol)
+          eof = 1;
+      MPI_Bcast(&eof,1,MPI_INT,0,world);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      MPI_Bcast(rows,nchunk*ncol,MPI_DOUBLE,0,world);
+      (this->*process)(nchunk,rows);
+    }
+    return;
+  }
+
+  // data file must hold all rows, since short reads are not detected
+
+  bigint start = offset_binary;
+  if (me == 0) {
+    if (fseek(fp,0,SEEK_END) || ftell(fp) < start+nbytes) eof = 1;
+    fseek(fp,start,SEEK_SET);
+  }
+  MPI_Bcast(&eof,1,MPI_INT,0,world);
+  if (eof) error->all(FLERR,"Unexpected end of data file");
+
+  RestartMPIIO *mpiio = new RestartMPIIO(lmp);
+  FILE *pfp = NULL;
+  if (mpiio->mpiio_exists) mpiio->openForRead(datafile);
+  else {
+    pfp = fopen(datafile,"rb");
+    if (pfp == NULL) {
+      char str[128];
+      snprintf(str,128,"Cannot open file %s",datafile);
+      error->one(FLERR,str);
+    }
+  }
+
+  // in each round, proc P reads the Pth block of BINCHUNK rows
+  // MPI-IO reads are collective, so procs without rows still participate
+
+  for (bigint first = 0; first < n; first += (bigint) nprocs*BINCHUNK) {
+    bigint mylo = first + (bigint) me*BINCHUNK;
+    int nmine = MAX(MIN(n-mylo,BINCHUNK),0);
+    bigint offset = start + mylo*ncol*sizeof(double);
+
+    if (mpiio->mpiio_exists) {
+      if (nmine == 0) offset = start;
+      mpiio->read(offset,(bigint) nmine*ncol,rows);
+    } else if (nmine) {
+      if (fseek(pfp,offset,SEEK_SET) ||
+          fread(rows,sizeof(double),nmine*ncol,pfp) != (size_t) nmine*ncol)
+        error->one(FLERR,"Unexpected end of data file");
+    }
+
+    if (nmine) (this->*process)(nmine,rows);
+  }
+
+  if (mpiio->mpiio_exists) mpiio->close();
+  else fclose(pfp);
+  delete mpiio;
+
+  // reposition proc 0 after Nth row
+
+  if (me == 0) fseek(fp,start+nbytes,SEEK_SET);
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Atoms section
+------------------------------------------------------------------------- */
+
+void ReadData::atom_rows(int n, double *buf)
+{
+  atom->data_atoms_binary(n,buf,id_offset,mol_offset,toffset,
+                          shiftflag,shift,parallelflag);
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Velocities section
+------------------------------------------------------------------------- */
+
+void ReadData::vel_rows(int n, double *buf)
+{
+  atom->data_vels_binary(n,buf,id_offset);
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Bonds section
+   each row = bond type, 2 atom IDs as 64-bit ints
+   if parallel, rows differ between procs and bonds are sent to their owners
+------------------------------------------------------------------------- */
+
+void ReadData::bond_rows(int n, double *buf)
+{
+  for (int i = 0; i < n; i++) {
+    double *values = &buf[3*i];
+    int itype = (int) ubuf(values[0]).i + boffset;
+    tagint atom1 = (tagint) ubuf(values[1]).i + id_offset;
+    tagint atom2 = (tagint) ubuf(values[2]).i + id_offset;
+    if (parallelflag) bond_rvous(itype,atom1,atom2);
+    else atom->data_bond(itype,atom1,atom2,topocount);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Angles section
+   each row = angle type, 3 atom IDs as 64-bit ints
+------------------------------------------------------------------------- */
+
+void ReadData::angle_rows(int n, double *buf)
+{
+  for (int i = 0; i < n; i++) {
+    double *values = &buf[4*i];
+    atom->data_angle((int) ubuf(values[0]).i + aoffset,
+                     (tagint) ubuf(values[1]).i + id_offset,
+                     (tagint) ubuf(values[2]).i + id_offset,
+                     (tagint) ubuf(values[3]).i + id_offset,topocount);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Dihedrals section
+   each row = dihedral type, 4 atom IDs as 64-bit ints
+------------------------------------------------------------------------- */
+
+void ReadData::dihedral_rows(int n, double *buf)
+{
+  for (int i = 0; i < n; i++) {
+    double *values = &buf[5*i];
+    atom->data_dihedral((int) ubuf(values[0]).i + doffset,
+                        (tagint) ubuf(values[1]).i + id_offset,
+                        (tagint) ubuf(values[2]).i + id_offset,
+                        (tagint) ubuf(values[3]).i + id_offset,
+                        (tagint) ubuf(values[4]).i + id_offset,topocount);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   process N rows of binary Impropers section
+   each row = improper type, 4 atom IDs as 64-bit ints
+------------------------------------------------------------------------- */
+
+void ReadData::improper_rows(int n, double *buf)
+{
+  for (int i = 0; i < n; i++) {
+    double *values = &buf[5*i];
+    atom->data_improper((int) ubuf(values[0]).i + ioffset,
+                        (tagint) ubuf(values[1]).i + id_offset,
+                        (tagint) ubuf(values[2]).i + id_offset,
+                        (tagint) ubuf(values[3]).i + id_offset,
+                        (tagint) ubuf(values[4]).i + id_offset,topocount);
+  }
+}
+
 /* ----------------------------------------------------------------------
    parse a line of coeffs into words, storing them in narg,arg
    trim anything from '#' onward
@@ -76,6 +76,48 @@ class ReadData : protected Pointers {
   char **fix_header;
   char **fix_section;
 
+  // parallel reading of large sections by all procs
+
+  int parallelflag;
+  char *datafile;            // name of data file, opened by each proc
+  char *window;              // part of data file read by this proc
+  int nprocs;
+
+  struct IDRvous {
+    int me;
+    tagint atomID;
+  };
+
+  struct BondRvous {
+    tagint atomID,partnerID;
+    int type;
+  };
+
+  int nbondrvous,maxbondrvous;
+  BondRvous *bondrvous;      // bonds parsed by this proc
+
+  int nrvous;                // data used by rendezvous callback methods
+  tagint *atomIDs;
+  int *procowner;
+
+  // binary sections of data file
+
+  bigint nrows_binary;       // # of rows in current binary section
+  int ncol_binary;           // # of values per row
+  bigint offset_binary;      // byte offset of 1st row in data file
+  double *rows;              // rows read or received by this proc
+  int *topocount;            // per-atom topology counts, NULL if storing
+
+  // union data struct for unpacking 64-bit ints from binary sections
+
+  union ubuf {
+    double d;
+    int64_t i;
+    ubuf(double arg) : d(arg) {}
+    ubuf(int64_t arg) : i(arg) {}
+    ubuf(int arg) : i(arg) {}
+  };
+
   // methods
 
   void open(char *);
@@ -108,6 +150,27 @@ class ReadData : protected Pointers {
   void impropercoeffs(int);
 
   void fix(int, char *);
+
+  void read_lines_parallel(bigint, void (ReadData::*)(int, char *));
+  void atom_lines(int, char *);
+  void bond_lines(int, char *);
+  void bond_rvous(int, tagint, tagint);
+
+  int binary_section(bigint, int);
+  void read_rows(bigint, int, int, void (ReadData::*)(int, double *));
+  void atom_rows(int, double *);
+  void vel_rows(int, double *);
+  void bond_rows(int, double *);
+  void angle_rows(int, double *);
+  void dihedral_rows(int, double *);
+  void improper_rows(int, double *);
+  void migrate_new_atoms();
+  void distribute_bonds(int *);
+
+  // callback functions for rendezvous communication
+
+  static int rendezvous_ids(int, char *, int &, int *&, char *&, void *);
+  static int rendezvous_bonds(int, char *, int &, int *&, char *&, void *);
 };
 
 }
@@ -184,6 +247,11 @@ E: Cannot use read_data extra with add flag
 
 Self-explanatory.
 
+E: Cannot use read_data parallel with a gzipped data file
+
+Parallel reading requires each processor to seek within the data file,
+which is not possible for a file decompressed through a pipe.
+
 W: Atom style in data file differs from currently defined atom style
 
 Self-explanatory.
@@ -513,6 +581,50 @@ E: Subsequent read data induced too many impropers per atom
 See the extra/improper/per/atom keyword for the create_box
 or the read_data command to set this limit larger.
 
+E: Line in data file is too long
+
+When the data file is read in parallel, no line of the Atoms or Bonds
+sections may have more than 256 characters.
+
+E: Incorrect format of Bonds section in data file
+
+Number of values in a line of the Bonds section is incorrect.
+
+E: Invalid atom ID in Bonds section of data file
+
+Atom IDs must be positive integers and within range of defined
+atoms.
+
+E: Invalid bond type in Bonds section of data file
+
+Bond type must be positive integer and within range of specified bond
+types.
+
+E: Atom style does not support binary data files
+
+The Atoms and Velocities sections of a data file can only be binary
+for atom styles atomic, charge, bond, angle, molecular, and full.
+
+E: Invalid binary section in data file
+
+A section of the data file starts with a NUL character, but not with
+the signature of a binary section written by the write_data command.
+
+E: Binary section of data file has swapped byte ordering
+
+The data file was written on a machine with different endianness.
+Write it as a text data file instead.
+
+E: Binary section of data file has newer format revision
+
+The data file was written by a newer version of LAMMPS with a binary
+format that this version cannot read.
+
+E: Incorrect format of binary section in data file
+
+The number of rows or values per row of a binary section does not
+match the header of the data file or the atom style.
+
 E: Impropers assigned incorrectly
 
 Impropers read in from the data file were not assigned correctly to
@@ -23,6 +23,7 @@
 #include <mpi.h>
 #include <cstring>
 #include <string>
+#include <thread>
 #include "reader.h"
 #include "style_reader.h"
 #include "atom.h"
@@ -46,6 +47,45 @@ enum{ID,TYPE,X,Y,Z,VX,VY,VZ,Q,IX,IY,IZ,FX,FY,FZ};
 enum{UNSET,NOSCALE_NOWRAP,NOSCALE_WRAP,SCALE_NOWRAP,SCALE_WRAP};
 enum{NOADD,YESADD,KEEPADD};
 
+namespace LAMMPS_NS {
+
+/* ----------------------------------------------------------------------
+   next snapshot as read by a background thread on a filereader proc
+   while the current snapshot is processed, see ReadDump::prefetch()
+------------------------------------------------------------------------- */
+
+class ReadDumpPrefetch {
+ public:
+  std::thread reader;
+  int active;                 // 1 if thread was started for next snapshot
+  int ready;                  // 1 if values below hold next snapshot
+  int status;                 // 1 if thread failed, 0 if not
+  std::string message;        // error message of failed thread
+
+  bigint ncurrent,nlast;      // selection criteria of ReadDump::next()
+  int nevery,nskip;
+
+  bigint *ntimestep;          // timestep found by each reader, -1 if none
+  int currentfile;            // dump file the snapshot was found in
+  bigint *nsnapatoms;         // # of atoms in snapshot of each reader
+  double box[3][3];           // snapshot header values
+  int boxinfo,triclinic_snap;
+  double **fields;            // per-atom values read by this proc
+  int maxfields;              // allocated rows of fields
+
+  ReadDumpPrefetch(int nreader) : active(0), ready(0), status(0),
+                                  fields(NULL), maxfields(0) {
+    ntimestep = new bigint[nreader];
+    nsnapatoms = new bigint[nreader];
+  }
+  ~ReadDumpPrefetch() {
+    delete [] ntimestep;
+    delete [] nsnapatoms;
+  }
+};
+
+}
+
 /* ---------------------------------------------------------------------- */
 
 ReadDump::ReadDump(LAMMPS *lmp) : Pointers(lmp)
@@ -76,12 +116,23 @@ ReadDump::ReadDump(LAMMPS *lmp) : Pointers(lmp)
   clustercomm = MPI_COMM_NULL;
   filereader = 0;
   parallel = 0;
+  nslice = 1;
+  islice = 0;
+  pf = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
 
 ReadDump::~ReadDump()
 {
+  // background thread must be done with the readers
+
+  if (pf) {
+    if (pf->reader.joinable()) pf->reader.join();
+    memory->destroy(pf->fields);
+    delete pf;
+  }
+
   for (int i = 0; i < nfile; i++) delete [] files[i];
   delete [] files;
   for (int i = 0; i < nfield; i++) delete [] fieldlabel[i];
@@ -149,7 +200,7 @@ void ReadDump::command(int narg, char **arg)
   bigint nsnap_all,npurge_all,nreplace_all,ntrim_all,nadd_all;
 
   bigint tmp = 0;
-  if (filereader)
+  if (filereader && islice == 0)
     for (int i = 0; i < nreader; i++)
       tmp += nsnapatoms[i];
   MPI_Allreduce(&tmp,&nsnap_all,1,MPI_LMP_BIGINT,MPI_SUM,world);
@@ -219,11 +270,17 @@ void ReadDump::setup_reader(int narg, char **arg)
 {
   // setup serial or parallel file reading
   // multiproc = 0: only one file to read from, only proc 0 is a reader
+  //   unless nslice > 1, then nslice clusters each read a slice of the file
   // multiproc_nfile >= nprocs: every proc reads one or more files
   // multiproc_nfile < nprocs: multiproc_nfile readers, create clusters
   // see read_dump.h for explanation of these variables
 
-  if (multiproc == 0) {
+  if (multiproc == 0 && nslice > 1) {
+    nreader = 1;
+    firstfile = -1;
+    islice = static_cast<int> ((bigint) me * nslice/nprocs);
+    MPI_Comm_split(world,islice,0,&clustercomm);
+  } else if (multiproc == 0) {
     nreader = 1;
     firstfile = -1;
     MPI_Comm_dup(world,&clustercomm);
@@ -271,6 +328,10 @@ void ReadDump::setup_reader(int narg, char **arg)
       filereader = 1;
   }
 
+  if (parallel && nslice > 1)
+    error->all(FLERR,"Read_dump readers keyword is not supported "
+               "by this reader style");
+
   // pass any arguments to readers
 
   if (narg > 0 && filereader)
@@ -299,15 +360,7 @@ bigint ReadDump::seek(bigint nrequest, int exact)
 
     for (ifile = 0; ifile < nfile; ifile++) {
       ntimestep = -1;
-      if (multiproc) {
-        char *ptr = strchr(files[ifile],'%');
-        char *multiname = new char[strlen(files[ifile]) + 16];
-        *ptr = '\0';
-        sprintf(multiname,"%s%d%s",files[ifile],0,ptr+1);
-        *ptr = '%';
-        readers[0]->open_file(multiname);
-        delete [] multiname;
-      } else readers[0]->open_file(files[ifile]);
+      open_reader(0,ifile);
 
       while (1) {
         eofflag = readers[0]->read_time(ntimestep);
@@ -342,19 +395,13 @@ bigint ReadDump::seek(bigint nrequest, int exact)
     return ntimestep;
   }
 
-  // for multiproc mode:
+  // for multiproc mode or slices of a single file:
   // all filereader procs search for same ntimestep in currentfile
 
-  if (multiproc && filereader) {
+  if ((multiproc || nslice > 1) && filereader) {
     for (int i = 0; i < nreader; i++) {
       if (me == 0 && i == 0) continue;    // proc 0, reader 0 already found it
-      char *ptr = strchr(files[currentfile],'%');
-      char *multiname = new char[strlen(files[currentfile]) + 16];
-      *ptr = '\0';
-      sprintf(multiname,"%s%d%s",files[currentfile],firstfile+i,ptr+1);
-      *ptr = '%';
-      readers[i]->open_file(multiname);
-      delete [] multiname;
+      open_reader(i,currentfile);
 
       bigint step;
       while (1) {
@@ -384,55 +431,28 @@ bigint ReadDump::seek(bigint nrequest, int exact)
 
 bigint ReadDump::next(bigint ncurrent, bigint nlast, int nevery, int nskip)
 {
-  int ifile,eofflag;
+  int eofflag;
   bigint ntimestep;
-
-  // proc 0 finds the timestep in its first reader
-
-  if (me == 0 || parallel) {
-
-    // exit file loop when dump timestep matches all criteria
-    // or files exhausted
-
-    int iskip = 0;
-
-    for (ifile = currentfile; ifile < nfile; ifile++) {
-      ntimestep = -1;
-      if (ifile != currentfile) {
-        if (multiproc) {
-          char *ptr = strchr(files[ifile],'%');
-          char *multiname = new char[strlen(files[ifile]) + 16];
-          *ptr = '\0';
-          sprintf(multiname,"%s%d%s",files[ifile],0,ptr+1);
-          *ptr = '%';
-          readers[0]->open_file(multiname);
-          delete [] multiname;
-        } else readers[0]->open_file(files[ifile]);
-      }
-
-      while (1) {
-        eofflag = readers[0]->read_time(ntimestep);
-        if (eofflag) break;
-        if (ntimestep > nlast) break;
-        if (ntimestep <= ncurrent) {
-          readers[0]->skip();
-          continue;
-        }
-        if (iskip == nskip) iskip = 0;
-        iskip++;
-        if (nevery && ntimestep % nevery) readers[0]->skip();
-        else if (iskip < nskip) readers[0]->skip();
-        else break;
-      }
-
-      if (eofflag) readers[0]->close_file();
-      else break;
+  int lastfile = currentfile;
+
+  // if snapshot was prefetched, every filereader proc has already found it
+  // an error of the background thread is raised here
+  // else proc 0 finds the timestep in its first reader
+
+  if (pf && pf->active && filereader) {
+    pf->reader.join();
+    pf->active = 0;
+    if (pf->status) {
+      pf->status = 0;
+      error->one(FLERR,pf->message.c_str());
     }
-
+    pf->ready = 1;
+    ntimestep = pf->ntimestep[0];
+    currentfile = pf->currentfile;
+  } else if (me == 0 || parallel) {
+    int ifile = currentfile;
+    ntimestep = find_next(0,ifile,ncurrent,nlast,nevery,nskip);
     currentfile = ifile;
-    if (eofflag) ntimestep = -1;
-    if (ntimestep <= ncurrent) ntimestep = -1;
-    if (ntimestep > nlast) ntimestep = -1;
   }
 
   if (!parallel) {
@@ -452,21 +472,33 @@ bigint ReadDump::next(bigint ncurrent, bigint nlast, int nevery, int nskip)
     return ntimestep;
   }
 
-  // for multiproc mode:
+  // for multiproc mode or slices of a single file:
   // all filereader procs search for same ntimestep in currentfile
+  // or check that their prefetched snapshot has the same ntimestep
+  // a slice reader is where proc 0 was, after the previous snapshot,
+  //   so it continues from there instead of rescanning the file
 
-  if (multiproc && filereader) {
+  if ((multiproc || nslice > 1) && filereader) {
     for (int i = 0; i < nreader; i++) {
+      if (pf && pf->ready) {
+        if (pf->ntimestep[i] != ntimestep)
+          error->one(FLERR,"Read dump parallel files "
+                     "do not all have same timestep");
+        continue;
+      }
       if (me == 0 && i == 0) continue;
-      char *ptr = strchr(files[currentfile],'%');
-      char *multiname = new char[strlen(files[currentfile]) + 16];
-      *ptr = '\0';
-      sprintf(multiname,"%s%d%s",files[currentfile],firstfile+i,ptr+1);
-      *ptr = '%';
-      readers[i]->open_file(multiname);
-      delete [] multiname;
 
       bigint step;
+      if (!multiproc) {
+        int ifile = lastfile;
+        step = find_next(i,ifile,ncurrent,nlast,nevery,nskip);
+        if (step != ntimestep || ifile != currentfile)
+          error->one(FLERR,"Read dump parallel files "
+                     "do not all have same timestep");
+        continue;
+      }
+
+      open_reader(i,currentfile);
       while (1) {
         eofflag = readers[i]->read_time(step);
         if (eofflag) break;
@@ -483,6 +515,186 @@ bigint ReadDump::next(bigint ncurrent, bigint nlast, int nevery, int nskip)
   return ntimestep;
 }
 
+/* ----------------------------------------------------------------------
+   find next matching snapshot for reader I, see next() for criteria
+   Ifile = dump file reader I has open, updated to file with snapshot
+   return matching ntimestep or -1 if did not find a match
+   called by filereader procs from next() and read_prefetch()
+------------------------------------------------------------------------- */
+
+bigint ReadDump::find_next(int i, int &ifile, bigint ncurrent, bigint nlast,
+                           int nevery, int nskip)
+{
+  int eofflag = 1;
+  bigint ntimestep = -1;
+
+  // exit file loop when dump timestep matches all criteria
+  // or files exhausted
+
+  int iskip = 0;
+  int startfile = ifile;
+
+  for (; ifile < nfile; ifile++) {
+    ntimestep = -1;
+    if (ifile != startfile) open_reader(i,ifile);
+
+    while (1) {
+      eofflag = readers[i]->read_time(ntimestep);
+      if (eofflag) break;
+      if (ntimestep > nlast) break;
+      if (ntimestep <= ncurrent) {
+        readers[i]->skip();
+        continue;
+      }
+      if (iskip == nskip) iskip = 0;
+      iskip++;
+      if (nevery && ntimestep % nevery) readers[i]->skip();
+      else if (iskip < nskip) readers[i]->skip();
+      else break;
+    }
+
+    if (eofflag) readers[i]->close_file();
+    else break;
+  }
+
+  if (eofflag) ntimestep = -1;
+  if (ntimestep <= ncurrent) ntimestep = -1;
+  if (ntimestep > nlast) ntimestep = -1;
+  return ntimestep;
+}
+
+/* ----------------------------------------------------------------------
+   open dump file Ifile for reader I
+   for multiproc mode, reader I reads parallel file firstfile+I
+------------------------------------------------------------------------- */
+
+void ReadDump::open_reader(int i, int ifile)
+{
+  if (multiproc) {
+    char *ptr = strchr(files[ifile],'%');
+    char *multiname = new char[strlen(files[ifile]) + 16];
+    *ptr = '\0';
+    sprintf(multiname,"%s%d%s",files[ifile],firstfile+i,ptr+1);
+    *ptr = '%';
+    readers[i]->open_file(multiname);
+    delete [] multiname;
+  } else readers[i]->open_file(files[ifile]);
+}
+
+/* ----------------------------------------------------------------------
+   start reading the snapshot following Ncurrent in a background thread
+   same selection criteria as next(), which waits for the thread
+   must be called after atoms() for the current snapshot
+------------------------------------------------------------------------- */
+
+void ReadDump::prefetch(bigint ncurrent, bigint nlast, int nevery, int nskip)
+{
+  pf->ready = 0;
+  if (!filereader) return;
+
+  pf->ncurrent = ncurrent;
+  pf->nlast = nlast;
+  pf->nevery = nevery;
+  pf->nskip = nskip;
+  pf->active = 1;
+  pf->reader = std::thread(&ReadDump::read_prefetch,this);
+}
+
+/* ----------------------------------------------------------------------
+   body of background thread started by prefetch()
+   each reader finds the next snapshot independently, next() checks
+     that all of them found the same one
+   must not communicate or raise errors, a failure is recorded in pf
+     and raised by next() on the main thread
+   errors of readers and memory allocation are thrown as ThreadError,
+     any other exception is reported with a generic message
+------------------------------------------------------------------------- */
+
+void ReadDump::read_prefetch()
+{
+  for (int i = 0; i < nreader; i++) pf->ntimestep[i] = -1;
+  pf->currentfile = currentfile;
+  pf->status = 0;
+
+  Error::defer_flag = 1;
+  try {
+    fetch_snapshot();
+  } catch (ThreadError &e) {
+    pf->status = 1;
+    pf->message = e.message;
+  } catch (...) {
+    pf->status = 1;
+    pf->message = "Read dump prefetch failed with unexpected exception";
+  }
+  Error::defer_flag = 0;
+}
+
+/* ----------------------------------------------------------------------
+   read header and my atoms of next snapshot into pf
+   same as header() and read_atoms(), called by read_prefetch()
+------------------------------------------------------------------------- */
+
+void ReadDump::fetch_snapshot()
+{
+  int fieldflag,xflag,yflag,zflag;
+
+  int nrows = 0;
+  for (int i = 0; i < nreader; i++) {
+    int ifile = currentfile;
+    bigint ntimestep = find_next(i,ifile,pf->ncurrent,pf->nlast,
+                                 pf->nevery,pf->nskip);
+    pf->ntimestep[i] = ntimestep;
+    if (i == 0) pf->currentfile = ifile;
+    if (ntimestep < 0) return;
+
+    pf->nsnapatoms[i] =
+      readers[i]->read_header(pf->box,pf->boxinfo,pf->triclinic_snap,0,
+                              nfield,fieldtype,fieldlabel,scaleflag,wrapflag,
+                              fieldflag,xflag,yflag,zflag);
+
+    // one reader per cluster reads its slice of the snapshot
+    // else this proc keeps all atoms of all its readers
+
+    bigint nsnap = pf->nsnapatoms[i];
+    bigint sfirst = 0;
+    if (!multiproc || multiproc_nfile < nprocs) {
+      sfirst = (bigint) islice * nsnap/nslice;
+      nsnap = (bigint) (islice+1) * pf->nsnapatoms[i]/nslice - sfirst;
+    }
+    if (nrows + nsnap > MAXSMALLINT) {
+      pf->status = 1;
+      pf->message = "Read dump snapshot is too large for a proc";
+      return;
+    }
+    if (nrows + nsnap > pf->maxfields || pf->maxfields == 0) {
+      pf->maxfields = MAX(nrows+nsnap,1);
+      memory->grow(pf->fields,pf->maxfields,nfield,"read_dump:prefetch");
+    }
+
+    readers[i]->skip_atoms(sfirst,nfield);
+    bigint ntotal = 0;
+    while (ntotal < nsnap) {
+      int nread = MIN(CHUNK,nsnap-ntotal);
+      readers[i]->read_atoms(nread,nfield,&pf->fields[nrows+ntotal]);
+      ntotal += nread;
+    }
+    readers[i]->skip_atoms(pf->nsnapatoms[i]-sfirst-nsnap,nfield);
+    nrows += nsnap;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   enable reading of snapshots in a background thread via prefetch()
+------------------------------------------------------------------------- */
+
+void ReadDump::setup_prefetch()
+{
+  if (parallel)
+    error->all(FLERR,"Read dump prefetch is not supported "
+               "by this reader style");
+  if (pf == NULL) pf = new ReadDumpPrefetch(nreader);
+}
+
 /* ----------------------------------------------------------------------
    read and broadcast and store snapshot header info
    set nsnapatoms = # of atoms in snapshot
@@ -493,7 +705,14 @@ void ReadDump::header(int fieldinfo)
   int boxinfo, triclinic_snap;
   int fieldflag,xflag,yflag,zflag;
 
-  if (filereader) {
+  // header of a prefetched snapshot was already read without field info
+
+  if (filereader && pf && pf->ready) {
+    for (int i = 0; i < nreader; i++) nsnapatoms[i] = pf->nsnapatoms[i];
+    memcpy(&box[0][0],&pf->box[0][0],9*sizeof(double));
+    boxinfo = pf->boxinfo;
+    triclinic_snap = pf->triclinic_snap;
+  } else if (filereader) {
     for (int i = 0; i < nreader; i++)
       nsnapatoms[i] = readers[i]->read_header(box,boxinfo,triclinic_snap,fieldinfo,
                                               nfield,fieldtype,fieldlabel,
@@ -725,12 +944,19 @@ void ReadDump::read_atoms()
   MPI_Request request;
   MPI_Status status;
 
+  // atoms of a prefetched snapshot are already in memory
+
+  int prefetched = 0;
+  if (filereader && pf && pf->ready) prefetched = 1;
+
   // one reader per cluster of procs
   // each reading proc reads one file and splits data across cluster
   // cluster can be all procs or a subset
+  // with several slices of a single file, a cluster reads only its slice
 
   if (!parallel && (!multiproc || multiproc_nfile < nprocs)) {
-    nsnap = nsnapatoms[0];
+    bigint sfirst = (bigint) islice * nsnapatoms[0]/nslice;
+    nsnap = (bigint) (islice+1) * nsnapatoms[0]/nslice - sfirst;
 
     if (filereader) {
       if (!buf) memory->create(buf,CHUNK,nfield,"read_dump:buf");
@@ -748,10 +974,14 @@ void ReadDump::read_atoms()
         memory->create(fields,maxnew,nfield,"read_dump:fields");
       }
 
+      if (!prefetched) readers[0]->skip_atoms(sfirst,nfield);
+
       ntotal = 0;
       while (ntotal < nsnap) {
         nread = MIN(CHUNK,nsnap-ntotal);
-        readers[0]->read_atoms(nread,nfield,buf);
+        double **rbuf = buf;
+        if (prefetched) rbuf = &pf->fields[ntotal];
+        else readers[0]->read_atoms(nread,nfield,buf);
         rfirst = ntotal;
         rlast = ntotal + nread;
 
@@ -760,10 +990,10 @@ void ReadDump::read_atoms()
           lo = MAX(ofirst,rfirst);
           hi = MIN(olast,rlast);
           if (otherproc)    // send to otherproc or copy to self
-            MPI_Send(&buf[nsend][0],(hi-lo)*nfield,MPI_DOUBLE,
+            MPI_Send(&rbuf[nsend][0],(hi-lo)*nfield,MPI_DOUBLE,
                      otherproc,0,clustercomm);
           else
-            memcpy(&fields[rfirst][0],&buf[nsend][0],
+            memcpy(&fields[rfirst][0],&rbuf[nsend][0],
                    (hi-lo)*nfield*sizeof(double));
           nsend += hi-lo;
           if (hi == olast) {
@@ -776,6 +1006,9 @@ void ReadDump::read_atoms()
         ntotal += nread;
       }
 
+      if (!prefetched)
+        readers[0]->skip_atoms(nsnapatoms[0]-sfirst-nsnap,nfield);
+
     } else {
       ofirst = (bigint) me_cluster * nsnap/nprocs_cluster;
       olast = (bigint) (me_cluster+1) * nsnap/nprocs_cluster;
@@ -800,6 +1033,20 @@ void ReadDump::read_atoms()
 
   // every proc is a filereader, reads one or more files
   // each proc keeps all data it reads, no communication required
+  // prefetched atoms of all readers are swapped in as a whole
+
+  } else if (prefetched) {
+    bigint sum = 0;
+    for (int i = 0; i < nreader; i++)
+      sum += nsnapatoms[i];
+    nnew = static_cast<int> (sum);
+
+    double **tmp = fields;
+    fields = pf->fields;
+    pf->fields = tmp;
+    int itmp = maxnew;
+    maxnew = pf->maxfields;
+    pf->maxfields = itmp;
 
   } else if (multiproc_nfile >= nprocs || parallel) {
     bigint sum = 0;
@@ -831,6 +1078,8 @@ void ReadDump::read_atoms()
       nnew += nsnap;
     }
   }
+
+  if (pf) pf->ready = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -1233,6 +1482,7 @@ int ReadDump::fields_and_keywords(int narg, char **arg)
   // parse optional args
 
   multiproc_nfile = 0;
+  nslice = 1;
   boxflag = 1;
   replaceflag = 1;
   purgeflag = 0;
@@ -1247,6 +1497,12 @@ int ReadDump::fields_and_keywords(int narg, char **arg)
       if (iarg+2 > narg) error->all(FLERR,"Illegal read_dump command");
       multiproc_nfile = force->inumeric(FLERR,arg[iarg+1]);
       iarg += 2;
+    } else if (strcmp(arg[iarg],"readers") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal read_dump command");
+      nslice = force->inumeric(FLERR,arg[iarg+1]);
+      if (nslice <= 0) error->all(FLERR,"Illegal read_dump command");
+      nslice = MIN(nslice,nprocs);
+      iarg += 2;
     } else if (strcmp(arg[iarg],"box") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal read_dump command");
       if (strcmp(arg[iarg+1],"yes") == 0) boxflag = 1;
@@ -1316,6 +1572,8 @@ int ReadDump::fields_and_keywords(int narg, char **arg)
     error->all(FLERR,"Dump file is not a multi-proc file");
   if (multiproc && multiproc_nfile == 0)
     error->all(FLERR,"Dump file is a multi-proc file");
+  if (multiproc && nslice > 1)
+    error->all(FLERR,"Read_dump readers keyword requires a single dump file");
 
   if (purgeflag && (replaceflag || trimflag))
     error->all(FLERR,"If read_dump purges it cannot replace or trim");
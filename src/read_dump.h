@@ -39,6 +39,8 @@ class ReadDump : protected Pointers {
   bigint next(bigint, bigint, int, int);
   void atoms();
   int fields_and_keywords(int, char **);
+  void setup_prefetch();
+  void prefetch(bigint, bigint, int, int);
 
 private:
   int me,nprocs;
@@ -60,6 +62,9 @@ private:
   int filereader;          // 1 if this proc reads from a dump file(s)
   int parallel;            // 1 if parallel reading (e.g. via ADIOS2)
 
+  int nslice;              // # of procs reading slices of one dump file
+  int islice;              // which slice of each snapshot my cluster reads
+
   int dimension;           // same as in Domain
   int triclinic;
 
@@ -97,6 +102,8 @@ private:
                             // nreader-length list of readers if proc reads
                             //   from multiple parallel dump files
 
+  class ReadDumpPrefetch *pf;  // next snapshot read by background thread
+
   void read_atoms();
   void process_atoms();
   void migrate_old_atoms();
@@ -105,6 +112,10 @@ private:
 
   void setup_multiproc();
   int whichtype(char *);
+  void open_reader(int, int);
+  bigint find_next(int, int &, bigint, bigint, int, int);
+  void read_prefetch();
+  void fetch_snapshot();
 
   double xfield(int, int);
   double yfield(int, int);
@@ -185,6 +196,26 @@ E: Cannot add atoms if dump file does not store atom type
 
 UNDOCUMENTED
 
+E: Read_dump readers keyword requires a single dump file
+
+Dump files written in parallel with a "%" in the filename are already
+read by several procs.  Use the nfile keyword instead.
+
+E: Read_dump readers keyword is not supported by this reader style
+
+Reader styles which read dump files in parallel, like adios, already
+split each snapshot across procs.
+
+E: Read dump prefetch is not supported by this reader style
+
+Reader styles which read dump files in parallel, like adios, cannot
+read the next snapshot in the background.
+
+E: Read dump prefetch failed with unexpected exception
+
+Reading the next snapshot in the background failed in a way that is
+not a LAMMPS error, e.g. because memory could not be allocated.
+
 U: No box information in dump. You have to use 'box no'
 
 Self-explanatory.
@@ -14,6 +14,7 @@
 #include "read_restart.h"
 #include <mpi.h>
 #include <cstring>
+#include <map>
 #include <dirent.h>
 #include "atom.h"
 #include "atom_vec.h"
@@ -63,7 +64,29 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
      ATOM_ID,ATOM_MAP_STYLE,ATOM_MAP_USER,ATOM_SORTFREQ,ATOM_SORTBIN,
      COMM_MODE,COMM_CUTOFF,COMM_VEL,NO_PAIR,
      EXTRA_BOND_PER_ATOM,EXTRA_ANGLE_PER_ATOM,EXTRA_DIHEDRAL_PER_ATOM,
-     EXTRA_IMPROPER_PER_ATOM,EXTRA_SPECIAL_PER_ATOM,ATOM_MAXSPECIAL};
+     EXTRA_IMPROPER_PER_ATOM,EXTRA_SPECIAL_PER_ATOM,ATOM_MAXSPECIAL,
+     DELTA_BASE,DELTA_OFFSET,DELTA_CHUNKS,DELTA_PREC};
+
+// delta records, also in write_restart.cpp
+
+enum{COMPACT,IMAGE,FULL};
+
+static uint64_t get_varint(const char *&ptr)
+{
+  uint64_t value = 0;
+  int shift = 0;
+  while (*ptr & 0x80) {
+    value |= (uint64_t) (*ptr++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= (uint64_t) (*ptr++ & 0x7f) << shift;
+  return value;
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+  return (int64_t) (value >> 1) ^ -((int64_t) (value & 1));
+}
 
 #define LB_FACTOR 1.1
 
@@ -118,6 +141,9 @@ void ReadRestart::command(int narg, char **arg)
     error->all(FLERR,
                "Read restart MPI-IO input not allowed with % in filename");
 
+  deltaflag = 0;
+  basefile = NULL;
+
   if (mpiioflag) {
     mpiio = new RestartMPIIO(lmp);
     if (!mpiio->mpiio_exists)
@@ -232,6 +258,10 @@ void ReadRestart::command(int narg, char **arg)
     while (m < assignedChunkSize) m += avec->unpack_restart(&buf[m]);
   }
 
+  // input of delta file relative to a full file
+
+  else if (deltaflag) read_delta();
+
   // input of single native file
   // nprocs_file = # of chunks in file
   // proc 0 reads a chunk and bcasts it to other procs
@@ -449,12 +479,13 @@ void ReadRestart::command(int narg, char **arg)
   // clean-up memory
 
   delete [] file;
+  delete [] basefile;
   memory->destroy(buf);
 
-  // for multiproc or MPI-IO files:
+  // for multiproc or MPI-IO or delta files:
   // perform irregular comm to migrate atoms to correct procs
 
-  if (multiproc || mpiioflag) {
+  if (multiproc || mpiioflag || deltaflag) {
 
     // if remapflag set, remap all atoms I read back to box before migrating
 
@@ -1188,6 +1219,17 @@ void ReadRestart::file_layout()
         memory->destroy(nproc_chunk_sizes);
         memory->destroy(nproc_chunk_offsets);
       }
+
+    } else if (flag == DELTA_BASE) {
+      deltaflag = 1;
+      basefile = read_string();
+    } else if (flag == DELTA_OFFSET) {
+      baseoffset = read_bigint();
+    } else if (flag == DELTA_CHUNKS) {
+      basechunks = read_int();
+    } else if (flag == DELTA_PREC) {
+      read_int();
+      read_double_vec(2,deltaprec);
     }
 
     flag = read_int();
@@ -1202,6 +1244,176 @@ void ReadRestart::file_layout()
   }
 }
 
+/* ----------------------------------------------------------------------
+   read per-atom section of a delta file
+   proc 0 reads atoms of the base file and then delta records in chunks
+   each proc keeps the atoms it owns by atom ID, procs are not in sync
+     with the sub-domains, so atoms are migrated by the caller
+   compact records update x,v,image flags of an atom of the base file
+   full records replace an atom of the base file or add a new atom
+   atoms of the base file without a record have been deleted
+------------------------------------------------------------------------- */
+
+void ReadRestart::read_delta()
+{
+  AtomVec *avec = atom->avec;
+  int nextra = atom->nextra_store;
+
+  int maxbuf = 0;
+  double *buf = NULL;
+  int n,m;
+
+  // proc 0 reads the base file in place of the delta file
+
+  FILE *fpdelta = fp;
+  if (me == 0) {
+    fp = fopen(basefile,"rb");
+    if (fp == NULL) {
+      char str[128];
+      snprintf(str,128,"Cannot open restart base file %s",basefile);
+      error->one(FLERR,str);
+    }
+    fseek(fp,baseoffset,SEEK_SET);
+  }
+
+  for (int iproc = 0; iproc < basechunks; iproc++) {
+    if (read_int() != PERPROC)
+      error->all(FLERR,"Invalid flag in peratom section of restart file");
+
+    n = read_int();
+    if (n > maxbuf) {
+      maxbuf = n;
+      memory->destroy(buf);
+      memory->create(buf,maxbuf,"read_restart:buf");
+    }
+    read_double_vec(n,buf);
+
+    m = 0;
+    while (m < n) {
+      tagint tag = (tagint) ubuf(buf[m+4]).i;
+      if ((tag-1) % nprocs == me) m += avec->unpack_restart(&buf[m]);
+      else m += static_cast<int> (buf[m]);
+    }
+  }
+
+  if (me == 0) fclose(fp);
+  fp = fpdelta;
+
+  // local index of atoms of the base file
+
+  std::map<tagint,int> index;
+  for (int i = 0; i < atom->nlocal; i++) index[atom->tag[i]] = i;
+  std::map<tagint,int>::iterator it;
+
+  int *seen;
+  int maxseen = atom->nmax;
+  memory->create(seen,maxseen,"read_restart:seen");
+  for (int i = 0; i < atom->nlocal; i++) seen[i] = 0;
+
+  // read and apply delta records
+
+  int maxcbuf = 0;
+  char *cbuf = NULL;
+  int64_t q[6];
+
+  for (int iproc = 0; iproc < nprocs_file; iproc++) {
+    if (read_int() != PERPROC)
+      error->all(FLERR,"Invalid flag in peratom section of restart file");
+
+    n = read_int();
+    if (n > maxcbuf) {
+      maxcbuf = n;
+      memory->destroy(cbuf);
+      memory->create(cbuf,maxcbuf,"read_restart:cbuf");
+    }
+    read_char_vec(n,cbuf);
+
+    const char *ptr = cbuf;
+    tagint tag = 0;
+
+    while (ptr < cbuf + n) {
+      tag += unzigzag(get_varint(ptr));
+      int kind = *ptr++;
+      int mine = ((tag-1) % nprocs == me);
+
+      if (kind == FULL) {
+        int nrec = get_varint(ptr);
+        if (mine) {
+          if (nrec > maxbuf) {
+            maxbuf = nrec;
+            memory->destroy(buf);
+            memory->create(buf,maxbuf,"read_restart:buf");
+          }
+          memcpy(buf,ptr,nrec*sizeof(double));
+          avec->unpack_restart(buf);
+
+          // new atom replaces atom of base file with same ID
+
+          int j = atom->nlocal - 1;
+          if (j >= maxseen) {
+            maxseen = atom->nmax;
+            memory->grow(seen,maxseen,"read_restart:seen");
+          }
+          it = index.find(tag);
+          if (it != index.end()) {
+            int i = it->second;
+            avec->copy(j,i,0);
+            for (int k = 0; k < nextra; k++)
+              atom->extra[i][k] = atom->extra[j][k];
+            atom->nlocal--;
+            seen[i] = 1;
+          } else seen[j] = 1;
+        }
+        ptr += nrec*sizeof(double);
+
+      } else {
+        for (int k = 0; k < 6; k++) q[k] = unzigzag(get_varint(ptr));
+        imageint image = 0;
+        if (kind == IMAGE) image = (imageint) get_varint(ptr);
+
+        if (mine) {
+          it = index.find(tag);
+          if (it == index.end())
+            error->one(FLERR,"Restart delta file does not match its base file");
+          int i = it->second;
+          double *x = atom->x[i];
+          double *v = atom->v[i];
+          for (int k = 0; k < 3; k++) {
+            x[k] += q[k]*deltaprec[0];
+            v[k] += q[3+k]*deltaprec[1];
+          }
+          if (kind == IMAGE) atom->image[i] = image;
+          domain->remap(x,atom->image[i]);
+          seen[i] = 1;
+        }
+      }
+    }
+  }
+
+  // delete atoms of base file that are not in delta file
+
+  int i = 0;
+  while (i < atom->nlocal) {
+    if (!seen[i]) {
+      int j = atom->nlocal - 1;
+      avec->copy(j,i,0);
+      for (int k = 0; k < nextra; k++)
+        atom->extra[i][k] = atom->extra[j][k];
+      seen[i] = seen[j];
+      atom->nlocal--;
+    } else i++;
+  }
+
+  memory->destroy(seen);
+  memory->destroy(cbuf);
+  memory->destroy(buf);
+
+  if (me == 0) {
+    fclose(fp);
+    fp = NULL;
+  }
+}
+
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
 // low-level fread methods
@@ -1324,3 +1536,14 @@ void ReadRestart::read_double_vec(int n, double *vec)
   if (me == 0) utils::sfread(FLERR,vec,sizeof(double),n,fp,NULL,error);
   MPI_Bcast(vec,n,MPI_DOUBLE,0,world);
 }
+
+/* ----------------------------------------------------------------------
+   read vector of N chars from restart file and bcast them
+------------------------------------------------------------------------- */
+
+void ReadRestart::read_char_vec(int n, char *vec)
+{
+  if (n < 0) error->all(FLERR,"Illegal size char vector read requested");
+  if (me == 0) utils::sfread(FLERR,vec,sizeof(char),n,fp,NULL,error);
+  MPI_Bcast(vec,n,MPI_CHAR,0,world);
+}
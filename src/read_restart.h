@@ -45,6 +45,14 @@ class ReadRestart : protected Pointers {
   bigint assignedChunkSize;
   MPI_Offset assignedChunkOffset,headerOffset;
 
+  // delta file values
+
+  int deltaflag;               // 1 if restart file is a delta file
+  char *basefile;              // full file the deltas are relative to
+  bigint baseoffset;           // offset of per-atom section in basefile
+  int basechunks;              // # of per-proc chunks in basefile
+  double deltaprec[2];         // resolution of position and velocity deltas
+
   void file_search(char *, char *);
   void header(int);
   void type_arrays();
@@ -54,6 +62,7 @@ class ReadRestart : protected Pointers {
   void endian();
   int version_numeric();
   void file_layout();
+  void read_delta();
 
   int read_int();
   bigint read_bigint();
@@ -61,6 +70,7 @@ class ReadRestart : protected Pointers {
   char *read_string();
   void read_int_vec(int, int *);
   void read_double_vec(int, double *);
+  void read_char_vec(int, char *);
 };
 
 }
@@ -98,6 +108,17 @@ E: Invalid flag in peratom section of restart file
 
 The format of this section of the file is not correct.
 
+E: Cannot open restart base file %s
+
+A delta restart file stores only differences to the full restart file
+it was written after, which must be available under the same name.
+
+E: Restart delta file does not match its base file
+
+An atom in the delta file refers to an atom that is not stored in the
+base file.  The base file has probably been overwritten by a different
+full restart file.
+
 E: Did not assign all restart atoms correctly
 
 Atoms read in from the restart file were not assigned correctly to
@@ -13,10 +13,13 @@
 
 #include "reader.h"
 #include <cstring>
+#include "memory.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
 
+#define CHUNK 1024
+
 // only proc 0 calls methods of this class, except for constructor/destructor
 
 /* ---------------------------------------------------------------------- */
@@ -75,6 +78,25 @@ void Reader::close_file()
   fp = NULL;
 }
 
+/* ----------------------------------------------------------------------
+   skip N atoms of current snapshot, Nfield = # of fields per atom
+   generic version which reads and discards the atoms
+------------------------------------------------------------------------- */
+
+void Reader::skip_atoms(bigint n, int nfield)
+{
+  if (n <= 0) return;
+
+  double **buf;
+  memory->create(buf,MIN(n,CHUNK),nfield,"reader:buf");
+  while (n > 0) {
+    int nchunk = MIN(n,CHUNK);
+    read_atoms(nchunk,nfield,buf);
+    n -= nchunk;
+  }
+  memory->destroy(buf);
+}
+
 /* ----------------------------------------------------------------------
    detect unused arguments
 ------------------------------------------------------------------------- */
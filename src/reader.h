@@ -32,6 +32,7 @@ class Reader : protected Pointers {
   virtual bigint read_header(double [3][3], int &, int &, int, int, int *, char **,
                              int, int, int &, int &, int &, int &) = 0;
   virtual void read_atoms(int, int, double **) = 0;
+  virtual void skip_atoms(bigint, int);
 
   virtual void open_file(const char *);
   virtual void close_file();
@@ -177,11 +177,83 @@ bigint ReaderNative::read_header(double box[3][3], int &boxinfo, int &triclinic,
     }
   }
 
+  match_fields(nwords,labels,nfield,fieldtype,fieldlabel,scaleflag,wrapflag,
+               fieldflag,xflag,yflag,zflag);
+  delete [] labels;
+
+  // create internal vector of word ptrs for future parsing of per-atom lines
+
+  words = new char*[nwords];
+
+  return natoms;
+}
+
+/* ----------------------------------------------------------------------
+   read N atom lines from dump file
+   stores appropriate values in fields array
+   return 0 if success, 1 if error
+   only called by filereader procs, maybe in a background thread
+------------------------------------------------------------------------- */
+
+void ReaderNative::read_atoms(int n, int nfield, double **fields)
+{
+  int i,m;
+  char *eof,*ptr;
+
+  for (i = 0; i < n; i++) {
+    eof = fgets(line,MAXLINE,fp);
+    if (eof == NULL) error->one(FLERR,"Unexpected end of dump file");
+
+    // tokenize the line
+    // not via strtok() which keeps its state in a global variable
+
+    ptr = line;
+    for (m = 0; m < nwords; m++) {
+      ptr += strspn(ptr," \t\n\r\f");
+      words[m] = ptr;
+      ptr += strcspn(ptr," \t\n\r\f");
+      if (*ptr) *ptr++ = '\0';
+    }
+
+    // convert selected fields to floats
+
+    for (m = 0; m < nfield; m++)
+      fields[i][m] = atof(words[fieldindex[m]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   skip N atom lines of current snapshot without parsing them
+------------------------------------------------------------------------- */
+
+void ReaderNative::skip_atoms(bigint n, int /*nfield*/)
+{
+  int nchunk;
+  while (n > 0) {
+    nchunk = MIN(n,MAXSMALLINT);
+    read_lines(nchunk);
+    n -= nchunk;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   match each of Nfield requested fields with one of N column labels
+   allocate and set fieldindex = which column each field maps to
+   set fieldflag = -1 if any fields are not found, else 0
+   set xyz flags as described for read_header()
+------------------------------------------------------------------------- */
+
+void ReaderNative::match_fields(int nwords, char **labels, int nfield,
+                                int *fieldtype, char **fieldlabel,
+                                int scaleflag, int wrapflag, int &fieldflag,
+                                int &xflag, int &yflag, int &zflag)
+{
   // match each field with a column of per-atom data
   // if fieldlabel set, match with explicit column
   // else infer one or more column matches from fieldtype
   // xyz flag set by scaleflag + wrapflag (if fieldlabel set) or column label
 
+  memory->destroy(fieldindex);
   memory->create(fieldindex,nfield,"read_dump:fieldindex");
 
   int s_index,u_index,su_index;
@@ -296,48 +368,11 @@ bigint ReaderNative::read_header(double box[3][3], int &boxinfo, int &triclinic,
       fieldindex[i] = find_label("iz",nwords,labels);
   }
 
-  delete [] labels;
-
   // set fieldflag = -1 if any unfound fields
 
   fieldflag = 0;
   for (int i = 0; i < nfield; i++)
     if (fieldindex[i] < 0) fieldflag = -1;
-
-  // create internal vector of word ptrs for future parsing of per-atom lines
-
-  words = new char*[nwords];
-
-  return natoms;
-}
-
-/* ----------------------------------------------------------------------
-   read N atom lines from dump file
-   stores appropriate values in fields array
-   return 0 if success, 1 if error
-   only called by proc 0
-------------------------------------------------------------------------- */
-
-void ReaderNative::read_atoms(int n, int nfield, double **fields)
-{
-  int i,m;
-  char *eof;
-
-  for (i = 0; i < n; i++) {
-    eof = fgets(line,MAXLINE,fp);
-    if (eof == NULL) error->one(FLERR,"Unexpected end of dump file");
-
-    // tokenize the line
-
-    words[0] = strtok(line," \t\n\r\f");
-    for (m = 1; m < nwords; m++)
-      words[m] = strtok(NULL," \t\n\r\f");
-
-    // convert selected fields to floats
-
-    for (m = 0; m < nfield; m++)
-      fields[i][m] = atof(words[fieldindex[m]]);
-  }
 }
 
 /* ----------------------------------------------------------------------
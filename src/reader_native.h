@@ -36,14 +36,17 @@ class ReaderNative : public Reader {
   bigint read_header(double [3][3], int &, int &, int, int, int *, char **,
                      int, int, int &, int &, int &, int &);
   void read_atoms(int, int, double **);
+  void skip_atoms(bigint, int);
 
-private:
+protected:
   char *line;              // line read from dump file
 
   int nwords;              // # of per-atom columns in dump file
   char **words;            // ptrs to values in parsed per-atom line
-  int *fieldindex;         //
+  int *fieldindex;         // which column each requested field maps to
 
+  void match_fields(int, char **, int, int *, char **, int, int, int &,
+                    int &, int &, int &);
   int find_label(const char *, int, char **);
   void read_lines(int);
 };
@@ -49,6 +49,7 @@ void Rerun::command(int narg, char **arg)
     if (strcmp(arg[iarg],"skip") == 0) break;
     if (strcmp(arg[iarg],"start") == 0) break;
     if (strcmp(arg[iarg],"stop") == 0) break;
+    if (strcmp(arg[iarg],"prefetch") == 0) break;
     if (strcmp(arg[iarg],"dump") == 0) break;
     iarg++;
   }
@@ -66,6 +67,7 @@ void Rerun::command(int narg, char **arg)
   int stopflag = 0;
   bigint start = -1;
   bigint stop = -1;
+  int prefetchflag = 0;
 
   while (iarg < narg) {
     if (strcmp(arg[iarg],"first") == 0) {
@@ -100,6 +102,12 @@ void Rerun::command(int narg, char **arg)
       stop = force->bnumeric(FLERR,arg[iarg+1]);
       if (stop < 0) error->all(FLERR,"Illegal rerun command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"prefetch") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal rerun command");
+      if (strcmp(arg[iarg+1],"yes") == 0) prefetchflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) prefetchflag = 0;
+      else error->all(FLERR,"Illegal rerun command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"dump") == 0) {
       break;
     } else error->all(FLERR,"Illegal rerun command");
@@ -122,12 +130,14 @@ void Rerun::command(int narg, char **arg)
   else nremain = rd->fields_and_keywords(0,NULL);
   if (nremain) rd->setup_reader(nremain,&arg[narg-nremain]);
   else rd->setup_reader(0,NULL);
+  if (prefetchflag) rd->setup_prefetch();
 
   // perform the pseudo run
   // invoke lmp->init() only once
   // read all relevant snapshots
   // use setup_minimal() since atoms are already owned by correct procs
   // addstep_compute_all() insures energy/virial computed on every snapshot
+  // with prefetch, next snapshot is read while current one is evaluated
 
   update->whichflag = 1;
 
@@ -153,6 +163,7 @@ void Rerun::command(int narg, char **arg)
     rd->header(firstflag);
     update->reset_timestep(ntimestep);
     rd->atoms();
+    if (prefetchflag) rd->prefetch(ntimestep,last,nevery,nskip);
 
     modify->init();
     update->integrate->setup_minimal(1);
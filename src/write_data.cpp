@@ -37,6 +37,15 @@ using namespace LAMMPS_NS;
 
 enum{II,IJ};
 
+// binary sections of data file, also in read_data.cpp
+//   magic, endian, format revision, # of rows, # of values per row
+//   followed by rows of values as doubles or 64-bit ints
+
+#define MAGIC_BINARY "\0LMPDAT"
+#define MAGICLEN 8
+#define ENDIAN 0x0001
+#define REVISION_BINARY 1
+
 /* ---------------------------------------------------------------------- */
 
 WriteData::WriteData(LAMMPS *lmp) : Pointers(lmp)
@@ -73,6 +82,7 @@ void WriteData::command(int narg, char **arg)
   pairflag = II;
   coeffflag = 1;
   fixflag = 1;
+  binaryflag = 0;
   int noinit = 0;
 
   int iarg = 1;
@@ -92,9 +102,15 @@ void WriteData::command(int narg, char **arg)
     } else if (strcmp(arg[iarg],"nofix") == 0) {
       fixflag = 0;
       iarg++;
+    } else if (strcmp(arg[iarg],"binary") == 0) {
+      binaryflag = 1;
+      iarg++;
     } else error->all(FLERR,"Illegal write_data command");
   }
 
+  if (binaryflag && !atom->avec->binary_data_allow)
+    error->all(FLERR,"Atom style does not support binary data files");
+
   // init entire system since comm->exchange is done
   // comm::init needs neighbor::init needs pair::init needs kspace::init, etc
   // exception is when called by -r command-line switch
@@ -190,7 +206,8 @@ void WriteData::write(char *file)
   // open data file
 
   if (me == 0) {
-    fp = fopen(file,"w");
+    if (binaryflag) fp = fopen(file,"wb");
+    else fp = fopen(file,"w");
     if (fp == NULL) {
       char str[128];
       snprintf(str,128,"Cannot open data file %s",file);
@@ -356,12 +373,14 @@ void WriteData::atoms()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   if (me == 0) {
     MPI_Status status;
     MPI_Request request;
 
     fprintf(fp,"\nAtoms # %s\n\n",atom->atom_style);
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_DOUBLE,iproc,0,world,&request);
@@ -371,7 +390,8 @@ void WriteData::atoms()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_data(fp,recvrow,buf);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_data(fp,recvrow,buf);
     }
 
   } else {
@@ -410,12 +430,14 @@ void WriteData::velocities()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   if (me == 0) {
     MPI_Status status;
     MPI_Request request;
 
     fprintf(fp,"\nVelocities\n\n");
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_DOUBLE,iproc,0,world,&request);
@@ -425,7 +447,8 @@ void WriteData::velocities()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_vel(fp,recvrow,buf);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_vel(fp,recvrow,buf);
     }
 
   } else {
@@ -462,6 +485,7 @@ void WriteData::bonds()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   int index = 1;
   if (me == 0) {
@@ -469,6 +493,7 @@ void WriteData::bonds()
     MPI_Request request;
 
     fprintf(fp,"\nBonds\n\n");
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_LMP_TAGINT,iproc,0,world,&request);
@@ -478,7 +503,8 @@ void WriteData::bonds()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_bond(fp,recvrow,buf,index);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_bond(fp,recvrow,buf,index);
       index += recvrow;
     }
 
@@ -516,6 +542,7 @@ void WriteData::angles()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   int index = 1;
   if (me == 0) {
@@ -523,6 +550,7 @@ void WriteData::angles()
     MPI_Request request;
 
     fprintf(fp,"\nAngles\n\n");
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_LMP_TAGINT,iproc,0,world,&request);
@@ -532,7 +560,8 @@ void WriteData::angles()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_angle(fp,recvrow,buf,index);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_angle(fp,recvrow,buf,index);
       index += recvrow;
     }
 
@@ -588,6 +617,7 @@ void WriteData::dihedrals()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   int index = 1;
   if (me == 0) {
@@ -595,6 +625,7 @@ void WriteData::dihedrals()
     MPI_Request request;
 
     fprintf(fp,"\nDihedrals\n\n");
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_LMP_TAGINT,iproc,0,world,&request);
@@ -604,7 +635,8 @@ void WriteData::dihedrals()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_dihedral(fp,recvrow,buf,index);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_dihedral(fp,recvrow,buf,index);
       index += recvrow;
     }
 
@@ -660,6 +692,7 @@ void WriteData::impropers()
   // all other procs wait for ping, send their chunk to proc 0
 
   int tmp,recvrow;
+  bigint nrows = binary_rows_total(sendrow);
 
   int index = 1;
   if (me == 0) {
@@ -667,6 +700,7 @@ void WriteData::impropers()
     MPI_Request request;
 
     fprintf(fp,"\nImpropers\n\n");
+    if (binaryflag) binary_header(nrows,ncol);
     for (int iproc = 0; iproc < nprocs; iproc++) {
       if (iproc) {
         MPI_Irecv(&buf[0][0],maxrow*ncol,MPI_LMP_TAGINT,iproc,0,world,&request);
@@ -676,7 +710,8 @@ void WriteData::impropers()
         recvrow /= ncol;
       } else recvrow = sendrow;
 
-      atom->avec->write_improper(fp,recvrow,buf,index);
+      if (binaryflag) binary_rows(recvrow,ncol,&buf[0][0]);
+      else atom->avec->write_improper(fp,recvrow,buf,index);
       index += recvrow;
     }
 
@@ -741,3 +776,59 @@ void WriteData::fix(int ifix, int mth)
 
   memory->destroy(buf);
 }
+
+/* ----------------------------------------------------------------------
+   return total # of rows of a binary section, 0 if not binary
+------------------------------------------------------------------------- */
+
+bigint WriteData::binary_rows_total(int sendrow)
+{
+  if (!binaryflag) return 0;
+  bigint n = sendrow;
+  bigint nrows;
+  MPI_Allreduce(&n,&nrows,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  return nrows;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes header of binary section, it follows the section keyword
+   the leading NUL char of the magic string marks the section as binary
+------------------------------------------------------------------------- */
+
+void WriteData::binary_header(bigint nrows, int ncol)
+{
+  int endian = ENDIAN;
+  int revision = REVISION_BINARY;
+  bigint ncol_big = ncol;
+
+  fwrite(MAGIC_BINARY,sizeof(char),MAGICLEN,fp);
+  fwrite(&endian,sizeof(int),1,fp);
+  fwrite(&revision,sizeof(int),1,fp);
+  fwrite(&nrows,sizeof(bigint),1,fp);
+  fwrite(&ncol_big,sizeof(bigint),1,fp);
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes N rows of binary section
+   per-atom values are packed as doubles, with ints already 64-bit via ubuf
+------------------------------------------------------------------------- */
+
+void WriteData::binary_rows(int n, int ncol, double *buf)
+{
+  fwrite(buf,sizeof(double),(bigint) n*ncol,fp);
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes N rows of binary topology section
+   types and atom IDs are always written as 64-bit ints
+------------------------------------------------------------------------- */
+
+void WriteData::binary_rows(int n, int ncol, tagint *buf)
+{
+  bigint nvalues = (bigint) n*ncol;
+  bigint *values;
+  memory->create(values,MAX(nvalues,1),"write_data:values");
+  for (bigint i = 0; i < nvalues; i++) values[i] = buf[i];
+  fwrite(values,sizeof(bigint),nvalues,fp);
+  memory->destroy(values);
+}
@@ -35,6 +35,7 @@ class WriteData : protected Pointers {
   int pairflag;
   int coeffflag;
   int fixflag;
+  int binaryflag;
   FILE *fp;
   bigint nbonds_local,nbonds;
   bigint nangles_local,nangles;
@@ -51,6 +52,11 @@ class WriteData : protected Pointers {
   void dihedrals();
   void impropers();
   void fix(int, int);
+
+  bigint binary_rows_total(int);
+  void binary_header(bigint, int);
+  void binary_rows(int, int, double *);
+  void binary_rows(int, int, tagint *);
 };
 
 }
@@ -75,6 +81,11 @@ E: Atom count is inconsistent, cannot write data file
 The sum of atoms across processors does not equal the global number
 of atoms.  Probably some atoms have been lost.
 
+E: Atom style does not support binary data files
+
+Binary data files can only be written for atom styles atomic, charge,
+bond, angle, molecular, and full.
+
 E: Cannot open data file %s
 
 The specified file cannot be opened.  Check that the path and name are
@@ -13,7 +13,9 @@
 
 #include "write_restart.h"
 #include <mpi.h>
+#include <cmath>
 #include <cstring>
+#include "async_writer.h"
 #include "atom.h"
 #include "atom_vec.h"
 #include "group.h"
@@ -28,6 +30,7 @@
 #include "domain.h"
 #include "modify.h"
 #include "fix.h"
+#include "fix_store.h"
 #include "universe.h"
 #include "comm.h"
 #include "output.h"
@@ -62,7 +65,35 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
      ATOM_ID,ATOM_MAP_STYLE,ATOM_MAP_USER,ATOM_SORTFREQ,ATOM_SORTBIN,
      COMM_MODE,COMM_CUTOFF,COMM_VEL,NO_PAIR,
      EXTRA_BOND_PER_ATOM,EXTRA_ANGLE_PER_ATOM,EXTRA_DIHEDRAL_PER_ATOM,
-     EXTRA_IMPROPER_PER_ATOM,EXTRA_SPECIAL_PER_ATOM,ATOM_MAXSPECIAL};
+     EXTRA_IMPROPER_PER_ATOM,EXTRA_SPECIAL_PER_ATOM,ATOM_MAXSPECIAL,
+     DELTA_BASE,DELTA_OFFSET,DELTA_CHUNKS,DELTA_PREC};
+
+// delta records, also in read_restart.cpp
+//   varint of difference of atom ID to previous record, kind of record
+//   COMPACT = 6 varints of quantized x,v differences to base file
+//   IMAGE = same as COMPACT followed by varint of new image flags
+//   FULL = varint of record length, record as written by pack_restart()
+// signed values are zigzag-encoded so that small differences are short
+
+enum{COMPACT,IMAGE,FULL};
+
+#define MAXVARINT 10
+#define QMAX 1.0e18
+
+static char *put_varint(char *ptr, uint64_t value)
+{
+  while (value >= 0x80) {
+    *ptr++ = (char) (value | 0x80);
+    value >>= 7;
+  }
+  *ptr++ = (char) value;
+  return ptr;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+  return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -73,6 +104,30 @@ WriteRestart::WriteRestart(LAMMPS *lmp) : Pointers(lmp)
   multiproc = 0;
   noinit = 0;
   fp = NULL;
+
+  deltaflag = deltafile = 0;
+  nwrite = 0;
+  basefile = NULL;
+  generation = 0;
+  id_fix = NULL;
+  fix = NULL;
+
+  asyncflag = 0;
+  async = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+WriteRestart::~WriteRestart()
+{
+  // finish async output of the last restart file
+
+  wait_write();
+  delete async;
+
+  delete [] basefile;
+  if (id_fix && modify->nfix) modify->delete_fix(id_fix);
+  delete [] id_fix;
 }
 
 /* ----------------------------------------------------------------------
@@ -97,6 +152,17 @@ void WriteRestart::command(int narg, char **arg)
     *ptr = '*'; // must restore arg[0] so it can be correctly parsed below
   } else strcpy(file,arg[0]);
 
+  // delta files need the state of a previous restart file
+
+  // async output would be waited for when this command finishes
+
+  for (int iarg = 1; iarg < narg; iarg++) {
+    if (strcmp(arg[iarg],"delta") == 0)
+      error->all(FLERR,"Write_restart delta keyword requires restart command");
+    if (strcmp(arg[iarg],"async") == 0)
+      error->all(FLERR,"Write_restart async keyword requires restart command");
+  }
+
   // check for multiproc output and an MPI-IO filename
 
   if (strchr(arg[0],'%')) multiproc = nprocs;
@@ -226,8 +292,55 @@ void WriteRestart::multiproc_options(int multiproc_caller, int mpiioflag_caller,
     } else if (strcmp(arg[iarg],"noinit") == 0) {
       noinit = 1;
       iarg++;
+
+    } else if (strcmp(arg[iarg],"delta") == 0) {
+      if (iarg+4 > narg) error->all(FLERR,"Illegal write_restart command");
+      if (multiproc || mpiioflag)
+        error->all(FLERR,"Restart delta not allowed with % or MPI-IO "
+                   "in filename");
+      if (domain->box_exist == 0)
+        error->all(FLERR,"Restart delta keyword before simulation box "
+                   "is defined");
+      deltaflag = 1;
+      nfull = force->inumeric(FLERR,arg[iarg+1]);
+      xprec = force->numeric(FLERR,arg[iarg+2]);
+      vprec = force->numeric(FLERR,arg[iarg+3]);
+      if (nfull <= 0 || xprec <= 0.0 || vprec <= 0.0)
+        error->all(FLERR,"Illegal write_restart command");
+      iarg += 4;
+
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal write_restart command");
+      if (strcmp(arg[iarg+1],"yes") == 0) asyncflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) asyncflag = 0;
+      else error->all(FLERR,"Illegal write_restart command");
+      if (asyncflag && mpiioflag)
+        error->all(FLERR,"Restart async not allowed with MPI-IO in filename");
+      iarg += 2;
+
     } else error->all(FLERR,"Illegal write_restart command");
   }
+
+  if (asyncflag && async == NULL) async = new AsyncWriter(memory,"write_restart:async");
+
+  // create a new fix STORE style for per-atom values of last full file
+  // x,v,image flags, hash of all other values, generation of full file
+
+  if (deltaflag && id_fix == NULL) {
+    id_fix = new char[strlen("WRITE_RESTART_DELTA") + 1];
+    strcpy(id_fix,"WRITE_RESTART_DELTA");
+
+    char **newarg = new char*[6];
+    newarg[0] = id_fix;
+    newarg[1] = (char *) "all";
+    newarg[2] = (char *) "STORE";
+    newarg[3] = (char *) "peratom";
+    newarg[4] = (char *) "0";
+    newarg[5] = (char *) "9";
+    modify->add_fix(6,newarg);
+    fix = (FixStore *) modify->fix[modify->nfix-1];
+    delete [] newarg;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -246,6 +359,11 @@ void WriteRestart::write(char *file)
 
   if (neighbor->build_once) domain->reset_box();
 
+  // previous file must be complete before fp is reused
+  // also ensures a toggled restart file is never overwritten while written
+
+  wait_write();
+
   // natoms = sum of nlocal = value to write into restart file
   // if unequal and thermo lostflag is "error", don't write restart file
 
@@ -308,6 +426,20 @@ void WriteRestart::write(char *file)
   double *buf;
   memory->create(buf,max_size,"write_restart:buf");
 
+  // with delta files, only every Nth file is a full file
+  // other files store differences of atoms to the last full file
+  // a file which would overwrite the last full file is a full file
+
+  deltafile = 0;
+  if (deltaflag) {
+    int ifix = modify->find_fix(id_fix);
+    if (ifix < 0) error->all(FLERR,"Could not find restart delta fix ID");
+    fix = (FixStore *) modify->fix[ifix];
+    if (nwrite % nfull && basefile && strcmp(file,basefile) != 0)
+      deltafile = 1;
+    nwrite++;
+  }
+
   // all procs write file layout info which may include per-proc sizes
 
   file_layout(send_size);
@@ -397,6 +529,13 @@ void WriteRestart::write(char *file)
     }
   }
 
+  // store my atoms of a full file before buf is reused by output below
+
+  if (deltaflag && !deltafile) {
+    generation++;
+    store_base(buf);
+  }
+
   // MPI-IO output to single file
 
   if (mpiioflag) {
@@ -409,29 +548,48 @@ void WriteRestart::write(char *file)
     mpiio->close();
   }
 
+  // delta file of encoded atoms
+
+  else if (deltafile) write_delta(send_size,buf);
+
   // output of one or more native files
   // filewriter = 1 = this proc writes to file
   // ping each proc in my cluster, receive its data, write data to file
   // else wait for ping from fileproc, send my data to fileproc
 
+  // for async output, filewriter copies data of all procs into a snapshot
+  //   and a background thread writes it, so run continues immediately
+
   else {
     int tmp,recv_size;
 
     if (filewriter) {
       MPI_Status status;
       MPI_Request request;
+      if (asyncflag) async->clear();
       for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+        double *rbuf = buf;
+        if (asyncflag)
+          rbuf = (double *) async->reserve((bigint) max_size*sizeof(double));
         if (iproc) {
-          MPI_Irecv(buf,max_size,MPI_DOUBLE,me+iproc,0,world,&request);
+          MPI_Irecv(rbuf,max_size,MPI_DOUBLE,me+iproc,0,world,&request);
           MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
           MPI_Wait(&request,&status);
           MPI_Get_count(&status,MPI_DOUBLE,&recv_size);
-        } else recv_size = send_size;
+        } else {
+          recv_size = send_size;
+          if (asyncflag) memcpy(rbuf,buf,(bigint) send_size*sizeof(double));
+        }
 
-        write_double_vec(PERPROC,recv_size,buf);
+        if (asyncflag) async->append(recv_size,sizeof(double));
+        else write_double_vec(PERPROC,recv_size,buf);
+      }
+      if (asyncflag)
+        async->start(&WriteRestart::write_async,this);
+      else {
+        fclose(fp);
+        fp = NULL;
       }
-      fclose(fp);
-      fp = NULL;
 
     } else {
       MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
@@ -439,6 +597,15 @@ void WriteRestart::write(char *file)
     }
   }
 
+  // a full file becomes the base of following delta files
+
+  if (deltaflag && !deltafile) {
+    delete [] basefile;
+    basefile = new char[strlen(file) + 1];
+    strcpy(basefile,file);
+    basechunks = nprocs;
+  }
+
   // clean up
 
   memory->destroy(buf);
@@ -603,6 +770,16 @@ void WriteRestart::file_layout(int send_size)
     write_int(MPIIO,mpiioflag);
   }
 
+  if (me == 0 && deltafile) {
+    double prec[2];
+    prec[0] = xprec;
+    prec[1] = vprec;
+    write_string(DELTA_BASE,basefile);
+    write_bigint(DELTA_OFFSET,baseoffset);
+    write_int(DELTA_CHUNKS,basechunks);
+    write_double_vec(DELTA_PREC,2,prec);
+  }
+
   if (mpiioflag) {
     int *all_send_sizes;
     memory->create(all_send_sizes,nprocs,"write_restart:all_send_sizes");
@@ -625,6 +802,199 @@ void WriteRestart::file_layout(int send_size)
     if (me == 0) headerOffset = ftell(fp);
     MPI_Bcast(&headerOffset,1,MPI_LMP_BIGINT,0,world);
   }
+
+  // per-atom section of a full file is read again via a later delta file
+
+  if (deltaflag && !deltafile && me == 0) baseoffset = ftell(fp);
+}
+
+/* ----------------------------------------------------------------------
+   write per-atom section of a delta file
+   same as native output of a full file, but with encoded atoms as bytes
+------------------------------------------------------------------------- */
+
+void WriteRestart::write_delta(int send_size, double *buf)
+{
+  bigint nbytes = (bigint) send_size*sizeof(double) +
+    (bigint) atom->nlocal * (8*MAXVARINT+1);
+  if (nbytes > MAXSMALLINT)
+    error->one(FLERR,"Too much per-proc info for restart delta");
+
+  int max_bytes;
+  int send_bytes = nbytes;
+  MPI_Allreduce(&send_bytes,&max_bytes,1,MPI_INT,MPI_MAX,world);
+
+  char *cbuf;
+  memory->create(cbuf,max_bytes,"write_restart:cbuf");
+  send_bytes = encode_delta(buf,cbuf);
+
+  int tmp,recv_bytes;
+
+  if (filewriter) {
+    MPI_Status status;
+    MPI_Request request;
+    if (asyncflag) async->clear();
+    for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+      char *rbuf = cbuf;
+      if (asyncflag) rbuf = async->reserve(max_bytes);
+      if (iproc) {
+        MPI_Irecv(rbuf,max_bytes,MPI_CHAR,me+iproc,0,world,&request);
+        MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+        MPI_Wait(&request,&status);
+        MPI_Get_count(&status,MPI_CHAR,&recv_bytes);
+      } else {
+        recv_bytes = send_bytes;
+        if (asyncflag) memcpy(rbuf,cbuf,send_bytes);
+      }
+
+      if (asyncflag) async->append(recv_bytes,sizeof(char));
+      else write_char_vec(PERPROC,recv_bytes,cbuf);
+    }
+    if (asyncflag) async->start(&WriteRestart::write_async,this);
+    else {
+      fclose(fp);
+      fp = NULL;
+    }
+
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
+    MPI_Rsend(cbuf,send_bytes,MPI_CHAR,fileproc,0,world);
+  }
+
+  memory->destroy(cbuf);
+}
+
+/* ----------------------------------------------------------------------
+   body of background thread for restart async yes
+   write all per-proc blocks gathered by write() or write_delta()
+   must not communicate or call into the rest of LAMMPS
+------------------------------------------------------------------------- */
+
+void WriteRestart::write_async()
+{
+  const int nblocks = async->count.size();
+  for (int i = 0; i < nblocks; i++) {
+    char *block = async->data + async->offset[i];
+    if (async->size[i] == sizeof(double))
+      write_double_vec(PERPROC,async->count[i],(double *) block);
+    else write_char_vec(PERPROC,async->count[i],block);
+  }
+  fclose(fp);
+  fp = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   wait until background thread has written the previous restart file
+   must be called before fp is reused or the restart file is read
+   a failure reported by the thread is raised here
+------------------------------------------------------------------------- */
+
+void WriteRestart::wait_write()
+{
+  if (async == NULL) return;
+  std::string mesg = async->wait();
+  if (!mesg.empty()) error->one(FLERR,mesg.c_str());
+}
+
+/* ----------------------------------------------------------------------
+   encode my atoms packed in buf as delta records into cbuf
+   an atom is COMPACT if it is in the base file and all its values
+     except x,v,image flags are unchanged, else it is written in FULL
+   return # of bytes in cbuf
+------------------------------------------------------------------------- */
+
+int WriteRestart::encode_delta(double *buf, char *cbuf)
+{
+  double **base = fix->astore;
+  int nlocal = atom->nlocal;
+
+  char *ptr = cbuf;
+  tagint prevtag = 0;
+  int64_t q[6];
+  int m = 0;
+
+  for (int i = 0; i < nlocal; i++) {
+    double *rec = &buf[m];
+    int n = static_cast<int> (rec[0]);
+    tagint tag = (tagint) ubuf(rec[4]).i;
+    imageint image = (imageint) ubuf(rec[7]).i;
+
+    int kind = FULL;
+    if (ubuf(base[i][8]).i == generation &&
+        ubuf(base[i][7]).i == record_hash(rec)) {
+      kind = COMPACT;
+      for (int k = 0; k < 6; k++) {
+        double value = (k < 3) ? rec[1+k] : rec[5+k];
+        double delta = (value - base[i][k]) / ((k < 3) ? xprec : vprec);
+        if (fabs(delta) > QMAX) kind = FULL;
+        else q[k] = static_cast<int64_t> (floor(delta + 0.5));
+      }
+      if (kind == COMPACT && image != (imageint) ubuf(base[i][6]).i)
+        kind = IMAGE;
+    }
+
+    ptr = put_varint(ptr,zigzag(tag - prevtag));
+    prevtag = tag;
+    *ptr++ = (char) kind;
+
+    if (kind == FULL) {
+      ptr = put_varint(ptr,n);
+      memcpy(ptr,rec,n*sizeof(double));
+      ptr += n*sizeof(double);
+    } else {
+      for (int k = 0; k < 6; k++) ptr = put_varint(ptr,zigzag(q[k]));
+      if (kind == IMAGE) ptr = put_varint(ptr,(uint64_t) image);
+    }
+
+    m += n;
+  }
+
+  return ptr - cbuf;
+}
+
+/* ----------------------------------------------------------------------
+   store per-atom values of full file as base for following delta files
+------------------------------------------------------------------------- */
+
+void WriteRestart::store_base(double *buf)
+{
+  double **base = fix->astore;
+  int nlocal = atom->nlocal;
+
+  int m = 0;
+  for (int i = 0; i < nlocal; i++) {
+    double *rec = &buf[m];
+    base[i][0] = rec[1];
+    base[i][1] = rec[2];
+    base[i][2] = rec[3];
+    base[i][3] = rec[8];
+    base[i][4] = rec[9];
+    base[i][5] = rec[10];
+    base[i][6] = rec[7];
+    base[i][7] = ubuf(record_hash(rec)).d;
+    base[i][8] = ubuf(generation).d;
+    m += static_cast<int> (rec[0]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   FNV-1a hash of all values of an atom record except x,image flags,v
+   all atom styles pack x,tag,type,mask,image,v first in pack_restart()
+------------------------------------------------------------------------- */
+
+int64_t WriteRestart::record_hash(double *rec)
+{
+  int n = static_cast<int> (rec[0]);
+  uint64_t hash = 14695981039346656037ULL;
+  for (int j = 0; j < n; j++) {
+    if ((j >= 1 && j <= 3) || (j >= 7 && j <= 10)) continue;
+    const unsigned char *bytes = (const unsigned char *) &rec[j];
+    for (int b = 0; b < (int) sizeof(double); b++) {
+      hash ^= bytes[b];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return (int64_t) hash;
 }
 
 // ----------------------------------------------------------------------
@@ -723,3 +1093,14 @@ void WriteRestart::write_double_vec(int flag, int n, double *vec)
   fwrite(&n,sizeof(int),1,fp);
   fwrite(vec,sizeof(double),n,fp);
 }
+
+/* ----------------------------------------------------------------------
+   write a flag and vector of N chars into restart file
+------------------------------------------------------------------------- */
+
+void WriteRestart::write_char_vec(int flag, int n, char *vec)
+{
+  fwrite(&flag,sizeof(int),1,fp);
+  fwrite(&n,sizeof(int),1,fp);
+  fwrite(vec,sizeof(char),n,fp);
+}
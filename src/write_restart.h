@@ -21,15 +21,18 @@ CommandStyle(write_restart,WriteRestart)
 #define LMP_WRITE_RESTART_H
 
 #include "pointers.h"
+#include <cstdint>
 
 namespace LAMMPS_NS {
 
 class WriteRestart : protected Pointers {
  public:
   WriteRestart(class LAMMPS *);
+  ~WriteRestart();
   void command(int, char **);
   void multiproc_options(int, int, int, char **);
   void write(char *);
+  void wait_write();
 
  private:
   int me,nprocs;
@@ -50,6 +53,25 @@ class WriteRestart : protected Pointers {
   class RestartMPIIO *mpiio;   // MPIIO for restart file output
   MPI_Offset headerOffset;
 
+  // delta file values
+
+  int deltaflag;             // 1 if files between full files are deltas
+  int deltafile;             // 1 if file being written is a delta file
+  int nfull;                 // every Nth file is a full file
+  int nwrite;                // # of files written so far
+  double xprec,vprec;        // resolution of position and velocity deltas
+  char *basefile;            // last full file, deltas are relative to it
+  bigint baseoffset;         // offset of per-atom section in basefile
+  int basechunks;            // # of per-proc chunks in basefile
+  bigint generation;         // # of full files written so far
+  char *id_fix;              // ID of fix STORE with per-atom base values
+  class FixStore *fix;
+
+  // background output values
+
+  int asyncflag;                // 1 if per-atom section is written by thread
+  class AsyncWriter *async;     // snapshot and thread for async output
+
   void header();
   void type_arrays();
   void force_fields();
@@ -65,6 +87,13 @@ class WriteRestart : protected Pointers {
   void write_string(int, const char *);
   void write_int_vec(int, int, int *);
   void write_double_vec(int, int, double *);
+  void write_char_vec(int, int, char *);
+
+  void write_delta(int, double *);
+  int encode_delta(double *, char *);
+  void store_base(double *);
+  int64_t record_hash(double *);
+  void write_async();
 };
 
 }
@@ -102,6 +131,39 @@ E: Cannot use write_restart nfile without % in restart file name
 
 Self-explanatory.
 
+E: Write_restart delta keyword requires restart command
+
+Delta files are relative to a previous full restart file, so they can
+only be written periodically via the restart command.
+
+E: Restart delta not allowed with % or MPI-IO in filename
+
+Delta files can only be written as a single native restart file.
+
+E: Write_restart async keyword requires restart command
+
+A restart file written by the write_restart command is complete when
+the command finishes, so it cannot be written in the background.
+
+E: Restart async not allowed with MPI-IO in filename
+
+MPI-IO output is collective and cannot be done by a background thread.
+
+E: Restart delta keyword before simulation box is defined
+
+The restart command with the delta keyword must be used after a
+read_data, read_restart, or create_box command.
+
+E: Could not find restart delta fix ID
+
+The internal fix which stores the atoms of the last full restart file
+has been deleted by an unfix command.
+
+E: Too much per-proc info for restart delta
+
+The encoded atoms of one processor must fit in a 32-bit integer
+number of bytes.
+
 E: Atom count is inconsistent, cannot write restart file
 
 Sum of atoms across processors does not equal initial total count.